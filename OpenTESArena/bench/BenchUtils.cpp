@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "BenchUtils.h"
+#include "../src/World/ChunkUtils.h"
+#include "../src/World/VoxelDefinition.h"
+
+BenchUtils::CityWorld::CityWorld(SNInt gridWidth, WEInt gridDepth, int seed)
+	: voxelGrid(gridWidth, 3, gridDepth), random(seed) { }
+
+bool BenchUtils::CityWorld::isBlock(SNInt x, WEInt z)
+{
+	return ((x % CityWorld::BLOCK_SPACING) == 0) && ((z % CityWorld::BLOCK_SPACING) == 0);
+}
+
+std::unique_ptr<BenchUtils::CityWorld> BenchUtils::makeCityWorld(int chunkCount, int seed)
+{
+	const SNInt gridWidth = chunkCount * ChunkUtils::CHUNK_DIM;
+	const WEInt gridDepth = chunkCount * ChunkUtils::CHUNK_DIM;
+	auto world = std::make_unique<CityWorld>(gridWidth, gridDepth, seed);
+
+	VoxelGrid &voxelGrid = world->voxelGrid;
+	const uint16_t floorID = voxelGrid.addVoxelDef(VoxelDefinition::makeFloor(0));
+	const uint16_t wallID = voxelGrid.addVoxelDef(
+		VoxelDefinition::makeWall(0, 0, 0, std::nullopt, VoxelDefinition::WallData::Type::Solid));
+
+	for (WEInt z = 0; z < gridDepth; z++)
+	{
+		for (SNInt x = 0; x < gridWidth; x++)
+		{
+			voxelGrid.setVoxel(x, 0, z, floorID);
+			if (CityWorld::isBlock(x, z))
+			{
+				voxelGrid.setVoxel(x, 1, z, wallID);
+			}
+		}
+	}
+
+	world->entityManager.init(chunkCount, chunkCount);
+
+	// Entity ray hits need the software renderer, but not a window.
+	Renderer &renderer = world->renderer;
+	renderer.initHeadless(64, 40);
+	renderer.initializeWorldRendering(1.0, true, 0, false, false, false, false);
+
+	return world;
+}
+
+bool BenchUtils::parseArgs(int argc, char *argv[], const ArgHandler &handler)
+{
+	// Every argument has a value.
+	if ((argc % 2) == 0)
+	{
+		std::fprintf(stderr, "Missing value for \"%s\".\n", argv[argc - 1]);
+		return false;
+	}
+
+	for (int i = 1; (i + 1) < argc; i += 2)
+	{
+		const std::string arg(argv[i]);
+		const char *value = argv[i + 1];
+		if (!handler(arg, value))
+		{
+			std::fprintf(stderr, "Invalid argument \"%s %s\".\n", arg.c_str(), value);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+double BenchUtils::getPercentile(const std::vector<double> &sortedSamples, double percentile)
+{
+	const size_t count = sortedSamples.size();
+	if (count == 0)
+	{
+		return 0.0;
+	}
+
+	const size_t rank = static_cast<size_t>(std::ceil((percentile / 100.0) * static_cast<double>(count)));
+	const size_t index = std::min(std::max<size_t>(rank, 1), count) - 1;
+	return sortedSamples[index];
+}
+
+double BenchUtils::getMean(const std::vector<double> &samples)
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	return std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+}
+
+FILE *BenchUtils::openOutput(const std::string &path)
+{
+	if (path.empty())
+	{
+		return stdout;
+	}
+
+	FILE *file = std::fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		std::fprintf(stderr, "Couldn't open \"%s\" for writing.\n", path.c_str());
+	}
+
+	return file;
+}
+
+void BenchUtils::closeOutput(FILE *file)
+{
+	if ((file != nullptr) && (file != stdout))
+	{
+		std::fclose(file);
+	}
+}
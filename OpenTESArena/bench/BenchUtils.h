@@ -0,0 +1,68 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/Entities/EntityDefinitionLibrary.h"
+#include "../src/Entities/EntityManager.h"
+#include "../src/Math/Random.h"
+#include "../src/Rendering/Renderer.h"
+#include "../src/World/LevelData.h"
+#include "../src/World/VoxelGrid.h"
+#include "../src/World/VoxelUtils.h"
+
+// Command line, statistics, and output helpers shared by the benchmark executables, and the
+// synthetic city the entity and physics benchmarks run in so they don't need game data.
+
+namespace BenchUtils
+{
+	// Floor everywhere with a regular pattern of wall blocks, like city streets, an empty entity
+	// manager, and a small headless renderer. Kept on the heap since the grid and renderer are large.
+	struct CityWorld
+	{
+		static constexpr int BLOCK_SPACING = 6; // Voxels between wall blocks.
+
+		VoxelGrid voxelGrid;
+		EntityManager entityManager;
+		EntityDefinitionLibrary entityDefLibrary;
+		LevelData::ChasmStates chasmStates;
+		Renderer renderer; // Entity rays can't be pixel-perfect since there are no flat textures.
+		Random random;
+
+		CityWorld(SNInt gridWidth, WEInt gridDepth, int seed);
+
+		// Returns whether the voxel column has a wall block.
+		static bool isBlock(SNInt x, WEInt z);
+	};
+
+	// Makes a city with the given number of chunks per side. The seed is for the world's random
+	// generator.
+	std::unique_ptr<CityWorld> makeCityWorld(int chunkCount, int seed);
+
+	// Handles one "--name value" argument pair. Returns false if the argument isn't recognized
+	// or its value is invalid.
+	using ArgHandler = std::function<bool(const std::string &arg, const char *value)>;
+
+	// Passes each "--name value" pair on the command line to the handler. Returns false and
+	// prints why if an argument is missing its value or is rejected by the handler.
+	bool parseArgs(int argc, char *argv[], const ArgHandler &handler);
+
+	// Nearest-rank percentile of sorted samples, or zero if there are none.
+	double getPercentile(const std::vector<double> &sortedSamples, double percentile);
+
+	// Mean of the samples, or zero if there are none.
+	double getMean(const std::vector<double> &samples);
+
+	// Opens the results file for writing, or returns stdout if the path is empty. Returns null and
+	// prints why if the file can't be opened.
+	FILE *openOutput(const std::string &path);
+
+	// Closes a file from openOutput().
+	void closeOutput(FILE *file);
+}
+
+#endif
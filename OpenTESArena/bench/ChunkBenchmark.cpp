@@ -0,0 +1,205 @@
+// Chunk streaming benchmark. Builds the wilderness map definition from the game data, walks the
+// player across it, and times each frame's chunk manager update to find hitches. Chunks are either
+// populated synchronously (no worker threads, like before streaming) or on worker threads, so the
+// two can be compared.
+//
+// Usage: bench_chunks [--frames 1200] [--speed 32] [--chunk-distance 6] [--output results.json]
+//
+// "max_ms" is the hitch metric: the longest frame spent in the chunk manager while traversing.
+// "sync_builds" counts chunks the player reached before a worker had them ready.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "../src/Assets/ExeData.h"
+#include "../src/Entities/EntityManager.h"
+#include "../src/Game/HeadlessRender.h"
+#include "../src/World/ArenaWildUtils.h"
+#include "../src/World/ChunkManager.h"
+#include "../src/World/ChunkUtils.h"
+#include "../src/World/ClimateType.h"
+#include "../src/World/MapDefinition.h"
+#include "../src/World/MapGeneration.h"
+#include "../src/World/SkyGeneration.h"
+#include "../src/World/WeatherType.h"
+#include "../src/World/WorldType.h"
+
+#include "components/utilities/JobPool.h"
+
+namespace
+{
+	constexpr int DefaultFrameCount = 1200;
+	constexpr double DefaultSpeed = 32.0; // Voxels per second, faster than running to stress streaming.
+	constexpr int DefaultChunkDistance = 6;
+	constexpr double FrameSeconds = 1.0 / 60.0;
+	constexpr uint32_t WildSeed = 12345;
+	constexpr int StartChunk = 16; // Far enough from the wild's edge for the whole walk.
+
+	bool MakeWildMap(HeadlessRender::Session &session, MapDefinition *outMapDef, SNInt *outChunkCountX,
+		WEInt *outChunkCountZ)
+	{
+		const ExeData &exeData = session.binaryAssetLibrary.getExeData();
+		Buffer2D<ArenaWildUtils::WildBlockID> wildBlockIDs =
+			ArenaWildUtils::generateWildernessIndices(WildSeed, exeData.wild);
+		*outChunkCountX = wildBlockIDs.getWidth();
+		*outChunkCountZ = wildBlockIDs.getHeight();
+
+		MapGeneration::WildGenInfo wildGenInfo;
+		wildGenInfo.init(std::move(wildBlockIDs), WildSeed);
+
+		SkyGeneration::ExteriorSkyGenInfo skyGenInfo;
+		skyGenInfo.init(ClimateType::Temperate, WeatherType::Clear, 1, 0, WildSeed, WildSeed, false);
+
+		return outMapDef->initWild(wildGenInfo, ClimateType::Temperate, WeatherType::Clear, skyGenInfo,
+			session.charClassLibrary, session.entityDefLibrary, session.binaryAssetLibrary,
+			session.textureManager);
+	}
+
+	struct Run
+	{
+		std::vector<double> samples; // Seconds per frame in the chunk manager.
+		double maxSeconds;
+		int syncBuildCount;
+	};
+
+	Run RunTraversal(const MapDefinition &mapDef, SNInt chunkCountX, WEInt chunkCountZ, int threadCount,
+		int chunkDistance, int frameCount, double speed)
+	{
+		JobPool jobPool;
+		jobPool.init(threadCount, "Chunk job");
+
+		EntityManager entityManager;
+		entityManager.init(chunkCountX, chunkCountZ);
+
+		auto chunkManager = std::make_unique<ChunkManager>();
+		chunkManager->init(WorldType::Wilderness, chunkDistance);
+
+		// Let the starting area finish loading before timing, like arriving from a loading screen.
+		const double startCoord = static_cast<double>(StartChunk * ChunkUtils::CHUNK_DIM) + 0.50;
+		NewDouble2 position(startCoord, startCoord);
+		const NewDouble2 velocity(speed, 0.0);
+		for (int i = 0; i < 2; i++)
+		{
+			chunkManager->update(position, NewDouble2::Zero, mapDef, 0, jobPool, entityManager);
+			chunkManager->waitForBuilds();
+		}
+
+		chunkManager->update(position, NewDouble2::Zero, mapDef, 0, jobPool, entityManager);
+		chunkManager->resetStreamingStats();
+
+		Run run;
+		run.samples.reserve(frameCount);
+		for (int i = 0; i < frameCount; i++)
+		{
+			position = position + (velocity * FrameSeconds);
+			chunkManager->update(position, velocity, mapDef, 0, jobPool, entityManager);
+			run.samples.push_back(chunkManager->getLastUpdateSeconds());
+
+			// Leave the workers the rest of the frame, as the game would while it renders.
+			const double sleepSeconds = std::max(FrameSeconds - chunkManager->getLastUpdateSeconds(), 0.0);
+			std::this_thread::sleep_for(std::chrono::duration<double>(sleepSeconds));
+		}
+
+		run.maxSeconds = chunkManager->getMaxUpdateSeconds();
+		run.syncBuildCount = chunkManager->getSyncBuildCount();
+
+		// The chunk manager waits for its workers before the job pool goes away.
+		chunkManager = nullptr;
+		return run;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int frameCount = DefaultFrameCount;
+	double speed = DefaultSpeed;
+	int chunkDistance = DefaultChunkDistance;
+	std::string outputPath;
+
+	const bool parsedArgs = BenchUtils::parseArgs(argc, argv, [&frameCount, &speed, &chunkDistance,
+		&outputPath](const std::string &arg, const char *value)
+	{
+		if (arg == "--frames")
+		{
+			frameCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--speed")
+		{
+			speed = std::max(std::atof(value), 0.0);
+		}
+		else if (arg == "--chunk-distance")
+		{
+			chunkDistance = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--output")
+		{
+			outputPath = value;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	});
+
+	if (!parsedArgs)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Allocated on the heap since the libraries are large. The renderer isn't used.
+	auto session = std::make_unique<HeadlessRender::Session>();
+	if (!session->init(64, 40))
+	{
+		return EXIT_FAILURE;
+	}
+
+	MapDefinition mapDef;
+	SNInt chunkCountX;
+	WEInt chunkCountZ;
+	if (!MakeWildMap(*session, &mapDef, &chunkCountX, &chunkCountZ))
+	{
+		std::fprintf(stderr, "Couldn't create wilderness map definition.\n");
+		return EXIT_FAILURE;
+	}
+
+	FILE *file = BenchUtils::openOutput(outputPath);
+	if (file == nullptr)
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::fprintf(file, "{\n  \"frames\": %d,\n  \"speed\": %.1f,\n  \"chunk_distance\": %d,\n  \"units\": \"ms\",\n"
+		"  \"runs\": [\n", frameCount, speed, chunkDistance);
+
+	// No worker threads populates every chunk during the update, like before streaming.
+	const int workerThreadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+	const int threadCounts[] = { 0, workerThreadCount };
+	const int runCount = static_cast<int>(std::size(threadCounts));
+	for (int runIndex = 0; runIndex < runCount; runIndex++)
+	{
+		const int threadCount = threadCounts[runIndex];
+		Run run = RunTraversal(mapDef, chunkCountX, chunkCountZ, threadCount, chunkDistance, frameCount, speed);
+		std::sort(run.samples.begin(), run.samples.end());
+
+		std::fprintf(file, "    { \"mode\": \"%s\", \"threads\": %d, \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, "
+			"\"max_ms\": %.4f, \"sync_builds\": %d }%s\n", (threadCount == 0) ? "sync" : "async", threadCount,
+			BenchUtils::getMean(run.samples) * 1000.0, BenchUtils::getPercentile(run.samples, 50.0) * 1000.0,
+			BenchUtils::getPercentile(run.samples, 99.0) * 1000.0,
+			run.maxSeconds * 1000.0, run.syncBuildCount, ((runIndex + 1) < runCount) ? "," : "");
+	}
+
+	std::fprintf(file, "  ]\n}\n");
+
+	BenchUtils::closeOutput(file);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,334 @@
+// Microbenchmark for the software renderer's column kernels. Times each kernel table available on
+// this CPU against the scalar table and checks that their output matches. The double kernels
+// must match exactly since default builds use them in place of the scalar shaders.
+//
+// Usage: column_kernels_bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/Rendering/ColumnKernels.h"
+
+namespace
+{
+	constexpr int DefaultIterations = 200000;
+	constexpr int RowWidth = 1920; // Sky gradient rows are a full frame wide.
+
+	// Inputs shaped like one chunk of a voxel column.
+	struct ChunkInputs
+	{
+		alignas(ColumnKernels::ChunkAlignment) int rows[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float r[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float g[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float b[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float emission[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float lightContributions[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) float fogPercents[ColumnKernels::ChunkSize];
+		ColumnKernels::ShadeParams params;
+
+		// The same inputs for the double kernels.
+		alignas(ColumnKernels::ChunkAlignment) double rDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double gDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double bDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double emissionDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double lightContributionsDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double fogPercentsDouble[ColumnKernels::ChunkSize];
+		ColumnKernels::ShadeParamsDouble paramsDouble;
+	};
+
+	struct ChunkOutputs
+	{
+		alignas(ColumnKernels::ChunkAlignment) float v[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double vDouble[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) uint32_t colors[ColumnKernels::ChunkSize];
+	};
+
+	void MakeInputs(ChunkInputs &inputs)
+	{
+		std::mt19937 rng(12345);
+		std::uniform_real_distribution<float> channelDist(0.0f, 1.0f);
+		std::uniform_real_distribution<float> lightDist(0.0f, 0.5f);
+
+		for (int i = 0; i < ColumnKernels::ChunkSize; i++)
+		{
+			inputs.rows[i] = 100 + i;
+			inputs.r[i] = channelDist(rng);
+			inputs.g[i] = channelDist(rng);
+			inputs.b[i] = channelDist(rng);
+			inputs.emission[i] = ((i % 7) == 0) ? 1.0f : 0.0f;
+			inputs.lightContributions[i] = lightDist(rng);
+			inputs.fogPercents[i] = channelDist(rng);
+		}
+
+		inputs.params.ambient = 0.45f;
+		inputs.params.fade = 1.0f;
+		inputs.params.fogR = 0.30f;
+		inputs.params.fogG = 0.35f;
+		inputs.params.fogB = 0.40f;
+		inputs.params.lightContribution = 0.20f;
+		inputs.params.fogPercent = 0.25f;
+
+		for (int i = 0; i < ColumnKernels::ChunkSize; i++)
+		{
+			inputs.rDouble[i] = inputs.r[i];
+			inputs.gDouble[i] = inputs.g[i];
+			inputs.bDouble[i] = inputs.b[i];
+			inputs.emissionDouble[i] = inputs.emission[i];
+			inputs.lightContributionsDouble[i] = inputs.lightContributions[i];
+			inputs.fogPercentsDouble[i] = inputs.fogPercents[i];
+		}
+
+		inputs.paramsDouble.ambient = 0.45;
+		inputs.paramsDouble.fade = 0.90;
+		inputs.paramsDouble.fogR = 0.30;
+		inputs.paramsDouble.fogG = 0.35;
+		inputs.paramsDouble.fogB = 0.40;
+		inputs.paramsDouble.lightContribution = 0.20;
+		inputs.paramsDouble.fogPercent = 0.25;
+	}
+
+	// Runs the function the given number of times and returns nanoseconds per pixel.
+	template <typename FunctionType>
+	double TimeKernel(int iterations, int pixelsPerIteration, FunctionType &&function)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			function();
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double nanoseconds = static_cast<double>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count());
+		return nanoseconds / (static_cast<double>(iterations) * static_cast<double>(pixelsPerIteration));
+	}
+
+	int GetMaxChannelDiff(uint32_t a, uint32_t b)
+	{
+		int maxDiff = 0;
+		for (int shift = 0; shift < 24; shift += 8)
+		{
+			const int channelA = static_cast<int>((a >> shift) & 0xFF);
+			const int channelB = static_cast<int>((b >> shift) & 0xFF);
+			maxDiff = std::max(maxDiff, std::abs(channelA - channelB));
+		}
+
+		return maxDiff;
+	}
+
+	struct KernelTimings
+	{
+		double interpolateV, shadeConstant, shadePerPixel, fillSpan;
+		double interpolateVDouble, shadePerPixelDouble;
+	};
+
+	KernelTimings BenchmarkTable(const ColumnKernels::Table &table, const ChunkInputs &inputs,
+		int iterations, ChunkOutputs &outputs)
+	{
+		constexpr int count = ColumnKernels::ChunkSize;
+		std::vector<uint32_t> rowColors(RowWidth);
+		std::vector<double> rowDepths(RowWidth);
+
+		// Accumulate outputs so the optimizer can't drop kernel calls.
+		volatile uint32_t sink = 0;
+
+		KernelTimings timings;
+		timings.interpolateV = TimeKernel(iterations, count, [&]()
+		{
+			table.interpolateV(inputs.rows, count, 90.50f, 420.25f, 0.0f, 0.99999f, outputs.v);
+			sink = sink + static_cast<uint32_t>(outputs.v[count - 1] * 1000.0f);
+		});
+
+		timings.shadeConstant = TimeKernel(iterations, count, [&]()
+		{
+			table.shadePixels(inputs.r, inputs.g, inputs.b, inputs.emission, nullptr, nullptr,
+				count, inputs.params, outputs.colors);
+			sink = sink + outputs.colors[count - 1];
+		});
+
+		timings.shadePerPixel = TimeKernel(iterations, count, [&]()
+		{
+			table.shadePixels(inputs.r, inputs.g, inputs.b, inputs.emission,
+				inputs.lightContributions, inputs.fogPercents, count, inputs.params, outputs.colors);
+			sink = sink + outputs.colors[count - 1];
+		});
+
+		timings.interpolateVDouble = TimeKernel(iterations, count, [&]()
+		{
+			table.interpolateVDouble(inputs.rows, count, 90.50, 420.25, 0.0, 0.99999, outputs.vDouble);
+			sink = sink + static_cast<uint32_t>(outputs.vDouble[count - 1] * 1000.0);
+		});
+
+		timings.shadePerPixelDouble = TimeKernel(iterations, count, [&]()
+		{
+			table.shadePixelsDouble(inputs.rDouble, inputs.gDouble, inputs.bDouble,
+				inputs.emissionDouble, inputs.lightContributionsDouble, inputs.fogPercentsDouble,
+				count, inputs.paramsDouble, outputs.colors);
+			sink = sink + outputs.colors[count - 1];
+		});
+
+		const int fillIterations = std::max(iterations / (RowWidth / count), 1);
+		timings.fillSpan = TimeKernel(fillIterations, RowWidth, [&]()
+		{
+			table.fillSpan(rowColors.data(), rowDepths.data(), RowWidth, sink,
+				std::numeric_limits<double>::infinity());
+			sink = sink + rowColors[RowWidth - 1];
+		});
+
+		return timings;
+	}
+
+	// Compares the table's output against the scalar table on the same inputs.
+	bool VerifyTable(const ColumnKernels::Table &table, const ChunkInputs &inputs)
+	{
+		const ColumnKernels::Table &scalarTable = ColumnKernels::getScalarTable();
+		bool success = true;
+
+		// Odd counts exercise the scalar tail of each vectorized kernel.
+		for (int count = 1; count <= ColumnKernels::ChunkSize; count += 7)
+		{
+			ChunkOutputs expected, actual;
+			scalarTable.interpolateV(inputs.rows, count, 90.50f, 420.25f, 0.0f, 0.99999f, expected.v);
+			table.interpolateV(inputs.rows, count, 90.50f, 420.25f, 0.0f, 0.99999f, actual.v);
+			for (int i = 0; i < count; i++)
+			{
+				if (std::abs(expected.v[i] - actual.v[i]) > 1e-6f)
+				{
+					std::printf("  %s interpolateV mismatch at %d: %f vs %f\n", table.name, i,
+						expected.v[i], actual.v[i]);
+					success = false;
+					break;
+				}
+			}
+
+			scalarTable.shadePixels(inputs.r, inputs.g, inputs.b, inputs.emission,
+				inputs.lightContributions, inputs.fogPercents, count, inputs.params, expected.colors);
+			table.shadePixels(inputs.r, inputs.g, inputs.b, inputs.emission,
+				inputs.lightContributions, inputs.fogPercents, count, inputs.params, actual.colors);
+			for (int i = 0; i < count; i++)
+			{
+				// Allow one step of difference from floating-point contraction.
+				if (GetMaxChannelDiff(expected.colors[i], actual.colors[i]) > 1)
+				{
+					std::printf("  %s shadePixels mismatch at %d: 0x%06X vs 0x%06X\n", table.name, i,
+						expected.colors[i], actual.colors[i]);
+					success = false;
+					break;
+				}
+			}
+
+			// The double kernels must match exactly.
+			scalarTable.interpolateVDouble(inputs.rows, count, 90.50, 420.25, 0.0, 0.99999, expected.vDouble);
+			table.interpolateVDouble(inputs.rows, count, 90.50, 420.25, 0.0, 0.99999, actual.vDouble);
+			for (int i = 0; i < count; i++)
+			{
+				if (expected.vDouble[i] != actual.vDouble[i])
+				{
+					std::printf("  %s interpolateVDouble mismatch at %d: %.17g vs %.17g\n", table.name, i,
+						expected.vDouble[i], actual.vDouble[i]);
+					success = false;
+					break;
+				}
+			}
+
+			for (int perPixel = 0; perPixel < 2; perPixel++)
+			{
+				const double *lightContributions = (perPixel != 0) ? inputs.lightContributionsDouble : nullptr;
+				const double *fogPercents = (perPixel != 0) ? inputs.fogPercentsDouble : nullptr;
+				scalarTable.shadePixelsDouble(inputs.rDouble, inputs.gDouble, inputs.bDouble,
+					inputs.emissionDouble, lightContributions, fogPercents, count, inputs.paramsDouble,
+					expected.colors);
+				table.shadePixelsDouble(inputs.rDouble, inputs.gDouble, inputs.bDouble,
+					inputs.emissionDouble, lightContributions, fogPercents, count, inputs.paramsDouble,
+					actual.colors);
+				for (int i = 0; i < count; i++)
+				{
+					if (expected.colors[i] != actual.colors[i])
+					{
+						std::printf("  %s shadePixelsDouble mismatch at %d: 0x%06X vs 0x%06X\n", table.name,
+							i, expected.colors[i], actual.colors[i]);
+						success = false;
+						break;
+					}
+				}
+			}
+		}
+
+		return success;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const int iterations = (argc > 1) ? std::max(std::atoi(argv[1]), 1) : DefaultIterations;
+
+	ChunkInputs inputs;
+	MakeInputs(inputs);
+
+	std::vector<const ColumnKernels::Table*> tables;
+	tables.push_back(&ColumnKernels::getScalarTable());
+
+	const ColumnKernels::Table *baselineTable = ColumnKernels::getBaselineTable();
+	if (baselineTable != nullptr)
+	{
+		tables.push_back(baselineTable);
+	}
+
+	const ColumnKernels::Table *avx2Table = ColumnKernels::getAVX2Table();
+	if ((avx2Table != nullptr) && ColumnKernels::isAVX2Supported())
+	{
+		tables.push_back(avx2Table);
+	}
+
+	std::printf("Column kernels (%d iterations, %d pixels per chunk, active: %s)\n", iterations,
+		ColumnKernels::ChunkSize, ColumnKernels::getActiveTable().name);
+	std::printf("%-10s %6s %16s %16s %16s %16s %16s %16s\n", "table", "width", "interpolateV",
+		"shade (const)", "shade (pixel)", "fillSpan", "interpV (dbl)", "shade (dbl)");
+
+	bool verified = true;
+	KernelTimings scalarTimings = KernelTimings();
+	for (const ColumnKernels::Table *table : tables)
+	{
+		ChunkOutputs outputs;
+		const KernelTimings timings = BenchmarkTable(*table, inputs, iterations, outputs);
+		if (table == tables.front())
+		{
+			scalarTimings = timings;
+		}
+		else
+		{
+			verified &= VerifyTable(*table, inputs);
+		}
+
+		auto formatTiming = [](double nsPerPixel, double scalarNsPerPixel)
+		{
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%.3fns %5.2fx", nsPerPixel,
+				scalarNsPerPixel / nsPerPixel);
+			return std::string(buffer);
+		};
+
+		std::printf("%-10s %6d %16s %16s %16s %16s %16s %16s\n", table->name, table->width,
+			formatTiming(timings.interpolateV, scalarTimings.interpolateV).c_str(),
+			formatTiming(timings.shadeConstant, scalarTimings.shadeConstant).c_str(),
+			formatTiming(timings.shadePerPixel, scalarTimings.shadePerPixel).c_str(),
+			formatTiming(timings.fillSpan, scalarTimings.fillSpan).c_str(),
+			formatTiming(timings.interpolateVDouble, scalarTimings.interpolateVDouble).c_str(),
+			formatTiming(timings.shadePerPixelDouble, scalarTimings.shadePerPixelDouble).c_str());
+	}
+
+	if (!verified)
+	{
+		std::printf("Vectorized kernels don't match scalar output.\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,342 @@
+// Entity tick stress benchmark. Fills a synthetic city grid with thousands of walking citizens
+// and times the entity manager's batched dynamic entity tick with different job pool sizes, so
+// the per-chunk split can be compared against a single thread. No game data is needed.
+//
+// Usage: bench_entities [--citizens 4000] [--ticks 600] [--chunks 8] [--rays 2000]
+//        [--output results.json]
+//
+// "threads" 0 ticks every chunk's batch on the calling thread. Each run starts from the same
+// seed, so every run simulates the same citizens taking the same turns.
+//
+// "ray_casts" times Physics::rayCast with entities included in the crowded grid after the
+// ticks. "gather" maps every nearby entity to its voxels before each ray like ray casts used to,
+// and "index" finds entities through the entity manager's voxel index as the ray steps.
+// "matches" says whether both found the same hit for every ray.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "../src/Entities/DynamicEntity.h"
+#include "../src/Entities/EntityAnimationDefinition.h"
+#include "../src/Entities/EntityAnimationInstance.h"
+#include "../src/Entities/EntityAnimationUtils.h"
+#include "../src/Entities/EntityDefinition.h"
+#include "../src/Entities/EntityDefinitionLibrary.h"
+#include "../src/Entities/EntityManager.h"
+#include "../src/Entities/EntityType.h"
+#include "../src/Game/CardinalDirectionName.h"
+#include "../src/Game/Physics.h"
+#include "../src/Math/Constants.h"
+#include "../src/Math/Random.h"
+#include "../src/World/ChunkUtils.h"
+#include "../src/World/ClimateType.h"
+#include "../src/World/VoxelGrid.h"
+
+#include "components/utilities/JobPool.h"
+
+namespace
+{
+	constexpr int DefaultCitizenCount = 4000;
+	constexpr int DefaultTickCount = 600;
+	constexpr int DefaultChunkCount = 8; // Per side.
+	constexpr int WarmupTickCount = 10;
+	constexpr int WorldSeed = 12345;
+	constexpr double TickSeconds = 1.0 / 60.0;
+	constexpr int DefaultRayCount = 2000;
+	constexpr int RayChunkDistance = 2;
+	constexpr double EyeHeight = 0.60;
+	constexpr double MaxPitch = 0.15;
+	constexpr double CitizenWidth = 0.75;
+	constexpr double CitizenHeight = 1.0;
+
+	EntityDefinition MakeCitizenDefinition()
+	{
+		// One angle with one keyframe per state is enough for visibility data.
+		auto makeKeyframeList = []()
+		{
+			EntityAnimationDefinition::KeyframeList keyframeList;
+			keyframeList.init(false);
+			keyframeList.addKeyframe(EntityAnimationDefinition::Keyframe(0, CitizenWidth, CitizenHeight));
+			return keyframeList;
+		};
+
+		EntityAnimationDefinition animDef;
+
+		EntityAnimationDefinition::State idleState;
+		idleState.init(EntityAnimationUtils::STATE_IDLE.c_str(), 1.0, true);
+		idleState.addKeyframeList(makeKeyframeList());
+		animDef.addState(std::move(idleState));
+
+		EntityAnimationDefinition::State walkState;
+		walkState.init(EntityAnimationUtils::STATE_WALK.c_str(), 0.50, true);
+		walkState.addKeyframeList(makeKeyframeList());
+		animDef.addState(std::move(walkState));
+
+		EntityDefinition entityDef;
+		entityDef.initCitizen(true, ClimateType::Temperate, std::move(animDef));
+		return entityDef;
+	}
+
+	// The synthetic city filled with walking citizens.
+	std::unique_ptr<BenchUtils::CityWorld> MakeWorld(int chunkCount, int citizenCount)
+	{
+		const SNInt gridWidth = chunkCount * ChunkUtils::CHUNK_DIM;
+		const WEInt gridDepth = chunkCount * ChunkUtils::CHUNK_DIM;
+		std::unique_ptr<BenchUtils::CityWorld> world = BenchUtils::makeCityWorld(chunkCount, WorldSeed);
+
+		const VoxelGrid &voxelGrid = world->voxelGrid;
+		EntityManager &entityManager = world->entityManager;
+		const EntityDefID defID = entityManager.addEntityDef(MakeCitizenDefinition(),
+			world->entityDefLibrary);
+
+		const CardinalDirectionName directions[] =
+		{
+			CardinalDirectionName::North, CardinalDirectionName::East,
+			CardinalDirectionName::South, CardinalDirectionName::West
+		};
+
+		Random &random = world->random;
+		for (int i = 0; i < citizenCount; i++)
+		{
+			SNInt x;
+			WEInt z;
+			do
+			{
+				x = random.next(gridWidth);
+				z = random.next(gridDepth);
+			} while (BenchUtils::CityWorld::isBlock(x, z));
+
+			EntityAnimationInstance animInst;
+			for (int j = 0; j < 2; j++)
+			{
+				EntityAnimationInstance::KeyframeList keyframeList;
+				keyframeList.addKeyframe(EntityAnimationInstance::Keyframe());
+
+				EntityAnimationInstance::State state;
+				state.addKeyframeList(std::move(keyframeList));
+				animInst.addState(std::move(state));
+			}
+
+			animInst.setStateIndex(1); // Walk.
+
+			EntityRef entityRef = entityManager.makeEntity(EntityType::Dynamic);
+			DynamicEntity *citizen = static_cast<DynamicEntity*>(entityRef.get());
+			citizen->initCitizen(defID, animInst, directions[random.next(4)]);
+			citizen->setPosition(NewDouble2(static_cast<SNDouble>(x) + 0.50,
+				static_cast<WEDouble>(z) + 0.50), entityManager, voxelGrid);
+		}
+
+		return world;
+	}
+
+	// Returns seconds per tick.
+	std::vector<double> RunTicks(BenchUtils::CityWorld &world, int chunkCount, int threadCount, int tickCount)
+	{
+		JobPool jobPool;
+		jobPool.init(threadCount, "Entity job");
+
+		// The player stands outside the grid so every citizen keeps walking.
+		DynamicEntity::TickContext context;
+		context.init(Double3(-100.0, 0.0, -100.0), true, 1.0, world.voxelGrid, world.entityManager,
+			world.entityDefLibrary);
+
+		const ChunkInt2 minChunk(0, 0);
+		const ChunkInt2 maxChunk(chunkCount - 1, chunkCount - 1);
+
+		std::vector<double> samples;
+		samples.reserve(tickCount);
+		for (int i = 0; i < (WarmupTickCount + tickCount); i++)
+		{
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			world.entityManager.tickDynamicEntities(context, minChunk, maxChunk, jobPool,
+				world.random, TickSeconds);
+			const auto endTime = std::chrono::high_resolution_clock::now();
+
+			if (i >= WarmupTickCount)
+			{
+				samples.push_back(std::chrono::duration<double>(endTime - startTime).count());
+			}
+		}
+
+		return samples;
+	}
+
+	// Selection rays from the player's eye, starting near the middle of the grid so the nearby
+	// chunks are all full.
+	std::vector<Physics::Ray> MakeRays(int chunkCount, int rayCount)
+	{
+		Random random(WorldSeed);
+		const int gridDim = chunkCount * ChunkUtils::CHUNK_DIM;
+		const double margin = static_cast<double>(gridDim) * 0.25;
+
+		std::vector<Physics::Ray> rays(rayCount);
+		for (Physics::Ray &ray : rays)
+		{
+			const Double3 start(margin + (random.nextReal() * (gridDim - (margin * 2.0))), 1.0 + EyeHeight,
+				margin + (random.nextReal() * (gridDim - (margin * 2.0))));
+
+			const double yaw = random.nextReal() * Constants::TwoPi;
+			const double pitch = ((random.nextReal() * 2.0) - 1.0) * MaxPitch;
+			ray.init(start, Double3(std::cos(yaw), pitch, std::sin(yaw)).normalized());
+		}
+
+		return rays;
+	}
+
+	struct RayRun
+	{
+		std::vector<Physics::Hit> hits;
+		double microsecondsPerRay;
+		int entityHitCount;
+	};
+
+	// Casts each ray with entities included, looking along the ray like the player selecting
+	// something. Entity hits aren't pixel-perfect since the citizens have no textures.
+	RayRun RunRayCasts(const std::vector<Physics::Ray> &rays, const BenchUtils::CityWorld &world,
+		bool useEntityVoxelIndex)
+	{
+		Physics::setEntityVoxelIndexEnabled(useEntityVoxelIndex);
+
+		RayRun run;
+		run.hits.resize(rays.size());
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (size_t i = 0; i < rays.size(); i++)
+		{
+			const Physics::Ray &ray = rays[i];
+			Physics::rayCast(ray.start, ray.direction, RayChunkDistance, 1.0, world.chasmStates,
+				ray.direction, false, true, world.entityManager, world.voxelGrid, world.entityDefLibrary,
+				world.renderer, run.hits[i]);
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		const double seconds = std::chrono::duration<double>(endTime - startTime).count();
+		run.microsecondsPerRay = (seconds * 1000000.0) / static_cast<double>(rays.size());
+		run.entityHitCount = static_cast<int>(std::count_if(run.hits.begin(), run.hits.end(),
+			[](const Physics::Hit &hit)
+		{
+			return (hit.getT() < Physics::Hit::MAX_T) && (hit.getType() == Physics::Hit::Type::Entity);
+		}));
+
+		Physics::setEntityVoxelIndexEnabled(true);
+		return run;
+	}
+
+	bool HitsMatch(const std::vector<Physics::Hit> &a, const std::vector<Physics::Hit> &b)
+	{
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if ((a[i].getT() != b[i].getT()) || ((a[i].getT() < Physics::Hit::MAX_T) &&
+				(a[i].getType() != b[i].getType())))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int citizenCount = DefaultCitizenCount;
+	int tickCount = DefaultTickCount;
+	int chunkCount = DefaultChunkCount;
+	int rayCount = DefaultRayCount;
+	std::string outputPath;
+
+	const bool parsedArgs = BenchUtils::parseArgs(argc, argv, [&citizenCount, &tickCount, &chunkCount,
+		&rayCount, &outputPath](const std::string &arg, const char *value)
+	{
+		if (arg == "--citizens")
+		{
+			citizenCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--ticks")
+		{
+			tickCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--chunks")
+		{
+			chunkCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--rays")
+		{
+			rayCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--output")
+		{
+			outputPath = value;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	});
+
+	if (!parsedArgs)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Single thread, then doubling up to the CPU's thread count.
+	std::vector<int> threadCounts = { 0 };
+	const int maxThreadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+	for (int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+	{
+		threadCounts.push_back(threadCount);
+	}
+
+	threadCounts.push_back(maxThreadCount);
+
+	FILE *file = BenchUtils::openOutput(outputPath);
+	if (file == nullptr)
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::fprintf(file, "{\n  \"citizens\": %d,\n  \"ticks\": %d,\n  \"chunks\": %d,\n  \"units\": \"ms\",\n"
+		"  \"runs\": [\n", citizenCount, tickCount, chunkCount * chunkCount);
+
+	const int runCount = static_cast<int>(threadCounts.size());
+	std::unique_ptr<BenchUtils::CityWorld> world;
+	for (int runIndex = 0; runIndex < runCount; runIndex++)
+	{
+		const int threadCount = threadCounts[runIndex];
+		world = MakeWorld(chunkCount, citizenCount);
+		std::vector<double> samples = RunTicks(*world, chunkCount, threadCount, tickCount);
+		std::sort(samples.begin(), samples.end());
+
+		const double mean = BenchUtils::getMean(samples);
+
+		std::fprintf(file, "    { \"threads\": %d, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, "
+			"\"p99\": %.4f, \"max\": %.4f, \"citizens_per_us\": %.2f }%s\n", threadCount,
+			mean * 1000.0, BenchUtils::getPercentile(samples, 50.0) * 1000.0,
+			BenchUtils::getPercentile(samples, 90.0) * 1000.0, BenchUtils::getPercentile(samples, 99.0) * 1000.0,
+			samples.back() * 1000.0,
+			static_cast<double>(citizenCount) / (mean * 1000000.0), ((runIndex + 1) < runCount) ? "," : "");
+	}
+
+	// Ray casts in the last run's world, with citizens spread out by the ticks.
+	const std::vector<Physics::Ray> rays = MakeRays(chunkCount, rayCount);
+	const RayRun gatherRun = RunRayCasts(rays, *world, false);
+	const RayRun indexRun = RunRayCasts(rays, *world, true);
+
+	std::fprintf(file, "  ],\n  \"ray_casts\": { \"rays\": %d, \"gather_us\": %.3f, \"index_us\": %.3f, "
+		"\"entity_hits\": %d, \"matches\": %s }\n}\n", rayCount, gatherRun.microsecondsPerRay,
+		indexRun.microsecondsPerRay, indexRun.entityHitCount,
+		HitsMatch(gatherRun.hits, indexRun.hits) ? "true" : "false");
+
+	BenchUtils::closeOutput(file);
+
+	return EXIT_SUCCESS;
+}
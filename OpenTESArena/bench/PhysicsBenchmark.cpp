@@ -0,0 +1,239 @@
+// Ray cast throughput benchmark. Casts a batch of line-of-sight rays through a synthetic city
+// grid, one at a time with Physics::rayCast and all at once with Physics::rayCastBatch on job
+// pools of different sizes, and writes rays per second as JSON. No game data is needed.
+//
+// Usage: bench_physics [--rays 1024] [--iterations 200] [--chunks 4] [--output results.json]
+//
+// Rays are voxel-only; bench_entities times ray casts that include entities. "threads" 0 casts
+// the batch on the calling thread. "matches" says whether every batched hit is the same as
+// casting that ray on its own.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchUtils.h"
+#include "../src/Game/Physics.h"
+#include "../src/Math/Constants.h"
+#include "../src/Math/Random.h"
+#include "../src/World/ChunkUtils.h"
+
+#include "components/utilities/BufferView.h"
+#include "components/utilities/JobPool.h"
+
+namespace
+{
+	constexpr int DefaultRayCount = 1024;
+	constexpr int DefaultIterationCount = 200;
+	constexpr int DefaultChunkCount = 4; // Per side.
+	constexpr int WarmupIterationCount = 5;
+	constexpr int WorldSeed = 12345;
+	constexpr int RayChunkDistance = 2;
+	constexpr double EyeHeight = 0.60;
+	constexpr double MaxPitch = 0.15; // Rays are mostly level, like line-of-sight checks.
+
+	// Flats face opposite the camera. Both cast modes use the same camera.
+	const Double3 CameraForward = Double3::UnitX;
+
+	std::vector<Physics::Ray> MakeRays(int chunkCount, int rayCount)
+	{
+		Random random(WorldSeed);
+		const double gridDim = static_cast<double>(chunkCount * ChunkUtils::CHUNK_DIM);
+
+		std::vector<Physics::Ray> rays(rayCount);
+		for (Physics::Ray &ray : rays)
+		{
+			const double yaw = random.nextReal() * Constants::TwoPi;
+			const double pitch = ((random.nextReal() * 2.0) - 1.0) * MaxPitch;
+			const Double3 start(random.nextReal() * gridDim, 1.0 + EyeHeight, random.nextReal() * gridDim);
+			const Double3 direction = Double3(std::cos(yaw), pitch, std::sin(yaw)).normalized();
+			ray.init(start, direction);
+		}
+
+		return rays;
+	}
+
+	void CastSingle(const std::vector<Physics::Ray> &rays, const BenchUtils::CityWorld &world,
+		std::vector<Physics::Hit> &hits)
+	{
+		for (size_t i = 0; i < rays.size(); i++)
+		{
+			const Physics::Ray &ray = rays[i];
+			Physics::rayCast(ray.start, ray.direction, RayChunkDistance, 1.0, world.chasmStates,
+				CameraForward, false, false, world.entityManager, world.voxelGrid, world.entityDefLibrary,
+				world.renderer, hits[i]);
+		}
+	}
+
+	void CastBatch(const std::vector<Physics::Ray> &rays, const BenchUtils::CityWorld &world,
+		JobPool *jobPool, std::vector<Physics::Hit> &hits)
+	{
+		const BufferView<const Physics::Ray> rayView(rays.data(), static_cast<int>(rays.size()));
+		BufferView<Physics::Hit> hitView(hits.data(), static_cast<int>(hits.size()));
+		Physics::rayCastBatch(rayView, RayChunkDistance, 1.0, world.chasmStates, CameraForward, false,
+			false, world.entityManager, world.voxelGrid, world.entityDefLibrary, world.renderer, jobPool,
+			hitView);
+	}
+
+	bool HitsMatch(const std::vector<Physics::Hit> &a, const std::vector<Physics::Hit> &b)
+	{
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			const bool aHit = a[i].getT() < Physics::Hit::MAX_T;
+			const bool bHit = b[i].getT() < Physics::Hit::MAX_T;
+			if (aHit != bHit)
+			{
+				return false;
+			}
+
+			if (aHit && ((a[i].getT() != b[i].getT()) || (a[i].getType() != b[i].getType())))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Returns seconds per iteration.
+	template <typename CastFunc>
+	std::vector<double> RunIterations(int iterationCount, CastFunc castFunc)
+	{
+		std::vector<double> samples;
+		samples.reserve(iterationCount);
+		for (int i = 0; i < (WarmupIterationCount + iterationCount); i++)
+		{
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			castFunc();
+			const auto endTime = std::chrono::high_resolution_clock::now();
+
+			if (i >= WarmupIterationCount)
+			{
+				samples.push_back(std::chrono::duration<double>(endTime - startTime).count());
+			}
+		}
+
+		std::sort(samples.begin(), samples.end());
+		return samples;
+	}
+
+	void WriteRun(FILE *file, const char *mode, int threadCount, std::vector<double> &samples,
+		int rayCount, int hitCount, bool matches, bool isLast)
+	{
+		const double mean = BenchUtils::getMean(samples);
+
+		std::fprintf(file, "    { \"mode\": \"%s\", \"threads\": %d, \"mean_ms\": %.4f, \"p50_ms\": %.4f, "
+			"\"p99_ms\": %.4f, \"rays_per_second\": %.0f, \"hits\": %d, \"matches\": %s }%s\n", mode,
+			threadCount, mean * 1000.0, BenchUtils::getPercentile(samples, 50.0) * 1000.0,
+			BenchUtils::getPercentile(samples, 99.0) * 1000.0, static_cast<double>(rayCount) / mean,
+			hitCount, matches ? "true" : "false", isLast ? "" : ",");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int rayCount = DefaultRayCount;
+	int iterationCount = DefaultIterationCount;
+	int chunkCount = DefaultChunkCount;
+	std::string outputPath;
+
+	const bool parsedArgs = BenchUtils::parseArgs(argc, argv, [&rayCount, &iterationCount, &chunkCount,
+		&outputPath](const std::string &arg, const char *value)
+	{
+		if (arg == "--rays")
+		{
+			rayCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--iterations")
+		{
+			iterationCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--chunks")
+		{
+			chunkCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--output")
+		{
+			outputPath = value;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	});
+
+	if (!parsedArgs)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Single thread, then doubling up to the CPU's thread count.
+	std::vector<int> threadCounts = { 0 };
+	const int maxThreadCount = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+	for (int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+	{
+		threadCounts.push_back(threadCount);
+	}
+
+	threadCounts.push_back(maxThreadCount);
+
+	FILE *file = BenchUtils::openOutput(outputPath);
+	if (file == nullptr)
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::unique_ptr<BenchUtils::CityWorld> world = BenchUtils::makeCityWorld(chunkCount, WorldSeed);
+	const std::vector<Physics::Ray> rays = MakeRays(chunkCount, rayCount);
+
+	auto getHitCount = [](const std::vector<Physics::Hit> &hits)
+	{
+		return static_cast<int>(std::count_if(hits.begin(), hits.end(), [](const Physics::Hit &hit)
+		{
+			return hit.getT() < Physics::Hit::MAX_T;
+		}));
+	};
+
+	std::fprintf(file, "{\n  \"rays\": %d,\n  \"iterations\": %d,\n  \"chunks\": %d,\n  \"runs\": [\n",
+		rayCount, iterationCount, chunkCount * chunkCount);
+
+	// One ray at a time is the reference for the batched hits.
+	std::vector<Physics::Hit> singleHits(rayCount);
+	std::vector<double> samples = RunIterations(iterationCount, [&rays, &world, &singleHits]()
+	{
+		CastSingle(rays, *world, singleHits);
+	});
+
+	WriteRun(file, "single", 0, samples, rayCount, getHitCount(singleHits), true, false);
+
+	const int runCount = static_cast<int>(threadCounts.size());
+	for (int runIndex = 0; runIndex < runCount; runIndex++)
+	{
+		const int threadCount = threadCounts[runIndex];
+		JobPool jobPool;
+		jobPool.init(threadCount, "Ray job");
+
+		std::vector<Physics::Hit> batchHits(rayCount);
+		samples = RunIterations(iterationCount, [&rays, &world, &jobPool, &batchHits]()
+		{
+			CastBatch(rays, *world, &jobPool, batchHits);
+		});
+
+		WriteRun(file, "batch", threadCount, samples, rayCount, getHitCount(batchHits),
+			HitsMatch(singleHits, batchHits), (runIndex + 1) == runCount);
+	}
+
+	std::fprintf(file, "  ]\n}\n");
+
+	BenchUtils::closeOutput(file);
+
+	return EXIT_SUCCESS;
+}
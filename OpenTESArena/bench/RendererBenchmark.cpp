@@ -0,0 +1,319 @@
+// Renderer benchmark. Loads representative scenes from the game data, replays a camera path
+// through each one with the software renderer, and writes per-phase timing percentiles as JSON
+// so results can be compared across commits.
+//
+// Usage: bench_renderer [--frames 300] [--size 640x400] [--paths dir/] [--output results.json]
+//     [--checkerboard 0|1] [--pipelined 0|1] [--occlusion-spans 0|1]
+//     [--ray-packets 0|1]
+//
+// A camera path for a scene is read from "<paths>/<scene name>.txt" if it exists (same pose
+// format as TESArena --headless), otherwise the camera turns in place from the level's start.
+//
+// With --pipelined 1, "frame" is the main thread's time in the renderer (the throughput side)
+// and "latency" is the time from a frame's capture to it being shown. There's no game tick to
+// overlap with here, so the frame time mostly shows the visibility work left on the main thread.
+//
+// "voxel_overdraw" is voxel pixels shaded per frame pixel. Running with --occlusion-spans 0 and 1
+// shows how much shading is saved by rejecting voxels behind opaque ranges in mid-column.
+//
+// --ray-packets 0 steps each column's voxel ray on its own, for comparing the "voxels" phase
+// against the SIMD ray packets.
+//
+// "texture_kb" is the texel memory of the scene's textures, including mip levels.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+
+#include "BenchUtils.h"
+#include "../src/Game/HeadlessRender.h"
+
+#include "components/utilities/File.h"
+
+namespace
+{
+	constexpr int DefaultFrameCount = 300;
+	constexpr int WarmupFrameCount = 10; // Rendered before timing so caches and threads settle.
+	constexpr int DefaultWidth = 640;
+	constexpr int DefaultHeight = 400;
+
+	// Chunk distance options have no upper limit, so "max" is a fixed value well past what
+	// players use, making the wilderness ray casting as expensive as a real session gets.
+	constexpr int FarChunkDistance = 16;
+
+	struct Scene
+	{
+		const char *name;
+		const std::string &levelName;
+		Clock clock;
+		int chunkDistance; // Zero to use the options value.
+	};
+
+	// Timings in seconds for one measurement across all frames of a scene.
+	struct Metric
+	{
+		const char *name;
+		std::vector<double> samples;
+
+		explicit Metric(const char *name) : name(name) { }
+	};
+
+	void WriteMetric(FILE *file, const Metric &metric, bool isLast)
+	{
+		std::vector<double> sorted = metric.samples;
+		std::sort(sorted.begin(), sorted.end());
+
+		std::fprintf(file, "        \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, "
+			"\"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n", metric.name,
+			BenchUtils::getMean(sorted) * 1000.0, BenchUtils::getPercentile(sorted, 50.0) * 1000.0,
+			BenchUtils::getPercentile(sorted, 90.0) * 1000.0, BenchUtils::getPercentile(sorted, 95.0) * 1000.0,
+			BenchUtils::getPercentile(sorted, 99.0) * 1000.0, sorted.back() * 1000.0, isLast ? "" : ",");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int frameCount = DefaultFrameCount;
+	int width = DefaultWidth;
+	int height = DefaultHeight;
+	int checkerboard = -1; // Negative uses the options value.
+	int pipelined = -1; // Negative uses the options value.
+	int occlusionSpans = -1; // Negative uses the renderer default.
+	int rayPackets = -1; // Negative uses the renderer default.
+	std::string pathsFolder, outputPath;
+
+	const bool parsedArgs = BenchUtils::parseArgs(argc, argv, [&frameCount, &width, &height, &pathsFolder,
+		&outputPath, &checkerboard, &pipelined, &occlusionSpans, &rayPackets](const std::string &arg, const char *value)
+	{
+		if (arg == "--frames")
+		{
+			frameCount = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--size")
+		{
+			// Expects WIDTHxHEIGHT.
+			if ((std::sscanf(value, "%dx%d", &width, &height) != 2) || (width <= 0) || (height <= 0))
+			{
+				return false;
+			}
+		}
+		else if (arg == "--paths")
+		{
+			pathsFolder = value;
+			if (!pathsFolder.empty() && (pathsFolder.back() != '/') && (pathsFolder.back() != '\\'))
+			{
+				pathsFolder.push_back('/');
+			}
+		}
+		else if (arg == "--output")
+		{
+			outputPath = value;
+		}
+		else if (arg == "--checkerboard")
+		{
+			checkerboard = (std::atoi(value) != 0) ? 1 : 0;
+		}
+		else if (arg == "--pipelined")
+		{
+			pipelined = (std::atoi(value) != 0) ? 1 : 0;
+		}
+		else if (arg == "--occlusion-spans")
+		{
+			occlusionSpans = (std::atoi(value) != 0) ? 1 : 0;
+		}
+		else if (arg == "--ray-packets")
+		{
+			rayPackets = (std::atoi(value) != 0) ? 1 : 0;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	});
+
+	if (!parsedArgs)
+	{
+		return EXIT_FAILURE;
+	}
+
+	const Scene scenes[] =
+	{
+		{ "interior_dungeon", HeadlessRender::DungeonLevelName, Clock(12, 0, 0), 0 },
+		{ "dense_city", HeadlessRender::CityLevelName, Clock(12, 0, 0), 0 },
+		{ "wilderness_far", HeadlessRender::WildernessLevelName, Clock(12, 0, 0), FarChunkDistance },
+		{ "night_city_lights", HeadlessRender::CityLevelName, Clock(22, 0, 0), 0 }
+	};
+
+	// Allocated on the heap since the libraries are large.
+	auto session = std::make_unique<HeadlessRender::Session>();
+	if (!session->init(width, height))
+	{
+		return EXIT_FAILURE;
+	}
+
+	const int defaultChunkDistance = session->chunkDistance;
+
+	if (checkerboard >= 0)
+	{
+		session->renderer.setCheckerboardRendering(checkerboard != 0);
+	}
+
+	if (pipelined >= 0)
+	{
+		session->renderer.setPipelinedRendering(pipelined != 0);
+	}
+
+	if (occlusionSpans >= 0)
+	{
+		session->renderer.setOcclusionSpans(occlusionSpans != 0);
+	}
+
+	if (rayPackets >= 0)
+	{
+		session->renderer.setRayPackets(rayPackets != 0);
+	}
+
+	FILE *file = BenchUtils::openOutput(outputPath);
+	if (file == nullptr)
+	{
+		return EXIT_FAILURE;
+	}
+
+	std::fprintf(file, "{\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"units\": \"ms\",\n"
+		"  \"scenes\": [\n", width, height, frameCount);
+
+	const int sceneCount = static_cast<int>(std::size(scenes));
+	for (int sceneIndex = 0; sceneIndex < sceneCount; sceneIndex++)
+	{
+		const Scene &scene = scenes[sceneIndex];
+		if (!session->loadLevel(scene.levelName, scene.clock))
+		{
+			std::fprintf(stderr, "Couldn't load scene \"%s\".\n", scene.name);
+			return EXIT_FAILURE;
+		}
+
+		session->chunkDistance = (scene.chunkDistance > 0) ? scene.chunkDistance : defaultChunkDistance;
+
+		// Recorded camera path if there is one.
+		std::vector<HeadlessRender::Pose> poses;
+		const std::string posesPath = pathsFolder + scene.name + ".txt";
+		const bool hasRecordedPath = !pathsFolder.empty() && File::exists(posesPath.c_str());
+		if (hasRecordedPath)
+		{
+			if (!HeadlessRender::loadPoses(posesPath.c_str(), &poses))
+			{
+				return EXIT_FAILURE;
+			}
+		}
+		else
+		{
+			poses = session->makeTurnPath();
+		}
+
+		auto getFramePose = [frameCount, &poses](int frameIndex)
+		{
+			const double pathPercent = (frameCount > 1) ?
+				(static_cast<double>(frameIndex) / static_cast<double>(frameCount - 1)) : 0.0;
+			return HeadlessRender::getPathPose(poses, pathPercent);
+		};
+
+		for (int i = 0; i < WarmupFrameCount; i++)
+		{
+			session->renderFrame(getFramePose(0));
+		}
+
+		using SwProfilerData = SoftwareRenderer::ProfilerData;
+		std::vector<Metric> metrics =
+		{
+			Metric("frame"),
+			Metric("latency"),
+			Metric("sky_gradient"),
+			Metric("distant_sky"),
+			Metric("voxels"),
+			Metric("flats"),
+			Metric("swizzle"),
+			Metric("update_visible_distant_objects"),
+			Metric("update_visible_flats"),
+			Metric("update_visible_light_lists")
+		};
+
+		int maxVisFlatCount = 0;
+		int maxVisLightCount = 0;
+		int renderThreadCount = 0;
+		int skyReusedCount = 0;
+		int maxLightsBinned = 0;
+		int maxLightCellsTouched = 0;
+		int maxFlatSortShifts = 0;
+		int fullFlatSortCount = 0;
+		int checkerboardedCount = 0;
+		int chunkDefsRebuiltCount = 0;
+		double totalVoxelOverdraw = 0.0;
+		double maxVoxelOverdraw = 0.0;
+		for (int i = 0; i < frameCount; i++)
+		{
+			session->renderFrame(getFramePose(i));
+
+			const Renderer::ProfilerData &profilerData = session->renderer.getProfilerData();
+			metrics[0].samples.push_back(profilerData.frameTime);
+			metrics[1].samples.push_back(profilerData.latency);
+			metrics[2].samples.push_back(profilerData.phaseSeconds[SwProfilerData::PHASE_SKY_GRADIENT]);
+			metrics[3].samples.push_back(profilerData.phaseSeconds[SwProfilerData::PHASE_DISTANT_SKY]);
+			metrics[4].samples.push_back(profilerData.phaseSeconds[SwProfilerData::PHASE_VOXELS]);
+			metrics[5].samples.push_back(profilerData.phaseSeconds[SwProfilerData::PHASE_FLATS]);
+			metrics[6].samples.push_back(profilerData.phaseSeconds[SwProfilerData::PHASE_SWIZZLE]);
+			metrics[7].samples.push_back(profilerData.visDistantObjsSeconds);
+			metrics[8].samples.push_back(profilerData.visFlatsSeconds);
+			metrics[9].samples.push_back(profilerData.visLightListsSeconds);
+
+			maxVisFlatCount = std::max(maxVisFlatCount, profilerData.visFlatCount);
+			maxVisLightCount = std::max(maxVisLightCount, profilerData.visLightCount);
+			skyReusedCount += profilerData.skyReused ? 1 : 0;
+			maxLightsBinned = std::max(maxLightsBinned, profilerData.lightsBinned);
+			maxLightCellsTouched = std::max(maxLightCellsTouched, profilerData.lightCellsTouched);
+			maxFlatSortShifts = std::max(maxFlatSortShifts, profilerData.flatSortShifts);
+			fullFlatSortCount += (profilerData.flatSortShifts < 0) ? 1 : 0;
+			checkerboardedCount += profilerData.checkerboarded ? 1 : 0;
+			chunkDefsRebuiltCount += profilerData.chunkDefsRebuilt;
+			totalVoxelOverdraw += profilerData.voxelOverdraw;
+			maxVoxelOverdraw = std::max(maxVoxelOverdraw, profilerData.voxelOverdraw);
+			renderThreadCount = static_cast<int>(profilerData.threadTimings.size());
+		}
+
+		std::fprintf(file, "    {\n      \"name\": \"%s\",\n      \"level\": \"%s\",\n"
+			"      \"camera_path\": \"%s\",\n      \"chunk_distance\": %d,\n"
+			"      \"render_threads\": %d,\n      \"max_visible_flats\": %d,\n"
+			"      \"max_visible_lights\": %d,\n      \"sky_reused_frames\": %d,\n"
+			"      \"max_lights_binned\": %d,\n      \"max_light_cells_touched\": %d,\n"
+			"      \"max_flat_sort_shifts\": %d,\n      \"full_flat_sort_frames\": %d,\n"
+			"      \"checkerboard_frames\": %d,\n      \"chunk_defs_rebuilt\": %d,\n"
+			"      \"voxel_overdraw\": { \"mean\": %.3f, \"max\": %.3f },\n"
+			"      \"texture_kb\": %d,\n"
+			"      \"timings\": {\n", scene.name, scene.levelName.c_str(),
+			hasRecordedPath ? "recorded" : "turn", session->chunkDistance, renderThreadCount,
+			maxVisFlatCount, maxVisLightCount, skyReusedCount, maxLightsBinned, maxLightCellsTouched,
+			maxFlatSortShifts, fullFlatSortCount, checkerboardedCount, chunkDefsRebuiltCount,
+			totalVoxelOverdraw / static_cast<double>(frameCount), maxVoxelOverdraw,
+			static_cast<int>(session->renderer.getProfilerData().textureBytes / 1024));
+
+		for (size_t i = 0; i < metrics.size(); i++)
+		{
+			WriteMetric(file, metrics[i], (i + 1) == metrics.size());
+		}
+
+		std::fprintf(file, "      }\n    }%s\n", ((sceneIndex + 1) < sceneCount) ? "," : "");
+	}
+
+	std::fprintf(file, "  ]\n}\n");
+
+	BenchUtils::closeOutput(file);
+
+	return EXIT_SUCCESS;
+}
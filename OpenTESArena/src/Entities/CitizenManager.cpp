@@ -192,7 +192,7 @@ void CitizenManager::spawnCitizens(LevelData &levelData, int raceID,
 
 		// Idle animation by default.
 		int defaultStateIndex;
-		if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &defaultStateIndex))
+		if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &defaultStateIndex))
 		{
 			DebugLogWarning("Couldn't get idle state index for citizen \"" + std::to_string(i) + "\".");
 			continue;
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 
 #include "DynamicEntity.h"
 #include "EntityManager.h"
@@ -65,6 +66,402 @@ namespace
 	}
 }
 
+DynamicEntity::TickContext::TickContext()
+{
+	this->playerWeaponSheathed = false;
+	this->ceilingHeight = 0.0;
+	this->voxelGrid = nullptr;
+	this->entityManager = nullptr;
+	this->entityDefLibrary = nullptr;
+}
+
+void DynamicEntity::TickContext::init(const Double3 &playerPosition, bool playerWeaponSheathed,
+	double ceilingHeight, const VoxelGrid &voxelGrid, const EntityManager &entityManager,
+	const EntityDefinitionLibrary &entityDefLibrary)
+{
+	this->playerPosition = playerPosition;
+	this->playerWeaponSheathed = playerWeaponSheathed;
+	this->ceilingHeight = ceilingHeight;
+	this->voxelGrid = &voxelGrid;
+	this->entityManager = &entityManager;
+	this->entityDefLibrary = &entityDefLibrary;
+}
+
+DynamicEntity::TickContext DynamicEntity::TickContext::makeFromGame(Game &game)
+{
+	auto &gameData = game.getGameData();
+	const auto &player = gameData.getPlayer();
+	const auto &levelData = gameData.getActiveWorld().getActiveLevel();
+
+	TickContext context;
+	context.init(player.getPosition(), player.getWeaponAnimation().isSheathed(),
+		levelData.getCeilingHeight(), levelData.getVoxelGrid(), levelData.getEntityManager(),
+		game.getEntityDefinitionLibrary());
+	return context;
+}
+
+DynamicEntity::TickBatch::DefInfo::DefInfo()
+{
+	this->defID = EntityManager::NO_DEF_ID;
+	this->animDef = nullptr;
+	this->idleStateIndex = -1;
+	this->walkStateIndex = -1;
+}
+
+void DynamicEntity::TickBatch::DefInfo::init(EntityDefID defID,
+	const EntityAnimationDefinition &animDef)
+{
+	this->defID = defID;
+	this->animDef = &animDef;
+
+	if (!animDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &this->idleStateIndex))
+	{
+		this->idleStateIndex = -1;
+	}
+
+	if (!animDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_WALK, &this->walkStateIndex))
+	{
+		this->walkStateIndex = -1;
+	}
+}
+
+int DynamicEntity::TickBatch::getDefInfoIndex(EntityDefID defID, const TickContext &context)
+{
+	// Only a handful of definitions are in a batch, so a linear search is fine.
+	const auto iter = std::find_if(this->defInfos.begin(), this->defInfos.end(),
+		[defID](const DefInfo &defInfo)
+	{
+		return defInfo.defID == defID;
+	});
+
+	if (iter != this->defInfos.end())
+	{
+		return static_cast<int>(std::distance(this->defInfos.begin(), iter));
+	}
+
+	const EntityDefinition &entityDef = context.entityManager->getEntityDef(
+		defID, *context.entityDefLibrary);
+
+	DefInfo defInfo;
+	defInfo.init(defID, entityDef.getAnimDef());
+	this->defInfos.emplace_back(std::move(defInfo));
+	return static_cast<int>(this->defInfos.size()) - 1;
+}
+
+void DynamicEntity::TickBatch::clear(int seed)
+{
+	this->entities.clear();
+	this->types.clear();
+	this->defInfoIndices.clear();
+	this->positions.clear();
+	this->velocities.clear();
+	this->directions.clear();
+	this->animStateIndices.clear();
+	this->creatureSoundSeconds.clear();
+	this->walkingIndices.clear();
+	this->soundIndices.clear();
+
+	// Definitions can change between ticks (i.e., a new level), so the cached ones can't be kept.
+	this->defInfos.clear();
+	this->random.init(seed);
+}
+
+int DynamicEntity::TickBatch::getCount() const
+{
+	return static_cast<int>(this->entities.size());
+}
+
+DynamicEntity &DynamicEntity::TickBatch::getEntity(int index) const
+{
+	DebugAssertIndex(this->entities, static_cast<size_t>(index));
+	return *this->entities[index];
+}
+
+void DynamicEntity::TickBatch::add(DynamicEntity &entity, const TickContext &context)
+{
+	this->entities.push_back(&entity);
+	this->types.push_back(entity.derivedType);
+	this->defInfoIndices.push_back(this->getDefInfoIndex(entity.getDefinitionID(), context));
+	this->positions.push_back(entity.position);
+	this->velocities.push_back(entity.velocity);
+	this->directions.push_back(entity.direction);
+	this->animStateIndices.push_back(entity.getAnimInstance().getStateIndex());
+	this->creatureSoundSeconds.push_back(entity.secondsTillCreatureSound);
+}
+
+void DynamicEntity::TickBatch::tickAnimations(double dt)
+{
+	const int count = this->getCount();
+	for (int i = 0; i < count; i++)
+	{
+		const DefInfo &defInfo = this->defInfos[this->defInfoIndices[i]];
+		const EntityAnimationDefinition::State &animDefState =
+			defInfo.animDef->getState(this->animStateIndices[i]);
+
+		EntityAnimationInstance &animInst = this->entities[i]->getAnimInstance();
+		animInst.tick(dt, animDefState.getTotalSeconds(), animDefState.isLooping());
+	}
+}
+
+void DynamicEntity::TickBatch::tickCitizenStates(const TickContext &context)
+{
+	// Distance to player is used for switching animation states.
+	constexpr double citizenIdleDistSqr = CitizenIdleDistance * CitizenIdleDistance;
+	const NewDouble2 playerPosXZ(context.playerPosition.x, context.playerPosition.z);
+	const bool playerWeaponSheathed = context.playerWeaponSheathed;
+
+	const int count = this->getCount();
+	for (int i = 0; i < count; i++)
+	{
+		if (this->types[i] != DynamicEntityType::Citizen)
+		{
+			continue;
+		}
+
+		const DefInfo &defInfo = this->defInfos[this->defInfoIndices[i]];
+		const int idleStateIndex = defInfo.idleStateIndex;
+		const int walkStateIndex = defInfo.walkStateIndex;
+		if ((idleStateIndex < 0) || (walkStateIndex < 0))
+		{
+			DebugLogWarning("Couldn't get citizen idle or walk state index.");
+			continue;
+		}
+
+		const NewDouble2 dirToPlayer = playerPosXZ - this->positions[i];
+		const double distToPlayerSqr = dirToPlayer.lengthSquared();
+		int &animStateIndex = this->animStateIndices[i];
+
+		if (animStateIndex == idleStateIndex)
+		{
+			const bool shouldChangeToWalking = !playerWeaponSheathed ||
+				(distToPlayerSqr > citizenIdleDistSqr);
+
+			// @todo: need to preserve their previous direction so they stay aligned with
+			// the center of the voxel. Basically need to store cardinal direction as internal state.
+			if (shouldChangeToWalking)
+			{
+				animStateIndex = walkStateIndex;
+				const int citizenDirectionIndex = GetRandomCitizenDirectionIndex(this->random);
+				const auto &citizenDirection = CitizenDirections[citizenDirectionIndex];
+				this->directions[i] = citizenDirection.second;
+				this->velocities[i] = citizenDirection.second * CitizenSpeed;
+			}
+			else
+			{
+				// Face towards player.
+				DebugAssert(std::isfinite(dirToPlayer.lengthSquared()));
+				this->directions[i] = dirToPlayer;
+			}
+		}
+		else if (animStateIndex == walkStateIndex)
+		{
+			const bool shouldChangeToIdle = playerWeaponSheathed &&
+				(distToPlayerSqr <= citizenIdleDistSqr);
+
+			if (shouldChangeToIdle)
+			{
+				animStateIndex = idleStateIndex;
+				this->velocities[i] = NewDouble2::Zero;
+			}
+		}
+
+		if (animStateIndex == walkStateIndex)
+		{
+			this->walkingIndices.push_back(i);
+		}
+	}
+}
+
+void DynamicEntity::TickBatch::tickCreatureStates(const TickContext &context, double dt)
+{
+	// @todo: creature AI
+
+	// Tick down the NPC's creature sound (if any). This is done on the top level so the counter
+	// doesn't predictably begin when the player enters the creature's hearing distance.
+	// @todo: hearing distance should probably be a property of the listener, not the creature.
+	constexpr double hearingDistSqr = HearingDistance * HearingDistance;
+	const Double3 &playerPosition = context.playerPosition;
+	const double soundHeight = context.ceilingHeight * 1.50;
+
+	const int count = this->getCount();
+	for (int i = 0; i < count; i++)
+	{
+		if (this->types[i] != DynamicEntityType::Creature)
+		{
+			continue;
+		}
+
+		double &secondsTillCreatureSound = this->creatureSoundSeconds[i];
+		secondsTillCreatureSound -= dt;
+		if (secondsTillCreatureSound <= 0.0)
+		{
+			// See if the NPC is within hearing distance of the player.
+			const NewDouble2 &position = this->positions[i];
+			const Double3 position3D(position.x, soundHeight, position.y);
+			if ((playerPosition - position3D).lengthSquared() < hearingDistSqr)
+			{
+				this->soundIndices.push_back(i);
+			}
+		}
+	}
+
+	// @todo: projectile motion + collision
+}
+
+void DynamicEntity::TickBatch::tickCitizenMovement(const TickContext &context, double dt)
+{
+	// Integrate walking citizens by delta time.
+	for (const int i : this->walkingIndices)
+	{
+		this->positions[i] = this->positions[i] + (this->velocities[i] * dt);
+	}
+
+	// Change facing of citizens about to walk into something.
+	const VoxelGrid &voxelGrid = *context.voxelGrid;
+	auto isSuitableVoxel = [&voxelGrid](const NewInt2 &voxel)
+	{
+		auto isValidVoxel = [&voxelGrid](const NewInt2 &voxel)
+		{
+			return voxelGrid.coordIsValid(voxel.x, 1, voxel.y);
+		};
+
+		auto isPassableVoxel = [&voxelGrid](const NewInt2 &voxel)
+		{
+			const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 1, voxel.y);
+			const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+			return voxelDef.dataType == VoxelDataType::None;
+		};
+
+		auto isWalkableVoxel = [&voxelGrid](const NewInt2 &voxel)
+		{
+			const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 0, voxel.y);
+			const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+			return voxelDef.dataType == VoxelDataType::Floor;
+		};
+
+		return isValidVoxel(voxel) && isPassableVoxel(voxel) && isWalkableVoxel(voxel);
+	};
+
+	for (const int i : this->walkingIndices)
+	{
+		const NewDouble2 &position = this->positions[i];
+		const NewDouble2 &direction = this->directions[i];
+
+		auto getVoxelAtDistance = [&position](const NewDouble2 &checkDist)
+		{
+			return NewInt2(
+				static_cast<SNInt>(std::floor(position.x + checkDist.x)),
+				static_cast<WEInt>(std::floor(position.y + checkDist.y)));
+		};
+
+		const NewInt2 curVoxel(
+			static_cast<SNInt>(std::floor(position.x)),
+			static_cast<WEInt>(std::floor(position.y)));
+		const NewInt2 nextVoxel = getVoxelAtDistance(direction * 0.50);
+
+		if ((nextVoxel == curVoxel) || isSuitableVoxel(nextVoxel))
+		{
+			continue;
+		}
+
+		// Need to change walking direction. Determine another safe route, or if
+		// none exist, then stop walking.
+		const CardinalDirectionName curDirectionName = CardinalDirection::getDirectionName(direction);
+
+		// Shuffle citizen direction indices so they don't all switch to the same
+		// direction every time.
+		std::array<int, 4> randomDirectionIndices = { 0, 1, 2, 3 };
+		RandomUtils::shuffle(randomDirectionIndices.data(),
+			static_cast<int>(randomDirectionIndices.size()), this->random);
+
+		const auto iter = std::find_if(randomDirectionIndices.begin(), randomDirectionIndices.end(),
+			[&getVoxelAtDistance, &isSuitableVoxel, curDirectionName](int dirIndex)
+		{
+			// See if this is a valid direction to go in.
+			const auto &directionPair = CitizenDirections[dirIndex];
+			const CardinalDirectionName cardinalDirectionName = directionPair.first;
+			if (cardinalDirectionName != curDirectionName)
+			{
+				const NewDouble2 &direction = directionPair.second;
+				const NewInt2 voxel = getVoxelAtDistance(direction * 0.50);
+				if (isSuitableVoxel(voxel))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		});
+
+		if (iter != randomDirectionIndices.end())
+		{
+			const auto &directionPair = CitizenDirections[*iter];
+			const NewDouble2 &newDirection = directionPair.second;
+			this->directions[i] = newDirection;
+			this->velocities[i] = newDirection * CitizenSpeed;
+		}
+		else
+		{
+			// Couldn't find any valid direction.
+			this->velocities[i] = NewDouble2::Zero;
+		}
+	}
+}
+
+void DynamicEntity::TickBatch::writeBack()
+{
+	const int count = this->getCount();
+	for (int i = 0; i < count; i++)
+	{
+		DynamicEntity &entity = *this->entities[i];
+		entity.position = this->positions[i];
+		entity.velocity = this->velocities[i];
+		entity.direction = this->directions[i];
+		entity.secondsTillCreatureSound = this->creatureSoundSeconds[i];
+
+		// Changing state restarts the animation.
+		EntityAnimationInstance &animInst = entity.getAnimInstance();
+		const int animStateIndex = this->animStateIndices[i];
+		if (animInst.getStateIndex() != animStateIndex)
+		{
+			animInst.setStateIndex(animStateIndex);
+		}
+	}
+}
+
+void DynamicEntity::TickBatch::tick(const TickContext &context, double dt)
+{
+	this->walkingIndices.clear();
+	this->soundIndices.clear();
+
+	this->tickAnimations(dt);
+	this->tickCitizenStates(context);
+	this->tickCreatureStates(context, dt);
+
+	// @todo: add a check here if updating the entity state has put them in a non-physics state.
+	this->tickCitizenMovement(context, dt);
+	this->writeBack();
+}
+
+void DynamicEntity::TickBatch::playCreatureSounds(const TickContext &context,
+	AudioManager &audioManager, Random &random)
+{
+	for (const int i : this->soundIndices)
+	{
+		// See if the NPC has a creature sound.
+		DynamicEntity &entity = *this->entities[i];
+		std::string creatureSoundFilename;
+		if (entity.tryGetCreatureSoundFilename(*context.entityManager, *context.entityDefLibrary,
+			&creatureSoundFilename))
+		{
+			entity.playCreatureSound(creatureSoundFilename, context.ceilingHeight, audioManager);
+			entity.secondsTillCreatureSound = DynamicEntity::nextCreatureSoundWaitTime(random);
+		}
+	}
+
+	this->soundIndices.clear();
+}
+
 DynamicEntity::DynamicEntity()
 	: direction(Double2::Zero), velocity(Double2::Zero)
 {
@@ -139,12 +536,6 @@ double DynamicEntity::nextCreatureSoundWaitTime(Random &random)
 	return 2.75 + (random.nextReal() * 4.50);
 }
 
-bool DynamicEntity::withinHearingDistance(const Double3 &point, double ceilingHeight)
-{
-	const Double3 position3D(this->position.x, ceilingHeight * 1.50, this->position.y);
-	return (point - position3D).lengthSquared() < (HearingDistance * HearingDistance);
-}
-
 bool DynamicEntity::tryGetCreatureSoundFilename(const EntityManager &entityManager,
 	const EntityDefinitionLibrary &entityDefLibrary, std::string *outFilename) const
 {
@@ -235,243 +626,6 @@ void DynamicEntity::setDestination(const NewDouble2 *point)
 	this->setDestination(point, minDistance);
 }
 
-void DynamicEntity::updateCitizenState(Game &game, double dt)
-{
-	auto &gameData = game.getGameData();
-	auto &random = game.getRandom();
-	const auto &player = gameData.getPlayer();
-	const auto &worldData = gameData.getActiveWorld();
-	const auto &levelData = worldData.getActiveLevel();
-	const auto &voxelGrid = levelData.getVoxelGrid();
-	const auto &entityManager = levelData.getEntityManager();
-	const auto &entityDefLibrary = game.getEntityDefinitionLibrary();
-	const EntityDefinition &entityDef = entityManager.getEntityDef(
-		this->getDefinitionID(), entityDefLibrary);
-	const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
-
-	// Distance to player is used for switching animation states.
-	constexpr double citizenIdleDistSqr = CitizenIdleDistance * CitizenIdleDistance;
-	const NewDouble2 playerPosXZ(
-		player.getPosition().x,
-		player.getPosition().z);
-	const NewDouble2 dirToPlayer = playerPosXZ - this->position;
-	const double distToPlayerSqr = dirToPlayer.lengthSquared();
-
-	// Get idle and walk state indices.
-	int idleStateIndex, walkStateIndex;
-	if (!animDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &idleStateIndex))
-	{
-		DebugLogWarning("Couldn't get citizen idle state index.");
-		return;
-	}
-
-	if (!animDef.tryGetStateIndex(EntityAnimationUtils::STATE_WALK.c_str(), &walkStateIndex))
-	{
-		DebugLogWarning("Couldn't get citizen walk state index.");
-		return;
-	}
-
-	const auto &playerWeaponAnim = player.getWeaponAnimation();
-	EntityAnimationInstance &animInst = this->getAnimInstance();
-	const int curAnimStateIndex = animInst.getStateIndex();
-
-	if (curAnimStateIndex == idleStateIndex)
-	{
-		const bool shouldChangeToWalking = !playerWeaponAnim.isSheathed() ||
-			(distToPlayerSqr > citizenIdleDistSqr);
-
-		// @todo: need to preserve their previous direction so they stay aligned with
-		// the center of the voxel. Basically need to store cardinal direction as internal state.
-		if (shouldChangeToWalking)
-		{
-			animInst.setStateIndex(walkStateIndex);
-			const int citizenDirectionIndex = GetRandomCitizenDirectionIndex(random);
-			const auto &citizenDirection = CitizenDirections[citizenDirectionIndex];
-			this->direction = citizenDirection.second;
-			this->velocity = this->direction * CitizenSpeed;
-		}
-		else
-		{
-			// Face towards player.
-			this->setDirection(dirToPlayer);
-		}
-	}
-	else if (curAnimStateIndex == walkStateIndex)
-	{
-		const bool shouldChangeToIdle = playerWeaponAnim.isSheathed() &&
-			(distToPlayerSqr <= citizenIdleDistSqr);
-
-		if (shouldChangeToIdle)
-		{
-			animInst.setStateIndex(idleStateIndex);
-			this->velocity = NewDouble2::Zero;
-		}
-	}
-}
-
-void DynamicEntity::updateCreatureState(Game &game, double dt)
-{
-	auto &gameData = game.getGameData();
-	const auto &worldData = gameData.getActiveWorld();
-	const auto &levelData = worldData.getActiveLevel();
-	const auto &entityManager = levelData.getEntityManager();
-	const auto &entityDefLibrary = game.getEntityDefinitionLibrary();
-	const double ceilingHeight = levelData.getCeilingHeight();
-
-	// @todo: creature AI
-
-	// Tick down the NPC's creature sound (if any). This is done on the top level so the counter
-	// doesn't predictably begin when the player enters the creature's hearing distance.
-	this->secondsTillCreatureSound -= dt;
-	if (this->secondsTillCreatureSound <= 0.0)
-	{
-		// See if the NPC is withing hearing distance of the player.
-		const Double3 &playerPosition = gameData.getPlayer().getPosition();
-		if (this->withinHearingDistance(playerPosition, ceilingHeight))
-		{
-			// See if the NPC has a creature sound.
-			std::string creatureSoundFilename;
-			if (this->tryGetCreatureSoundFilename(entityManager, entityDefLibrary, &creatureSoundFilename))
-			{
-				auto &audioManager = game.getAudioManager();
-				this->playCreatureSound(creatureSoundFilename, ceilingHeight, audioManager);
-
-				const double creatureSoundWaitTime =
-					DynamicEntity::nextCreatureSoundWaitTime(game.getRandom());
-				this->secondsTillCreatureSound = creatureSoundWaitTime;
-			}
-		}
-	}
-}
-
-void DynamicEntity::updateProjectileState(Game &game, double dt)
-{
-	// @todo: projectile motion + collision
-}
-
-void DynamicEntity::updatePhysics(const WorldData &worldData,
-	const EntityDefinitionLibrary &entityDefLibrary, Random &random, double dt)
-{
-	const auto &levelData = worldData.getActiveLevel();
-	const DynamicEntityType dynamicEntityType = this->getDerivedType();
-
-	if (dynamicEntityType == DynamicEntityType::Citizen)
-	{
-		// Update citizen position and change facing if about to hit something.
-		const auto &voxelGrid = levelData.getVoxelGrid();
-		const auto &entityManager = levelData.getEntityManager();
-		const EntityDefinition &entityDef = entityManager.getEntityDef(
-			this->getDefinitionID(), entityDefLibrary);
-		const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
-
-		// If citizen and walking, continue walking until next block is not air.
-		int walkStateIndex;
-		if (!animDef.tryGetStateIndex(EntityAnimationUtils::STATE_WALK.c_str(), &walkStateIndex))
-		{
-			DebugLogWarning("Couldn't get citizen walk state index.");
-			return;
-		}
-
-		const EntityAnimationInstance &animInst = this->getAnimInstance();
-		const int curAnimStateIndex = animInst.getStateIndex();
-		if (curAnimStateIndex == walkStateIndex)
-		{
-			// Integrate by delta time.
-			this->position = this->position + (this->velocity * dt);
-
-			const NewDouble2 position = this->getPosition();
-			const NewDouble2 &direction = this->getDirection();
-
-			auto getVoxelAtDistance = [&position](const NewDouble2 &checkDist)
-			{
-				return NewInt2(
-					static_cast<SNInt>(std::floor(position.x + checkDist.x)),
-					static_cast<WEInt>(std::floor(position.y + checkDist.y)));
-			};
-
-			const NewInt2 curVoxel(
-				static_cast<SNInt>(std::floor(position.x)),
-				static_cast<WEInt>(std::floor(position.y)));
-			const NewInt2 nextVoxel = getVoxelAtDistance(direction * 0.50);
-
-			if (nextVoxel != curVoxel)
-			{
-				auto isSuitableVoxel = [&voxelGrid](const NewInt2 &voxel)
-				{
-					auto isValidVoxel = [&voxelGrid](const NewInt2 &voxel)
-					{
-						return voxelGrid.coordIsValid(voxel.x, 1, voxel.y);
-					};
-
-					auto isPassableVoxel = [&voxelGrid](const NewInt2 &voxel)
-					{
-						const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 1, voxel.y);
-						const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
-						return voxelDef.dataType == VoxelDataType::None;
-					};
-
-					auto isWalkableVoxel = [&voxelGrid](const NewInt2 &voxel)
-					{
-						const uint16_t voxelID = voxelGrid.getVoxel(voxel.x, 0, voxel.y);
-						const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
-						return voxelDef.dataType == VoxelDataType::Floor;
-					};
-
-					return isValidVoxel(voxel) && isPassableVoxel(voxel) && isWalkableVoxel(voxel);
-				};
-
-				if (!isSuitableVoxel(nextVoxel))
-				{
-					// Need to change walking direction. Determine another safe route, or if
-					// none exist, then stop walking.
-					const CardinalDirectionName curDirectionName =
-						CardinalDirection::getDirectionName(direction);
-
-					// Shuffle citizen direction indices so they don't all switch to the same
-					// direction every time.
-					std::array<int, 4> randomDirectionIndices = { 0, 1, 2, 3 };
-					RandomUtils::shuffle(randomDirectionIndices.data(),
-						static_cast<int>(randomDirectionIndices.size()), random);
-
-					const auto iter = std::find_if(randomDirectionIndices.begin(), randomDirectionIndices.end(),
-						[&getVoxelAtDistance, &isSuitableVoxel, curDirectionName](int dirIndex)
-					{
-						// See if this is a valid direction to go in.
-						const auto &directionPair = CitizenDirections[dirIndex];
-						const CardinalDirectionName cardinalDirectionName = directionPair.first;
-						if (cardinalDirectionName != curDirectionName)
-						{
-							const NewDouble2 &direction = directionPair.second;
-							const NewInt2 voxel = getVoxelAtDistance(direction * 0.50);
-							if (isSuitableVoxel(voxel))
-							{
-								return true;
-							}
-						}
-
-						return false;
-					});
-
-					if (iter != randomDirectionIndices.end())
-					{
-						const auto &directionPair = CitizenDirections[*iter];
-						const NewDouble2 &newDirection = directionPair.second;
-						this->setDirection(newDirection);
-						this->velocity = newDirection * CitizenSpeed;
-					}
-					else
-					{
-						// Couldn't find any valid direction.
-						this->velocity = NewDouble2::Zero;
-					}
-				}
-			}
-		}
-	}
-
-	// @todo: other dynamic entity types
-}
-
 void DynamicEntity::reset()
 {
 	Entity::reset();
@@ -482,27 +636,13 @@ void DynamicEntity::reset()
 
 void DynamicEntity::tick(Game &game, double dt)
 {
-	Entity::tick(game, dt);
-
-	// Update derived entity state.
-	switch (this->derivedType)
-	{
-	case DynamicEntityType::Citizen:
-		this->updateCitizenState(game, dt);
-		break;
-	case DynamicEntityType::Creature:
-		this->updateCreatureState(game, dt);
-		break;
-	case DynamicEntityType::Projectile:
-		this->updateProjectileState(game, dt);
-		break;
-	default:
-		DebugNotImplementedMsg(std::to_string(static_cast<int>(this->derivedType)));
-	}
+	// Same path as the entity manager's batched tick, with a batch of one.
+	const TickContext context = TickContext::makeFromGame(game);
+	auto &random = game.getRandom();
 
-	// Update physics/pathfinding/etc..
-	// @todo: add a check here if updating the entity state has put them in a non-physics state.
-	const auto &worldData = game.getGameData().getActiveWorld();
-	const auto &entityDefLibrary = game.getEntityDefinitionLibrary();
-	this->updatePhysics(worldData, entityDefLibrary, game.getRandom(), dt);
+	TickBatch batch;
+	batch.clear(random.next());
+	batch.add(*this, context);
+	batch.tick(context, dt);
+	batch.playCreatureSounds(context, game.getAudioManager(), random);
 }
@@ -3,9 +3,11 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "DynamicEntityType.h"
 #include "Entity.h"
+#include "../Math/Random.h"
 #include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 
@@ -13,15 +15,95 @@
 // on the entity's position relative to the player's camera.
 
 class AudioManager;
+class EntityAnimationDefinition;
 class EntityDefinitionLibrary;
 class EntityManager;
 class ExeData;
+class VoxelGrid;
 class WorldData;
 
 enum class CardinalDirectionName;
 
 class DynamicEntity final : public Entity
 {
+public:
+	// World state shared by every dynamic entity in a tick, looked up once instead of per entity.
+	struct TickContext
+	{
+		Double3 playerPosition;
+		bool playerWeaponSheathed;
+		double ceilingHeight;
+		const VoxelGrid *voxelGrid;
+		const EntityManager *entityManager;
+		const EntityDefinitionLibrary *entityDefLibrary;
+
+		TickContext();
+
+		void init(const Double3 &playerPosition, bool playerWeaponSheathed, double ceilingHeight,
+			const VoxelGrid &voxelGrid, const EntityManager &entityManager,
+			const EntityDefinitionLibrary &entityDefLibrary);
+
+		// Gets the tick context for the active level.
+		static TickContext makeFromGame(Game &game);
+	};
+
+	// Dynamic entity state copied into parallel arrays so a group of entities (i.e., a chunk)
+	// can be stepped in tight loops, then written back. A batch only touches its own entities
+	// and random generator, so separate batches can be ticked on separate threads. Creature
+	// sounds are deferred to playCreatureSounds() since audio isn't thread-safe.
+	class TickBatch
+	{
+	private:
+		// Animation data shared by all entities with the same definition.
+		struct DefInfo
+		{
+			EntityDefID defID;
+			const EntityAnimationDefinition *animDef;
+			int idleStateIndex, walkStateIndex; // -1 if the definition doesn't have the state.
+
+			DefInfo();
+
+			void init(EntityDefID defID, const EntityAnimationDefinition &animDef);
+		};
+
+		std::vector<DynamicEntity*> entities;
+		std::vector<DynamicEntityType> types;
+		std::vector<int> defInfoIndices;
+		std::vector<NewDouble2> positions, velocities, directions;
+		std::vector<int> animStateIndices;
+		std::vector<double> creatureSoundSeconds;
+		std::vector<int> walkingIndices; // Citizens that are walking this tick.
+		std::vector<int> soundIndices; // Creatures that are due to play a sound.
+		std::vector<DefInfo> defInfos;
+		Random random;
+
+		// Gets the index of the definition's info, adding it if necessary.
+		int getDefInfoIndex(EntityDefID defID, const TickContext &context);
+
+		// Passes over the batch, in tick order.
+		void tickAnimations(double dt);
+		void tickCitizenStates(const TickContext &context);
+		void tickCreatureStates(const TickContext &context, double dt);
+		void tickCitizenMovement(const TickContext &context, double dt);
+		void writeBack();
+	public:
+		// Removes all entities and reseeds the batch's random generator.
+		void clear(int seed);
+
+		int getCount() const;
+		DynamicEntity &getEntity(int index) const;
+
+		// Copies the entity's state into the batch.
+		void add(DynamicEntity &entity, const TickContext &context);
+
+		// Animates and moves every entity in the batch, then writes their state back.
+		void tick(const TickContext &context, double dt);
+
+		// Plays the sounds of creatures that were due for one in the last tick. Must be on the
+		// main thread.
+		void playCreatureSounds(const TickContext &context, AudioManager &audioManager,
+			Random &random);
+	};
 private:
 	NewDouble2 direction;
 	NewDouble2 velocity;
@@ -32,9 +114,6 @@ private:
 	// Gets the next creature sound wait time (in seconds) from the given RNG.
 	static double nextCreatureSoundWaitTime(Random &random);
 
-	// @todo: this should probably be a property of the listener, not this entity.
-	bool withinHearingDistance(const Double3 &point, double ceilingHeight);
-
 	// Attempts to get the entity's creature sound filename (if any). Returns success.
 	bool tryGetCreatureSoundFilename(const EntityManager &entityManager,
 		const EntityDefinitionLibrary &entityDefLibrary, std::string *outFilename) const;
@@ -45,15 +124,6 @@ private:
 
 	// Helper method for rotating.
 	void yaw(double radians);
-
-	// Update functions for various dynamic entity types.
-	void updateCitizenState(Game &game, double dt);
-	void updateCreatureState(Game &game, double dt);
-	void updateProjectileState(Game &game, double dt);
-
-	// Updates the entity's physics in the world (if any).
-	void updatePhysics(const WorldData &worldData, const EntityDefinitionLibrary &entityDefLibrary,
-		Random &random, double dt);
 public:
 	DynamicEntity();
 	virtual ~DynamicEntity() = default;
@@ -86,6 +156,8 @@ public:
 	void setDestination(const NewDouble2 *point);
 
 	virtual void reset() override;
+
+	// Ticks this entity alone. The entity manager ticks dynamic entities in batches instead.
 	virtual void tick(Game &game, double dt) override;
 };
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 
@@ -68,6 +69,7 @@ void EntityAnimationDefinition::KeyframeList::clearKeyframes()
 EntityAnimationDefinition::State::State()
 {
 	this->name.fill('\0');
+	this->id = EntityAnimationUtils::STATE_ID_NONE;
 	this->totalSeconds = 0.0;
 	this->loop = false;
 }
@@ -76,6 +78,7 @@ void EntityAnimationDefinition::State::init(const char *name, double totalSecond
 {
 	DebugAssertMsg(!String::isNullOrEmpty(name), "State must have a name.");
 	std::snprintf(this->name.data(), this->name.size(), "%s", name);
+	this->id = EntityAnimationUtils::getStateID(this->name.data());
 
 	this->totalSeconds = totalSeconds;
 	this->loop = loop;
@@ -86,6 +89,11 @@ const char *EntityAnimationDefinition::State::getName() const
 	return this->name.data();
 }
 
+EntityAnimationStateID EntityAnimationDefinition::State::getID() const
+{
+	return this->id;
+}
+
 int EntityAnimationDefinition::State::getKeyframeListCount() const
 {
 	return static_cast<int>(this->keyframeLists.size());
@@ -117,6 +125,45 @@ void EntityAnimationDefinition::State::clearKeyframeLists()
 	this->keyframeLists.clear();
 }
 
+EntityAnimationDefinition::EntityAnimationDefinition()
+{
+	this->stateIndices.fill(-1);
+	this->maxKeyframeWidth = 0.0;
+}
+
+void EntityAnimationDefinition::updateStateIndices()
+{
+	this->stateIndices.fill(-1);
+
+	// Iterate backwards so the first state with a given ID wins, like the string look-up.
+	for (int i = static_cast<int>(this->states.size()) - 1; i >= 0; i--)
+	{
+		const EntityAnimationStateID stateID = this->states[i].getID();
+		if (stateID != EntityAnimationUtils::STATE_ID_NONE)
+		{
+			DebugAssertIndex(this->stateIndices, static_cast<size_t>(stateID));
+			this->stateIndices[stateID] = i;
+		}
+	}
+}
+
+void EntityAnimationDefinition::updateMaxKeyframeWidth()
+{
+	this->maxKeyframeWidth = 0.0;
+	for (const State &state : this->states)
+	{
+		for (int i = 0; i < state.getKeyframeListCount(); i++)
+		{
+			const KeyframeList &keyframeList = state.getKeyframeList(i);
+			for (int j = 0; j < keyframeList.getKeyframeCount(); j++)
+			{
+				const Keyframe &keyframe = keyframeList.getKeyframe(j);
+				this->maxKeyframeWidth = std::max(this->maxKeyframeWidth, keyframe.getWidth());
+			}
+		}
+	}
+}
+
 int EntityAnimationDefinition::getStateCount() const
 {
 	return static_cast<int>(this->states.size());
@@ -149,9 +196,33 @@ bool EntityAnimationDefinition::tryGetStateIndex(const char *name, int *outIndex
 	return false;
 }
 
+bool EntityAnimationDefinition::tryGetStateIndex(EntityAnimationStateID stateID, int *outIndex) const
+{
+	if ((stateID < 0) || (stateID >= static_cast<int>(this->stateIndices.size())))
+	{
+		return false;
+	}
+
+	const int stateIndex = this->stateIndices[stateID];
+	if (stateIndex < 0)
+	{
+		return false;
+	}
+
+	*outIndex = stateIndex;
+	return true;
+}
+
+double EntityAnimationDefinition::getMaxKeyframeWidth() const
+{
+	return this->maxKeyframeWidth;
+}
+
 void EntityAnimationDefinition::addState(State &&state)
 {
 	this->states.push_back(std::move(state));
+	this->updateStateIndices();
+	this->updateMaxKeyframeWidth();
 }
 
 void EntityAnimationDefinition::removeState(const char *name)
@@ -160,10 +231,14 @@ void EntityAnimationDefinition::removeState(const char *name)
 	if (this->tryGetStateIndex(name, &stateIndex))
 	{
 		this->states.erase(this->states.begin() + stateIndex);
+		this->updateStateIndices();
+		this->updateMaxKeyframeWidth();
 	}
 }
 
 void EntityAnimationDefinition::clear()
 {
 	this->states.clear();
+	this->stateIndices.fill(-1);
+	this->maxKeyframeWidth = 0.0;
 }
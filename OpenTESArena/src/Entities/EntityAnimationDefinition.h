@@ -55,6 +55,7 @@ public:
 	{
 	private:
 		std::array<char, EntityAnimationUtils::NAME_LENGTH> name; // Idle, Attack, etc..
+		EntityAnimationStateID id; // Interned name, if it has one.
 		std::vector<KeyframeList> keyframeLists; // Each list occupies a slice of 360 degrees.
 		double totalSeconds; // Duration of state in seconds.
 		bool loop;
@@ -64,6 +65,7 @@ public:
 		void init(const char *name, double totalSeconds, bool loop);
 
 		const char *getName() const;
+		EntityAnimationStateID getID() const;
 		int getKeyframeListCount() const;
 		const KeyframeList &getKeyframeList(int index) const;
 		double getTotalSeconds() const;
@@ -74,11 +76,27 @@ public:
 	};
 private:
 	std::vector<State> states; // Idle, Attack, etc..
+
+	// State ID -> state index mappings, -1 if there's no state with that ID.
+	std::array<int, EntityAnimationUtils::STATE_ID_COUNT> stateIndices;
+
+	// Widest keyframe in any state, for bounding where the entity can be seen or selected.
+	double maxKeyframeWidth;
+
+	void updateStateIndices();
+	void updateMaxKeyframeWidth();
 public:
+	EntityAnimationDefinition();
+
 	int getStateCount() const;
 	const State &getState(int index) const;
 	bool tryGetStateIndex(const char *name, int *outIndex) const;
 
+	// Constant-time look-up for states with an interned name. Prefer this in hot paths.
+	bool tryGetStateIndex(EntityAnimationStateID stateID, int *outIndex) const;
+
+	double getMaxKeyframeWidth() const;
+
 	void addState(State &&state);
 	void removeState(const char *name);
 	void clear();
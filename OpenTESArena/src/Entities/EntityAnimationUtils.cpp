@@ -0,0 +1,38 @@
+#include <array>
+
+#include "EntityAnimationUtils.h"
+
+#include "components/utilities/String.h"
+#include "components/utilities/StringView.h"
+
+namespace
+{
+	// State names in ID order.
+	const std::array<const std::string*, EntityAnimationUtils::STATE_ID_COUNT> StateIdNames =
+	{
+		&EntityAnimationUtils::STATE_IDLE,
+		&EntityAnimationUtils::STATE_LOOK,
+		&EntityAnimationUtils::STATE_WALK,
+		&EntityAnimationUtils::STATE_ATTACK,
+		&EntityAnimationUtils::STATE_DEATH,
+		&EntityAnimationUtils::STATE_ACTIVATED
+	};
+}
+
+EntityAnimationStateID EntityAnimationUtils::getStateID(const char *name)
+{
+	if (String::isNullOrEmpty(name))
+	{
+		return EntityAnimationUtils::STATE_ID_NONE;
+	}
+
+	for (int i = 0; i < static_cast<int>(StateIdNames.size()); i++)
+	{
+		if (StringView::caseInsensitiveEquals(*StateIdNames[i], name))
+		{
+			return i;
+		}
+	}
+
+	return EntityAnimationUtils::STATE_ID_NONE;
+}
@@ -3,6 +3,10 @@
 
 #include <string>
 
+// Interned animation state name. Known state names are resolved to these once so hot paths
+// can find a state without comparing strings.
+using EntityAnimationStateID = int;
+
 namespace EntityAnimationUtils
 {
 	const std::string STATE_IDLE = "Idle";
@@ -12,8 +16,21 @@ namespace EntityAnimationUtils
 	const std::string STATE_DEATH = "Death";
 	const std::string STATE_ACTIVATED = "Activated";
 
+	// IDs of the state names above. Names without an ID can still be looked up by string.
+	constexpr EntityAnimationStateID STATE_ID_NONE = -1;
+	constexpr EntityAnimationStateID STATE_ID_IDLE = 0;
+	constexpr EntityAnimationStateID STATE_ID_LOOK = 1;
+	constexpr EntityAnimationStateID STATE_ID_WALK = 2;
+	constexpr EntityAnimationStateID STATE_ID_ATTACK = 3;
+	constexpr EntityAnimationStateID STATE_ID_DEATH = 4;
+	constexpr EntityAnimationStateID STATE_ID_ACTIVATED = 5;
+	constexpr int STATE_ID_COUNT = 6;
+
 	// Max length of animation state name.
 	constexpr int NAME_LENGTH = 32;
+
+	// Gets the ID of a state name (case-insensitive), or STATE_ID_NONE if it doesn't have one.
+	EntityAnimationStateID getStateID(const char *name);
 }
 
 #endif
@@ -14,6 +14,7 @@
 #include "../World/VoxelDataType.h"
 
 #include "components/debug/Debug.h"
+#include "components/utilities/JobPool.h"
 
 namespace
 {
@@ -41,6 +42,15 @@ void EntityManager::EntityVisibilityData::init(const Entity *entity, const Doubl
 	this->keyframeIndex = keyframeIndex;
 }
 
+void EntityManager::VoxelIndexEntry::init(const NewInt2 &voxel, const ChunkInt2 &chunk,
+	EntityType type, EntityDefID defID)
+{
+	this->voxel = voxel;
+	this->chunk = chunk;
+	this->type = type;
+	this->defID = defID;
+}
+
 template <typename T>
 int EntityManager::EntityGroup<T>::getCount() const
 {
@@ -261,11 +271,19 @@ void EntityManager::EntityGroup<T>::clear()
 	this->freeIndices.clear();
 }
 
+EntityManager::EntityManager()
+{
+	this->nextID = FIRST_ENTITY_ID;
+	this->dynamicTickBatchCount = 0;
+}
+
 void EntityManager::init(SNInt chunkCountX, WEInt chunkCountZ)
 {
 	this->staticGroups.init(chunkCountX, chunkCountZ);
 	this->dynamicGroups.init(chunkCountX, chunkCountZ);
 	this->nextID = FIRST_ENTITY_ID;
+	this->dynamicTickBatchCount = 0;
+	this->clearVoxelIndex();
 }
 
 EntityID EntityManager::nextFreeID()
@@ -293,6 +311,99 @@ bool EntityManager::isValidChunk(const ChunkInt2 &chunk) const
 	return (chunk.x >= 0) && (chunk.x < chunkCountX) && (chunk.y >= 0) && (chunk.y < chunkCountZ);
 }
 
+void EntityManager::updateVoxelIndexEntry(const Entity &entity, const ChunkInt2 &chunk)
+{
+	const EntityID id = entity.getID();
+	const EntityDefID defID = entity.getDefinitionID();
+	const NewDouble2 &entityPos = entity.getPosition();
+	const NewInt2 voxel(
+		static_cast<SNInt>(entityPos.x),
+		static_cast<WEInt>(entityPos.y));
+
+	auto entryIter = this->voxelIndexEntries.find(id);
+	if (entryIter == this->voxelIndexEntries.end())
+	{
+		VoxelIndexEntry entry;
+		entry.init(voxel, chunk, entity.getEntityType(), defID);
+		this->voxelIndexEntries.emplace(id, entry);
+		this->voxelEntityIDs[voxel].push_back(id);
+		this->voxelIndexDefCounts[defID]++;
+		return;
+	}
+
+	VoxelIndexEntry &entry = entryIter->second;
+	if (entry.voxel != voxel)
+	{
+		// Order within a voxel doesn't matter, so swap with the last ID instead of shifting.
+		std::vector<EntityID> &oldIDs = this->voxelEntityIDs[entry.voxel];
+		const auto idIter = std::find(oldIDs.begin(), oldIDs.end(), id);
+		DebugAssert(idIter != oldIDs.end());
+		*idIter = oldIDs.back();
+		oldIDs.pop_back();
+
+		if (oldIDs.size() == 0)
+		{
+			this->voxelEntityIDs.erase(entry.voxel);
+		}
+
+		this->voxelEntityIDs[voxel].push_back(id);
+		entry.voxel = voxel;
+	}
+
+	if (entry.defID != defID)
+	{
+		int &oldDefCount = this->voxelIndexDefCounts[entry.defID];
+		oldDefCount--;
+		if (oldDefCount == 0)
+		{
+			this->voxelIndexDefCounts.erase(entry.defID);
+		}
+
+		this->voxelIndexDefCounts[defID]++;
+		entry.defID = defID;
+	}
+
+	entry.chunk = chunk;
+}
+
+void EntityManager::removeVoxelIndexEntry(EntityID id)
+{
+	const auto entryIter = this->voxelIndexEntries.find(id);
+	if (entryIter == this->voxelIndexEntries.end())
+	{
+		// Never placed.
+		return;
+	}
+
+	const VoxelIndexEntry &entry = entryIter->second;
+	std::vector<EntityID> &ids = this->voxelEntityIDs[entry.voxel];
+	const auto idIter = std::find(ids.begin(), ids.end(), id);
+	DebugAssert(idIter != ids.end());
+	*idIter = ids.back();
+	ids.pop_back();
+
+	if (ids.size() == 0)
+	{
+		this->voxelEntityIDs.erase(entry.voxel);
+	}
+
+	int &defCount = this->voxelIndexDefCounts[entry.defID];
+	defCount--;
+	if (defCount == 0)
+	{
+		this->voxelIndexDefCounts.erase(entry.defID);
+	}
+
+	this->voxelIndexEntries.erase(entryIter);
+}
+
+void EntityManager::clearVoxelIndex()
+{
+	this->voxelEntityIDs.clear();
+	this->voxelIndexEntries.clear();
+	this->voxelIndexDefCounts.clear();
+}
+
 EntityRef EntityManager::makeEntity(EntityType type)
 {
 	const EntityID id = this->nextFreeID();
@@ -669,6 +780,74 @@ int EntityManager::getTotalEntities(const Entity **outEntities, int outSize) con
 	return writeIndex;
 }
 
+int EntityManager::getCountInVoxel(const NewInt2 &voxel) const
+{
+	const auto iter = this->voxelEntityIDs.find(voxel);
+	return (iter != this->voxelEntityIDs.end()) ? static_cast<int>(iter->second.size()) : 0;
+}
+
+int EntityManager::getEntitiesInVoxel(const NewInt2 &voxel, const Entity **outEntities, int outSize) const
+{
+	if ((outEntities == nullptr) || (outSize == 0))
+	{
+		return 0;
+	}
+
+	const auto iter = this->voxelEntityIDs.find(voxel);
+	if (iter == this->voxelEntityIDs.end())
+	{
+		return 0;
+	}
+
+	// The index knows each entity's group, so there's no need to search every chunk for them.
+	int writeIndex = 0;
+	for (const EntityID id : iter->second)
+	{
+		if (writeIndex == outSize)
+		{
+			break;
+		}
+
+		const VoxelIndexEntry &entry = this->voxelIndexEntries.at(id);
+		const Entity *entity = [this, id, &entry]() -> const Entity*
+		{
+			if (entry.type == EntityType::Static)
+			{
+				return this->getInternal(id, this->staticGroups.get(entry.chunk.x, entry.chunk.y));
+			}
+			else
+			{
+				return this->getInternal(id, this->dynamicGroups.get(entry.chunk.x, entry.chunk.y));
+			}
+		}();
+
+		DebugAssert(entity != nullptr);
+		outEntities[writeIndex] = entity;
+		writeIndex++;
+	}
+
+	return writeIndex;
+}
+
+int EntityManager::getMaxEntityVoxelReach(const EntityDefinitionLibrary &entityDefLibrary) const
+{
+	double maxHalfWidth = 0.0;
+	for (const auto &pair : this->voxelIndexDefCounts)
+	{
+		const EntityDefID defID = pair.first;
+		if (defID == EntityManager::NO_DEF_ID)
+		{
+			continue;
+		}
+
+		const EntityDefinition &entityDef = this->getEntityDef(defID, entityDefLibrary);
+		const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
+		maxHalfWidth = std::max(maxHalfWidth, animDef.getMaxKeyframeWidth() * 0.50);
+	}
+
+	return static_cast<int>(std::ceil(maxHalfWidth));
+}
+
 bool EntityManager::hasEntityDef(EntityDefID defID) const
 {
 	return (defID >= 0) && (defID < static_cast<int>(this->entityDefs.size()));
@@ -855,6 +1034,11 @@ void EntityManager::updateEntityChunk(Entity *entity, const VoxelGrid &voxelGrid
 		return;
 	}
 
+	// Swapping groups moves the entity, so keep what's needed afterwards for the voxel index.
+	const EntityID entityID = entity->getID();
+	const EntityType entityType = entity->getEntityType();
+	const NewDouble2 entityPos = entity->getPosition();
+
 	// Find which chunk they were in.
 	SNInt oldChunkX = -1;
 	WEInt oldChunkZ = -1;
@@ -904,10 +1088,12 @@ void EntityManager::updateEntityChunk(Entity *entity, const VoxelGrid &voxelGrid
 		}
 	};
 
+	bool foundGroup = false;
 	if (entity->getEntityType() == EntityType::Static)
 	{
 		EntityGroup<StaticEntity> *staticEntityGroupPtr = nullptr;
-		if (tryGetEntityGroupInfo(this->staticGroups, &staticEntityGroupPtr))
+		foundGroup = tryGetEntityGroupInfo(this->staticGroups, &staticEntityGroupPtr);
+		if (foundGroup)
 		{
 			trySwapEntityGroup(entity, *staticEntityGroupPtr, this->staticGroups);
 		}
@@ -915,7 +1101,8 @@ void EntityManager::updateEntityChunk(Entity *entity, const VoxelGrid &voxelGrid
 	else if (entity->getEntityType() == EntityType::Dynamic)
 	{
 		EntityGroup<DynamicEntity> *dynamicEntityGroupPtr = nullptr;
-		if (tryGetEntityGroupInfo(this->dynamicGroups, &dynamicEntityGroupPtr))
+		foundGroup = tryGetEntityGroupInfo(this->dynamicGroups, &dynamicEntityGroupPtr);
+		if (foundGroup)
 		{
 			trySwapEntityGroup(entity, *dynamicEntityGroupPtr, this->dynamicGroups);
 		}
@@ -925,6 +1112,20 @@ void EntityManager::updateEntityChunk(Entity *entity, const VoxelGrid &voxelGrid
 		DebugLogError("Unhandled entity type \"" +
 			std::to_string(static_cast<int>(entity->getEntityType())) + "\".");
 	}
+
+	if (foundGroup)
+	{
+		// Re-acquire the entity by ID since the old pointer can be dangling now.
+		const NewInt2 entityVoxel(
+			static_cast<SNInt>(entityPos.x),
+			static_cast<WEInt>(entityPos.y));
+		const ChunkInt2 entityChunk = VoxelUtils::newVoxelToChunk(entityVoxel);
+		const Entity *movedEntity = (entityType == EntityType::Static) ?
+			this->getInternal(entityID, this->staticGroups.get(entityChunk.x, entityChunk.y)) :
+			this->getInternal(entityID, this->dynamicGroups.get(entityChunk.x, entityChunk.y));
+		DebugAssert(movedEntity != nullptr);
+		this->updateVoxelIndexEntry(*movedEntity, entityChunk);
+	}
 }
 
 void EntityManager::remove(EntityID id)
@@ -943,6 +1144,7 @@ void EntityManager::remove(EntityID id)
 			if (entityIndex.has_value())
 			{
 				// Static entity.
+				this->removeVoxelIndexEntry(id);
 				staticGroup.remove(id);
 
 				// Insert entity ID into the free list.
@@ -955,6 +1157,7 @@ void EntityManager::remove(EntityID id)
 			if (entityIndex.has_value())
 			{
 				// Dynamic entity.
+				this->removeVoxelIndexEntry(id);
 				dynamicGroup.remove(id);
 
 				// Insert entity ID into the free list.
@@ -984,16 +1187,114 @@ void EntityManager::clear()
 	this->entityDefs.clear();
 	this->freeIDs.clear();
 	this->nextID = FIRST_ENTITY_ID;
+	this->dynamicTickBatchCount = 0;
+	this->clearVoxelIndex();
 }
 
 void EntityManager::clearChunk(const ChunkInt2 &coord)
 {
 	auto &staticGroup = this->staticGroups.get(coord.x, coord.y);
 	auto &dynamicGroup = this->dynamicGroups.get(coord.x, coord.y);
+
+	auto removeGroupFromVoxelIndex = [this](const auto &entityGroup)
+	{
+		for (int i = 0; i < entityGroup.getCount(); i++)
+		{
+			const Entity *entity = entityGroup.getEntityAtIndex(i);
+			if (entity != nullptr)
+			{
+				this->removeVoxelIndexEntry(entity->getID());
+			}
+		}
+	};
+
+	removeGroupFromVoxelIndex(staticGroup);
+	removeGroupFromVoxelIndex(dynamicGroup);
 	staticGroup.clear();
 	dynamicGroup.clear();
 }
 
+void EntityManager::tickDynamicEntities(const DynamicEntity::TickContext &context,
+	const ChunkInt2 &minChunk, const ChunkInt2 &maxChunk, JobPool &jobPool, Random &random, double dt)
+{
+	// Gather one batch per chunk with dynamic entities in it.
+	this->dynamicTickBatchCount = 0;
+	for (WEInt z = minChunk.y; z <= maxChunk.y; z++)
+	{
+		for (SNInt x = minChunk.x; x <= maxChunk.x; x++)
+		{
+			const bool coordIsValid = (x >= 0) && (x < this->dynamicGroups.getWidth()) &&
+				(z >= 0) && (z < this->dynamicGroups.getHeight());
+
+			if (!coordIsValid)
+			{
+				continue;
+			}
+
+			if (this->dynamicTickBatchCount == static_cast<int>(this->dynamicTickBatches.size()))
+			{
+				this->dynamicTickBatches.emplace_back();
+				this->dynamicTickBatchChunks.emplace_back();
+			}
+
+			auto &batch = this->dynamicTickBatches[this->dynamicTickBatchCount];
+			batch.clear(random.next());
+			this->dynamicTickBatchChunks[this->dynamicTickBatchCount] = ChunkInt2(x, z);
+
+			auto &entityGroup = this->dynamicGroups.get(x, z);
+			const int entityCount = entityGroup.getCount();
+			for (int i = 0; i < entityCount; i++)
+			{
+				DynamicEntity *entity = entityGroup.getEntityAtIndex(i);
+				if (entity != nullptr)
+				{
+					batch.add(*entity, context);
+				}
+			}
+
+			if (batch.getCount() > 0)
+			{
+				this->dynamicTickBatchCount++;
+			}
+		}
+	}
+
+	// Batches only write to their own chunk's entities, so they can all run at once. The pool is
+	// shared with chunk streaming, so only wait for the tick jobs.
+	JobPool::Batch jobBatch;
+	for (int i = 0; i < this->dynamicTickBatchCount; i++)
+	{
+		auto &batch = this->dynamicTickBatches[i];
+		jobPool.submit([&batch, &context, dt]()
+		{
+			batch.tick(context, dt);
+		}, jobBatch);
+	}
+
+	jobPool.wait(jobBatch);
+
+	// Entities stay in their chunk's group while moving, but the voxel index follows them.
+	for (int i = 0; i < this->dynamicTickBatchCount; i++)
+	{
+		const auto &batch = this->dynamicTickBatches[i];
+		const ChunkInt2 &chunk = this->dynamicTickBatchChunks[i];
+		for (int j = 0; j < batch.getCount(); j++)
+		{
+			this->updateVoxelIndexEntry(batch.getEntity(j), chunk);
+		}
+	}
+}
+
+void EntityManager::playDynamicEntitySounds(const DynamicEntity::TickContext &context,
+	AudioManager &audioManager, Random &random)
+{
+	for (int i = 0; i < this->dynamicTickBatchCount; i++)
+	{
+		auto &batch = this->dynamicTickBatches[i];
+		batch.playCreatureSounds(context, audioManager, random);
+	}
+}
+
 void EntityManager::tick(Game &game, double dt)
 {
 	// Only want to tick entities near the player, so get the chunks near the player.
@@ -1044,5 +1345,9 @@ void EntityManager::tick(Game &game, double dt)
 	};
 
 	tickNearbyEntityGroups(this->staticGroups);
-	tickNearbyEntityGroups(this->dynamicGroups);
+
+	const DynamicEntity::TickContext context = DynamicEntity::TickContext::makeFromGame(game);
+	auto &random = game.getRandom();
+	this->tickDynamicEntities(context, minChunk, maxChunk, game.getJobPool(), random, dt);
+	this->playDynamicEntitySounds(context, game.getAudioManager(), random);
 }
@@ -18,8 +18,11 @@
 
 #include "components/utilities/Buffer2D.h"
 
+class AudioManager;
 class EntityDefinitionLibrary;
 class Game;
+class JobPool;
+class Random;
 
 enum class EntityType;
 
@@ -40,6 +43,18 @@ public:
 			int angleIndex, int keyframeIndex);
 	};
 private:
+	// Where an entity is in the voxel index. The chunk is the one whose entity group owns the
+	// entity, which can lag behind its position until its chunk is updated.
+	struct VoxelIndexEntry
+	{
+		NewInt2 voxel;
+		ChunkInt2 chunk;
+		EntityType type;
+		EntityDefID defID;
+
+		void init(const NewInt2 &voxel, const ChunkInt2 &chunk, EntityType type, EntityDefID defID);
+	};
+
 	template <typename T>
 	class EntityGroup
 	{
@@ -102,12 +117,29 @@ private:
 	std::vector<EntityID> freeIDs;
 	EntityID nextID;
 
+	// Dynamic entity state of each chunk ticked last, reused between ticks to avoid allocating.
+	std::vector<DynamicEntity::TickBatch> dynamicTickBatches;
+	std::vector<ChunkInt2> dynamicTickBatchChunks;
+	int dynamicTickBatchCount;
+
+	// Entity IDs by the voxel column their position is in, for ray casts and other spatial
+	// queries that only care about a few voxels. Kept up to date as entities are placed, moved
+	// and removed. Entities only enter the index once they have a position.
+	std::unordered_map<NewInt2, std::vector<EntityID>> voxelEntityIDs;
+	std::unordered_map<EntityID, VoxelIndexEntry> voxelIndexEntries;
+	std::unordered_map<EntityDefID, int> voxelIndexDefCounts; // Indexed entities per definition.
+
 	// Obtains an available ID to be assigned to a new entity, incrementing the current max
 	// if no previously owned IDs are available to reuse.
 	EntityID nextFreeID();
 
 	bool isValidChunk(const ChunkInt2 &chunk) const;
 
+	// Adds the entity to the voxel index or moves it to the voxel column of its position.
+	void updateVoxelIndexEntry(const Entity &entity, const ChunkInt2 &chunk);
+	void removeVoxelIndexEntry(EntityID id);
+	void clearVoxelIndex();
+
 	// Helper functions for looking up an entity in the given group by ID.
 	template <typename T>
 	Entity *getInternal(EntityID id, EntityGroup<T> &group);
@@ -119,6 +151,8 @@ public:
 	static constexpr EntityDefID NO_DEF_ID = -1;
 	static constexpr EntityRenderID NO_RENDER_ID = -1;
 
+	EntityManager();
+
 	// Requires the chunks per X and Z side in the voxel grid for allocating entity groups.
 	void init(SNInt chunkCountX, WEInt chunkCountZ);
 
@@ -158,6 +192,17 @@ public:
 	// Gets pointers to all entities. Returns number of entities written.
 	int getTotalEntities(const Entity **outEntities, int outSize) const;
 
+	// Gets number of entities whose position is in the given voxel column.
+	int getCountInVoxel(const NewInt2 &voxel) const;
+
+	// Gets pointers to entities whose position is in the given voxel column. Returns number of
+	// entities written.
+	int getEntitiesInVoxel(const NewInt2 &voxel, const Entity **outEntities, int outSize) const;
+
+	// Gets how many voxel columns past its own an entity's widest keyframe can reach, for any
+	// entity in the voxel index. Queries for what touches a voxel need to look this far around it.
+	int getMaxEntityVoxelReach(const EntityDefinitionLibrary &entityDefLibrary) const;
+
 	// Returns whether the given entity definition ID points to a valid definition.
 	bool hasEntityDef(EntityDefID defID) const;
 
@@ -195,6 +240,17 @@ public:
 	// Deletes all entities in the given chunk.
 	void clearChunk(const ChunkInt2 &coord);
 
+	// Ticks the dynamic entities in the given chunks by delta time. Each chunk's entities are
+	// copied into a batch and the batches are ticked in parallel on the job pool. Each batch's
+	// random generator is seeded from the given one so results don't depend on thread timing.
+	// Creature sounds are left for playDynamicEntitySounds().
+	void tickDynamicEntities(const DynamicEntity::TickContext &context, const ChunkInt2 &minChunk,
+		const ChunkInt2 &maxChunk, JobPool &jobPool, Random &random, double dt);
+
+	// Plays creature sounds that came due in the last dynamic entity tick.
+	void playDynamicEntitySounds(const DynamicEntity::TickContext &context,
+		AudioManager &audioManager, Random &random);
+
 	// Ticks the entity manager by delta time.
 	void tick(Game &game, double dt);
 };
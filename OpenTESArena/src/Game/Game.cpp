@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
@@ -20,6 +21,7 @@
 
 #include "components/debug/Debug.h"
 #include "components/utilities/File.h"
+#include "components/utilities/Profiler.h"
 #include "components/utilities/String.h"
 #include "components/utilities/TextLinesFile.h"
 #include "components/vfs/manager.hpp"
@@ -73,6 +75,15 @@ Game::Game()
 		static_cast<Renderer::WindowMode>(this->options.getGraphics_WindowMode()),
 		this->options.getGraphics_LetterboxMode());
 
+	// The scale bounds are user-editable, so use the sanitized range.
+	double dynamicResolutionMinScale;
+	double dynamicResolutionMaxScale;
+	this->options.getGraphics_DynamicResolutionScaleRange(&dynamicResolutionMinScale,
+		&dynamicResolutionMaxScale);
+	this->renderer.setDynamicResolution(this->options.getGraphics_DynamicResolution(),
+		dynamicResolutionMinScale, dynamicResolutionMaxScale,
+		this->options.getGraphics_DynamicResolutionTargetFPSClamped());
+
 	// Determine which version of the game the Arena path is pointing to.
 	const bool isFloppyVersion = [this, arenaPathIsRelative]()
 	{
@@ -166,6 +177,7 @@ Game::Game()
 
 	this->random.init();
 	this->scratchAllocator.init(SCRATCH_BUFFER_SIZE);
+	this->jobPool.init(std::max(Platform::getThreadCount() - 1, 1), "Game job");
 
 	// Initialize panel and music to default.
 	this->panel = Panel::defaultPanel(*this);
@@ -298,9 +310,9 @@ ScratchAllocator &Game::getScratchAllocator()
 	return this->scratchAllocator;
 }
 
-Profiler &Game::getProfiler()
+JobPool &Game::getJobPool()
 {
-	return this->profiler;
+	return this->jobPool;
 }
 
 const FPSCounter &Game::getFPSCounter() const
@@ -410,6 +422,41 @@ void Game::saveScreenshot(const Surface &surface)
 	}
 }
 
+void Game::saveProfilerTrace()
+{
+	const std::string tracePath = []()
+	{
+		const std::string traceFolder = Platform::getProfilerTracePath();
+		const std::string tracePrefix("trace");
+		int traceIndex = 0;
+
+		auto getNextAvailablePath = [&traceFolder, &tracePrefix, &traceIndex]()
+		{
+			std::stringstream ss;
+			ss << std::setw(3) << std::setfill('0') << traceIndex;
+			traceIndex++;
+			return traceFolder + tracePrefix + ss.str() + ".json";
+		};
+
+		std::string path = getNextAvailablePath();
+		while (File::exists(path.c_str()))
+		{
+			path = getNextAvailablePath();
+		}
+
+		return path;
+	}();
+
+	if (Profiler::get().exportChromeTrace(tracePath))
+	{
+		DebugLog("Profiler trace saved to \"" + tracePath + "\".");
+	}
+	else
+	{
+		DebugLogWarning("Failed to save profiler trace to \"" + tracePath + "\".");
+	}
+}
+
 void Game::handlePanelChanges()
 {
 	// If a sub-panel pop was requested, then pop the top of the sub-panel stack.
@@ -451,6 +498,7 @@ void Game::handleEvents(bool &running)
 		bool applicationExit = this->inputManager.applicationExit(e);
 		bool resized = this->inputManager.windowResized(e);
 		bool takeScreenshot = this->inputManager.keyPressed(e, SDLK_PRINTSCREEN);
+		bool saveTrace = this->inputManager.keyPressed(e, SDLK_F12);
 
 		if (applicationExit)
 		{
@@ -482,6 +530,12 @@ void Game::handleEvents(bool &running)
 			this->saveScreenshot(screenshot);
 		}
 
+		if (saveTrace)
+		{
+			// Only has zones if the profiler is recording (profiler level above zero).
+			this->saveProfilerTrace();
+		}
+
 		// Panel-specific events are handled by the active panel.
 		this->getActivePanel()->handleEvent(e);
 
@@ -492,6 +546,8 @@ void Game::handleEvents(bool &running)
 
 void Game::tick(double dt)
 {
+	ProfilerZone("Game::tick");
+
 	// Tick the active panel.
 	this->getActivePanel()->tick(dt);
 
@@ -501,6 +557,8 @@ void Game::tick(double dt)
 
 void Game::render()
 {
+	ProfilerZone("Game::render");
+
 	// Draw the panel's main content.
 	this->panel->render(this->renderer);
 
@@ -546,10 +604,18 @@ void Game::loop()
 
 	auto thisTime = std::chrono::high_resolution_clock::now();
 
+	Profiler &profiler = Profiler::get();
+	profiler.setThreadName("Main thread");
+
 	// Primary game loop.
 	bool running = true;
 	while (running)
 	{
+		// Only record zones while the profiler is shown so it costs nothing otherwise.
+		profiler.setEnabled(this->options.getMisc_ProfilerLevel() > Options::MIN_PROFILER_LEVEL);
+		ProfilerFrame();
+		ProfilerZone("Game::loop");
+
 		const auto lastTime = thisTime;
 		thisTime = std::chrono::high_resolution_clock::now();
 
@@ -619,6 +685,7 @@ void Game::loop()
 		// Listen for input events.
 		try
 		{
+			ProfilerZone("Game::handleEvents");
 			this->handleEvents(running);
 		}
 		catch (const std::exception &e)
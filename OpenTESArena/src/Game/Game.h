@@ -25,7 +25,7 @@
 #include "../Rendering/Renderer.h"
 
 #include "components/utilities/Allocator.h"
-#include "components/utilities/Profiler.h"
+#include "components/utilities/JobPool.h"
 
 // This class holds the current game data, manages the primary game loop, and 
 // updates the game state each frame.
@@ -64,7 +64,7 @@ private:
 	TextAssetLibrary textAssetLibrary;
 	Random random; // Convenience random for ease of use.
 	ScratchAllocator scratchAllocator;
-	Profiler profiler;
+	JobPool jobPool; // Worker threads for splitting up game tick work.
 	FPSCounter fpsCounter;
 	std::string basePath, optionsPath;
 	bool requestedSubPanelPop;
@@ -81,6 +81,10 @@ private:
 	// available index.
 	void saveScreenshot(const Surface &surface);
 
+	// Saves the profiler's recorded zones as a Chrome trace in the traces folder at the lowest
+	// available index.
+	void saveProfilerTrace();
+
 	// Handles any changes in panels after an SDL event or game tick.
 	void handlePanelChanges();
 
@@ -158,8 +162,8 @@ public:
 	// Gets the scratch buffer that is reset each frame.
 	ScratchAllocator &getScratchAllocator();
 
-	// Gets the profiler instance for measuring precise time spans.
-	Profiler &getProfiler();
+	// Gets the worker threads for game tick work that can be split up (i.e., entities by chunk).
+	JobPool &getJobPool();
 
 	// Gets the frames-per-second counter. This is updated in the game loop.
 	const FPSCounter &getFPSCounter() const;
@@ -0,0 +1,691 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <numeric>
+
+#include "HeadlessRender.h"
+#include "../Assets/MIFFile.h"
+#include "../Interface/Surface.h"
+#include "../Math/Constants.h"
+#include "../Rendering/RendererUtils.h"
+#include "../Utilities/Platform.h"
+#include "../World/DistantSky.h"
+#include "../World/LocationDefinition.h"
+#include "../World/LocationUtils.h"
+#include "../World/ProvinceDefinition.h"
+#include "../World/WeatherType.h"
+#include "../World/WorldMapDefinition.h"
+#include "../World/WorldType.h"
+
+#include "components/debug/Debug.h"
+#include "components/utilities/File.h"
+#include "components/utilities/Profiler.h"
+#include "components/utilities/String.h"
+#include "components/utilities/TextLinesFile.h"
+#include "components/vfs/manager.hpp"
+
+namespace
+{
+	const std::string HeadlessArg = "--headless";
+	const std::string ImperialMIF = "IMPERIAL.MIF";
+
+	// Fixed seed so generated level content is the same every run.
+	constexpr int RandomSeed = 12345;
+
+	// Poses in the camera path made by Session::makeTurnPath().
+	constexpr int TurnPoseCount = 9;
+
+	// Per-channel difference allowed when comparing a frame to the golden image.
+	constexpr int GoldenImageChannelTolerance = 2;
+
+	// Interior types for .MIF filename prefixes. Anything else is treated as a dungeon.
+	const std::array<std::pair<const char*, ArenaTypes::MenuType>, 11> InteriorPrefixes =
+	{
+		{
+			{ "BS", ArenaTypes::MenuType::House },
+			{ "EQUIP", ArenaTypes::MenuType::Equipment },
+			{ "MAGE", ArenaTypes::MenuType::MagesGuild },
+			{ "NOBLE", ArenaTypes::MenuType::Noble },
+			{ "PALACE", ArenaTypes::MenuType::Palace },
+			{ "TAVERN", ArenaTypes::MenuType::Tavern },
+			{ "TEMPLE", ArenaTypes::MenuType::Temple },
+			{ "TOWER", ArenaTypes::MenuType::Tower },
+			{ "TOWNPAL", ArenaTypes::MenuType::Palace },
+			{ "VILPAL", ArenaTypes::MenuType::Palace },
+			{ "WCRYPT", ArenaTypes::MenuType::Crypt }
+		}
+	};
+
+	ArenaTypes::MenuType GetInteriorTypeFromMIF(const std::string &mifName)
+	{
+		const std::string uppercaseName = String::toUppercase(mifName);
+		for (const auto &pair : InteriorPrefixes)
+		{
+			const std::string prefix(pair.first);
+			if (uppercaseName.compare(0, prefix.size(), prefix) == 0)
+			{
+				return pair.second;
+			}
+		}
+
+		return ArenaTypes::MenuType::Dungeon;
+	}
+
+	bool TryParseInt(const std::string &str, int *outValue)
+	{
+		try
+		{
+			size_t index = 0;
+			*outValue = std::stoi(str, &index);
+			return index == str.size();
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	bool TryParseDouble(const std::string &str, double *outValue)
+	{
+		try
+		{
+			size_t index = 0;
+			*outValue = std::stod(str, &index);
+			return index == str.size();
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	// Same check as the game uses for the Arena folder's executable.
+	bool TryGetIsFloppyVersion(const std::string &arenaPath, bool *outIsFloppyVersion)
+	{
+		const std::string fullArenaPath = String::addTrailingSlashIfMissing(arenaPath);
+		if (File::exists((fullArenaPath + ExeData::CD_VERSION_EXE_FILENAME).c_str()))
+		{
+			*outIsFloppyVersion = false;
+			return true;
+		}
+		else if (File::exists((fullArenaPath + ExeData::FLOPPY_VERSION_EXE_FILENAME).c_str()))
+		{
+			*outIsFloppyVersion = true;
+			return true;
+		}
+		else
+		{
+			DebugLogError("\"" + fullArenaPath + "\" does not have an Arena executable.");
+			return false;
+		}
+	}
+
+	// The premade city in the center province, used as the location for every headless level
+	// besides the dungeon so runs are repeatable.
+	const LocationDefinition *GetImperialCityLocationDefinition(const ProvinceDefinition &provinceDef)
+	{
+		for (int i = 0; i < provinceDef.getLocationCount(); i++)
+		{
+			const LocationDefinition &locationDef = provinceDef.getLocationDef(i);
+			if (locationDef.getType() == LocationDefinition::Type::City)
+			{
+				const LocationDefinition::CityDefinition &cityDef = locationDef.getCityDefinition();
+				if ((cityDef.type == LocationDefinition::CityDefinition::Type::CityState) &&
+					cityDef.premade && cityDef.palaceIsMainQuestDungeon)
+				{
+					return &locationDef;
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	const LocationDefinition *GetFirstDungeonLocationDefinition(const ProvinceDefinition &provinceDef)
+	{
+		for (int i = 0; i < provinceDef.getLocationCount(); i++)
+		{
+			const LocationDefinition &locationDef = provinceDef.getLocationDef(i);
+			if (locationDef.getType() == LocationDefinition::Type::Dungeon)
+			{
+				return &locationDef;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+const std::string HeadlessRender::CityLevelName = "CITY";
+const std::string HeadlessRender::WildernessLevelName = "WILD";
+const std::string HeadlessRender::DungeonLevelName = "DUNGEON";
+
+HeadlessRender::Pose::Pose(const Double3 &position, const Double3 &direction)
+	: position(position), direction(direction) { }
+
+HeadlessRender::Session::Session()
+	: random(RandomSeed)
+{
+	this->chunkDistance = 0;
+}
+
+bool HeadlessRender::Session::init(int width, int height)
+{
+	DebugLog("Initializing headless (Platform: " + Platform::getPlatform() + ").");
+
+	// Read options the same way the game does, but don't create a "changes" file.
+	const std::string basePath = Platform::getBasePath();
+	this->options.loadDefaults(basePath + "options/" + Options::DEFAULT_FILENAME);
+
+	const std::string changesOptionsPath = Platform::getOptionsPath() + Options::CHANGES_FILENAME;
+	if (File::exists(changesOptionsPath.c_str()))
+	{
+		this->options.loadChanges(changesOptionsPath);
+	}
+
+	this->chunkDistance = this->options.getMisc_ChunkDistance();
+
+	const bool arenaPathIsRelative = File::pathIsRelative(this->options.getMisc_ArenaPath().c_str());
+	const std::string arenaPath = (arenaPathIsRelative ? basePath : "") +
+		this->options.getMisc_ArenaPath();
+	VFS::Manager::get().initialize(std::string(arenaPath));
+
+	bool isFloppyVersion;
+	if (!TryGetIsFloppyVersion(arenaPath, &isFloppyVersion))
+	{
+		return false;
+	}
+
+	// Only the libraries needed for loading a level. There's no audio, fonts, or UI.
+	if (!this->binaryAssetLibrary.init(isFloppyVersion))
+	{
+		DebugLogError("Couldn't init binary asset library.");
+		return false;
+	}
+
+	if (!this->textAssetLibrary.init())
+	{
+		DebugLogError("Couldn't init text asset library.");
+		return false;
+	}
+
+	const ExeData &exeData = this->binaryAssetLibrary.getExeData();
+	this->charClassLibrary.init(exeData);
+	this->entityDefLibrary.init(exeData, this->textureManager);
+
+	// The 3D renderer fills the whole headless frame buffer.
+	const double resolutionScale = 1.0;
+	const bool fullGameWindow = true;
+	this->renderer.initHeadless(width, height);
+	this->renderer.initializeWorldRendering(resolutionScale, fullGameWindow,
+		this->options.getGraphics_RenderThreadsMode(),
+		this->options.getGraphics_RenderThreadsWorkStealing(),
+		this->options.getGraphics_ColumnMajorFrameBuffer(),
+		this->options.getGraphics_CheckerboardRendering(),
+		this->options.getGraphics_PipelinedRendering());
+
+	return true;
+}
+
+bool HeadlessRender::Session::loadLevel(const std::string &levelName, const Clock &clock)
+{
+	// Replace any previous level and player.
+	this->gameData = std::make_unique<GameData>(Player::makeRandom(this->charClassLibrary,
+		this->binaryAssetLibrary.getExeData(), this->random), this->binaryAssetLibrary);
+	this->gameData->getClock() = clock;
+
+	const WorldMapDefinition &worldMapDef = this->gameData->getWorldMapDefinition();
+	const ProvinceDefinition &centerProvinceDef =
+		worldMapDef.getProvinceDef(LocationUtils::CENTER_PROVINCE_ID);
+	const LocationDefinition *cityLocationDefPtr = GetImperialCityLocationDefinition(centerProvinceDef);
+	if (cityLocationDefPtr == nullptr)
+	{
+		DebugLogError("Couldn't find location for \"" + ImperialMIF + "\".");
+		return false;
+	}
+
+	const int starCount = DistantSky::getStarCountFromDensity(this->options.getMisc_StarDensity());
+	if (String::caseInsensitiveEquals(levelName, CityLevelName) ||
+		String::caseInsensitiveEquals(levelName, ImperialMIF))
+	{
+		if (!this->gameData->loadCity(*cityLocationDefPtr, centerProvinceDef, WeatherType::Clear,
+			starCount, this->entityDefLibrary, this->charClassLibrary, this->binaryAssetLibrary,
+			this->textAssetLibrary, this->random, this->textureManager, this->textureInstManager,
+			this->renderer))
+		{
+			DebugLogError("Couldn't load city \"" + cityLocationDefPtr->getName() + "\".");
+			return false;
+		}
+	}
+	else if (String::caseInsensitiveEquals(levelName, WildernessLevelName))
+	{
+		const bool ignoreGatePos = true;
+		if (!this->gameData->loadWilderness(*cityLocationDefPtr, centerProvinceDef, NewInt2(),
+			NewInt2(), ignoreGatePos, WeatherType::Clear, starCount, this->entityDefLibrary,
+			this->charClassLibrary, this->binaryAssetLibrary, this->random, this->textureManager,
+			this->textureInstManager, this->renderer))
+		{
+			DebugLogError("Couldn't load wilderness \"" + cityLocationDefPtr->getName() + "\".");
+			return false;
+		}
+	}
+	else if (String::caseInsensitiveEquals(levelName, DungeonLevelName))
+	{
+		const ProvinceDefinition &provinceDef = worldMapDef.getProvinceDef(0);
+		const LocationDefinition *dungeonLocationDefPtr = GetFirstDungeonLocationDefinition(provinceDef);
+		if (dungeonLocationDefPtr == nullptr)
+		{
+			DebugLogError("Couldn't find named dungeon in \"" + provinceDef.getName() + "\".");
+			return false;
+		}
+
+		const bool isArtifactDungeon = false;
+		if (!this->gameData->loadNamedDungeon(*dungeonLocationDefPtr, provinceDef, isArtifactDungeon,
+			ArenaTypes::MenuType::Dungeon, this->entityDefLibrary, this->charClassLibrary,
+			this->binaryAssetLibrary, this->random, this->textureManager, this->textureInstManager,
+			this->renderer))
+		{
+			DebugLogError("Couldn't load named dungeon \"" + dungeonLocationDefPtr->getName() + "\".");
+			return false;
+		}
+	}
+	else
+	{
+		MIFFile mif;
+		if (!mif.init(levelName.c_str()))
+		{
+			DebugLogError("Could not init .MIF file \"" + levelName + "\".");
+			return false;
+		}
+
+		const ArenaTypes::MenuType interiorType = GetInteriorTypeFromMIF(levelName);
+		if (!this->gameData->loadInterior(*cityLocationDefPtr, centerProvinceDef, interiorType, mif,
+			this->entityDefLibrary, this->charClassLibrary, this->binaryAssetLibrary, this->random,
+			this->textureManager, this->textureInstManager, this->renderer))
+		{
+			DebugLogError("Couldn't load interior \"" + levelName + "\".");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::vector<HeadlessRender::Pose> HeadlessRender::Session::makeTurnPath() const
+{
+	DebugAssert(this->gameData != nullptr);
+	const Player &player = this->gameData->getPlayer();
+	const Double3 &startDirection = player.getDirection();
+
+	std::vector<Pose> poses;
+	for (int i = 0; i < TurnPoseCount; i++)
+	{
+		const double angle = (2.0 * Constants::Pi) *
+			(static_cast<double>(i) / static_cast<double>(TurnPoseCount - 1));
+		const double sinAngle = std::sin(angle);
+		const double cosAngle = std::cos(angle);
+		const Double3 direction(
+			(startDirection.x * cosAngle) - (startDirection.z * sinAngle),
+			startDirection.y,
+			(startDirection.x * sinAngle) + (startDirection.z * cosAngle));
+		poses.push_back(Pose(player.getPosition(), direction.normalized()));
+	}
+
+	return poses;
+}
+
+void HeadlessRender::Session::renderFrame(const Pose &pose)
+{
+	DebugAssert(this->gameData != nullptr);
+	GameData &gameData = *this->gameData;
+	const WorldData &worldData = gameData.getActiveWorld();
+	const LevelData &level = worldData.getActiveLevel();
+	const bool isExterior = worldData.getWorldType() != WorldType::Interior;
+	const double latitude = gameData.getLocationDefinition().getLatitude();
+
+	this->renderer.renderWorld(pose.position, pose.direction, this->options.getGraphics_VerticalFOV(),
+		gameData.getAmbientPercent(), gameData.getDaytimePercent(), gameData.getChasmAnimPercent(),
+		latitude, gameData.nightLightsAreActive(), isExterior, this->options.getMisc_PlayerHasLight(),
+		this->chunkDistance, level.getCeilingHeight(), level.getOpenDoors(), level.getFadingVoxels(),
+		level.getChasmStates(), level.getVoxelGrid(), level.getEntityManager(), this->entityDefLibrary);
+}
+
+HeadlessRender::Settings::Settings()
+{
+	this->levelName = CityLevelName;
+	this->width = 640;
+	this->height = 400;
+	this->frameCount = 300;
+}
+
+bool HeadlessRender::isRequested(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i] == HeadlessArg)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool HeadlessRender::parseArgs(int argc, char *argv[], Settings *outSettings)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg(argv[i]);
+		if (arg == HeadlessArg)
+		{
+			continue;
+		}
+
+		// Every other argument has a value.
+		if ((i + 1) >= argc)
+		{
+			DebugLogError("Missing value for \"" + arg + "\".");
+			return false;
+		}
+
+		const std::string value(argv[++i]);
+		if (arg == "--level")
+		{
+			outSettings->levelName = value;
+		}
+		else if (arg == "--poses")
+		{
+			outSettings->posesPath = value;
+		}
+		else if (arg == "--frames")
+		{
+			if (!TryParseInt(value, &outSettings->frameCount) || (outSettings->frameCount <= 0))
+			{
+				DebugLogError("Invalid frame count \"" + value + "\".");
+				return false;
+			}
+		}
+		else if (arg == "--size")
+		{
+			std::array<std::string, 2> dimensions;
+			if (!String::splitExpected(value, 'x', dimensions) ||
+				!TryParseInt(dimensions[0], &outSettings->width) ||
+				!TryParseInt(dimensions[1], &outSettings->height) ||
+				(outSettings->width <= 0) || (outSettings->height <= 0))
+			{
+				DebugLogError("Invalid size \"" + value + "\" (expected WIDTHxHEIGHT).");
+				return false;
+			}
+		}
+		else if (arg == "--frames-dir")
+		{
+			outSettings->framesPath = String::addTrailingSlashIfMissing(value);
+		}
+		else if (arg == "--timings")
+		{
+			outSettings->timingsPath = value;
+		}
+		else if (arg == "--trace")
+		{
+			outSettings->tracePath = value;
+		}
+		else if (arg == "--golden")
+		{
+			outSettings->goldenPath = value;
+		}
+		else
+		{
+			DebugLogError("Unrecognized argument \"" + arg + "\".");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HeadlessRender::loadPoses(const char *filename, std::vector<Pose> *outPoses)
+{
+	TextLinesFile posesFile;
+	if (!posesFile.init(filename))
+	{
+		DebugLogError("Couldn't init poses file \"" + std::string(filename) + "\".");
+		return false;
+	}
+
+	outPoses->clear();
+	for (int i = 0; i < posesFile.getLineCount(); i++)
+	{
+		const std::string &line = posesFile.getLine(i);
+		const std::vector<std::string> tokens = String::split(
+			String::trimExtra(String::replace(line, String::TAB, String::SPACE)));
+
+		std::array<double, 6> values;
+		bool success = tokens.size() == values.size();
+		for (size_t j = 0; success && (j < values.size()); j++)
+		{
+			success = TryParseDouble(tokens[j], &values[j]);
+		}
+
+		if (!success)
+		{
+			DebugLogError("Invalid pose \"" + line + "\" in \"" + std::string(filename) + "\".");
+			return false;
+		}
+
+		const Double3 position(values[0], values[1], values[2]);
+		const Double3 direction = Double3(values[3], values[4], values[5]).normalized();
+		outPoses->push_back(Pose(position, direction));
+	}
+
+	if (outPoses->empty())
+	{
+		DebugLogError("No poses in \"" + std::string(filename) + "\".");
+		return false;
+	}
+
+	return true;
+}
+
+HeadlessRender::Pose HeadlessRender::getPathPose(const std::vector<Pose> &poses, double percent)
+{
+	DebugAssert(!poses.empty());
+
+	// Linearly interpolate between the two poses on either side of the percent.
+	const double clampedPercent = std::clamp(percent, 0.0, 1.0);
+	const double poseValue = clampedPercent * static_cast<double>(poses.size() - 1);
+	const int startIndex = std::min(static_cast<int>(poseValue), static_cast<int>(poses.size()) - 1);
+	const int endIndex = std::min(startIndex + 1, static_cast<int>(poses.size()) - 1);
+	const double posePercent = poseValue - static_cast<double>(startIndex);
+
+	const Pose &startPose = poses[startIndex];
+	const Pose &endPose = poses[endIndex];
+	return Pose(startPose.position.lerp(endPose.position, posePercent),
+		startPose.direction.lerp(endPose.direction, posePercent).normalized());
+}
+
+bool HeadlessRender::writePPM(const char *filename, const uint32_t *pixels, int width, int height)
+{
+	std::ofstream stream(filename, std::ios::binary);
+	if (!stream.is_open())
+	{
+		DebugLogError("Couldn't open \"" + std::string(filename) + "\" for writing.");
+		return false;
+	}
+
+	stream << "P6\n" << width << ' ' << height << "\n255\n";
+
+	std::vector<uint8_t> row(width * 3);
+	for (int y = 0; y < height; y++)
+	{
+		const uint32_t *srcRow = pixels + (y * width);
+		for (int x = 0; x < width; x++)
+		{
+			const uint32_t pixel = srcRow[x];
+			row[(x * 3)] = static_cast<uint8_t>(pixel >> 16);
+			row[(x * 3) + 1] = static_cast<uint8_t>(pixel >> 8);
+			row[(x * 3) + 2] = static_cast<uint8_t>(pixel);
+		}
+
+		stream.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return stream.good();
+}
+
+bool HeadlessRender::matchesGoldenImage(const char *filename, const uint32_t *pixels, int width, int height)
+{
+	const Surface golden = Surface::loadBMP(filename, Renderer::DEFAULT_PIXELFORMAT);
+	if (golden.get() == nullptr)
+	{
+		DebugLogError("Couldn't load golden image \"" + std::string(filename) + "\".");
+		return false;
+	}
+
+	if ((golden.getWidth() != width) || (golden.getHeight() != height))
+	{
+		DebugLogError("Golden image dimensions (" + std::to_string(golden.getWidth()) + "x" +
+			std::to_string(golden.getHeight()) + ") don't match frame (" + std::to_string(width) +
+			"x" + std::to_string(height) + ").");
+		return false;
+	}
+
+	const RendererUtils::GoldenImageDiff diff = RendererUtils::compareToGoldenImage(pixels,
+		static_cast<const uint32_t*>(golden.getPixels()), width * height, GoldenImageChannelTolerance);
+
+	const bool matches = diff.diffPixelCount == 0;
+	std::printf("Golden image %s: %d/%d pixels differ (max channel diff: %d).\n",
+		matches ? "matches" : "doesn't match", diff.diffPixelCount, diff.totalPixelCount,
+		diff.maxChannelDiff);
+
+	return matches;
+}
+
+int HeadlessRender::run(const Settings &settings)
+{
+	// Allocated on the heap since the libraries are large.
+	auto session = std::make_unique<Session>();
+	if (!session->init(settings.width, settings.height))
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Noon, so lighting doesn't depend on when the run happens.
+	if (!session->loadLevel(settings.levelName, Clock(12, 0, 0)))
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Camera path. Without a pose script, turn in place once from the level's start point.
+	std::vector<Pose> poses;
+	if (!settings.posesPath.empty())
+	{
+		if (!HeadlessRender::loadPoses(settings.posesPath.c_str(), &poses))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		poses = session->makeTurnPath();
+	}
+
+	if (!settings.framesPath.empty() && !Platform::directoryExists(settings.framesPath))
+	{
+		Platform::createDirectoryRecursively(settings.framesPath);
+	}
+
+	std::ofstream timingsStream;
+	if (!settings.timingsPath.empty())
+	{
+		timingsStream.open(settings.timingsPath);
+		if (!timingsStream.is_open())
+		{
+			DebugLogError("Couldn't open \"" + settings.timingsPath + "\" for writing.");
+			return EXIT_FAILURE;
+		}
+
+		timingsStream << "frame,milliseconds,visible_flats,visible_lights\n";
+	}
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(settings.frameCount);
+
+	// Only record zones for the rendered frames, not loading.
+	Profiler &profiler = Profiler::get();
+	if (!settings.tracePath.empty())
+	{
+		profiler.setThreadName("Main thread");
+		profiler.clear();
+		profiler.setEnabled(true);
+	}
+
+	for (int i = 0; i < settings.frameCount; i++)
+	{
+		ProfilerFrame();
+
+		const double pathPercent = (settings.frameCount > 1) ?
+			(static_cast<double>(i) / static_cast<double>(settings.frameCount - 1)) : 0.0;
+		session->renderFrame(HeadlessRender::getPathPose(poses, pathPercent));
+
+		const Renderer::ProfilerData &profilerData = session->renderer.getProfilerData();
+		frameTimes.push_back(profilerData.frameTime);
+
+		if (timingsStream.is_open())
+		{
+			timingsStream << i << ',' << String::fixedPrecision(profilerData.frameTime * 1000.0, 3) <<
+				',' << profilerData.visFlatCount << ',' << profilerData.visLightCount << '\n';
+		}
+
+		if (!settings.framesPath.empty())
+		{
+			// A pipelined frame is otherwise still drawing, and the buffer holds the previous pose.
+			// Written frames therefore aren't overlapped with the next one.
+			session->renderer.flushHeadlessFrame();
+
+			char frameFilename[32];
+			std::snprintf(frameFilename, sizeof(frameFilename), "frame%05d.ppm", i);
+			const std::string framePath = settings.framesPath + frameFilename;
+			const std::vector<uint32_t> &frameBuffer = session->renderer.getHeadlessFrameBuffer();
+			if (!HeadlessRender::writePPM(framePath.c_str(), frameBuffer.data(),
+				profilerData.width, profilerData.height))
+			{
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if (!settings.tracePath.empty())
+	{
+		// Render threads are parked between frames, so nothing is being recorded.
+		profiler.setEnabled(false);
+		if (!profiler.exportChromeTrace(settings.tracePath))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	const double totalTime = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+	const auto minMaxTimes = std::minmax_element(frameTimes.begin(), frameTimes.end());
+	std::printf("%s %dx%d, %d frames: avg %.3fms, min %.3fms, max %.3fms\n",
+		settings.levelName.c_str(), settings.width, settings.height, settings.frameCount,
+		(totalTime / static_cast<double>(frameTimes.size())) * 1000.0,
+		*minMaxTimes.first * 1000.0, *minMaxTimes.second * 1000.0);
+
+	if (!settings.goldenPath.empty())
+	{
+		session->renderer.flushHeadlessFrame();
+		const Renderer::ProfilerData &profilerData = session->renderer.getProfilerData();
+		const std::vector<uint32_t> &frameBuffer = session->renderer.getHeadlessFrameBuffer();
+		if (!HeadlessRender::matchesGoldenImage(settings.goldenPath.c_str(), frameBuffer.data(),
+			profilerData.width, profilerData.height))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
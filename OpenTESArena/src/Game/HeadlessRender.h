@@ -0,0 +1,115 @@
+#ifndef HEADLESS_RENDER_H
+#define HEADLESS_RENDER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+#include "GameData.h"
+#include "Options.h"
+#include "../Assets/BinaryAssetLibrary.h"
+#include "../Assets/TextAssetLibrary.h"
+#include "../Entities/CharacterClassLibrary.h"
+#include "../Entities/EntityDefinitionLibrary.h"
+#include "../Math/Random.h"
+#include "../Math/Vector3.h"
+#include "../Media/TextureInstanceManager.h"
+#include "../Media/TextureManager.h"
+#include "../Rendering/Renderer.h"
+
+// Renders the game world without a window or SDL video. A level is loaded from the game data,
+// the camera follows a script of poses, and frames are rendered into memory. Intended for
+// performance regression testing on machines without a display. With a golden image, the last
+// frame is compared against it and the exit code is nonzero if they don't match.
+//
+// Usage: TESArena --headless [--level CITY] [--poses poses.txt] [--frames 300]
+//     [--size 640x400] [--frames-dir frames/] [--timings timings.csv] [--trace trace.json]
+//     [--golden golden.bmp]
+
+namespace HeadlessRender
+{
+	// Camera placement for one point on the camera path.
+	struct Pose
+	{
+		Double3 position, direction;
+
+		Pose(const Double3 &position, const Double3 &direction);
+		Pose() = default;
+	};
+
+	// Level names besides interior .MIF filenames.
+	extern const std::string CityLevelName; // The premade city.
+	extern const std::string WildernessLevelName; // Wilderness around the premade city.
+	extern const std::string DungeonLevelName; // The first named dungeon in the first province.
+
+	// Game libraries, renderer, and game data needed for loading and rendering a level without
+	// a window. Only the parts of Game used by level loading are initialized.
+	struct Session
+	{
+		Options options;
+		BinaryAssetLibrary binaryAssetLibrary;
+		TextAssetLibrary textAssetLibrary;
+		CharacterClassLibrary charClassLibrary;
+		EntityDefinitionLibrary entityDefLibrary;
+		TextureManager textureManager;
+		TextureInstanceManager textureInstManager;
+		Random random;
+		Renderer renderer;
+		std::unique_ptr<GameData> gameData;
+		int chunkDistance;
+
+		Session();
+
+		// Reads options and game data, and initializes the 3D renderer at the given size.
+		bool init(int width, int height);
+
+		// Loads a level by name (see above), or any interior .MIF. Night lights depend on the
+		// clock when the level is loaded.
+		bool loadLevel(const std::string &levelName, const Clock &clock);
+
+		// Camera path that turns in place once from the level's starting point.
+		std::vector<Pose> makeTurnPath() const;
+
+		// Renders the active level into the renderer's headless frame buffer.
+		void renderFrame(const Pose &pose);
+	};
+
+	struct Settings
+	{
+		std::string levelName; // A level name or interior .MIF for Session::loadLevel().
+		std::string posesPath; // One "x y z dirX dirY dirZ" pose per line. Empty turns in place.
+		std::string framesPath; // Folder for .PPM frames, or empty to not save frames.
+		std::string timingsPath; // CSV of per-frame timings, or empty to not save timings.
+		std::string tracePath; // Chrome trace of profiler zones, or empty to not record zones.
+		std::string goldenPath; // .BMP the last frame must match, or empty to not compare.
+		int width, height, frameCount;
+
+		Settings();
+	};
+
+	// Returns whether the command line asks for headless rendering.
+	bool isRequested(int argc, char *argv[]);
+
+	// Reads headless settings from the command line. Returns false if an argument is invalid.
+	bool parseArgs(int argc, char *argv[], Settings *outSettings);
+
+	// Reads a camera path from a pose script. Lines starting with '#' are comments.
+	bool loadPoses(const char *filename, std::vector<Pose> *outPoses);
+
+	// Gets the camera pose at some percent [0, 1] along the camera path.
+	Pose getPathPose(const std::vector<Pose> &poses, double percent);
+
+	// Writes row-major ARGB8888 pixels to a binary .PPM file.
+	bool writePPM(const char *filename, const uint32_t *pixels, int width, int height);
+
+	// Compares row-major ARGB8888 pixels against a golden .BMP and prints the result. Returns
+	// whether they match within the channel tolerance.
+	bool matchesGoldenImage(const char *filename, const uint32_t *pixels, int width, int height);
+
+	// Loads the level and renders every frame. Returns the process exit code.
+	int run(const Settings &settings);
+}
+
+#endif
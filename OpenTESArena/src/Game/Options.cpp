@@ -27,7 +27,15 @@ namespace
 		{ "LetterboxMode", OptionType::Int },
 		{ "CursorScale", OptionType::Double },
 		{ "ModernInterface", OptionType::Bool },
-		{ "RenderThreadsMode", OptionType::Int }
+		{ "RenderThreadsMode", OptionType::Int },
+		{ "RenderThreadsWorkStealing", OptionType::Bool },
+		{ "ColumnMajorFrameBuffer", OptionType::Bool },
+		{ "CheckerboardRendering", OptionType::Bool },
+		{ "PipelinedRendering", OptionType::Bool },
+		{ "DynamicResolution", OptionType::Bool },
+		{ "DynamicResolutionMinScale", OptionType::Double },
+		{ "DynamicResolutionMaxScale", OptionType::Double },
+		{ "DynamicResolutionTargetFPS", OptionType::Int }
 	};
 
 	const std::vector<std::pair<std::string, OptionType>> AudioMappings =
@@ -475,6 +483,54 @@ void Options::checkGraphics_ResolutionScale(double value) const
 		String::fixedPrecision(Options::MAX_RESOLUTION_SCALE, 2) + ".");
 }
 
+void Options::checkGraphics_DynamicResolutionMinScale(double value) const
+{
+	DebugAssertMsg(value >= Options::MIN_RESOLUTION_SCALE,
+		"Dynamic resolution min scale cannot be less than " +
+		String::fixedPrecision(Options::MIN_RESOLUTION_SCALE, 2) + ".");
+	DebugAssertMsg(value <= Options::MAX_RESOLUTION_SCALE,
+		"Dynamic resolution min scale cannot be greater than " +
+		String::fixedPrecision(Options::MAX_RESOLUTION_SCALE, 2) + ".");
+}
+
+void Options::checkGraphics_DynamicResolutionMaxScale(double value) const
+{
+	DebugAssertMsg(value >= Options::MIN_RESOLUTION_SCALE,
+		"Dynamic resolution max scale cannot be less than " +
+		String::fixedPrecision(Options::MIN_RESOLUTION_SCALE, 2) + ".");
+	DebugAssertMsg(value <= Options::MAX_RESOLUTION_SCALE,
+		"Dynamic resolution max scale cannot be greater than " +
+		String::fixedPrecision(Options::MAX_RESOLUTION_SCALE, 2) + ".");
+}
+
+void Options::checkGraphics_DynamicResolutionTargetFPS(int value) const
+{
+	DebugAssertMsg(value >= Options::MIN_FPS, "Dynamic resolution target FPS cannot be less than " +
+		std::to_string(Options::MIN_FPS) + ".");
+}
+
+void Options::getGraphics_DynamicResolutionScaleRange(double *outMinScale, double *outMaxScale) const
+{
+	// Read without the checkers since these come straight from the options file.
+	double minScale = this->getDouble(Options::SECTION_GRAPHICS, "DynamicResolutionMinScale");
+	double maxScale = this->getDouble(Options::SECTION_GRAPHICS, "DynamicResolutionMaxScale");
+	if (maxScale < minScale)
+	{
+		DebugLogWarning("Dynamic resolution min scale " + String::fixedPrecision(minScale, 2) +
+			" is greater than max scale " + String::fixedPrecision(maxScale, 2) + ", swapping.");
+		std::swap(minScale, maxScale);
+	}
+
+	*outMinScale = std::clamp(minScale, Options::MIN_RESOLUTION_SCALE, Options::MAX_RESOLUTION_SCALE);
+	*outMaxScale = std::clamp(maxScale, Options::MIN_RESOLUTION_SCALE, Options::MAX_RESOLUTION_SCALE);
+}
+
+int Options::getGraphics_DynamicResolutionTargetFPSClamped() const
+{
+	const int targetFps = this->getInt(Options::SECTION_GRAPHICS, "DynamicResolutionTargetFPS");
+	return std::max(targetFps, Options::MIN_FPS);
+}
+
 void Options::checkGraphics_VerticalFOV(double value) const
 {
 	DebugAssertMsg(value >= Options::MIN_VERTICAL_FOV, "Vertical FOV cannot be less than " +
@@ -147,6 +147,14 @@ void set##section##_##name(const std::string &value) \
 	OPTION_DOUBLE(Graphics, CursorScale)
 	OPTION_BOOL(Graphics, ModernInterface)
 	OPTION_INT(Graphics, RenderThreadsMode)
+	OPTION_BOOL(Graphics, RenderThreadsWorkStealing)
+	OPTION_BOOL(Graphics, ColumnMajorFrameBuffer)
+	OPTION_BOOL(Graphics, CheckerboardRendering)
+	OPTION_BOOL(Graphics, PipelinedRendering)
+	OPTION_BOOL(Graphics, DynamicResolution)
+	OPTION_DOUBLE(Graphics, DynamicResolutionMinScale)
+	OPTION_DOUBLE(Graphics, DynamicResolutionMaxScale)
+	OPTION_INT(Graphics, DynamicResolutionTargetFPS)
 
 	OPTION_DOUBLE(Audio, MusicVolume)
 	OPTION_DOUBLE(Audio, SoundVolume)
@@ -171,6 +179,13 @@ void set##section##_##name(const std::string &value) \
 	OPTION_INT(Misc, StarDensity)
 	OPTION_BOOL(Misc, PlayerHasLight)
 
+	// Gets the dynamic resolution scale bounds from the user-editable min/max scale options,
+	// clamped to the allowed resolution scales and swapped if they are out of order.
+	void getGraphics_DynamicResolutionScaleRange(double *outMinScale, double *outMaxScale) const;
+
+	// Gets the dynamic resolution target FPS, raised to the minimum allowed FPS if needed.
+	int getGraphics_DynamicResolutionTargetFPSClamped() const;
+
 	// Reads all the key-values pairs from the given absolute path into the default members.
 	void loadDefaults(const std::string &filename);
 
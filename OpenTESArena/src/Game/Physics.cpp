@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <type_traits>
 
 #include "Physics.h"
 #include "../Assets/MIFFile.h"
@@ -16,12 +18,14 @@
 #include "../World/VoxelGrid.h"
 
 #include "components/debug/Debug.h"
+#include "components/utilities/JobPool.h"
 
 // @todo: allow hits on the insides of voxels until the renderer uses back-face culling (if ever).
 
 namespace Physics
 {
-	using VoxelEntityMap = std::unordered_map<Int3, std::vector<EntityManager::EntityVisibilityData>>;
+	// Whether ray casts find entities through the entity manager's voxel index.
+	bool EntityVoxelIndexEnabled = true;
 
 	// Converts the normal to the associated voxel facing on success. Not all conversions
 	// exist, for example, diagonals have normals but do not have a voxel facing.
@@ -64,119 +68,156 @@ namespace Physics
 		return success;
 	}
 
-	// Builds a set of voxels that are at least partially touched by entities. Ignores entities
-	// behind the camera.
-	Physics::VoxelEntityMap makeVoxelEntityMap(const Double3 &cameraPosition,
-		const Double3 &cameraDirection, int chunkDistance, double ceilingHeight,
-		const VoxelGrid &voxelGrid, const EntityManager &entityManager,
-		const EntityDefinitionLibrary &entityDefLibrary)
+	// Entity look-ups for one ray. Entities are found through the entity manager's voxel index
+	// as the ray reaches each voxel instead of gathering every nearby entity up front, and an
+	// entity's visibility data is only calculated the first time the ray gets near it. Without
+	// the voxel index, every nearby entity is mapped to its voxels before the ray is cast.
+	struct EntityRayQuery
 	{
-		const NewDouble2 cameraPosXZ(cameraPosition.x, cameraPosition.z);
-		const NewDouble2 cameraDirXZ(cameraDirection.x, cameraDirection.z);
-
-		const NewInt2 cameraVoxelXZ(
-			static_cast<SNInt>(std::floor(cameraPosXZ.x)),
-			static_cast<WEInt>(std::floor(cameraPosXZ.y)));
-		const ChunkInt2 cameraChunk = VoxelUtils::newVoxelToChunk(cameraVoxelXZ);
+		struct Entry
+		{
+			EntityManager::EntityVisibilityData visData;
+			Int3 minVoxel, maxVoxel; // Voxels at least partially touched by the entity.
+			bool valid; // False if the entity is behind the camera or too far away.
+		};
 
+		NewDouble2 cameraPosXZ, cameraDirXZ;
 		ChunkInt2 minChunk, maxChunk;
-		ChunkUtils::getSurroundingChunks(cameraChunk, chunkDistance, &minChunk, &maxChunk);
+		double ceilingHeight;
+		int voxelReach; // Voxel columns to look around for entities wide enough to reach in.
+		bool enabled;
+		bool useVoxelIndex;
+		std::unordered_map<EntityID, Entry> entries;
+		std::vector<const Entity*> entityBuffer;
+		std::unordered_map<Int3, std::vector<const Entity*>> voxelEntities; // Without the voxel index.
+
+		EntityRayQuery()
+		{
+			this->ceilingHeight = 0.0;
+			this->voxelReach = 0;
+			this->enabled = false;
+			this->useVoxelIndex = true;
+		}
 
-		// Gather up entities in nearby chunks.
-		const int totalNearbyEntities = [&entityManager, &minChunk, &maxChunk]()
+		// Starts a new ray. The voxel reach doesn't depend on the ray, so it can be shared by
+		// all rays in a batch. Cached entities are cleared since their visibility data depends
+		// on where the ray starts.
+		void init(const Double3 &cameraPosition, const Double3 &cameraDirection, int chunkDistance,
+			double ceilingHeight, int voxelReach)
 		{
-			int count = 0;
-			for (WEInt z = minChunk.y; z <= maxChunk.y; z++)
-			{
-				for (SNInt x = minChunk.x; x <= maxChunk.x; x++)
-				{
-					count += entityManager.getTotalCountInChunk(ChunkInt2(x, z));
-				}
-			}
+			this->cameraPosXZ = NewDouble2(cameraPosition.x, cameraPosition.z);
+			this->cameraDirXZ = NewDouble2(cameraDirection.x, cameraDirection.z);
+
+			const NewInt2 cameraVoxelXZ(
+				static_cast<SNInt>(std::floor(this->cameraPosXZ.x)),
+				static_cast<WEInt>(std::floor(this->cameraPosXZ.y)));
+			const ChunkInt2 cameraChunk = VoxelUtils::newVoxelToChunk(cameraVoxelXZ);
+			ChunkUtils::getSurroundingChunks(cameraChunk, chunkDistance, &this->minChunk, &this->maxChunk);
+
+			this->ceilingHeight = ceilingHeight;
+			this->voxelReach = voxelReach;
+			this->enabled = true;
+			this->useVoxelIndex = Physics::EntityVoxelIndexEnabled;
+			this->entries.clear();
+			this->voxelEntities.clear();
+		}
+	};
 
-			return count;
-		}();
+	// Gets the ray query's entry for an entity, calculating its visibility data and the voxels it
+	// touches if the ray hasn't seen it yet.
+	const EntityRayQuery::Entry &getEntityRayQueryEntry(const Entity &entity, EntityRayQuery &query,
+		const VoxelGrid &voxelGrid, const EntityManager &entityManager,
+		const EntityDefinitionLibrary &entityDefLibrary)
+	{
+		auto iter = query.entries.find(entity.getID());
+		if (iter != query.entries.end())
+		{
+			return iter->second;
+		}
 
-		std::vector<const Entity*> entities(totalNearbyEntities, nullptr);
-		int entityInsertIndex = 0;
-		auto addEntitiesFromChunk = [&entityManager, &entities, &entityInsertIndex](SNInt chunkX, WEInt chunkZ)
+		EntityRayQuery::Entry entry;
+		entry.valid = false;
+
+		// Skip any entities that are behind the camera or outside the nearby chunks.
+		const NewDouble2 &entityPos = entity.getPosition();
+		const NewDouble2 entityPosEyeDiff = entityPos - query.cameraPosXZ;
+		const NewInt2 entityVoxelXZ(
+			static_cast<SNInt>(std::floor(entityPos.x)),
+			static_cast<WEInt>(std::floor(entityPos.y)));
+		const ChunkInt2 entityChunk = VoxelUtils::newVoxelToChunk(entityVoxelXZ);
+		const bool isInNearbyChunk = (entityChunk.x >= query.minChunk.x) &&
+			(entityChunk.x <= query.maxChunk.x) && (entityChunk.y >= query.minChunk.y) &&
+			(entityChunk.y <= query.maxChunk.y);
+
+		if ((query.cameraDirXZ.dot(entityPosEyeDiff) >= 0.0) && isInNearbyChunk)
 		{
-			const Entity **entitiesPtr = entities.data() + entityInsertIndex;
-			const int size = static_cast<int>(entities.size()) - entityInsertIndex;
-			const int writtenCount = entityManager.getTotalEntitiesInChunk(
-				ChunkInt2(chunkX, chunkZ), entitiesPtr, size);
-			DebugAssert(writtenCount <= size);
-			entityInsertIndex += writtenCount;
-		};
+			entityManager.getEntityVisibilityData(entity, query.cameraPosXZ, query.ceilingHeight,
+				voxelGrid, entityDefLibrary, entry.visData);
+
+			// Use a bounding box to determine which voxels the entity could be in.
+			Double3 minPoint, maxPoint;
+			entityManager.getEntityBoundingBox(entity, entry.visData, entityDefLibrary, &minPoint, &maxPoint);
+
+			entry.minVoxel = Int3(
+				static_cast<SNInt>(std::floor(minPoint.x)),
+				static_cast<int>(std::floor(minPoint.y / query.ceilingHeight)),
+				static_cast<WEInt>(std::floor(minPoint.z)));
+			entry.maxVoxel = Int3(
+				static_cast<SNInt>(std::floor(maxPoint.x)),
+				static_cast<int>(std::floor(maxPoint.y / query.ceilingHeight)),
+				static_cast<WEInt>(std::floor(maxPoint.z)));
+			entry.valid = true;
+		}
+
+		iter = query.entries.emplace(entity.getID(), entry).first;
+		return iter->second;
+	}
 
-		for (WEInt z = minChunk.y; z <= maxChunk.y; z++)
+	// Maps every entity in the ray query's nearby chunks to the voxels it touches, for ray casts
+	// that don't use the entity manager's voxel index.
+	void gatherEntityRayQueryEntities(EntityRayQuery &query, const VoxelGrid &voxelGrid,
+		const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary)
+	{
+		std::vector<const Entity*> &entityBuffer = query.entityBuffer;
+		entityBuffer.clear();
+		for (WEInt z = query.minChunk.y; z <= query.maxChunk.y; z++)
 		{
-			for (SNInt x = minChunk.x; x <= maxChunk.x; x++)
+			for (SNInt x = query.minChunk.x; x <= query.maxChunk.x; x++)
 			{
-				addEntitiesFromChunk(x, z);
+				const ChunkInt2 chunk(x, z);
+				const int startIndex = static_cast<int>(entityBuffer.size());
+				entityBuffer.resize(startIndex + entityManager.getTotalCountInChunk(chunk));
+				const int writtenCount = entityManager.getTotalEntitiesInChunk(chunk,
+					entityBuffer.data() + startIndex, static_cast<int>(entityBuffer.size()) - startIndex);
+				entityBuffer.resize(startIndex + writtenCount);
 			}
 		}
 
-		// Build mappings of voxels to entities.
-		VoxelEntityMap voxelEntityMap;
-		for (const Entity *entityPtr : entities)
+		for (const Entity *entityPtr : entityBuffer)
 		{
 			if (entityPtr == nullptr)
 			{
 				continue;
 			}
 
-			const Entity &entity = *entityPtr;
-
-			// Skip any entities that are behind the camera.
-			NewDouble2 entityPosEyeDiff = entity.getPosition() - cameraPosXZ;
-			if (cameraDirXZ.dot(entityPosEyeDiff) < 0.0)
+			const EntityRayQuery::Entry &entry = Physics::getEntityRayQueryEntry(*entityPtr, query,
+				voxelGrid, entityManager, entityDefLibrary);
+			if (!entry.valid)
 			{
 				continue;
 			}
 
-			EntityManager::EntityVisibilityData visData;
-			entityManager.getEntityVisibilityData(entity, cameraPosXZ, ceilingHeight, voxelGrid,
-				entityDefLibrary, visData);
-
-			// Use a bounding box to determine which voxels the entity could be in.
-			Double3 minPoint, maxPoint;
-			entityManager.getEntityBoundingBox(entity, visData, entityDefLibrary, &minPoint, &maxPoint);
-
-			// Only iterate over voxels the entity could be in (at least partially).
-			// This loop should always hit at least 1 voxel.
-			const SNInt startX = static_cast<SNInt>(std::floor(minPoint.x));
-			const SNInt endX = static_cast<SNInt>(std::floor(maxPoint.x));
-			const int startY = static_cast<int>(std::floor(minPoint.y / ceilingHeight));
-			const int endY = static_cast<int>(std::floor(maxPoint.y / ceilingHeight));
-			const WEInt startZ = static_cast<WEInt>(std::floor(minPoint.z));
-			const WEInt endZ = static_cast<WEInt>(std::floor(maxPoint.z));
-
-			for (WEInt z = startZ; z <= endZ; z++)
+			for (WEInt z = entry.minVoxel.z; z <= entry.maxVoxel.z; z++)
 			{
-				for (int y = startY; y <= endY; y++)
+				for (int y = entry.minVoxel.y; y <= entry.maxVoxel.y; y++)
 				{
-					for (SNInt x = startX; x <= endX; x++)
+					for (SNInt x = entry.minVoxel.x; x <= entry.maxVoxel.x; x++)
 					{
-						const Int3 voxel(x, y, z);
-
-						// Add the entity to the list. Create a new voxel->entity list mapping if
-						// there isn't one for this voxel.
-						auto iter = voxelEntityMap.find(voxel);
-						if (iter == voxelEntityMap.end())
-						{
-							iter = voxelEntityMap.insert(std::make_pair(
-								voxel, std::vector<EntityManager::EntityVisibilityData>())).first;
-						}
-
-						auto &entityDataList = iter->second;
-						entityDataList.push_back(visData);
+						query.voxelEntities[Int3(x, y, z)].push_back(entityPtr);
 					}
 				}
 			}
 		}
-
-		return voxelEntityMap;
 	}
 
 	// Checks an initial voxel for ray hits and writes them into the output parameter.
@@ -914,38 +955,92 @@ namespace Physics
 	// Helper function for testing which entities in a voxel are intersected by a ray.
 	bool testEntitiesInVoxel(const Double3 &rayStart, const Double3 &rayDirection,
 		const Double3 &flatForward, const Double3 &flatRight, const Double3 &flatUp,
-		const Int3 &voxel, const VoxelEntityMap &voxelEntityMap, bool pixelPerfect,
-		const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary,
-		const Renderer &renderer, Physics::Hit &hit)
+		const Int3 &voxel, EntityRayQuery &entityQuery, bool pixelPerfect,
+		const VoxelGrid &voxelGrid, const EntityManager &entityManager,
+		const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer, Physics::Hit &hit)
 	{
+		if (!entityQuery.enabled)
+		{
+			return false;
+		}
+
 		// Use a separate hit variable so we can determine whether an entity was closer.
 		Physics::Hit entityHit;
 		entityHit.setT(Hit::MAX_T);
 
-		const auto iter = voxelEntityMap.find(voxel);
-		if (iter != voxelEntityMap.end())
+		auto testEntity = [&rayStart, &rayDirection, &flatForward, &flatRight, &flatUp, pixelPerfect,
+			&entityManager, &entityDefLibrary, &renderer, &entityHit](const Entity &entity,
+			const EntityRayQuery::Entry &entry)
 		{
-			// Iterate over all the entities that cross this voxel and ray test them.
-			const auto &entityVisDataList = iter->second;
-			for (const auto &visData : entityVisDataList)
-			{
-				const Entity &entity = *visData.entity;
-				const EntityDefinition &entityDef = entityManager.getEntityDef(
-					entity.getDefinitionID(), entityDefLibrary);
-				const EntityAnimationDefinition::Keyframe &animKeyframe =
-					entityManager.getEntityAnimKeyframe(entity, visData, entityDefLibrary);
+			const EntityManager::EntityVisibilityData &visData = entry.visData;
+			const EntityAnimationDefinition::Keyframe &animKeyframe =
+				entityManager.getEntityAnimKeyframe(entity, visData, entityDefLibrary);
 
-				const double flatWidth = animKeyframe.getWidth();
-				const double flatHeight = animKeyframe.getHeight();
+			const double flatWidth = animKeyframe.getWidth();
+			const double flatHeight = animKeyframe.getHeight();
 
-				Double3 hitPoint;
-				if (renderer.getEntityRayIntersection(visData, flatForward, flatRight, flatUp,
-					flatWidth, flatHeight, rayStart, rayDirection, pixelPerfect, &hitPoint))
+			Double3 hitPoint;
+			if (renderer.getEntityRayIntersection(visData, flatForward, flatRight, flatUp,
+				flatWidth, flatHeight, rayStart, rayDirection, pixelPerfect, &hitPoint))
+			{
+				const double distance = (hitPoint - rayStart).length();
+				if (distance < entityHit.getT())
+				{
+					entityHit.initEntity(distance, hitPoint, entity.getID(), entity.getEntityType());
+				}
+			}
+		};
+
+		if (!entityQuery.useVoxelIndex)
+		{
+			// Every entity touching this voxel was already gathered.
+			const auto iter = entityQuery.voxelEntities.find(voxel);
+			if (iter != entityQuery.voxelEntities.end())
+			{
+				for (const Entity *entityPtr : iter->second)
+				{
+					testEntity(*entityPtr, entityQuery.entries.at(entityPtr->getID()));
+				}
+			}
+		}
+		else
+		{
+			// Entities are indexed by the voxel column of their position, so check the columns
+			// around this voxel that a wide entity could reach in from.
+			const int reach = entityQuery.voxelReach;
+			for (WEInt z = voxel.z - reach; z <= voxel.z + reach; z++)
+			{
+				for (SNInt x = voxel.x - reach; x <= voxel.x + reach; x++)
 				{
-					const double distance = (hitPoint - rayStart).length();
-					if (distance < entityHit.getT())
+					const NewInt2 voxelXZ(x, z);
+					const int entityCount = entityManager.getCountInVoxel(voxelXZ);
+					if (entityCount == 0)
 					{
-						entityHit.initEntity(distance, hitPoint, entity.getID(), entity.getEntityType());
+						continue;
+					}
+
+					std::vector<const Entity*> &entityBuffer = entityQuery.entityBuffer;
+					entityBuffer.resize(entityCount);
+					const int writtenCount = entityManager.getEntitiesInVoxel(voxelXZ,
+						entityBuffer.data(), static_cast<int>(entityBuffer.size()));
+					DebugAssert(writtenCount == entityCount);
+
+					// Ray test the entities that cross this voxel.
+					for (const Entity *entityPtr : entityBuffer)
+					{
+						const Entity &entity = *entityPtr;
+						const EntityRayQuery::Entry &entry = Physics::getEntityRayQueryEntry(entity,
+							entityQuery, voxelGrid, entityManager, entityDefLibrary);
+
+						const bool touchesVoxel = entry.valid &&
+							(voxel.x >= entry.minVoxel.x) && (voxel.x <= entry.maxVoxel.x) &&
+							(voxel.y >= entry.minVoxel.y) && (voxel.y <= entry.maxVoxel.y) &&
+							(voxel.z >= entry.minVoxel.z) && (voxel.z <= entry.maxVoxel.z);
+
+						if (touchesVoxel)
+						{
+							testEntity(entity, entry);
+						}
 					}
 				}
 			}
@@ -969,7 +1064,7 @@ namespace Physics
 	void rayCastInternal(const Double3 &rayStart, const Double3 &rayDirection,
 		const Double3 &cameraForward, double ceilingHeight,
 		const LevelData::ChasmStates &chasmStates, const VoxelGrid &voxelGrid,
-		const VoxelEntityMap &voxelEntityMap, bool pixelPerfect, const EntityManager &entityManager,
+		EntityRayQuery &entityQuery, bool pixelPerfect, const EntityManager &entityManager,
 		const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer, Physics::Hit &hit)
 	{
 		// Each flat shares the same axes. The forward direction always faces opposite to 
@@ -1083,7 +1178,7 @@ namespace Physics
 			bool success = Physics::testInitialVoxelRay(rayStart, rayDirection, rayStartVoxel,
 				facing, initialFarPoint, ceilingHeight, chasmStates, voxelGrid, hit);
 			success |= Physics::testEntitiesInVoxel(rayStart, rayDirection, flatForward, flatRight,
-				flatUp, rayStartVoxel, voxelEntityMap, pixelPerfect, entityManager,
+				flatUp, rayStartVoxel, entityQuery, pixelPerfect, voxelGrid, entityManager,
 				entityDefLibrary, renderer, hit);
 
 			if (success)
@@ -1167,8 +1262,8 @@ namespace Physics
 			bool success = Physics::testVoxelRay(rayStart, rayDirection, savedVoxel, savedFacing,
 				nearPoint, farPoint, axisLen.y, chasmStates, voxelGrid, hit);
 			success |= Physics::testEntitiesInVoxel(rayStart, rayDirection, flatForward, flatRight,
-				flatUp, savedVoxel, voxelEntityMap, pixelPerfect, entityManager, entityDefLibrary,
-				renderer, hit);
+				flatUp, savedVoxel, entityQuery, pixelPerfect, voxelGrid, entityManager,
+				entityDefLibrary, renderer, hit);
 
 			if (success)
 			{
@@ -1177,6 +1272,105 @@ namespace Physics
 			}
 		}
 	}
+
+	// Direction sign bits of a ray, for picking the ray cast loop specialized for them.
+	constexpr int OCTANT_COUNT = 8;
+
+	int getRayOctant(const Double3 &rayDirection)
+	{
+		return ((rayDirection.x >= 0.0) ? 1 : 0) | ((rayDirection.y >= 0.0) ? 2 : 0) |
+			((rayDirection.z >= 0.0) ? 4 : 0);
+	}
+
+	// Rays per job in a batch. Small enough to spread a few hundred rays over several workers.
+	constexpr int RAY_BATCH_JOB_SIZE = 32;
+
+	// Casts rays that all have the same direction signs, writing each ray's hit at its own index.
+	template <bool NonNegativeDirX, bool NonNegativeDirY, bool NonNegativeDirZ>
+	void rayCastGroup(const Physics::Ray *rays, const int *rayIndices, int rayCount, int chunkDistance,
+		double ceilingHeight, const LevelData::ChasmStates &chasmStates, const Double3 &cameraForward,
+		bool pixelPerfect, bool includeEntities, int entityVoxelReach, const EntityManager &entityManager,
+		const VoxelGrid &voxelGrid, const EntityDefinitionLibrary &entityDefLibrary,
+		const Renderer &renderer, EntityRayQuery &entityQuery, Physics::Hit *outHits)
+	{
+		for (int i = 0; i < rayCount; i++)
+		{
+			const int rayIndex = rayIndices[i];
+			const Physics::Ray &ray = rays[rayIndex];
+			Physics::Hit &hit = outHits[rayIndex];
+
+			// Set the hit distance to max. This will ensure that if we don't hit a voxel but do hit
+			// an entity, the distance can still be used.
+			hit.setT(Hit::MAX_T);
+
+			if (includeEntities)
+			{
+				entityQuery.init(ray.start, ray.direction, chunkDistance, ceilingHeight, entityVoxelReach);
+				if (!entityQuery.useVoxelIndex)
+				{
+					Physics::gatherEntityRayQueryEntities(entityQuery, voxelGrid, entityManager,
+						entityDefLibrary);
+				}
+			}
+			else
+			{
+				entityQuery.enabled = false;
+			}
+
+			Physics::rayCastInternal<NonNegativeDirX, NonNegativeDirY, NonNegativeDirZ>(ray.start,
+				ray.direction, cameraForward, ceilingHeight, chasmStates, voxelGrid, entityQuery,
+				pixelPerfect, entityManager, entityDefLibrary, renderer, hit);
+		}
+	}
+
+	// Picks the ray cast loop for an octant once per group of rays, for better code generation
+	// than branching on direction signs inside the loop.
+	void rayCastGroup(int octant, const Physics::Ray *rays, const int *rayIndices, int rayCount,
+		int chunkDistance, double ceilingHeight, const LevelData::ChasmStates &chasmStates,
+		const Double3 &cameraForward, bool pixelPerfect, bool includeEntities, int entityVoxelReach,
+		const EntityManager &entityManager, const VoxelGrid &voxelGrid,
+		const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer,
+		EntityRayQuery &entityQuery, Physics::Hit *outHits)
+	{
+		auto castGroup = [&](auto nonNegativeDirX, auto nonNegativeDirY, auto nonNegativeDirZ)
+		{
+			Physics::rayCastGroup<decltype(nonNegativeDirX)::value, decltype(nonNegativeDirY)::value,
+				decltype(nonNegativeDirZ)::value>(rays, rayIndices, rayCount, chunkDistance, ceilingHeight,
+				chasmStates, cameraForward, pixelPerfect, includeEntities, entityVoxelReach, entityManager,
+				voxelGrid, entityDefLibrary, renderer, entityQuery, outHits);
+		};
+
+		switch (octant)
+		{
+		case 0:
+			castGroup(std::false_type(), std::false_type(), std::false_type());
+			break;
+		case 1:
+			castGroup(std::true_type(), std::false_type(), std::false_type());
+			break;
+		case 2:
+			castGroup(std::false_type(), std::true_type(), std::false_type());
+			break;
+		case 3:
+			castGroup(std::true_type(), std::true_type(), std::false_type());
+			break;
+		case 4:
+			castGroup(std::false_type(), std::false_type(), std::true_type());
+			break;
+		case 5:
+			castGroup(std::true_type(), std::false_type(), std::true_type());
+			break;
+		case 6:
+			castGroup(std::false_type(), std::true_type(), std::true_type());
+			break;
+		case 7:
+			castGroup(std::true_type(), std::true_type(), std::true_type());
+			break;
+		default:
+			DebugNotImplementedMsg(std::to_string(octant));
+			break;
+		}
+	}
 }
 
 const double Physics::Hit::MAX_T = std::numeric_limits<double>::infinity();
@@ -1246,109 +1440,141 @@ void Physics::Hit::setT(double t)
 	this->t = t;
 }
 
+void Physics::Ray::init(const Double3 &start, const Double3 &direction)
+{
+	this->start = start;
+	this->direction = direction;
+}
+
+void Physics::setEntityVoxelIndexEnabled(bool enabled)
+{
+	Physics::EntityVoxelIndexEnabled = enabled;
+}
+
 bool Physics::rayCast(const Double3 &rayStart, const Double3 &rayDirection, int chunkDistance,
 	double ceilingHeight, const LevelData::ChasmStates &chasmStates,
 	const Double3 &cameraForward, bool pixelPerfect, bool includeEntities,
 	const EntityManager &entityManager, const VoxelGrid &voxelGrid,
 	const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer, Physics::Hit &hit)
 {
-	// Set the hit distance to max. This will ensure that if we don't hit a voxel but do hit an
-	// entity, the distance can still be used.
-	hit.setT(Hit::MAX_T);
+	Ray ray;
+	ray.init(rayStart, rayDirection);
+
+	const int rayIndex = 0;
+	const int entityVoxelReach = includeEntities ?
+		entityManager.getMaxEntityVoxelReach(entityDefLibrary) : 0;
+
+	EntityRayQuery entityQuery;
+	Physics::rayCastGroup(Physics::getRayOctant(rayDirection), &ray, &rayIndex, 1, chunkDistance,
+		ceilingHeight, chasmStates, cameraForward, pixelPerfect, includeEntities, entityVoxelReach,
+		entityManager, voxelGrid, entityDefLibrary, renderer, entityQuery, &hit);
+
+	// Return whether the ray hit something.
+	return hit.getT() < Hit::MAX_T;
+}
+
+bool Physics::rayCast(const Double3 &rayStart, const Double3 &rayDirection, int chunkDistance,
+	const LevelData::ChasmStates &chasmStates, const Double3 &cameraForward,
+	bool pixelPerfect, bool includeEntities, const EntityManager &entityManager,
+	const VoxelGrid &voxelGrid, const EntityDefinitionLibrary &entityDefLibrary,
+	const Renderer &renderer, Physics::Hit &hit)
+{
+	constexpr double ceilingHeight = 1.0;
+	return Physics::rayCast(rayStart, rayDirection, chunkDistance, ceilingHeight, chasmStates,
+		cameraForward, pixelPerfect, includeEntities, entityManager, voxelGrid, entityDefLibrary,
+		renderer, hit);
+}
 
-	VoxelEntityMap voxelEntityMap;
-	if (includeEntities)
+int Physics::rayCastBatch(const BufferView<const Ray> &rays, int chunkDistance, double ceilingHeight,
+	const LevelData::ChasmStates &chasmStates, const Double3 &cameraForward, bool pixelPerfect,
+	bool includeEntities, const EntityManager &entityManager, const VoxelGrid &voxelGrid,
+	const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer, JobPool *jobPool,
+	BufferView<Hit> &outHits)
+{
+	DebugAssert(outHits.getCount() == rays.getCount());
+	const int rayCount = rays.getCount();
+	if (rayCount == 0)
 	{
-		voxelEntityMap = Physics::makeVoxelEntityMap(rayStart, rayDirection, chunkDistance,
-			ceilingHeight, voxelGrid, entityManager, entityDefLibrary);
+		return 0;
 	}
 
-	// Ray cast through the voxel grid, populating the output hit data. Use the ray direction
-	// booleans for better code generation (at the expense of having a pile of if/else branches
-	// here).
-	const bool nonNegativeDirX = rayDirection.x >= 0.0;
-	const bool nonNegativeDirY = rayDirection.y >= 0.0;
-	const bool nonNegativeDirZ = rayDirection.z >= 0.0;
+	// Sort ray indices by octant so each group runs the same ray cast loop.
+	std::array<int, OCTANT_COUNT + 1> octantOffsets;
+	octantOffsets.fill(0);
+	for (int i = 0; i < rayCount; i++)
+	{
+		const int octant = Physics::getRayOctant(rays.get(i).direction);
+		octantOffsets[octant + 1]++;
+	}
 
-	if (nonNegativeDirX)
+	for (int i = 0; i < OCTANT_COUNT; i++)
 	{
-		if (nonNegativeDirY)
-		{
-			if (nonNegativeDirZ)
-			{
-				Physics::rayCastInternal<true, true, true>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
-			else
-			{
-				Physics::rayCastInternal<true, true, false>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
-		}
-		else
-		{
-			if (nonNegativeDirZ)
-			{
-				Physics::rayCastInternal<true, false, true>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
-			else
-			{
-				Physics::rayCastInternal<true, false, false>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
-		}
+		octantOffsets[i + 1] += octantOffsets[i];
 	}
-	else
+
+	std::vector<int> rayIndices(rayCount);
+	std::array<int, OCTANT_COUNT> octantWriteIndices;
+	std::copy(octantOffsets.begin(), octantOffsets.begin() + OCTANT_COUNT, octantWriteIndices.begin());
+	for (int i = 0; i < rayCount; i++)
 	{
-		if (nonNegativeDirY)
+		const int octant = Physics::getRayOctant(rays.get(i).direction);
+		rayIndices[octantWriteIndices[octant]] = i;
+		octantWriteIndices[octant]++;
+	}
+
+	// Shared by every ray.
+	const int entityVoxelReach = includeEntities ?
+		entityManager.getMaxEntityVoxelReach(entityDefLibrary) : 0;
+
+	auto castRayRange = [&rays, &rayIndices, &outHits, chunkDistance, ceilingHeight, &chasmStates,
+		&cameraForward, pixelPerfect, includeEntities, entityVoxelReach, &entityManager, &voxelGrid,
+		&entityDefLibrary, &renderer](int octant, int startIndex, int count)
+	{
+		EntityRayQuery entityQuery;
+		Physics::rayCastGroup(octant, rays.get(), rayIndices.data() + startIndex, count,
+			chunkDistance, ceilingHeight, chasmStates, cameraForward, pixelPerfect, includeEntities,
+			entityVoxelReach, entityManager, voxelGrid, entityDefLibrary, renderer, entityQuery,
+			outHits.get());
+	};
+
+	// Each job casts a slice of one octant group's rays. Every ray writes its own hit, so jobs
+	// don't share any output.
+	const bool useJobs = (jobPool != nullptr) && (jobPool->getThreadCount() > 0);
+	JobPool::Batch jobBatch; // The pool might have other users' jobs queued.
+	for (int octant = 0; octant < OCTANT_COUNT; octant++)
+	{
+		const int octantStart = octantOffsets[octant];
+		const int octantEnd = octantOffsets[octant + 1];
+		for (int i = octantStart; i < octantEnd; i += RAY_BATCH_JOB_SIZE)
 		{
-			if (nonNegativeDirZ)
+			const int count = std::min(RAY_BATCH_JOB_SIZE, octantEnd - i);
+			if (useJobs)
 			{
-				Physics::rayCastInternal<false, true, true>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
+				jobPool->submit([&castRayRange, octant, i, count]()
+				{
+					castRayRange(octant, i, count);
+				}, jobBatch);
 			}
 			else
 			{
-				Physics::rayCastInternal<false, true, false>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
+				castRayRange(octant, i, count);
 			}
 		}
-		else
+	}
+
+	if (useJobs)
+	{
+		jobPool->wait(jobBatch);
+	}
+
+	int hitCount = 0;
+	for (int i = 0; i < rayCount; i++)
+	{
+		if (outHits.get(i).getT() < Hit::MAX_T)
 		{
-			if (nonNegativeDirZ)
-			{
-				Physics::rayCastInternal<false, false, true>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
-			else
-			{
-				Physics::rayCastInternal<false, false, false>(rayStart, rayDirection, cameraForward,
-					ceilingHeight, chasmStates, voxelGrid, voxelEntityMap, pixelPerfect, entityManager,
-					entityDefLibrary, renderer, hit);
-			}
+			hitCount++;
 		}
 	}
 
-	// Return whether the ray hit something.
-	return hit.getT() < Hit::MAX_T;
-}
-
-bool Physics::rayCast(const Double3 &rayStart, const Double3 &rayDirection, int chunkDistance,
-	const LevelData::ChasmStates &chasmStates, const Double3 &cameraForward,
-	bool pixelPerfect, bool includeEntities, const EntityManager &entityManager,
-	const VoxelGrid &voxelGrid, const EntityDefinitionLibrary &entityDefLibrary,
-	const Renderer &renderer, Physics::Hit &hit)
-{
-	constexpr double ceilingHeight = 1.0;
-	return Physics::rayCast(rayStart, rayDirection, chunkDistance, ceilingHeight, chasmStates,
-		cameraForward, pixelPerfect, includeEntities, entityManager, voxelGrid, entityDefLibrary,
-		renderer, hit);
+	return hitCount;
 }
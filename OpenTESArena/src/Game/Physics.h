@@ -11,8 +11,11 @@
 #include "../Rendering/Renderer.h"
 #include "../World/VoxelDefinition.h"
 
+#include "components/utilities/BufferView.h"
+
 // Namespace for physics-related calculations like ray casting.
 
+class JobPool;
 class VoxelGrid;
 
 namespace Physics
@@ -60,6 +63,20 @@ namespace Physics
 		void setT(double t);
 	};
 
+	// A ray for batched ray casts.
+	struct Ray
+	{
+		Double3 start;
+		Double3 direction;
+
+		void init(const Double3 &start, const Double3 &direction);
+	};
+
+	// Sets whether ray casts find entities through the entity manager's voxel index (the default).
+	// Otherwise every nearby entity is mapped to its voxels before each ray like before the index,
+	// which is only kept so benchmarks can compare the two. Not thread-safe; set it between casts.
+	void setEntityVoxelIndexEnabled(bool enabled);
+
 	// @todo: bit mask elements for each voxel data type.
 
 	// Casts a ray through the world and writes any intersection data into the output
@@ -74,6 +91,17 @@ namespace Physics
 		bool pixelPerfect, bool includeEntities, const EntityManager &entityManager,
 		const VoxelGrid &voxelGrid, const EntityDefinitionLibrary &entityDefLibrary,
 		const Renderer &renderer, Physics::Hit &hit);
+
+	// Casts many rays at once (i.e., line-of-sight checks for every nearby entity), writing each
+	// ray's intersection data into the same index of the output hits. Setup shared by the rays
+	// is done once, rays are cast in groups with the same direction signs, and the groups are
+	// split across the job pool's workers if given one. Rays that hit nothing have a hit T of
+	// Hit::MAX_T. Returns the number of rays that hit something.
+	int rayCastBatch(const BufferView<const Ray> &rays, int chunkDistance, double ceilingHeight,
+		const LevelData::ChasmStates &chasmStates, const Double3 &cameraForward, bool pixelPerfect,
+		bool includeEntities, const EntityManager &entityManager, const VoxelGrid &voxelGrid,
+		const EntityDefinitionLibrary &entityDefLibrary, const Renderer &renderer, JobPool *jobPool,
+		BufferView<Hit> &outHits);
 };
 
 #endif
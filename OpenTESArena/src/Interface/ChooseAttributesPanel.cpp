@@ -253,7 +253,11 @@ ChooseAttributesPanel::ChooseAttributesPanel(Game &game)
 						renderer.initializeWorldRendering(
 							options.getGraphics_ResolutionScale(),
 							fullGameWindow,
-							options.getGraphics_RenderThreadsMode());
+							options.getGraphics_RenderThreadsMode(),
+							options.getGraphics_RenderThreadsWorkStealing(),
+							options.getGraphics_ColumnMajorFrameBuffer(),
+							options.getGraphics_CheckerboardRendering(),
+							options.getGraphics_PipelinedRendering());
 
 						std::unique_ptr<GameData> gameData = [this, &game, &binaryAssetLibrary]()
 						{
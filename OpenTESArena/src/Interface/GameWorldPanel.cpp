@@ -68,6 +68,7 @@
 #include "../World/WorldType.h"
 
 #include "components/debug/Debug.h"
+#include "components/utilities/Profiler.h"
 #include "components/utilities/String.h"
 
 namespace
@@ -1942,13 +1943,15 @@ void GameWorldPanel::handleNightLightChange(bool active)
 		if ((entityDef.getType() == EntityDefinition::Type::Doodad) &&
 			(entityDef.getDoodad().streetlight))
 		{
-			const std::string &newStateName = active ?
-				EntityAnimationUtils::STATE_ACTIVATED : EntityAnimationUtils::STATE_IDLE;
+			const EntityAnimationStateID newStateID = active ?
+				EntityAnimationUtils::STATE_ID_ACTIVATED : EntityAnimationUtils::STATE_ID_IDLE;
 
 			const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
 			int newStateIndex;
-			if (!animDef.tryGetStateIndex(newStateName.c_str(), &newStateIndex))
+			if (!animDef.tryGetStateIndex(newStateID, &newStateIndex))
 			{
+				const std::string &newStateName = active ?
+					EntityAnimationUtils::STATE_ACTIVATED : EntityAnimationUtils::STATE_IDLE;
 				DebugLogWarning("Missing entity animation state \"" + newStateName + "\".");
 				continue;
 			}
@@ -2691,7 +2694,8 @@ void GameWorldPanel::drawProfiler(int profilerLevel, Renderer &renderer)
 
 		const Renderer::ProfilerData &profilerData = renderer.getProfilerData();
 		const Int2 renderDims(profilerData.width, profilerData.height);
-		const double resolutionScale = options.getGraphics_ResolutionScale();
+		const double resolutionScale = profilerData.resolutionScale;
+		const bool dynamicResolution = options.getGraphics_DynamicResolution();
 
 		auto &gameData = game.getGameData();
 		const auto &player = gameData.getPlayer();
@@ -2703,7 +2707,8 @@ void GameWorldPanel::drawProfiler(int profilerLevel, Renderer &renderer)
 
 		const std::string renderWidth = std::to_string(renderDims.x);
 		const std::string renderHeight = std::to_string(renderDims.y);
-		const std::string renderResScale = String::fixedPrecision(resolutionScale, 2);
+		const std::string renderResScale = String::fixedPrecision(resolutionScale, 2) +
+			(dynamicResolution ? ", dynamic" : "");
 
 		const std::string posX = String::fixedPrecision(position.x, 2);
 		const std::string posY = String::fixedPrecision(position.y, 2);
@@ -2772,15 +2777,64 @@ void GameWorldPanel::drawProfiler(int profilerLevel, Renderer &renderer)
 		// Draw frame times and graph.
 		const Renderer::ProfilerData &profilerData = renderer.getProfilerData();
 		const std::string renderTime = String::fixedPrecision(profilerData.frameTime * 1000.0, 2);
+		const std::string latencyTime = String::fixedPrecision(profilerData.latency * 1000.0, 2);
+
+		// Average render thread wait before each phase, in microseconds.
+		auto getPhaseWaitText = [&profilerData](int phaseIndex)
+		{
+			const auto &histogram = profilerData.phaseWaits.at(phaseIndex);
+			return String::fixedPrecision(histogram.getAverageMicroseconds(), 1);
+		};
+
+		// Least and most busy render threads as a percent of their frame time, to show imbalance.
+		const std::string threadBusyText = [&profilerData]()
+		{
+			double minBusyPercent = 100.0;
+			double maxBusyPercent = 0.0;
+			int tilesStolen = 0;
+			for (const auto &timing : profilerData.threadTimings)
+			{
+				const double totalSeconds = timing.busySeconds + timing.idleSeconds;
+				const double busyPercent = (totalSeconds > 0.0) ?
+					((timing.busySeconds / totalSeconds) * 100.0) : 0.0;
+				minBusyPercent = std::min(minBusyPercent, busyPercent);
+				maxBusyPercent = std::max(maxBusyPercent, busyPercent);
+				tilesStolen += timing.tilesStolen;
+			}
+
+			if (profilerData.threadTimings.size() == 0)
+			{
+				minBusyPercent = 0.0;
+			}
+
+			return String::fixedPrecision(minBusyPercent, 1) + "%-" +
+				String::fixedPrecision(maxBusyPercent, 1) + "%, stolen: " +
+				std::to_string(tilesStolen);
+		}();
 
 		const std::string text =
-			"3D render: " + renderTime + "ms" + "\n" +
+			"3D render: " + renderTime + "ms, latency: " + latencyTime + "ms" + "\n" +
 			"Vis flats: " + std::to_string(profilerData.visFlatCount) + " (" +
-			std::to_string(profilerData.potentiallyVisFlatCount) + ")" +
-			", lights: " + std::to_string(profilerData.visLightCount) + "\n" +
+			std::to_string(profilerData.potentiallyVisFlatCount) + ", culled " +
+			std::to_string(profilerData.culledChunkFlatCount) + ", sort " +
+			((profilerData.flatSortShifts >= 0) ? std::to_string(profilerData.flatSortShifts) : "full") + ")" +
+			", lights: " + std::to_string(profilerData.visLightCount) + " (binned " +
+			std::to_string(profilerData.lightsBinned) + ", cells " +
+			std::to_string(profilerData.lightCellsTouched) + ")" +
+			", sky: " + (profilerData.skyReused ? "cached" : "drawn") +
+			", columns: " + (profilerData.checkerboarded ? "half" : "all") +
+			", chunks rebuilt: " + std::to_string(profilerData.chunkDefsRebuilt) +
+			", overdraw: " + String::fixedPrecision(profilerData.voxelOverdraw, 2) + "\n" +
 			"FPS Graph:" + '\n' +
 			"                               " + std::to_string(targetFps) + "\n\n\n\n" +
-			"                               " + std::to_string(0);
+			"                               " + std::to_string(0) + "\n" +
+			"Thread waits (us): " +
+			getPhaseWaitText(SoftwareRenderer::ProfilerData::PHASE_SKY_GRADIENT) + ", " +
+			getPhaseWaitText(SoftwareRenderer::ProfilerData::PHASE_DISTANT_SKY) + ", " +
+			getPhaseWaitText(SoftwareRenderer::ProfilerData::PHASE_VOXELS) + ", " +
+			getPhaseWaitText(SoftwareRenderer::ProfilerData::PHASE_FLATS) + ", " +
+			getPhaseWaitText(SoftwareRenderer::ProfilerData::PHASE_SWIZZLE) + "\n" +
+			"Thread busy: " + threadBusyText;
 
 		const auto &fontLibrary = game.getFontLibrary();
 		const RichTextString richText(
@@ -2862,6 +2916,8 @@ void GameWorldPanel::drawProfiler(int profilerLevel, Renderer &renderer)
 
 void GameWorldPanel::tick(double dt)
 {
+	ProfilerZone("GameWorldPanel::tick");
+
 	auto &game = this->getGame();
 	DebugAssert(game.gameDataIsActive());
 
@@ -2877,7 +2933,11 @@ void GameWorldPanel::tick(double dt)
 	auto &gameData = game.getGameData();
 	const bool debugFastForwardClock = inputManager.keyIsDown(SDL_SCANCODE_R); // @todo: camp button
 	const Clock oldClock = gameData.getClock();
-	gameData.tick(debugFastForwardClock ? (dt * 250.0) : dt, game);
+	{
+		ProfilerZone("GameData::tick");
+		gameData.tick(debugFastForwardClock ? (dt * 250.0) : dt, game);
+	}
+
 	const Clock newClock = gameData.getClock();
 
 	auto &renderer = game.getRenderer();
@@ -2962,7 +3022,11 @@ void GameWorldPanel::tick(double dt)
 	// Tick the player.
 	auto &player = gameData.getPlayer();
 	const Int3 oldPlayerVoxel = player.getVoxelPosition();
-	player.tick(game, dt);
+	{
+		ProfilerZone("Player::tick");
+		player.tick(game, dt);
+	}
+
 	const Int3 newPlayerVoxel = player.getVoxelPosition();
 
 	// Handle input for the player's attack.
@@ -2974,7 +3038,10 @@ void GameWorldPanel::tick(double dt)
 
 	// Tick level data (entities, animated distant land, etc.).
 	auto &levelData = worldData.getActiveLevel();
-	levelData.tick(game, dt);
+	{
+		ProfilerZone("LevelData::tick");
+		levelData.tick(game, dt);
+	}
 
 	// See if the player changed voxels in the XZ plane. If so, trigger text and
 	// sound events, and handle any level transition.
@@ -3006,6 +3073,8 @@ void GameWorldPanel::tick(double dt)
 
 void GameWorldPanel::render(Renderer &renderer)
 {
+	ProfilerZone("GameWorldPanel::render");
+
 	DebugAssert(this->getGame().gameDataIsActive());
 
 	// Clear full screen.
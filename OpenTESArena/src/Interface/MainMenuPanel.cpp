@@ -333,7 +333,11 @@ MainMenuPanel::MainMenuPanel(Game &game)
 			const auto &options = game.getOptions();
 			const bool fullGameWindow = options.getGraphics_ModernInterface();
 			renderer.initializeWorldRendering(options.getGraphics_ResolutionScale(),
-				fullGameWindow, options.getGraphics_RenderThreadsMode());
+				fullGameWindow, options.getGraphics_RenderThreadsMode(),
+				options.getGraphics_RenderThreadsWorkStealing(),
+				options.getGraphics_ColumnMajorFrameBuffer(),
+				options.getGraphics_CheckerboardRendering(),
+				options.getGraphics_PipelinedRendering());
 
 			// Game data instance, to be initialized further by one of the loading methods below.
 			// Create a player with random data for testing.
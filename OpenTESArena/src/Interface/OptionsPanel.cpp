@@ -226,7 +226,9 @@ const std::string OptionsPanel::LETTERBOX_MODE_NAME = "Letterbox Mode";
 const std::string OptionsPanel::MODERN_INTERFACE_NAME = "Modern Interface";
 const std::string OptionsPanel::RENDER_THREADS_MODE_NAME = "Render Threads Mode";
 const std::string OptionsPanel::RESOLUTION_SCALE_NAME = "Resolution Scale";
+const std::string OptionsPanel::DYNAMIC_RESOLUTION_NAME = "Dynamic Resolution";
 const std::string OptionsPanel::VERTICAL_FOV_NAME = "Vertical FOV";
+const std::string OptionsPanel::CHECKERBOARD_RENDERING_NAME = "Checkerboard Rendering";
 
 // Audio.
 const std::string OptionsPanel::SOUND_CHANNELS_NAME = "Sound Channels";
@@ -250,6 +252,9 @@ const std::string OptionsPanel::PLAYER_HAS_LIGHT_NAME = "Player Has Light";
 // Dev.
 const std::string OptionsPanel::COLLISION_NAME = "Collision";
 const std::string OptionsPanel::PROFILER_LEVEL_NAME = "Profiler Level";
+const std::string OptionsPanel::WORK_STEALING_NAME = "Work-Stealing Render Threads";
+const std::string OptionsPanel::COLUMN_MAJOR_FRAME_BUFFER_NAME = "Column-Major Frame Buffer";
+const std::string OptionsPanel::PIPELINED_RENDERING_NAME = "Pipelined Rendering";
 
 OptionsPanel::OptionsPanel(Game &game)
 	: Panel(game)
@@ -419,6 +424,24 @@ OptionsPanel::OptionsPanel(Game &game)
 			value, fullGameWindow);
 	}));
 
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::DYNAMIC_RESOLUTION_NAME,
+		"Lowers the resolution scale when the game world is slow to\ndraw and raises it again when there is time to spare.",
+		options.getGraphics_DynamicResolution(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		auto &renderer = game.getRenderer();
+		options.setGraphics_DynamicResolution(value);
+
+		double minScale;
+		double maxScale;
+		options.getGraphics_DynamicResolutionScaleRange(&minScale, &maxScale);
+		renderer.setDynamicResolution(value, minScale, maxScale,
+			options.getGraphics_DynamicResolutionTargetFPSClamped());
+	}));
+
 	this->graphicsOptions.push_back(std::make_unique<DoubleOption>(
 		OptionsPanel::VERTICAL_FOV_NAME,
 		"Recommended 60.0 for classic mode.",
@@ -516,6 +539,19 @@ OptionsPanel::OptionsPanel(Game &game)
 	renderThreadsModeOption->setDisplayOverrides({ "Very Low", "Low", "Medium", "High", "Very High", "Max" });
 	this->graphicsOptions.push_back(std::move(renderThreadsModeOption));
 
+	this->graphicsOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::CHECKERBOARD_RENDERING_NAME,
+		"Draws every other column of the 3D world each frame and\nreuses the previous frame for the rest. Faster at high\nresolutions, but can leave trails on moving objects.",
+		options.getGraphics_CheckerboardRendering(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		auto &renderer = game.getRenderer();
+		options.setGraphics_CheckerboardRendering(value);
+		renderer.setCheckerboardRendering(value);
+	}));
+
 	// Create audio options.
 	this->audioOptions.push_back(std::make_unique<IntOption>(
 		OptionsPanel::SOUND_CHANNELS_NAME,
@@ -737,6 +773,45 @@ OptionsPanel::OptionsPanel(Game &game)
 		options.setMisc_ProfilerLevel(value);
 	}));
 
+	this->devOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::WORK_STEALING_NAME,
+		"Lets idle render threads take column tiles from busy ones\ninstead of each thread drawing a fixed set of columns.",
+		options.getGraphics_RenderThreadsWorkStealing(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		auto &renderer = game.getRenderer();
+		options.setGraphics_RenderThreadsWorkStealing(value);
+		renderer.setRenderThreadsWorkStealing(value);
+	}));
+
+	this->devOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::COLUMN_MAJOR_FRAME_BUFFER_NAME,
+		"Draws the 3D world into a buffer where screen columns are\ncontiguous, then converts it to rows at the end of the frame.",
+		options.getGraphics_ColumnMajorFrameBuffer(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		auto &renderer = game.getRenderer();
+		options.setGraphics_ColumnMajorFrameBuffer(value);
+		renderer.setColumnMajorFrameBuffer(value);
+	}));
+
+	this->devOptions.push_back(std::make_unique<BoolOption>(
+		OptionsPanel::PIPELINED_RENDERING_NAME,
+		"Draws each 3D world frame while the next game tick runs\nand shows it one frame later, trading latency for speed.",
+		options.getGraphics_PipelinedRendering(),
+		[this](bool value)
+	{
+		auto &game = this->getGame();
+		auto &options = game.getOptions();
+		auto &renderer = game.getRenderer();
+		options.setGraphics_PipelinedRendering(value);
+		renderer.setPipelinedRendering(value);
+	}));
+
 	// Set initial tab.
 	this->tab = OptionsPanel::Tab::Graphics;
 
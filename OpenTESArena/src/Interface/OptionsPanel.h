@@ -142,7 +142,9 @@ private:
 	static const std::string MODERN_INTERFACE_NAME;
 	static const std::string RENDER_THREADS_MODE_NAME;
 	static const std::string RESOLUTION_SCALE_NAME;
+	static const std::string DYNAMIC_RESOLUTION_NAME;
 	static const std::string VERTICAL_FOV_NAME;
+	static const std::string CHECKERBOARD_RENDERING_NAME;
 
 	// Audio.
 	static const std::string SOUND_CHANNELS_NAME;
@@ -166,6 +168,9 @@ private:
 	// Dev.
 	static const std::string COLLISION_NAME;
 	static const std::string PROFILER_LEVEL_NAME;
+	static const std::string WORK_STEALING_NAME;
+	static const std::string COLUMN_MAJOR_FRAME_BUFFER_NAME;
+	static const std::string PIPELINED_RENDERING_NAME;
 
 	std::unique_ptr<TextBox> titleTextBox, backToPauseMenuTextBox, graphicsTextBox, audioTextBox,
 		inputTextBox, miscTextBox, devTextBox;
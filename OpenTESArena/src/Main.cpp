@@ -6,16 +6,26 @@
 #include "SDL.h"
 
 #include "Game/Game.h"
+#include "Game/HeadlessRender.h"
 
 #include "components/debug/Debug.h"
 
 int main(int argc, char *argv[])
 {
-	static_cast<void>(argc);
-	static_cast<void>(argv);
-
 	try
 	{
+		// Render the game world without a window (i.e., for performance testing).
+		if (HeadlessRender::isRequested(argc, argv))
+		{
+			HeadlessRender::Settings settings;
+			if (!HeadlessRender::parseArgs(argc, argv, &settings))
+			{
+				return EXIT_FAILURE;
+			}
+
+			return HeadlessRender::run(settings);
+		}
+
 		// Allocated on the heap to avoid stack overflow warning.
 		auto g = std::make_unique<Game>();
 		g->loop();
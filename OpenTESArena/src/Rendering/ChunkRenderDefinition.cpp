@@ -47,6 +47,13 @@ VoxelRenderDefID ChunkRenderDefinition::addVoxelRenderDef(VoxelRenderDefinition
 	return id;
 }
 
+void ChunkRenderDefinition::setVoxelRenderDefID(SNInt x, int y, WEInt z, VoxelRenderDefID id)
+{
+	DebugAssert((id == ChunkRenderDefinition::NO_VOXEL_ID) ||
+		((id >= 0) && (id < static_cast<int>(this->voxelRenderDefs.size()))));
+	this->voxelRenderDefIDs.set(x, y, z, id);
+}
+
 void ChunkRenderDefinition::clear()
 {
 	this->voxelRenderDefs.clear();
@@ -36,6 +36,7 @@ public:
 	VoxelRenderDefID getVoxelRenderDefID(SNInt x, int y, WEInt z) const;
 
 	VoxelRenderDefID addVoxelRenderDef(VoxelRenderDefinition &&def);
+	void setVoxelRenderDefID(SNInt x, int y, WEInt z, VoxelRenderDefID id);
 	void clear();
 };
 
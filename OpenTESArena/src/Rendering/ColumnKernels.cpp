@@ -0,0 +1,124 @@
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#include "ColumnKernels.h"
+#include "ColumnKernelsImpl.h"
+
+namespace
+{
+	template <typename Real>
+	void InterpolateVScalarKernel(const int *rows, int count, Real yProjStart, Real yProjEnd,
+		Real vStart, Real vEnd, Real *outV)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			outV[i] = InterpolateVScalar(rows[i], yProjStart, yProjEnd, vStart, vEnd);
+		}
+	}
+
+	template <typename Real>
+	void ShadePixelsScalarKernel(const Real *r, const Real *g, const Real *b, const Real *emission,
+		const Real *lightContributions, const Real *fogPercents, int count,
+		const ColumnKernels::BasicShadeParams<Real> &params, uint32_t *outColors)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const Real lightContribution = (lightContributions != nullptr) ?
+				lightContributions[i] : params.lightContribution;
+			const Real fogPercent = (fogPercents != nullptr) ? fogPercents[i] : params.fogPercent;
+			outColors[i] = ShadePixelScalar(r[i], g[i], b[i], emission[i], lightContribution,
+				fogPercent, params);
+		}
+	}
+
+	void FillSpanScalarKernel(uint32_t *colors, double *depths, int count, uint32_t color, double depth)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			colors[i] = color;
+			depths[i] = depth;
+		}
+	}
+
+	const ColumnKernels::Table ScalarTable =
+	{
+		"Scalar",
+		1,
+		1,
+		InterpolateVScalarKernel<float>,
+		InterpolateVScalarKernel<double>,
+		ShadePixelsScalarKernel<float>,
+		ShadePixelsScalarKernel<double>,
+		FillSpanScalarKernel
+	};
+}
+
+const ColumnKernels::Table &ColumnKernels::getScalarTable()
+{
+	return ScalarTable;
+}
+
+const ColumnKernels::Table *ColumnKernels::getBaselineTable()
+{
+#if defined(HAVE_SIMD)
+	return &SimdTable;
+#else
+	return nullptr;
+#endif
+}
+
+bool ColumnKernels::isAVX2Supported()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	// The OS must save AVX registers on context switches (OSXSAVE + XCR0 bits 1 and 2).
+	__cpuid(info, 1);
+	const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+	const bool hasAVX = (info[2] & (1 << 28)) != 0;
+	if (!hasOSXSAVE || !hasAVX || ((_xgetbv(0) & 0x6) != 0x6))
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+const ColumnKernels::Table &ColumnKernels::getActiveTable()
+{
+	static const Table &table = []() -> const Table&
+	{
+		const Table *avx2Table = ColumnKernels::getAVX2Table();
+		const Table *baselineTable = ColumnKernels::getBaselineTable();
+
+		if ((avx2Table != nullptr) && ColumnKernels::isAVX2Supported() &&
+			((baselineTable == nullptr) || (avx2Table->width >= baselineTable->width)))
+		{
+			return *avx2Table;
+		}
+		else if (baselineTable != nullptr)
+		{
+			return *baselineTable;
+		}
+		else
+		{
+			return ColumnKernels::getScalarTable();
+		}
+	}();
+
+	return table;
+}
@@ -0,0 +1,83 @@
+#ifndef COLUMN_KERNELS_H
+#define COLUMN_KERNELS_H
+
+#include <cstdint>
+
+// Inner loops of the software renderer's column and row drawing, compiled once per instruction
+// set. The best kernel table supported by the running CPU is picked at runtime, so a baseline
+// build still uses wider vectors on CPUs that have them.
+//
+// Texture sampling and depth testing stay with the caller since column pixels are strided in
+// the frame buffer and texels can't be gathered efficiently without AVX2 gathers. Callers batch
+// the pixels that pass the depth test and hand them to these kernels for the shading math.
+//
+// The shading kernels come in float and double versions so both shading precisions of the
+// software renderer can use them. The double versions do the same operations in the same order
+// as the renderer's scalar double shaders, so their output is identical.
+
+namespace ColumnKernels
+{
+	// Max pixels per kernel call. Callers split columns into chunks of this size so their
+	// scratch arrays can live on the stack.
+	constexpr int ChunkSize = 64;
+
+	// Alignment of kernel input and output arrays (wide enough for AVX-512).
+	constexpr int ChunkAlignment = 64;
+
+	// Shading values shared by all pixels in a kernel call.
+	template <typename Real>
+	struct BasicShadeParams
+	{
+		Real ambient;
+		Real fade; // 1.0 when not fading.
+		Real fogR, fogG, fogB;
+		Real lightContribution; // Used when no per-pixel light contributions are given.
+		Real fogPercent; // Used when no per-pixel fog percents are given.
+	};
+
+	using ShadeParams = BasicShadeParams<float>;
+	using ShadeParamsDouble = BasicShadeParams<double>;
+
+	struct Table
+	{
+		const char *name;
+		int width; // Pixels per iteration.
+		int doubleWidth; // Pixels per iteration of the double kernels.
+
+		// Calculates the texture V coordinate of each row within the projected column.
+		void (*interpolateV)(const int *rows, int count, float yProjStart, float yProjEnd,
+			float vStart, float vEnd, float *outV);
+		void (*interpolateVDouble)(const int *rows, int count, double yProjStart, double yProjEnd,
+			double vStart, double vEnd, double *outV);
+
+		// Applies light, fade, and fog to sampled texel colors, then clamps and packs them into
+		// RGB. Per-pixel light contributions and fog percents are optional (may be null).
+		void (*shadePixels)(const float *r, const float *g, const float *b, const float *emission,
+			const float *lightContributions, const float *fogPercents, int count,
+			const ShadeParams &params, uint32_t *outColors);
+		void (*shadePixelsDouble)(const double *r, const double *g, const double *b,
+			const double *emission, const double *lightContributions, const double *fogPercents,
+			int count, const ShadeParamsDouble &params, uint32_t *outColors);
+
+		// Sets a contiguous span of the color and depth buffers to one value.
+		void (*fillSpan)(uint32_t *colors, double *depths, int count, uint32_t color, double depth);
+	};
+
+	// Plain C++ kernels, always available.
+	const Table &getScalarTable();
+
+	// Kernels using the instruction set Simd.h picks from the project's compiler flags, or null
+	// if none is available.
+	const Table *getBaselineTable();
+
+	// Kernels compiled separately with AVX2 enabled, or null if this isn't an x86 build.
+	const Table *getAVX2Table();
+
+	// Returns whether the running CPU and OS support AVX2.
+	bool isAVX2Supported();
+
+	// Gets the widest kernel table usable on the running CPU. Chosen once on first call.
+	const Table &getActiveTable();
+}
+
+#endif
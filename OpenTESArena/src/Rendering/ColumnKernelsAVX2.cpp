@@ -0,0 +1,17 @@
+// This file is compiled with AVX2 enabled (see CMakeLists.txt). Its kernels are only called
+// after ColumnKernels::isAVX2Supported() confirms the CPU can run them.
+
+#include "ColumnKernels.h"
+
+#if defined(__AVX2__)
+#include "ColumnKernelsImpl.h"
+#endif
+
+const ColumnKernels::Table *ColumnKernels::getAVX2Table()
+{
+#if defined(__AVX2__)
+	return &SimdTable;
+#else
+	return nullptr;
+#endif
+}
@@ -0,0 +1,268 @@
+#ifndef COLUMN_KERNELS_IMPL_H
+#define COLUMN_KERNELS_IMPL_H
+
+#include <cstdint>
+
+#include "ColumnKernels.h"
+#include "Simd.h"
+
+// Kernel bodies shared by every instruction set. Only include this from a ColumnKernels source
+// file; each one compiles it with its own Simd.h instruction set. Everything here has internal
+// linkage so the per-instruction-set copies never collide at link time, and it deliberately
+// avoids the standard library so no inline library code gets compiled with wider instructions
+// than the rest of the program expects.
+
+namespace
+{
+	// The same operations in the same order as the renderer's scalar shaders.
+	template <typename Real>
+	Real InterpolateVScalar(int row, Real yProjStart, Real yProjEnd, Real vStart, Real vEnd)
+	{
+		const Real yPercent = ((static_cast<Real>(row) + static_cast<Real>(0.50)) - yProjStart) /
+			(yProjEnd - yProjStart);
+		return vStart + ((vEnd - vStart) * yPercent);
+	}
+
+	template <typename Real>
+	uint32_t ShadePixelScalar(Real r, Real g, Real b, Real emission, Real lightContribution,
+		Real fogPercent, const ColumnKernels::BasicShadeParams<Real> &params)
+	{
+		constexpr Real one = static_cast<Real>(1.0);
+		constexpr Real channelMax = static_cast<Real>(255.0);
+
+		// Shading from light, then fade.
+		const Real light = params.ambient + (emission + lightContribution);
+		const Real lightPercent = (light < one) ? light : one;
+		Real colorR = (r * lightPercent) * params.fade;
+		Real colorG = (g * lightPercent) * params.fade;
+		Real colorB = (b * lightPercent) * params.fade;
+
+		// Linearly interpolate with fog.
+		colorR += (params.fogR - colorR) * fogPercent;
+		colorG += (params.fogG - colorG) * fogPercent;
+		colorB += (params.fogB - colorB) * fogPercent;
+
+		// Clamp maximum (don't worry about negative values).
+		colorR = (colorR > one) ? one : colorR;
+		colorG = (colorG > one) ? one : colorG;
+		colorB = (colorB > one) ? one : colorB;
+
+		return (static_cast<uint32_t>(colorR * channelMax) << 16) |
+			(static_cast<uint32_t>(colorG * channelMax) << 8) |
+			(static_cast<uint32_t>(colorB * channelMax));
+	}
+
+#if defined(HAVE_SIMD)
+	void InterpolateVSimd(const int *rows, int count, float yProjStart, float yProjEnd,
+		float vStart, float vEnd, float *outV)
+	{
+		const simd_type half = simd_set1(0.50f);
+		const simd_type projStart = simd_set1(yProjStart);
+		const simd_type projHeight = simd_set1(yProjEnd - yProjStart);
+		const simd_type textureVStart = simd_set1(vStart);
+		const simd_type textureVHeight = simd_set1(vEnd - vStart);
+
+		int i = 0;
+		for (; (i + static_cast<int>(simd_size)) <= count; i += static_cast<int>(simd_size))
+		{
+			const simd_type row = simd_cvtepi32(simd_load_i(rows + i));
+			const simd_type yPercent = simd_div(simd_sub(simd_add(row, half), projStart), projHeight);
+			simd_store(outV + i, simd_add(textureVStart, simd_mul(textureVHeight, yPercent)));
+		}
+
+		for (; i < count; i++)
+		{
+			outV[i] = InterpolateVScalar(rows[i], yProjStart, yProjEnd, vStart, vEnd);
+		}
+	}
+
+	void ShadePixelsSimd(const float *r, const float *g, const float *b, const float *emission,
+		const float *lightContributions, const float *fogPercents, int count,
+		const ColumnKernels::ShadeParams &params, uint32_t *outColors)
+	{
+		const simd_type ambient = simd_set1(params.ambient);
+		const simd_type fade = simd_set1(params.fade);
+		const simd_type fogR = simd_set1(params.fogR);
+		const simd_type fogG = simd_set1(params.fogG);
+		const simd_type fogB = simd_set1(params.fogB);
+		const simd_type constLightContribution = simd_set1(params.lightContribution);
+		const simd_type constFogPercent = simd_set1(params.fogPercent);
+		const simd_type one = simd_set1(1.0f);
+		const simd_type channelMax = simd_set1(255.0f);
+		const simd_type redScale = simd_set1(65536.0f);
+		const simd_type greenScale = simd_set1(256.0f);
+
+		int i = 0;
+		for (; (i + static_cast<int>(simd_size)) <= count; i += static_cast<int>(simd_size))
+		{
+			const simd_type lightContribution = (lightContributions != nullptr) ?
+				simd_load(lightContributions + i) : constLightContribution;
+			const simd_type fogPercent = (fogPercents != nullptr) ?
+				simd_load(fogPercents + i) : constFogPercent;
+
+			// Shading from light, then fade.
+			const simd_type light = simd_add(ambient, simd_add(simd_load(emission + i), lightContribution));
+			const simd_type lightPercent = simd_min(light, one);
+			simd_type colorR = simd_mul(simd_mul(simd_load(r + i), lightPercent), fade);
+			simd_type colorG = simd_mul(simd_mul(simd_load(g + i), lightPercent), fade);
+			simd_type colorB = simd_mul(simd_mul(simd_load(b + i), lightPercent), fade);
+
+			// Linearly interpolate with fog.
+			colorR = simd_add(colorR, simd_mul(simd_sub(fogR, colorR), fogPercent));
+			colorG = simd_add(colorG, simd_mul(simd_sub(fogG, colorG), fogPercent));
+			colorB = simd_add(colorB, simd_mul(simd_sub(fogB, colorB), fogPercent));
+
+			// Clamp maximum, then truncate each channel to 0-255.
+			const simd_type r8 = simd_cvtepi32(simd_cvttps_epi32(simd_mul(simd_min(colorR, one), channelMax)));
+			const simd_type g8 = simd_cvtepi32(simd_cvttps_epi32(simd_mul(simd_min(colorG, one), channelMax)));
+			const simd_type b8 = simd_cvtepi32(simd_cvttps_epi32(simd_mul(simd_min(colorB, one), channelMax)));
+
+			// Pack with float math since not every instruction set has integer shifts at this
+			// width. The largest packed value (0xFFFFFF) fits exactly in a float's mantissa.
+			const simd_type packed = simd_add(simd_add(simd_mul(r8, redScale), simd_mul(g8, greenScale)), b8);
+			simd_store_i(outColors + i, simd_cvttps_epi32(packed));
+		}
+
+		for (; i < count; i++)
+		{
+			const float lightContribution = (lightContributions != nullptr) ?
+				lightContributions[i] : params.lightContribution;
+			const float fogPercent = (fogPercents != nullptr) ? fogPercents[i] : params.fogPercent;
+			outColors[i] = ShadePixelScalar(r[i], g[i], b[i], emission[i], lightContribution,
+				fogPercent, params);
+		}
+	}
+
+	void InterpolateVSimdDouble(const int *rows, int count, double yProjStart, double yProjEnd,
+		double vStart, double vEnd, double *outV)
+	{
+		const simd_type_d half = simd_set1_d(0.50);
+		const simd_type_d projStart = simd_set1_d(yProjStart);
+		const simd_type_d projHeight = simd_set1_d(yProjEnd - yProjStart);
+		const simd_type_d textureVStart = simd_set1_d(vStart);
+		const simd_type_d textureVHeight = simd_set1_d(vEnd - vStart);
+
+		int i = 0;
+		for (; (i + static_cast<int>(simd_size_d)) <= count; i += static_cast<int>(simd_size_d))
+		{
+			const simd_type_d row = simd_loadu_cvtepi32_d(rows + i);
+			const simd_type_d yPercent = simd_div_d(simd_sub_d(simd_add_d(row, half), projStart), projHeight);
+			simd_store_d(outV + i, simd_add_d(textureVStart, simd_mul_d(textureVHeight, yPercent)));
+		}
+
+		for (; i < count; i++)
+		{
+			outV[i] = InterpolateVScalar(rows[i], yProjStart, yProjEnd, vStart, vEnd);
+		}
+	}
+
+	void ShadePixelsSimdDouble(const double *r, const double *g, const double *b,
+		const double *emission, const double *lightContributions, const double *fogPercents,
+		int count, const ColumnKernels::ShadeParamsDouble &params, uint32_t *outColors)
+	{
+		const simd_type_d ambient = simd_set1_d(params.ambient);
+		const simd_type_d fade = simd_set1_d(params.fade);
+		const simd_type_d fogR = simd_set1_d(params.fogR);
+		const simd_type_d fogG = simd_set1_d(params.fogG);
+		const simd_type_d fogB = simd_set1_d(params.fogB);
+		const simd_type_d constLightContribution = simd_set1_d(params.lightContribution);
+		const simd_type_d constFogPercent = simd_set1_d(params.fogPercent);
+		const simd_type_d one = simd_set1_d(1.0);
+		const simd_type_d channelMax = simd_set1_d(255.0);
+		const simd_type_d redScale = simd_set1_d(65536.0);
+		const simd_type_d greenScale = simd_set1_d(256.0);
+
+		int i = 0;
+		for (; (i + static_cast<int>(simd_size_d)) <= count; i += static_cast<int>(simd_size_d))
+		{
+			const simd_type_d lightContribution = (lightContributions != nullptr) ?
+				simd_load_d(lightContributions + i) : constLightContribution;
+			const simd_type_d fogPercent = (fogPercents != nullptr) ?
+				simd_load_d(fogPercents + i) : constFogPercent;
+
+			// Shading from light, then fade.
+			const simd_type_d light = simd_add_d(ambient, simd_add_d(simd_load_d(emission + i), lightContribution));
+			const simd_type_d lightPercent = simd_min_d(light, one);
+			simd_type_d colorR = simd_mul_d(simd_mul_d(simd_load_d(r + i), lightPercent), fade);
+			simd_type_d colorG = simd_mul_d(simd_mul_d(simd_load_d(g + i), lightPercent), fade);
+			simd_type_d colorB = simd_mul_d(simd_mul_d(simd_load_d(b + i), lightPercent), fade);
+
+			// Linearly interpolate with fog.
+			colorR = simd_add_d(colorR, simd_mul_d(simd_sub_d(fogR, colorR), fogPercent));
+			colorG = simd_add_d(colorG, simd_mul_d(simd_sub_d(fogG, colorG), fogPercent));
+			colorB = simd_add_d(colorB, simd_mul_d(simd_sub_d(fogB, colorB), fogPercent));
+
+			// Clamp maximum, then truncate each channel to 0-255.
+			const simd_type_d r8 = simd_trunc_d(simd_mul_d(simd_min_d(colorR, one), channelMax));
+			const simd_type_d g8 = simd_trunc_d(simd_mul_d(simd_min_d(colorG, one), channelMax));
+			const simd_type_d b8 = simd_trunc_d(simd_mul_d(simd_min_d(colorB, one), channelMax));
+
+			// Whole channel values pack exactly in double math.
+			const simd_type_d packed = simd_add_d(simd_add_d(simd_mul_d(r8, redScale), simd_mul_d(g8, greenScale)), b8);
+			simd_storeu_cvttpd_epi32(outColors + i, packed);
+		}
+
+		for (; i < count; i++)
+		{
+			const double lightContribution = (lightContributions != nullptr) ?
+				lightContributions[i] : params.lightContribution;
+			const double fogPercent = (fogPercents != nullptr) ? fogPercents[i] : params.fogPercent;
+			outColors[i] = ShadePixelScalar(r[i], g[i], b[i], emission[i], lightContribution,
+				fogPercent, params);
+		}
+	}
+
+	void FillSpanSimd(uint32_t *colors, double *depths, int count, uint32_t color, double depth)
+	{
+		const simd_type_i colorValue = simd_set1_i(static_cast<int>(color));
+		const simd_type_d depthValue = simd_set1_d(depth);
+
+		int i = 0;
+		for (; (i + static_cast<int>(simd_size)) <= count; i += static_cast<int>(simd_size))
+		{
+			simd_storeu_i(colors + i, colorValue);
+		}
+
+		for (; i < count; i++)
+		{
+			colors[i] = color;
+		}
+
+		i = 0;
+		for (; (i + static_cast<int>(simd_size_d)) <= count; i += static_cast<int>(simd_size_d))
+		{
+			simd_storeu_d(depths + i, depthValue);
+		}
+
+		for (; i < count; i++)
+		{
+			depths[i] = depth;
+		}
+	}
+
+	constexpr const char *SimdTableName =
+#if defined(HAVE_SIMD_AVX512)
+		"AVX-512";
+#elif defined(__AVX2__)
+		"AVX2";
+#elif defined(HAVE_SIMD_AVX)
+		"AVX";
+#else
+		"SSE2";
+#endif
+
+	const ColumnKernels::Table SimdTable =
+	{
+		SimdTableName,
+		static_cast<int>(simd_size),
+		static_cast<int>(simd_size_d),
+		InterpolateVSimd,
+		InterpolateVSimdDouble,
+		ShadePixelsSimd,
+		ShadePixelsSimdDouble,
+		FillSpanSimd
+	};
+#endif
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+
+#include "DynamicResolution.h"
+
+#include "components/debug/Debug.h"
+
+DynamicResolution::DynamicResolution()
+{
+	this->minScale = 0.0;
+	this->maxScale = 0.0;
+	this->targetFrameTime = 0.0;
+	this->scale = 0.0;
+	this->frameTimeSum = 0.0;
+	this->frameCount = 0;
+	this->underBudgetWindows = 0;
+	this->enabled = false;
+}
+
+void DynamicResolution::init(bool enabled, double minScale, double maxScale,
+	double targetFrameTime, double initialScale)
+{
+	DebugAssert(minScale > 0.0);
+	DebugAssert(maxScale >= minScale);
+	DebugAssert(targetFrameTime > 0.0);
+
+	this->minScale = minScale;
+	this->maxScale = maxScale;
+	this->targetFrameTime = targetFrameTime;
+
+	const double snappedScale = std::round(initialScale / DynamicResolution::SCALE_STEP) *
+		DynamicResolution::SCALE_STEP;
+	this->scale = std::clamp(snappedScale, minScale, maxScale);
+	this->frameTimeSum = 0.0;
+	this->frameCount = 0;
+	this->underBudgetWindows = 0;
+	this->enabled = enabled;
+}
+
+bool DynamicResolution::isEnabled() const
+{
+	return this->enabled;
+}
+
+double DynamicResolution::getScale() const
+{
+	return this->scale;
+}
+
+bool DynamicResolution::update(double frameTime)
+{
+	DebugAssert(this->enabled);
+
+	this->frameTimeSum += frameTime;
+	this->frameCount++;
+	if (this->frameCount < DynamicResolution::WINDOW_FRAME_COUNT)
+	{
+		return false;
+	}
+
+	const double averageFrameTime = this->frameTimeSum / static_cast<double>(this->frameCount);
+	this->frameTimeSum = 0.0;
+	this->frameCount = 0;
+
+	// Over budget: step down right away.
+	if (averageFrameTime > this->targetFrameTime)
+	{
+		this->underBudgetWindows = 0;
+		if (this->scale > this->minScale)
+		{
+			this->scale = std::max(this->scale - DynamicResolution::SCALE_STEP, this->minScale);
+			return true;
+		}
+
+		return false;
+	}
+
+	if (this->scale >= this->maxScale)
+	{
+		this->underBudgetWindows = 0;
+		return false;
+	}
+
+	// Under budget: frame time mostly scales with pixel count, so only step up if the next
+	// step is expected to stay comfortably within the target.
+	const double nextScale = std::min(this->scale + DynamicResolution::SCALE_STEP, this->maxScale);
+	const double pixelRatio = (nextScale * nextScale) / (this->scale * this->scale);
+	const double estimatedFrameTime = averageFrameTime * pixelRatio;
+	if (estimatedFrameTime >= (this->targetFrameTime * DynamicResolution::STEP_UP_BUDGET_PERCENT))
+	{
+		this->underBudgetWindows = 0;
+		return false;
+	}
+
+	this->underBudgetWindows++;
+	if (this->underBudgetWindows < DynamicResolution::STEP_UP_WINDOW_COUNT)
+	{
+		return false;
+	}
+
+	this->underBudgetWindows = 0;
+	this->scale = nextScale;
+	return true;
+}
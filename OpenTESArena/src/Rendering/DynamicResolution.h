@@ -0,0 +1,45 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+// Picks the game world's resolution scale from recent 3D frame times so heavy scenes drop to a
+// lower resolution instead of missing the target frame rate. The scale moves in fixed steps so
+// frame buffers are only reallocated occasionally, and stepping up needs a sustained surplus
+// that would survive the extra pixels, so the scale doesn't oscillate between two steps.
+
+class DynamicResolution
+{
+public:
+	// Resolution scale change per step.
+	static constexpr double SCALE_STEP = 0.05;
+
+	// Frames averaged for each decision.
+	static constexpr int WINDOW_FRAME_COUNT = 20;
+
+	// Consecutive under-budget windows needed before stepping up.
+	static constexpr int STEP_UP_WINDOW_COUNT = 3;
+
+	// Fraction of the target frame time the estimated time at the next step up must stay under.
+	static constexpr double STEP_UP_BUDGET_PERCENT = 0.85;
+private:
+	double minScale, maxScale;
+	double targetFrameTime; // In seconds.
+	double scale;
+	double frameTimeSum; // Frames in the current window.
+	int frameCount;
+	int underBudgetWindows;
+	bool enabled;
+public:
+	DynamicResolution();
+
+	// Starts from the given scale, snapped to a step within the bounds.
+	void init(bool enabled, double minScale, double maxScale, double targetFrameTime,
+		double initialScale);
+
+	bool isEnabled() const;
+	double getScale() const;
+
+	// Adds the time of a finished 3D frame. Returns whether the scale changed.
+	bool update(double frameTime);
+};
+
+#endif
@@ -1 +1,73 @@
-#include "EntityRenderInstance.h"
\ No newline at end of file
+#include "EntityRenderInstance.h"
+
+void EntityRenderInstance::init(const Double3 &position, double width, double height,
+	EntityID entityID, EntityRenderID entityRenderID, int animStateID, int animAngleID,
+	int animKeyframeID, int lightIntensity, bool isStatic, bool canBeVisible)
+{
+	this->position = position;
+	this->width = width;
+	this->height = height;
+	this->entityID = entityID;
+	this->entityRenderID = entityRenderID;
+	this->animStateID = animStateID;
+	this->animAngleID = animAngleID;
+	this->animKeyframeID = animKeyframeID;
+	this->lightIntensity = lightIntensity;
+	this->isStatic = isStatic;
+	this->canBeVisible = canBeVisible;
+}
+
+const Double3 &EntityRenderInstance::getPosition() const
+{
+	return this->position;
+}
+
+double EntityRenderInstance::getWidth() const
+{
+	return this->width;
+}
+
+double EntityRenderInstance::getHeight() const
+{
+	return this->height;
+}
+
+EntityID EntityRenderInstance::getEntityID() const
+{
+	return this->entityID;
+}
+
+EntityRenderID EntityRenderInstance::getEntityRenderID() const
+{
+	return this->entityRenderID;
+}
+
+int EntityRenderInstance::getAnimStateID() const
+{
+	return this->animStateID;
+}
+
+int EntityRenderInstance::getAnimAngleID() const
+{
+	return this->animAngleID;
+}
+
+int EntityRenderInstance::getAnimKeyframeID() const
+{
+	return this->animKeyframeID;
+}
+
+int EntityRenderInstance::getLightIntensity() const
+{
+	return this->lightIntensity;
+}
+
+bool EntityRenderInstance::getIsStatic() const
+{
+	return this->isStatic;
+}
+
+bool EntityRenderInstance::getCanBeVisible() const
+{
+	return this->canBeVisible;
+}
@@ -1,13 +1,39 @@
 #ifndef ENTITY_RENDER_INSTANCE_H
 #define ENTITY_RENDER_INSTANCE_H
 
+#include "../Entities/EntityUtils.h"
+#include "../Math/Vector3.h"
+
+// An entity's state as seen from the camera for one frame. Entities that can't be seen are
+// still kept if they give off light.
+
 class EntityRenderInstance
 {
 private:
-	// @todo: position, unique scale width/height values
-	int defID;
+	Double3 position; // Bottom center of the flat.
+	double width, height;
+	EntityID entityID;
+	EntityRenderID entityRenderID;
+	int animStateID, animAngleID, animKeyframeID;
+	int lightIntensity; // Zero if the entity isn't a light.
+	bool isStatic; // Static lights stay binned in the visible light lists between frames.
+	bool canBeVisible; // In a chunk overlapping the view and in front of the camera.
 public:
+	void init(const Double3 &position, double width, double height, EntityID entityID,
+		EntityRenderID entityRenderID, int animStateID, int animAngleID, int animKeyframeID,
+		int lightIntensity, bool isStatic, bool canBeVisible);
 
+	const Double3 &getPosition() const;
+	double getWidth() const;
+	double getHeight() const;
+	EntityID getEntityID() const;
+	EntityRenderID getEntityRenderID() const;
+	int getAnimStateID() const;
+	int getAnimAngleID() const;
+	int getAnimKeyframeID() const;
+	int getLightIntensity() const;
+	bool getIsStatic() const;
+	bool getCanBeVisible() const;
 };
 
 #endif
@@ -1 +1,45 @@
-#include "RenderCamera.h"
\ No newline at end of file
+#include "RenderCamera.h"
+#include "../World/ChunkUtils.h"
+
+void RenderCamera::init(const ChunkInt2 &chunk, const VoxelDouble3 &voxel,
+	const VoxelDouble3 &direction, Degrees fovX, Degrees fovY)
+{
+	this->chunk = chunk;
+	this->voxel = voxel;
+	this->direction = direction;
+	this->fovX = fovX;
+	this->fovY = fovY;
+}
+
+const ChunkInt2 &RenderCamera::getChunk() const
+{
+	return this->chunk;
+}
+
+const VoxelDouble3 &RenderCamera::getVoxel() const
+{
+	return this->voxel;
+}
+
+const VoxelDouble3 &RenderCamera::getDirection() const
+{
+	return this->direction;
+}
+
+Degrees RenderCamera::getFovX() const
+{
+	return this->fovX;
+}
+
+Degrees RenderCamera::getFovY() const
+{
+	return this->fovY;
+}
+
+Double3 RenderCamera::getAbsolutePosition() const
+{
+	return Double3(
+		static_cast<double>(this->chunk.x * ChunkUtils::CHUNK_DIM) + this->voxel.x,
+		this->voxel.y,
+		static_cast<double>(this->chunk.y * ChunkUtils::CHUNK_DIM) + this->voxel.z);
+}
@@ -1,6 +1,7 @@
 #ifndef RENDER_CAMERA_H
 #define RENDER_CAMERA_H
 
+#include "../Math/MathUtils.h"
 #include "../Math/Vector3.h"
 #include "../World/VoxelUtils.h"
 
@@ -10,10 +11,20 @@ class RenderCamera
 {
 private:
 	ChunkInt2 chunk;
-	VoxelDouble3 voxel, direction;
-	double fovX, fovY;
+	VoxelDouble3 voxel, direction; // Position in the chunk, and normalized look direction.
+	Degrees fovX, fovY;
 public:
-	// @todo
+	void init(const ChunkInt2 &chunk, const VoxelDouble3 &voxel, const VoxelDouble3 &direction,
+		Degrees fovX, Degrees fovY);
+
+	const ChunkInt2 &getChunk() const;
+	const VoxelDouble3 &getVoxel() const;
+	const VoxelDouble3 &getDirection() const;
+	Degrees getFovX() const;
+	Degrees getFovY() const;
+
+	// Gets the camera position in the space of the voxel grid the chunks are cut from.
+	Double3 getAbsolutePosition() const;
 };
 
 #endif
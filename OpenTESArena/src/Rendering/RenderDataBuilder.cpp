@@ -1 +1,241 @@
-#include "RenderDataBuilder.h"
\ No newline at end of file
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderDataBuilder.h"
+#include "../Entities/EntityDefinitionLibrary.h"
+#include "../Entities/EntityManager.h"
+#include "../Entities/EntityType.h"
+#include "../Entities/EntityUtils.h"
+#include "../Math/Constants.h"
+#include "../World/ChunkUtils.h"
+#include "../World/VoxelDataType.h"
+#include "../World/VoxelGrid.h"
+
+#include "components/debug/Debug.h"
+
+namespace
+{
+	// Fills a chunk render definition from its part of the voxel grid. Voxels sharing a voxel
+	// grid ID share a voxel render definition.
+	void BuildChunk(const VoxelGrid &voxelGrid, SNInt chunkX, WEInt chunkZ,
+		ChunkRenderDefinition *outChunkRenderDef)
+	{
+		outChunkRenderDef->clear();
+
+		std::unordered_map<uint16_t, VoxelRenderDefID> renderDefIDs;
+		const SNInt startX = chunkX * ChunkUtils::CHUNK_DIM;
+		const WEInt startZ = chunkZ * ChunkUtils::CHUNK_DIM;
+		for (WEInt z = 0; z < outChunkRenderDef->getDepth(); z++)
+		{
+			for (int y = 0; y < outChunkRenderDef->getHeight(); y++)
+			{
+				for (SNInt x = 0; x < outChunkRenderDef->getWidth(); x++)
+				{
+					const uint16_t voxelID = voxelGrid.getVoxel(startX + x, y, startZ + z);
+					auto iter = renderDefIDs.find(voxelID);
+					if (iter == renderDefIDs.end())
+					{
+						const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+						VoxelRenderDefID renderDefID = ChunkRenderDefinition::NO_VOXEL_ID;
+						if (voxelDef.dataType != VoxelDataType::None)
+						{
+							VoxelRenderDefinition renderDef;
+							renderDef.init(voxelDef);
+							renderDefID = outChunkRenderDef->addVoxelRenderDef(std::move(renderDef));
+						}
+
+						iter = renderDefIDs.emplace(voxelID, renderDefID).first;
+					}
+
+					outChunkRenderDef->setVoxelRenderDefID(x, y, z, iter->second);
+				}
+			}
+		}
+	}
+
+	// Gets the entities in the chunks around the camera. Entities in chunks outside the camera's
+	// 2D frustum are written separately so lights in them can still be found.
+	void GetNearbyEntities(const ChunkInt2 &cameraChunk, const NewDouble2 &eye2D,
+		const NewDouble2 &cameraDir, Degrees fovX, int chunkDistance, double fogDistance,
+		const EntityManager &entityManager, std::vector<const Entity*> *outViewChunkEntities,
+		std::vector<const Entity*> *outCulledChunkEntities)
+	{
+		// Get the min and max chunk coordinates to loop over.
+		ChunkInt2 minChunk, maxChunk;
+		ChunkUtils::getSurroundingChunks(cameraChunk, chunkDistance, &minChunk, &maxChunk);
+
+		// 2D view frustum out to the fog distance. A flat is only drawn if its center is in front
+		// of the camera and its edge is within the fog distance, so it's inside this triangle
+		// grown by the flat's radius.
+		const double frustumDistance = fogDistance + RenderDataBuilder::ENTITY_CULL_RADIUS;
+		const NewDouble2 cameraMaxPoint = eye2D + (cameraDir * frustumDistance);
+		const double frustumHalfWidth = frustumDistance * std::tan((fovX * 0.50) * Constants::DegToRad);
+		const NewDouble2 cameraFrustumP0 = eye2D;
+		const NewDouble2 cameraFrustumP1 = cameraMaxPoint + (cameraDir.rightPerp() * frustumHalfWidth);
+		const NewDouble2 cameraFrustumP2 = cameraMaxPoint + (cameraDir.leftPerp() * frustumHalfWidth);
+
+		// Chunks are tested as the circle around their corners.
+		constexpr double chunkHalfDim = static_cast<double>(ChunkUtils::CHUNK_DIM) * 0.50;
+		const double chunkCullRadius = (chunkHalfDim * std::sqrt(2.0)) + RenderDataBuilder::ENTITY_CULL_RADIUS;
+
+		// The entity manager keeps entities grouped by chunk as they move, so each chunk's entities
+		// are appended directly.
+		for (WEInt chunkZ = minChunk.y; chunkZ <= maxChunk.y; chunkZ++)
+		{
+			for (SNInt chunkX = minChunk.x; chunkX <= maxChunk.x; chunkX++)
+			{
+				const ChunkInt2 chunk(chunkX, chunkZ);
+				const int count = entityManager.getTotalCountInChunk(chunk);
+				if (count == 0)
+				{
+					continue;
+				}
+
+				const NewInt2 chunkVoxel = VoxelUtils::chunkVoxelToNewVoxel(chunk, VoxelInt2(0, 0));
+				const NewDouble2 chunkCenter(
+					static_cast<SNDouble>(chunkVoxel.x) + chunkHalfDim,
+					static_cast<WEDouble>(chunkVoxel.y) + chunkHalfDim);
+				const bool chunkInView = MathUtils::triangleCircleIntersection(
+					cameraFrustumP0, cameraFrustumP1, cameraFrustumP2, chunkCenter, chunkCullRadius);
+
+				std::vector<const Entity*> &outEntities = chunkInView ? *outViewChunkEntities : *outCulledChunkEntities;
+				const size_t insertIndex = outEntities.size();
+				outEntities.resize(insertIndex + count);
+
+				const int writtenCount = entityManager.getTotalEntitiesInChunk(
+					chunk, outEntities.data() + insertIndex, count);
+				DebugAssert(writtenCount <= count);
+				outEntities.resize(insertIndex + writtenCount);
+			}
+		}
+	}
+}
+
+RenderCamera RenderDataBuilder::makeCamera(const Double3 &eye, const Double3 &direction,
+	Degrees fovY, double aspect)
+{
+	const ChunkInt2 chunk(
+		static_cast<int>(std::floor(eye.x / static_cast<double>(ChunkUtils::CHUNK_DIM))),
+		static_cast<int>(std::floor(eye.z / static_cast<double>(ChunkUtils::CHUNK_DIM))));
+	const VoxelDouble3 voxel(
+		eye.x - static_cast<double>(chunk.x * ChunkUtils::CHUNK_DIM),
+		eye.y,
+		eye.z - static_cast<double>(chunk.y * ChunkUtils::CHUNK_DIM));
+	const Degrees fovX = MathUtils::verticalFovToHorizontalFov(fovY, aspect);
+
+	RenderCamera camera;
+	camera.init(chunk, voxel, direction, fovX, fovY);
+	return camera;
+}
+
+int RenderDataBuilder::updateDefinitions(const VoxelGrid &voxelGrid,
+	RenderDefinitionGroup *outDefGroup)
+{
+	const bool sizeChanged = (outDefGroup->getWidth() != voxelGrid.getWidth()) ||
+		(outDefGroup->getHeight() != voxelGrid.getHeight()) ||
+		(outDefGroup->getDepth() != voxelGrid.getDepth());
+	if (sizeChanged)
+	{
+		outDefGroup->init(voxelGrid.getWidth(), voxelGrid.getHeight(), voxelGrid.getDepth());
+	}
+
+	int rebuiltCount = 0;
+	for (WEInt chunkZ = 0; chunkZ < outDefGroup->getChunkCountZ(); chunkZ++)
+	{
+		for (SNInt chunkX = 0; chunkX < outDefGroup->getChunkCountX(); chunkX++)
+		{
+			const uint64_t revision = voxelGrid.getChunkRevision(chunkX, chunkZ);
+			if (outDefGroup->getChunkRevision(chunkX, chunkZ) != revision)
+			{
+				BuildChunk(voxelGrid, chunkX, chunkZ, &outDefGroup->getChunkRenderDef(chunkX, chunkZ));
+				outDefGroup->setChunkRevision(chunkX, chunkZ, revision);
+				rebuiltCount++;
+			}
+		}
+	}
+
+	return rebuiltCount;
+}
+
+void RenderDataBuilder::updateInstances(const std::vector<LevelData::DoorState> &openDoors,
+	const std::vector<LevelData::FadeState> &fadingVoxels,
+	const LevelData::ChasmStates &chasmStates, RenderInstanceGroup *outInstGroup)
+{
+	outInstGroup->init(openDoors, fadingVoxels, chasmStates);
+}
+
+void RenderDataBuilder::updateEntityInstances(const RenderCamera &camera, int chunkDistance,
+	double fogDistance, double ceilingHeight, bool nightLightsAreActive, const VoxelGrid &voxelGrid,
+	const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary,
+	RenderInstanceGroup *outInstGroup)
+{
+	const Double3 eye = camera.getAbsolutePosition();
+	const Double3 &direction = camera.getDirection();
+	const Double3 forwardXZ = Double3(direction.x, 0.0, direction.z).normalized();
+	const NewDouble2 eye2D(eye.x, eye.z);
+	const NewDouble2 cameraDir(forwardXZ.x, forwardXZ.z);
+
+	std::vector<const Entity*> viewChunkEntities, culledChunkEntities;
+	GetNearbyEntities(camera.getChunk(), eye2D, cameraDir, camera.getFovX(), chunkDistance,
+		fogDistance, entityManager, &viewChunkEntities, &culledChunkEntities);
+
+	const int viewChunkEntityCount = static_cast<int>(viewChunkEntities.size());
+	const int culledChunkEntityCount = static_cast<int>(culledChunkEntities.size());
+	outInstGroup->clearEntities(viewChunkEntityCount, culledChunkEntityCount);
+
+	for (int i = 0; i < (viewChunkEntityCount + culledChunkEntityCount); i++)
+	{
+		const bool inCulledChunk = i >= viewChunkEntityCount;
+		const Entity *entity = inCulledChunk ?
+			culledChunkEntities[i - viewChunkEntityCount] : viewChunkEntities[i];
+
+		// Entities can currently be null because of EntityGroup implementation details.
+		if (entity == nullptr)
+		{
+			continue;
+		}
+
+		const EntityDefinition &entityDef = entityManager.getEntityDef(
+			entity->getDefinitionID(), entityDefLibrary);
+
+		// See if the entity is a light.
+		int lightIntensity;
+		if (!EntityUtils::tryGetLightIntensity(entityDef, &lightIntensity))
+		{
+			constexpr int streetLightIntensity = 4;
+			const bool isActiveStreetLight = ((entityDef.getType() == EntityDefinition::Type::Doodad) &&
+				entityDef.getDoodad().streetlight) && nightLightsAreActive;
+			lightIntensity = isActiveStreetLight ? streetLightIntensity : 0;
+		}
+
+		// The flat's center must be in front of the camera to be visible. This is checked before
+		// getting animation data since that is most of the per-entity cost.
+		const NewDouble2 flatEyeDiff = entity->getPosition() - eye2D;
+		const bool inFrontOfCamera = cameraDir.dot(flatEyeDiff) > 0.0;
+		const bool canBeVisible = !inCulledChunk && inFrontOfCamera;
+		if ((lightIntensity == 0) && !canBeVisible)
+		{
+			continue;
+		}
+
+		EntityManager::EntityVisibilityData visData;
+		entityManager.getEntityVisibilityData(*entity, eye2D, ceilingHeight, voxelGrid,
+			entityDefLibrary, visData);
+
+		// Get entity animation state to determine render properties.
+		const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
+		const EntityAnimationDefinition::State &animDefState = animDef.getState(visData.stateIndex);
+		const EntityAnimationDefinition::KeyframeList &animDefKeyframeList =
+			animDefState.getKeyframeList(visData.angleIndex);
+		const EntityAnimationDefinition::Keyframe &animDefKeyframe =
+			animDefKeyframeList.getKeyframe(visData.keyframeIndex);
+
+		EntityRenderInstance entityInst;
+		entityInst.init(visData.flatPosition, animDefKeyframe.getWidth(), animDefKeyframe.getHeight(),
+			entity->getID(), entity->getRenderID(), visData.stateIndex, visData.angleIndex,
+			visData.keyframeIndex, lightIntensity, entity->getEntityType() == EntityType::Static,
+			canBeVisible);
+		outInstGroup->addEntity(entityInst);
+	}
+}
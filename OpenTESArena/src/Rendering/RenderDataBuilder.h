@@ -1,18 +1,46 @@
 #ifndef RENDER_DATA_BUILDER_H
 #define RENDER_DATA_BUILDER_H
 
+#include <vector>
+
 #include "RenderCamera.h"
 #include "RenderDefinitionGroup.h"
 #include "RenderInstanceGroup.h"
+#include "../Math/MathUtils.h"
+#include "../Math/Vector3.h"
+#include "../World/LevelData.h"
 
 // Generates bulk render data from gameplay data to be passed to a renderer.
 
+class EntityDefinitionLibrary;
+class EntityManager;
+class VoxelGrid;
+
 namespace RenderDataBuilder
 {
-	// @todo: pass gameplay data as parameters
-	RenderCamera makeCamera();
-	RenderDefinitionGroup makeDefinitions();
-	RenderInstanceGroup makeInstances();
+	// Farthest an entity's flat is expected to reach from its center. Chunk culling keeps any
+	// chunk within this distance of the view so wide flats near a chunk edge aren't lost.
+	constexpr double ENTITY_CULL_RADIUS = 8.0;
+
+	// Makes a camera from a position in the voxel grid.
+	RenderCamera makeCamera(const Double3 &eye, const Double3 &direction, Degrees fovY, double aspect);
+
+	// Brings the chunk render definitions up to date with the voxel grid. Only chunks whose
+	// voxels changed since they were last built are rebuilt. Returns the number rebuilt.
+	int updateDefinitions(const VoxelGrid &voxelGrid, RenderDefinitionGroup *outDefGroup);
+
+	// Copies the level state that changes between ticks.
+	void updateInstances(const std::vector<LevelData::DoorState> &openDoors,
+		const std::vector<LevelData::FadeState> &fadingVoxels,
+		const LevelData::ChasmStates &chasmStates, RenderInstanceGroup *outInstGroup);
+
+	// Rebuilds the entity instances in the chunks around the camera. Whole chunks outside the
+	// camera's 2D frustum out to the fog distance are culled, and only lights are kept from them
+	// and from behind the camera.
+	void updateEntityInstances(const RenderCamera &camera, int chunkDistance, double fogDistance,
+		double ceilingHeight, bool nightLightsAreActive, const VoxelGrid &voxelGrid,
+		const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary,
+		RenderInstanceGroup *outInstGroup);
 }
 
 #endif
@@ -1 +1,113 @@
-#include "RenderDefinitionGroup.h"
\ No newline at end of file
+#include <algorithm>
+
+#include "RenderDefinitionGroup.h"
+#include "../World/ChunkUtils.h"
+
+#include "components/debug/Debug.h"
+
+RenderDefinitionGroup::RenderDefinitionGroup()
+{
+	this->width = 0;
+	this->height = 0;
+	this->depth = 0;
+	this->chunkCountX = 0;
+	this->chunkCountZ = 0;
+}
+
+void RenderDefinitionGroup::init(SNInt width, int height, WEInt depth)
+{
+	ChunkUtils::getChunkCounts(width, depth, &this->chunkCountX, &this->chunkCountZ);
+
+	const int chunkCount = this->chunkCountX * this->chunkCountZ;
+	this->chunkRenderDefs = std::vector<ChunkRenderDefinition>(chunkCount);
+	this->chunkRevisions = std::vector<uint64_t>(chunkCount, RenderDefinitionGroup::NO_REVISION);
+
+	// Chunks on the far edges only cover what's left of the voxel grid.
+	for (WEInt chunkZ = 0; chunkZ < this->chunkCountZ; chunkZ++)
+	{
+		for (SNInt chunkX = 0; chunkX < this->chunkCountX; chunkX++)
+		{
+			const SNInt startX = chunkX * ChunkUtils::CHUNK_DIM;
+			const WEInt startZ = chunkZ * ChunkUtils::CHUNK_DIM;
+			const SNInt chunkWidth = std::min(ChunkUtils::CHUNK_DIM, width - startX);
+			const WEInt chunkDepth = std::min(ChunkUtils::CHUNK_DIM, depth - startZ);
+			ChunkRenderDefinition &chunkRenderDef = this->getChunkRenderDef(chunkX, chunkZ);
+			chunkRenderDef.init(chunkWidth, height, chunkDepth, ChunkInt2(chunkX, chunkZ));
+		}
+	}
+
+	this->width = width;
+	this->height = height;
+	this->depth = depth;
+}
+
+SNInt RenderDefinitionGroup::getWidth() const
+{
+	return this->width;
+}
+
+int RenderDefinitionGroup::getHeight() const
+{
+	return this->height;
+}
+
+WEInt RenderDefinitionGroup::getDepth() const
+{
+	return this->depth;
+}
+
+SNInt RenderDefinitionGroup::getChunkCountX() const
+{
+	return this->chunkCountX;
+}
+
+WEInt RenderDefinitionGroup::getChunkCountZ() const
+{
+	return this->chunkCountZ;
+}
+
+ChunkRenderDefinition &RenderDefinitionGroup::getChunkRenderDef(SNInt chunkX, WEInt chunkZ)
+{
+	const int index = chunkX + (chunkZ * this->chunkCountX);
+	DebugAssertIndex(this->chunkRenderDefs, static_cast<size_t>(index));
+	return this->chunkRenderDefs[index];
+}
+
+const ChunkRenderDefinition &RenderDefinitionGroup::getChunkRenderDef(SNInt chunkX, WEInt chunkZ) const
+{
+	const int index = chunkX + (chunkZ * this->chunkCountX);
+	DebugAssertIndex(this->chunkRenderDefs, static_cast<size_t>(index));
+	return this->chunkRenderDefs[index];
+}
+
+uint64_t RenderDefinitionGroup::getChunkRevision(SNInt chunkX, WEInt chunkZ) const
+{
+	const int index = chunkX + (chunkZ * this->chunkCountX);
+	DebugAssertIndex(this->chunkRevisions, static_cast<size_t>(index));
+	return this->chunkRevisions[index];
+}
+
+const VoxelDefinition &RenderDefinitionGroup::getVoxelDef(SNInt x, int y, WEInt z) const
+{
+	// Chunk dimensions are a power of two, so the chunk and the voxel inside it come from a
+	// shift and a mask.
+	static_assert((ChunkUtils::CHUNK_DIM & (ChunkUtils::CHUNK_DIM - 1)) == 0);
+	const SNInt chunkX = x / ChunkUtils::CHUNK_DIM;
+	const WEInt chunkZ = z / ChunkUtils::CHUNK_DIM;
+	const ChunkRenderDefinition &chunkRenderDef = this->getChunkRenderDef(chunkX, chunkZ);
+	const VoxelRenderDefID id = chunkRenderDef.getVoxelRenderDefID(x & (ChunkUtils::CHUNK_DIM - 1), y,
+		z & (ChunkUtils::CHUNK_DIM - 1));
+	if (id == ChunkRenderDefinition::NO_VOXEL_ID)
+	{
+		return this->airVoxelDef;
+	}
+
+	return chunkRenderDef.getVoxelRenderDef(id).getVoxelDef();
+}
+
+void RenderDefinitionGroup::setChunkRevision(SNInt chunkX, WEInt chunkZ, uint64_t revision)
+{
+	const int index = chunkX + (chunkZ * this->chunkCountX);
+	DebugAssertIndex(this->chunkRevisions, static_cast<size_t>(index));
+	this->chunkRevisions[index] = revision;
+}
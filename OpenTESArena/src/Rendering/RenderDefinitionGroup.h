@@ -1,9 +1,15 @@
 #ifndef RENDER_DEFINITION_GROUP_H
 #define RENDER_DEFINITION_GROUP_H
 
+#include <cstdint>
+#include <vector>
+
+#include "ChunkRenderDefinition.h"
 #include "EntityRenderDefinition.h"
 #include "SkyObjectRenderDefinition.h"
 #include "VoxelRenderDefinition.h"
+#include "../World/VoxelDefinition.h"
+#include "../World/VoxelUtils.h"
 
 // Contains render definition data for shared voxel/entity/sky-object data.
 
@@ -13,11 +19,42 @@
 class RenderDefinitionGroup
 {
 private:
-	// @todo: collections of voxel/entity/sky-object render definitions
-	// - might have ChunkRenderDefinition for voxels, or not if an array is fine (indexable by
-	//   voxel render instances).
+	// @todo: collections of entity/sky-object render definitions
+
+	// One per chunk of the voxel grid, ordered by X then Z. Each remembers the voxel grid
+	// revision it was built from so only changed chunks are rebuilt.
+	std::vector<ChunkRenderDefinition> chunkRenderDefs;
+	std::vector<uint64_t> chunkRevisions;
+	VoxelDefinition airVoxelDef; // For voxels with nothing to render.
+	SNInt width, chunkCountX;
+	int height;
+	WEInt depth, chunkCountZ;
 public:
+	// Revision for chunks that have never been built.
+	static constexpr uint64_t NO_REVISION = 0;
+
+	RenderDefinitionGroup();
+
+	// Sizes the chunks to cover a voxel grid of the given dimensions. Every chunk is left
+	// empty with no revision.
+	void init(SNInt width, int height, WEInt depth);
+
+	// Voxel grid dimensions.
+	SNInt getWidth() const;
+	int getHeight() const;
+	WEInt getDepth() const;
+
+	SNInt getChunkCountX() const;
+	WEInt getChunkCountZ() const;
+	ChunkRenderDefinition &getChunkRenderDef(SNInt chunkX, WEInt chunkZ);
+	const ChunkRenderDefinition &getChunkRenderDef(SNInt chunkX, WEInt chunkZ) const;
+	uint64_t getChunkRevision(SNInt chunkX, WEInt chunkZ) const;
+
+	// Gets the definition of the voxel at the given voxel grid coordinate, or air if there is
+	// nothing to render.
+	const VoxelDefinition &getVoxelDef(SNInt x, int y, WEInt z) const;
 
+	void setChunkRevision(SNInt chunkX, WEInt chunkZ, uint64_t revision);
 };
 
 #endif
@@ -4,12 +4,26 @@
 class RenderFrameSettings
 {
 private:
-	// @todo: shader variables for a given frame, time of day, delta time, etc.
-	// - things that don't fit into camera or bulk voxel/entity/sky-object data.
-	// - ceiling height
-	double resolutionScale;
+	// Shader variables for a given frame, time of day, etc. Things that don't fit into camera
+	// or bulk voxel/entity/sky-object data.
+	// @todo: delta time.
+	double ambient, daytimePercent, chasmAnimPercent, latitude, ceilingHeight;
+	int chunkDistance;
+	bool nightLightsAreActive, isExterior, playerHasLight;
 public:
-	void init();
+	void init(double ambient, double daytimePercent, double chasmAnimPercent, double latitude,
+		double ceilingHeight, int chunkDistance, bool nightLightsAreActive, bool isExterior,
+		bool playerHasLight);
+
+	double getAmbient() const;
+	double getDaytimePercent() const;
+	double getChasmAnimPercent() const;
+	double getLatitude() const;
+	double getCeilingHeight() const;
+	int getChunkDistance() const;
+	bool getNightLightsAreActive() const;
+	bool getIsExterior() const;
+	bool getPlayerHasLight() const;
 };
 
 #endif
@@ -1 +1,49 @@
-#include "RenderInitSettings.h"
\ No newline at end of file
+#include "RenderInitSettings.h"
+
+void RenderInitSettings::init(int width, int height, int renderThreadsMode,
+	bool renderThreadsWorkStealing, bool columnMajorFrameBuffer, bool checkerboardRendering,
+	bool pipelinedRendering)
+{
+	this->width = width;
+	this->height = height;
+	this->renderThreadsMode = renderThreadsMode;
+	this->renderThreadsWorkStealing = renderThreadsWorkStealing;
+	this->columnMajorFrameBuffer = columnMajorFrameBuffer;
+	this->checkerboardRendering = checkerboardRendering;
+	this->pipelinedRendering = pipelinedRendering;
+}
+
+int RenderInitSettings::getWidth() const
+{
+	return this->width;
+}
+
+int RenderInitSettings::getHeight() const
+{
+	return this->height;
+}
+
+int RenderInitSettings::getRenderThreadsMode() const
+{
+	return this->renderThreadsMode;
+}
+
+bool RenderInitSettings::getRenderThreadsWorkStealing() const
+{
+	return this->renderThreadsWorkStealing;
+}
+
+bool RenderInitSettings::getColumnMajorFrameBuffer() const
+{
+	return this->columnMajorFrameBuffer;
+}
+
+bool RenderInitSettings::getCheckerboardRendering() const
+{
+	return this->checkerboardRendering;
+}
+
+bool RenderInitSettings::getPipelinedRendering() const
+{
+	return this->pipelinedRendering;
+}
@@ -4,14 +4,26 @@
 class RenderInitSettings
 {
 private:
-	// @todo: rarely modified values
-	// - i.e. max render width/height of window, aspect ratio, max thread count of hardware.
+	// Rarely modified values.
+	// @todo: max render width/height of window, aspect ratio, max thread count of hardware.
 	// - note that it's _max_ thread count; the render frame settings can say what fraction to use
 	//   and the renderer will just limit its for loop to giving work to that fraction.
 
 	// @todo: might also contain SDL window handle for use with present().
+	int width, height;
+	int renderThreadsMode;
+	bool renderThreadsWorkStealing, columnMajorFrameBuffer, checkerboardRendering, pipelinedRendering;
 public:
-	void init();
+	void init(int width, int height, int renderThreadsMode, bool renderThreadsWorkStealing,
+		bool columnMajorFrameBuffer, bool checkerboardRendering, bool pipelinedRendering);
+
+	int getWidth() const;
+	int getHeight() const;
+	int getRenderThreadsMode() const;
+	bool getRenderThreadsWorkStealing() const;
+	bool getColumnMajorFrameBuffer() const;
+	bool getCheckerboardRendering() const;
+	bool getPipelinedRendering() const;
 };
 
 #endif
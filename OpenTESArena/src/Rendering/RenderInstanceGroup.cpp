@@ -1 +1,58 @@
-#include "RenderInstanceGroup.h"
\ No newline at end of file
+#include "RenderInstanceGroup.h"
+
+RenderInstanceGroup::RenderInstanceGroup()
+{
+	this->potentiallyVisibleEntityCount = 0;
+	this->culledChunkEntityCount = 0;
+}
+
+void RenderInstanceGroup::init(const std::vector<LevelData::DoorState> &openDoors,
+	const std::vector<LevelData::FadeState> &fadingVoxels,
+	const LevelData::ChasmStates &chasmStates)
+{
+	this->openDoors = openDoors;
+	this->fadingVoxels = fadingVoxels;
+	this->chasmStates = chasmStates;
+}
+
+const std::vector<LevelData::DoorState> &RenderInstanceGroup::getOpenDoors() const
+{
+	return this->openDoors;
+}
+
+const std::vector<LevelData::FadeState> &RenderInstanceGroup::getFadingVoxels() const
+{
+	return this->fadingVoxels;
+}
+
+const LevelData::ChasmStates &RenderInstanceGroup::getChasmStates() const
+{
+	return this->chasmStates;
+}
+
+void RenderInstanceGroup::clearEntities(int potentiallyVisibleEntityCount, int culledChunkEntityCount)
+{
+	this->entityInsts.clear();
+	this->potentiallyVisibleEntityCount = potentiallyVisibleEntityCount;
+	this->culledChunkEntityCount = culledChunkEntityCount;
+}
+
+void RenderInstanceGroup::addEntity(const EntityRenderInstance &entityInst)
+{
+	this->entityInsts.push_back(entityInst);
+}
+
+const std::vector<EntityRenderInstance> &RenderInstanceGroup::getEntities() const
+{
+	return this->entityInsts;
+}
+
+int RenderInstanceGroup::getPotentiallyVisibleEntityCount() const
+{
+	return this->potentiallyVisibleEntityCount;
+}
+
+int RenderInstanceGroup::getCulledChunkEntityCount() const
+{
+	return this->culledChunkEntityCount;
+}
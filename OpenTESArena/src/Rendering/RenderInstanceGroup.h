@@ -1,20 +1,52 @@
 #ifndef RENDER_INSTANCE_GROUP_H
 #define RENDER_INSTANCE_GROUP_H
 
+#include <vector>
+
 #include "EntityRenderInstance.h"
 #include "SkyObjectRenderInstance.h"
 #include "VoxelRenderInstance.h"
+#include "../World/LevelData.h"
 
 // All unique instances of voxels/entities/sky-objects in the game world that have positions,
 // shader variables, etc. for their current state.
 
+// For now this is a copy of the level state the renderer reads while drawing, taken after the
+// game tick so a frame can be drawn while the next tick changes the level. Voxels are read from
+// the render definition group instead, which only changes between frames. Entities are rebuilt
+// every frame from the camera's point of view.
+
 class RenderInstanceGroup
 {
 private:
-	// @todo: all voxel/entity/sky-object render instances, with whatever references into
-	// render definition group entries needed.
+	// @todo: all voxel/sky-object render instances, with whatever references into render
+	// definition group entries needed.
+	std::vector<LevelData::DoorState> openDoors;
+	std::vector<LevelData::FadeState> fadingVoxels;
+	LevelData::ChasmStates chasmStates;
+	std::vector<EntityRenderInstance> entityInsts;
+	int potentiallyVisibleEntityCount; // Entities in chunks overlapping the view.
+	int culledChunkEntityCount; // Entities in chunks outside the view, only kept if they're lights.
 public:
+	RenderInstanceGroup();
+
+	// Copies the given level state, reusing this group's allocations where possible.
+	void init(const std::vector<LevelData::DoorState> &openDoors,
+		const std::vector<LevelData::FadeState> &fadingVoxels,
+		const LevelData::ChasmStates &chasmStates);
+
+	const std::vector<LevelData::DoorState> &getOpenDoors() const;
+	const std::vector<LevelData::FadeState> &getFadingVoxels() const;
+	const LevelData::ChasmStates &getChasmStates() const;
+
+	// Removes the previous frame's entities, keeping their allocation. The counts are before
+	// any entities are skipped for not being visible or lights.
+	void clearEntities(int potentiallyVisibleEntityCount, int culledChunkEntityCount);
+	void addEntity(const EntityRenderInstance &entityInst);
 
+	const std::vector<EntityRenderInstance> &getEntities() const;
+	int getPotentiallyVisibleEntityCount() const;
+	int getCulledChunkEntityCount() const;
 };
 
 #endif
@@ -5,6 +5,8 @@
 
 #include "SDL.h"
 
+#include "RenderDataBuilder.h"
+#include "RenderFrameSettings.h"
 #include "Renderer.h"
 #include "../Entities/EntityAnimationInstance.h"
 #include "../Interface/CursorAlignment.h"
@@ -32,7 +34,22 @@ Renderer::ProfilerData::ProfilerData()
 	this->potentiallyVisFlatCount = 0;
 	this->visFlatCount = 0;
 	this->visLightCount = 0;
+	this->phaseSeconds.fill(0.0);
+	this->visDistantObjsSeconds = 0.0;
+	this->visFlatsSeconds = 0.0;
+	this->visLightListsSeconds = 0.0;
+	this->skyReused = false;
+	this->lightsBinned = 0;
+	this->lightCellsTouched = 0;
+	this->culledChunkFlatCount = 0;
+	this->flatSortShifts = 0;
+	this->checkerboarded = false;
+	this->chunkDefsRebuilt = 0;
+	this->voxelOverdraw = 0.0;
+	this->textureBytes = 0;
 	this->frameTime = 0.0;
+	this->resolutionScale = 0.0;
+	this->latency = 0.0;
 }
 
 const char *Renderer::DEFAULT_RENDER_SCALE_QUALITY = "nearest";
@@ -50,6 +67,12 @@ Renderer::Renderer()
 	this->renderer = nullptr;
 	this->letterboxMode = 0;
 	this->fullGameWindow = false;
+	this->headless = false;
+	this->pipelinedRendering = false;
+	this->hasPipelinedFrame = false;
+	this->chunkDefsRebuilt = 0;
+	this->resolutionScale = 1.0;
+	this->appliedResolutionScale = 1.0;
 }
 
 Renderer::~Renderer()
@@ -114,6 +137,90 @@ int Renderer::makeRendererDimension(int value, double resolutionScale)
 		std::round(static_cast<double>(value) * resolutionScale)), 1);
 }
 
+void Renderer::resetPipelinedFrameBuffer()
+{
+	// The 3D renderer might still be drawing into the old buffer.
+	this->softwareRenderer.finishFrame();
+
+	int frameSize = 0;
+	if (this->pipelinedRendering)
+	{
+		frameSize = this->headless ? static_cast<int>(this->headlessFrameBuffer.size()) :
+			(this->gameWorldTexture.getWidth() * this->gameWorldTexture.getHeight());
+	}
+
+	this->pipelinedFrameBuffer = std::vector<uint32_t>(frameSize);
+	this->hasPipelinedFrame = false;
+}
+
+double Renderer::getTargetResolutionScale() const
+{
+	return this->dynamicResolution.isEnabled() ?
+		this->dynamicResolution.getScale() : this->resolutionScale;
+}
+
+void Renderer::resizeGameWorld()
+{
+	DebugAssert(this->softwareRenderer.isInited());
+
+	// The 3D renderer might still be drawing into the old buffer.
+	this->softwareRenderer.finishFrame();
+
+	const double resolutionScale = this->getTargetResolutionScale();
+	const int screenWidth = this->getWindowDimensions().x;
+
+	// Height of the game world view in pixels. Determined by whether the game 
+	// interface is visible or not.
+	const int viewHeight = this->getViewHeight();
+
+	// Calculate renderer dimensions.
+	const int renderWidth = Renderer::makeRendererDimension(screenWidth, resolutionScale);
+	const int renderHeight = Renderer::makeRendererDimension(viewHeight, resolutionScale);
+
+	// Reinitialize the game world frame buffer.
+	if (this->headless)
+	{
+		this->headlessFrameBuffer = std::vector<uint32_t>(renderWidth * renderHeight);
+	}
+	else
+	{
+		this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
+		DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
+			"Couldn't recreate game world texture, " + std::string(SDL_GetError()));
+	}
+
+	// Resize 3D renderer.
+	this->softwareRenderer.resize(renderWidth, renderHeight);
+	this->resetPipelinedFrameBuffer();
+	this->appliedResolutionScale = resolutionScale;
+}
+
+void Renderer::updateProfilerData()
+{
+	const SoftwareRenderer::ProfilerData swProfilerData = this->softwareRenderer.getProfilerData();
+	this->profilerData.width = swProfilerData.width;
+	this->profilerData.height = swProfilerData.height;
+	this->profilerData.potentiallyVisFlatCount = swProfilerData.potentiallyVisFlatCount;
+	this->profilerData.visFlatCount = swProfilerData.visFlatCount;
+	this->profilerData.visLightCount = swProfilerData.visLightCount;
+	this->profilerData.phaseWaits = swProfilerData.phaseWaits;
+	this->profilerData.phaseSeconds = swProfilerData.phaseSeconds;
+	this->profilerData.visDistantObjsSeconds = swProfilerData.visDistantObjsSeconds;
+	this->profilerData.visFlatsSeconds = swProfilerData.visFlatsSeconds;
+	this->profilerData.visLightListsSeconds = swProfilerData.visLightListsSeconds;
+	this->profilerData.skyReused = swProfilerData.skyReused;
+	this->profilerData.lightsBinned = swProfilerData.lightsBinned;
+	this->profilerData.lightCellsTouched = swProfilerData.lightCellsTouched;
+	this->profilerData.culledChunkFlatCount = swProfilerData.culledChunkFlatCount;
+	this->profilerData.flatSortShifts = swProfilerData.flatSortShifts;
+	this->profilerData.checkerboarded = swProfilerData.checkerboarded;
+	this->profilerData.chunkDefsRebuilt = this->chunkDefsRebuilt;
+	this->profilerData.voxelOverdraw = swProfilerData.voxelOverdraw;
+	this->profilerData.textureBytes = swProfilerData.textureBytes;
+	this->profilerData.threadTimings = swProfilerData.threadTimings;
+}
+
 double Renderer::getLetterboxAspect() const
 {
 	if (this->letterboxMode == 0)
@@ -140,6 +247,11 @@ double Renderer::getLetterboxAspect() const
 
 Int2 Renderer::getWindowDimensions() const
 {
+	if (this->headless)
+	{
+		return this->headlessDimensions;
+	}
+
 	const SDL_Surface *nativeSurface = SDL_GetWindowSurface(this->window);
 	return Int2(nativeSurface->w, nativeSurface->h);
 }
@@ -242,6 +354,36 @@ Surface Renderer::getScreenshot() const
 	return screenshot;
 }
 
+bool Renderer::isHeadless() const
+{
+	return this->headless;
+}
+
+const std::vector<uint32_t> &Renderer::getHeadlessFrameBuffer() const
+{
+	DebugAssert(this->headless);
+	return this->headlessFrameBuffer;
+}
+
+void Renderer::flushHeadlessFrame()
+{
+	DebugAssert(this->headless);
+	if (!this->pipelinedRendering || !this->hasPipelinedFrame)
+	{
+		return;
+	}
+
+	this->softwareRenderer.finishFrame();
+	this->updateProfilerData();
+	std::copy(this->pipelinedFrameBuffer.begin(), this->pipelinedFrameBuffer.end(),
+		this->headlessFrameBuffer.begin());
+
+	const auto shownTime = std::chrono::high_resolution_clock::now();
+	this->profilerData.latency = static_cast<double>(
+		(shownTime - this->pipelinedFrameStartTime).count()) / static_cast<double>(std::nano::den);
+	this->hasPipelinedFrame = false;
+}
+
 const Renderer::ProfilerData &Renderer::getProfilerData() const
 {
 	return this->profilerData;
@@ -469,6 +611,20 @@ void Renderer::init(int width, int height, WindowMode windowMode, int letterboxM
 	this->fullGameWindow = false;
 }
 
+void Renderer::initHeadless(int width, int height)
+{
+	DebugLog("Initializing headless.");
+
+	DebugAssert(width > 0);
+	DebugAssert(height > 0);
+	DebugAssert(this->window == nullptr);
+
+	this->headless = true;
+	this->headlessDimensions = Int2(width, height);
+	this->letterboxMode = 0;
+	this->fullGameWindow = false;
+}
+
 void Renderer::resize(int width, int height, double resolutionScale, bool fullGameWindow)
 {
 	// The window's dimensions are resized automatically by SDL. The renderer's are not.
@@ -485,26 +641,12 @@ void Renderer::resize(int width, int height, double resolutionScale, bool fullGa
 		"Couldn't recreate native frame buffer, " + std::string(SDL_GetError()));
 
 	this->fullGameWindow = fullGameWindow;
+	this->resolutionScale = resolutionScale;
 
 	// Rebuild the 3D renderer if initialized.
 	if (this->softwareRenderer.isInited())
 	{
-		// Height of the game world view in pixels. Determined by whether the game 
-		// interface is visible or not.
-		const int viewHeight = this->getViewHeight();
-
-		// Calculate renderer dimensions.
-		const int renderWidth = Renderer::makeRendererDimension(width, resolutionScale);
-		const int renderHeight = Renderer::makeRendererDimension(viewHeight, resolutionScale);
-
-		// Reinitialize the game world frame buffer.
-		this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
-			SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
-		DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
-			"Couldn't recreate game world texture, " + std::string(SDL_GetError()));
-
-		// Resize 3D renderer.
-		this->softwareRenderer.resize(renderWidth, renderHeight);
+		this->resizeGameWorld();
 	}
 }
 
@@ -557,9 +699,16 @@ void Renderer::setClipRect(const SDL_Rect *rect)
 }
 
 void Renderer::initializeWorldRendering(double resolutionScale, bool fullGameWindow,
-	int renderThreadsMode)
+	int renderThreadsMode, bool renderThreadsWorkStealing, bool columnMajorFrameBuffer,
+	bool checkerboardRendering, bool pipelinedRendering)
 {
+	// A pipelined frame might still be drawing into the old buffers.
+	this->softwareRenderer.finishFrame();
 	this->fullGameWindow = fullGameWindow;
+	this->resolutionScale = resolutionScale;
+
+	// Dynamic resolution starts from its last step instead of the options value.
+	resolutionScale = this->getTargetResolutionScale();
 
 	const int screenWidth = this->getWindowDimensions().x;
 
@@ -572,13 +721,25 @@ void Renderer::initializeWorldRendering(double resolutionScale, bool fullGameWin
 	const int renderHeight = Renderer::makeRendererDimension(viewHeight, resolutionScale);
 
 	// Initialize a new game world frame buffer, removing any previous game world frame buffer.
-	this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
-		SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
-	DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
-		"Couldn't create game world texture, " + std::string(SDL_GetError()));
+	if (this->headless)
+	{
+		this->headlessFrameBuffer = std::vector<uint32_t>(renderWidth * renderHeight);
+	}
+	else
+	{
+		this->gameWorldTexture = this->createTexture(Renderer::DEFAULT_PIXELFORMAT,
+			SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
+		DebugAssertMsg(this->gameWorldTexture.get() != nullptr,
+			"Couldn't create game world texture, " + std::string(SDL_GetError()));
+	}
 
 	// Initialize 3D rendering.
-	this->softwareRenderer.init(renderWidth, renderHeight, renderThreadsMode);
+	this->softwareRenderer.init(renderWidth, renderHeight, renderThreadsMode,
+		renderThreadsWorkStealing, columnMajorFrameBuffer, checkerboardRendering, pipelinedRendering);
+
+	this->pipelinedRendering = pipelinedRendering;
+	this->resetPipelinedFrameBuffer();
+	this->appliedResolutionScale = resolutionScale;
 }
 
 void Renderer::setRenderThreadsMode(int mode)
@@ -587,12 +748,76 @@ void Renderer::setRenderThreadsMode(int mode)
 	this->softwareRenderer.setRenderThreadsMode(mode);
 }
 
+void Renderer::setRenderThreadsWorkStealing(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setRenderThreadsWorkStealing(enabled);
+}
+
+void Renderer::setColumnMajorFrameBuffer(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setColumnMajorFrameBuffer(enabled);
+}
+
+void Renderer::setCheckerboardRendering(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setCheckerboardRendering(enabled);
+}
+
+void Renderer::setPipelinedRendering(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setPipelinedRendering(enabled);
+	this->pipelinedRendering = enabled;
+	this->resetPipelinedFrameBuffer();
+}
+
+void Renderer::setOcclusionSpans(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setOcclusionSpans(enabled);
+}
+
+void Renderer::setRayPackets(bool enabled)
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.setRayPackets(enabled);
+}
+
+void Renderer::setDynamicResolution(bool enabled, double minScale, double maxScale, int targetFps)
+{
+	DebugAssert(targetFps > 0);
+	const double targetFrameTime = 1.0 / static_cast<double>(targetFps);
+	this->dynamicResolution.init(enabled, minScale, maxScale, targetFrameTime,
+		this->resolutionScale);
+
+	if (this->softwareRenderer.isInited() &&
+		(this->getTargetResolutionScale() != this->appliedResolutionScale))
+	{
+		this->resizeGameWorld();
+	}
+}
+
 void Renderer::setFogDistance(double fogDistance)
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.setFogDistance(fogDistance);
 }
 
+void Renderer::beginTextureBatch()
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.beginTextureBatch();
+}
+
+void Renderer::endTextureBatch()
+{
+	DebugAssert(this->softwareRenderer.isInited());
+	this->softwareRenderer.endTextureBatch();
+}
+
 void Renderer::setVoxelTexture(int id, const uint8_t *srcTexels, const Palette &palette)
 {
 	DebugAssert(this->softwareRenderer.isInited());
@@ -644,6 +869,9 @@ void Renderer::clearTexturesAndEntityRenderIDs()
 {
 	DebugAssert(this->softwareRenderer.isInited());
 	this->softwareRenderer.clearTexturesAndEntityRenderIDs();
+
+	// Don't show a pipelined frame of the old level.
+	this->hasPipelinedFrame = false;
 }
 
 void Renderer::clearDistantSky()
@@ -739,33 +967,125 @@ void Renderer::renderWorld(const Double3 &eye, const Double3 &forward, double fo
 {
 	// The 3D renderer must be initialized.
 	DebugAssert(this->softwareRenderer.isInited());
+
+	// Apply any resolution step from the previous frame before drawing into the buffers.
+	if (this->getTargetResolutionScale() != this->appliedResolutionScale)
+	{
+		this->resizeGameWorld();
+	}
 	
 	// Lock the game world texture and give the pixel pointer to the software renderer.
 	// - Supposedly this is faster than SDL_UpdateTexture(). In any case, there's one
 	//   less frame buffer to take care of.
-	uint32_t *gameWorldPixels;
-	int gameWorldPitch;
-	int status = SDL_LockTexture(this->gameWorldTexture.get(), nullptr,
-		reinterpret_cast<void**>(&gameWorldPixels), &gameWorldPitch);
-	DebugAssertMsg(status == 0, "Couldn't lock game world texture, " +
-		std::string(SDL_GetError()));
-
-	// Render the game world to the game world frame buffer.
+	// - Without a window, render into memory instead.
+	auto lockGameWorldPixels = [this]()
+	{
+		uint32_t *gameWorldPixels;
+		if (this->headless)
+		{
+			gameWorldPixels = this->headlessFrameBuffer.data();
+		}
+		else
+		{
+			int gameWorldPitch;
+			int status = SDL_LockTexture(this->gameWorldTexture.get(), nullptr,
+				reinterpret_cast<void**>(&gameWorldPixels), &gameWorldPitch);
+			DebugAssertMsg(status == 0, "Couldn't lock game world texture, " +
+				std::string(SDL_GetError()));
+		}
+
+		return gameWorldPixels;
+	};
+
+	// Brings the render groups up to date with the game world and draws them. The groups are
+	// only changed once the 3D renderer is done with the previous frame.
+	auto drawGameWorld = [&](uint32_t *colorBuffer)
+	{
+		this->softwareRenderer.finishFrame();
+
+		// Only chunks whose voxels changed since the last frame are rebuilt.
+		this->chunkDefsRebuilt = RenderDataBuilder::updateDefinitions(voxelGrid, &this->renderDefGroup);
+
+		const double aspect = static_cast<double>(this->getWindowDimensions().x) /
+			static_cast<double>(this->getViewHeight());
+		const RenderCamera camera = RenderDataBuilder::makeCamera(eye, forward, fovY, aspect);
+		RenderDataBuilder::updateInstances(openDoors, fadingVoxels, chasmStates, &this->renderInstGroup);
+		RenderDataBuilder::updateEntityInstances(camera, chunkDistance,
+			this->softwareRenderer.getFogDistance(), ceilingHeight, nightLightsAreActive, voxelGrid,
+			entityManager, entityDefLibrary, &this->renderInstGroup);
+
+		RenderFrameSettings settings;
+		settings.init(ambient, daytimePercent, chasmAnimPercent, latitude, ceilingHeight,
+			chunkDistance, nightLightsAreActive, isExterior, playerHasLight);
+
+		this->softwareRenderer.render(this->renderDefGroup, this->renderInstGroup, camera, settings,
+			colorBuffer);
+	};
+
 	const auto startTime = std::chrono::high_resolution_clock::now();
-	this->softwareRenderer.render(eye, forward, fovY, ambient, daytimePercent, chasmAnimPercent,
-		latitude, nightLightsAreActive, isExterior, playerHasLight, chunkDistance, ceilingHeight,
-		openDoors, fadingVoxels, chasmStates, voxelGrid, entityManager, entityDefLibrary, gameWorldPixels);
-	const auto endTime = std::chrono::high_resolution_clock::now();
+	if (this->pipelinedRendering)
+	{
+		// The previous frame is finished and shown, then this frame is handed to the render
+		// threads and drawn while the next game tick runs.
+		auto showPipelinedFrame = [this, &lockGameWorldPixels]()
+		{
+			this->softwareRenderer.finishFrame();
+			this->updateProfilerData();
 
-	// Update profiler stats.
-	const SoftwareRenderer::ProfilerData swProfilerData = this->softwareRenderer.getProfilerData();
-	this->profilerData.width = swProfilerData.width;
-	this->profilerData.height = swProfilerData.height;
-	this->profilerData.potentiallyVisFlatCount = swProfilerData.potentiallyVisFlatCount;
-	this->profilerData.visFlatCount = swProfilerData.visFlatCount;
-	this->profilerData.visLightCount = swProfilerData.visLightCount;
-	this->profilerData.frameTime = static_cast<double>((endTime - startTime).count()) /
-		static_cast<double>(std::nano::den);
+			uint32_t *gameWorldPixels = lockGameWorldPixels();
+			std::copy(this->pipelinedFrameBuffer.begin(), this->pipelinedFrameBuffer.end(),
+				gameWorldPixels);
+
+			const auto shownTime = std::chrono::high_resolution_clock::now();
+			this->profilerData.latency = static_cast<double>(
+				(shownTime - this->pipelinedFrameStartTime).count()) / static_cast<double>(std::nano::den);
+		};
+
+		// Without a previous frame, this frame is waited on so nothing stale is shown.
+		const bool hasPreviousFrame = this->hasPipelinedFrame;
+		if (hasPreviousFrame)
+		{
+			showPipelinedFrame();
+		}
+
+		this->pipelinedFrameStartTime = std::chrono::high_resolution_clock::now();
+		drawGameWorld(this->pipelinedFrameBuffer.data());
+
+		if (!hasPreviousFrame)
+		{
+			showPipelinedFrame();
+			this->hasPipelinedFrame = true;
+		}
+
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		this->profilerData.frameTime = static_cast<double>((endTime - startTime).count()) /
+			static_cast<double>(std::nano::den);
+	}
+	else
+	{
+		// Render the game world to the game world frame buffer.
+		uint32_t *gameWorldPixels = lockGameWorldPixels();
+		drawGameWorld(gameWorldPixels);
+		const auto endTime = std::chrono::high_resolution_clock::now();
+
+		// Update profiler stats.
+		this->updateProfilerData();
+		this->profilerData.frameTime = static_cast<double>((endTime - startTime).count()) /
+			static_cast<double>(std::nano::den);
+		this->profilerData.latency = this->profilerData.frameTime;
+	}
+
+	// Decide the next frame's resolution from this frame's time.
+	this->profilerData.resolutionScale = this->appliedResolutionScale;
+	if (this->dynamicResolution.isEnabled())
+	{
+		this->dynamicResolution.update(this->profilerData.frameTime);
+	}
+
+	if (this->headless)
+	{
+		return;
+	}
 
 	// Update the game world texture with the new ARGB8888 pixels.
 	SDL_UnlockTexture(this->gameWorldTexture.get());
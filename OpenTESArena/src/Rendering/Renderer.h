@@ -1,10 +1,15 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "DynamicResolution.h"
+#include "RenderDefinitionGroup.h"
+#include "RenderInstanceGroup.h"
 #include "SoftwareRenderer.h"
 #include "../Interface/Texture.h"
 #include "../Math/Vector2.h"
@@ -60,8 +65,49 @@ public:
 		// Visible flats and lights.
 		int potentiallyVisFlatCount, visFlatCount, visLightCount;
 
+		// Render thread wait times per phase (sky gradient, distant sky, voxels, flats).
+		std::array<SoftwareRenderer::ProfilerData::WaitHistogram,
+			SoftwareRenderer::ProfilerData::PHASE_COUNT> phaseWaits;
+
+		// Wall-clock time of each render thread phase in the most recent frame.
+		std::array<double, SoftwareRenderer::ProfilerData::PHASE_COUNT> phaseSeconds;
+
+		// Main thread visibility work in the most recent frame.
+		double visDistantObjsSeconds, visFlatsSeconds, visLightListsSeconds;
+
+		// Whether the most recent frame reused the cached sky.
+		bool skyReused;
+
+		// Light list binning work in the most recent frame.
+		int lightsBinned, lightCellsTouched;
+
+		// Flat culling and sorting work in the most recent frame.
+		int culledChunkFlatCount, flatSortShifts;
+
+		// Whether the most recent frame only drew every other column.
+		bool checkerboarded;
+
+		// Chunks whose voxel render definitions were rebuilt for the most recent frame.
+		int chunkDefsRebuilt;
+
+		// Voxel pixels shaded per frame pixel in the most recent frame.
+		double voxelOverdraw;
+
+		// Bytes of texels in the 3D renderer's textures.
+		size_t textureBytes;
+
+		// Busy and idle time of each render thread.
+		std::vector<SoftwareRenderer::ProfilerData::ThreadTiming> threadTimings;
+
 		double frameTime;
 
+		// Game world resolution scale used for the most recent frame.
+		double resolutionScale;
+
+		// Time from the frame's level state being captured to it being shown. Same as the frame
+		// time unless the frame was pipelined.
+		double latency;
+
 		ProfilerData();
 	};
 private:
@@ -72,16 +118,43 @@ private:
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	Texture nativeTexture, gameWorldTexture; // Frame buffers.
+	std::vector<uint32_t> headlessFrameBuffer; // Game world frame buffer when there's no window.
+	std::vector<uint32_t> pipelinedFrameBuffer; // Drawn into by a pipelined frame, shown on the next one.
+	std::chrono::high_resolution_clock::time_point pipelinedFrameStartTime; // When the pipelined frame was captured.
+	Int2 headlessDimensions;
 	SoftwareRenderer softwareRenderer; // Game world renderer.
+	RenderDefinitionGroup renderDefGroup; // Chunk render definitions, kept between frames.
+	RenderInstanceGroup renderInstGroup; // Level state and entities of the frame being drawn.
+	int chunkDefsRebuilt; // Chunk render definitions rebuilt for the frame being drawn.
+	DynamicResolution dynamicResolution; // Adjusts the game world resolution when enabled.
 	ProfilerData profilerData;
+	double resolutionScale; // Game world resolution scale from the options.
+	double appliedResolutionScale; // Resolution scale the game world buffers are sized for.
 	int letterboxMode; // Determines aspect ratio of the original UI (16:10, 4:3, etc.).
 	bool fullGameWindow; // Determines height of 3D frame buffer.
+	bool headless; // No window or SDL video; only the game world can be rendered.
+	bool pipelinedRendering; // Whether each game world frame is shown one frame later.
+	bool hasPipelinedFrame; // Whether the pipelined frame buffer holds a frame of the current size.
 
 	// Helper method for making a renderer context.
 	static SDL_Renderer *createRenderer(SDL_Window *window);
 
 	// Generates a renderer dimension while avoiding pitfalls of numeric imprecision.
 	static int makeRendererDimension(int value, double resolutionScale);
+
+	// Sizes the pipelined frame buffer to the game world frame buffer, or frees it when
+	// pipelined rendering is off. Any frame in it is dropped.
+	void resetPipelinedFrameBuffer();
+
+	// Gets the resolution scale the game world should be rendered at, either from the options
+	// or from dynamic resolution.
+	double getTargetResolutionScale() const;
+
+	// Reallocates the game world frame buffer and 3D renderer for the target resolution scale.
+	void resizeGameWorld();
+
+	// Copies the 3D renderer's profiler stats for the most recently finished frame.
+	void updateProfilerData();
 public:
 	// Only defined so members are initialized for Game ctor exception handling.
 	Renderer();
@@ -121,6 +194,18 @@ public:
 	// Gets a screenshot of the current window.
 	Surface getScreenshot() const;
 
+	// Returns whether the renderer was initialized without a window.
+	bool isHeadless() const;
+
+	// Gets the game world pixels from the most recent headless frame. The buffer has the
+	// dimensions of the 3D renderer and is row-major ARGB8888.
+	const std::vector<uint32_t> &getHeadlessFrameBuffer() const;
+
+	// Waits for a pipelined frame still being drawn and copies it to the headless frame buffer,
+	// so the buffer holds the most recent renderWorld() call's frame. The next frame isn't
+	// overlapped with anything since there's no previous frame left to show.
+	void flushHeadlessFrame();
+
 	// Gets profiler data (timings, renderer properties, etc.).
 	const ProfilerData &getProfilerData() const;
 
@@ -157,6 +242,10 @@ public:
 
 	void init(int width, int height, WindowMode windowMode, int letterboxMode);
 
+	// Initializes the renderer without a window or SDL video, for rendering the game world into
+	// memory (i.e., for automated testing). Drawing to the native frame buffer is not allowed.
+	void initHeadless(int width, int height);
+
 	// Resizes the renderer dimensions.
 	void resize(int width, int height, double resolutionScale, bool fullGameWindow);
 
@@ -184,13 +273,42 @@ public:
 	// the game interface. If there is an existing renderer in memory, it will be 
 	// overwritten with the new one.
 	void initializeWorldRendering(double resolutionScale, bool fullGameWindow,
-		int renderThreadsMode);
+		int renderThreadsMode, bool renderThreadsWorkStealing, bool columnMajorFrameBuffer,
+		bool checkerboardRendering, bool pipelinedRendering);
 
 	// Sets which mode to use for software render threads (low, medium, high, etc.).
 	void setRenderThreadsMode(int mode);
 
+	// Sets whether software render threads use work stealing to balance columns.
+	void setRenderThreadsWorkStealing(bool enabled);
+
+	// Sets whether the 3D world is drawn column-major and converted to row-major afterwards.
+	void setColumnMajorFrameBuffer(bool enabled);
+
+	// Sets whether the 3D world only draws every other column each frame and reprojects the rest.
+	void setCheckerboardRendering(bool enabled);
+
+	// Sets whether each 3D world frame is drawn while the next game tick runs and shown one frame
+	// later, trading latency for throughput.
+	void setPipelinedRendering(bool enabled);
+
+	// Sets whether opaque ranges anywhere in a 3D world column reject voxels behind them. On by
+	// default; turning it off is for comparing overdraw.
+	void setOcclusionSpans(bool enabled);
+
+	// Sets whether the game world resolution scale follows the 3D frame time, stepping between
+	// the given bounds to stay within the target frame rate. When off, the resolution scale from
+	// resize() and initializeWorldRendering() is used. Can be set before world rendering exists.
+	void setDynamicResolution(bool enabled, double minScale, double maxScale, int targetFps);
+
+	// Sets whether voxel rays of neighboring columns are stepped together in SIMD packets. On by
+	// default; the output is the same either way.
+	void setRayPackets(bool enabled);
+
 	// Helper methods for changing data in the 3D renderer.
 	void setFogDistance(double fogDistance);
+	void beginTextureBatch();
+	void endTextureBatch();
 	void setVoxelTexture(int id, const uint8_t *srcTexels, const Palette &palette);
 	EntityRenderID makeEntityRenderID();
 	void setFlatTextures(EntityRenderID entityRenderID, const EntityAnimationDefinition &animDef,
@@ -220,8 +338,9 @@ public:
 	void fillRect(const Color &color, int x, int y, int w, int h);
 	void fillOriginalRect(const Color &color, int x, int y, int w, int h);
 
-	// Runs the 3D renderer which draws the world onto the native frame buffer.
-	// If the renderer is uninitialized, this causes a crash.
+	// Runs the 3D renderer which draws the world onto the native frame buffer, or into the
+	// headless frame buffer if there's no window. If the renderer is uninitialized, this
+	// causes a crash.
 	void renderWorld(const Double3 &eye, const Double3 &forward, double fovY, double ambient,
 		double daytimePercent, double chasmAnimPercent, double latitude, bool nightLightsAreActive,
 		bool isExterior, bool playerHasLight, int chunkDistance, double ceilingHeight,
@@ -11,6 +11,8 @@
 class RendererInterface
 {
 public:
+	virtual ~RendererInterface() = default;
+
 	virtual void init(const RenderInitSettings &settings) = 0;
 	virtual void shutdown() = 0;
 	virtual void resize(int width, int height) = 0;
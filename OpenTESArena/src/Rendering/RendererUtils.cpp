@@ -244,3 +244,42 @@ bool RendererUtils::isBeforeNoon(double daytimePercent)
 {
 	return daytimePercent < 0.50;
 }
+
+RendererUtils::GoldenImageDiff RendererUtils::compareToGoldenImage(const uint32_t *pixels,
+	const uint32_t *goldenPixels, int pixelCount, int channelTolerance)
+{
+	DebugAssert(pixels != nullptr);
+	DebugAssert(goldenPixels != nullptr);
+
+	GoldenImageDiff diff;
+	diff.maxChannelDiff = 0;
+	diff.diffPixelCount = 0;
+	diff.totalPixelCount = pixelCount;
+
+	for (int i = 0; i < pixelCount; i++)
+	{
+		const uint32_t pixel = pixels[i];
+		const uint32_t goldenPixel = goldenPixels[i];
+		if (pixel == goldenPixel)
+		{
+			continue;
+		}
+
+		// Compare R, G, and B; alpha is not written by the renderer.
+		int pixelMaxDiff = 0;
+		for (int shift = 0; shift < 24; shift += 8)
+		{
+			const int channel = static_cast<int>((pixel >> shift) & 0xFF);
+			const int goldenChannel = static_cast<int>((goldenPixel >> shift) & 0xFF);
+			pixelMaxDiff = std::max(pixelMaxDiff, std::abs(channel - goldenChannel));
+		}
+
+		diff.maxChannelDiff = std::max(diff.maxChannelDiff, pixelMaxDiff);
+		if (pixelMaxDiff > channelTolerance)
+		{
+			diff.diffPixelCount++;
+		}
+	}
+
+	return diff;
+}
@@ -1,6 +1,7 @@
 #ifndef RENDERER_UTILS_H
 #define RENDERER_UTILS_H
 
+#include <cstdint>
 #include <vector>
 
 #include "../Math/MathUtils.h"
@@ -14,6 +15,14 @@
 
 namespace RendererUtils
 {
+	// Result of comparing a rendered frame against a reference ("golden") frame.
+	struct GoldenImageDiff
+	{
+		int maxChannelDiff; // Largest absolute difference of any one color channel.
+		int diffPixelCount; // Pixels with any channel differing by more than the tolerance.
+		int totalPixelCount;
+	};
+
 	// Gets the number of render threads to use based on the given mode.
 	int getRenderThreadsFromMode(int mode);
 
@@ -78,6 +87,11 @@ namespace RendererUtils
 	// Returns whether the given percent through the day is before noon. This affects
 	// the sliding window direction of the sky palette.
 	bool isBeforeNoon(double daytimePercent);
+
+	// Compares two ARGB8888 images of the same size channel-by-channel. Differences within the
+	// tolerance are allowed so float and double shading builds can share reference images.
+	GoldenImageDiff compareToGoldenImage(const uint32_t *pixels, const uint32_t *goldenPixels,
+		int pixelCount, int channelTolerance);
 }
 
 #endif
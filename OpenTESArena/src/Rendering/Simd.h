@@ -39,6 +39,29 @@ static_assert(simd_size == 16);
 #define simd_min(a, b) _mm512_min_ps(a, b)
 #define simd_max(a, b) _mm512_max_ps(a, b)
 #define simd_cvtepi32(a) _mm512_cvtepi32_ps(a)
+#define simd_cvttps_epi32(a) _mm512_cvttps_epi32(a)
+#define simd_load_i(ptr) _mm512_load_si512(ptr)
+#define simd_store_i(ptr, a) _mm512_store_si512(ptr, a)
+#define simd_storeu_i(ptr, a) _mm512_storeu_si512(ptr, a)
+#define simd_set1_i(a) _mm512_set1_epi32(a)
+
+#define simd_type_d __m512d
+#define simd_size_d (sizeof(simd_type_d) / sizeof(double))
+#define simd_set1_d(a) _mm512_set1_pd(a)
+#define simd_storeu_d(ptr, a) _mm512_storeu_pd(ptr, a)
+#define simd_mask_d __mmask8
+#define simd_load_d(ptr) _mm512_load_pd(ptr)
+#define simd_store_d(ptr, a) _mm512_store_pd(ptr, a)
+#define simd_add_d(a, b) _mm512_add_pd(a, b)
+#define simd_sub_d(a, b) _mm512_sub_pd(a, b)
+#define simd_div_d(a, b) _mm512_div_pd(a, b)
+#define simd_cmplt_d(a, b) _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define simd_blend_d(a, b, mask) _mm512_mask_blend_pd(mask, a, b)
+#define simd_mul_d(a, b) _mm512_mul_pd(a, b)
+#define simd_min_d(a, b) _mm512_min_pd(a, b)
+#define simd_trunc_d(a) _mm512_cvtepi32_pd(_mm512_cvttpd_epi32(a))
+#define simd_loadu_cvtepi32_d(ptr) _mm512_cvtepi32_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)))
+#define simd_storeu_cvttpd_epi32(ptr, a) _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), _mm512_cvttpd_epi32(a))
 #elif defined(HAVE_SIMD_AVX)
 #include <immintrin.h>
 #define simd_type __m256
@@ -60,8 +83,31 @@ static_assert(simd_size == 8);
 #define simd_min(a, b) _mm256_min_ps(a, b)
 #define simd_max(a, b) _mm256_max_ps(a, b)
 #define simd_cvtepi32(a) _mm256_cvtepi32_ps(a)
+#define simd_cvttps_epi32(a) _mm256_cvttps_epi32(a)
+#define simd_load_i(ptr) _mm256_load_si256(reinterpret_cast<const __m256i*>(ptr))
+#define simd_store_i(ptr, a) _mm256_store_si256(reinterpret_cast<__m256i*>(ptr), a)
+#define simd_storeu_i(ptr, a) _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), a)
+#define simd_set1_i(a) _mm256_set1_epi32(a)
+
+#define simd_type_d __m256d
+#define simd_size_d (sizeof(simd_type_d) / sizeof(double))
+#define simd_set1_d(a) _mm256_set1_pd(a)
+#define simd_storeu_d(ptr, a) _mm256_storeu_pd(ptr, a)
+#define simd_mask_d __m256d
+#define simd_load_d(ptr) _mm256_load_pd(ptr)
+#define simd_store_d(ptr, a) _mm256_store_pd(ptr, a)
+#define simd_add_d(a, b) _mm256_add_pd(a, b)
+#define simd_sub_d(a, b) _mm256_sub_pd(a, b)
+#define simd_div_d(a, b) _mm256_div_pd(a, b)
+#define simd_cmplt_d(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define simd_blend_d(a, b, mask) _mm256_blendv_pd(a, b, mask)
+#define simd_mul_d(a, b) _mm256_mul_pd(a, b)
+#define simd_min_d(a, b) _mm256_min_pd(a, b)
+#define simd_trunc_d(a) _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(a))
+#define simd_loadu_cvtepi32_d(ptr) _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)))
+#define simd_storeu_cvttpd_epi32(ptr, a) _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), _mm256_cvttpd_epi32(a))
 #elif defined(HAVE_SIMD_SSE2)
-#include <xmmintrin.h>
+#include <emmintrin.h>
 #define simd_type __m128
 #define simd_type_i __m128i
 #define simd_align alignof(simd_type)
@@ -81,6 +127,29 @@ static_assert(simd_size == 4);
 #define simd_min(a, b) _mm_min_ps(a, b)
 #define simd_max(a, b) _mm_max_ps(a, b)
 #define simd_cvtepi32(a) _mm_cvtepi32_ps(a)
+#define simd_cvttps_epi32(a) _mm_cvttps_epi32(a)
+#define simd_load_i(ptr) _mm_load_si128(reinterpret_cast<const __m128i*>(ptr))
+#define simd_store_i(ptr, a) _mm_store_si128(reinterpret_cast<__m128i*>(ptr), a)
+#define simd_storeu_i(ptr, a) _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), a)
+#define simd_set1_i(a) _mm_set1_epi32(a)
+
+#define simd_type_d __m128d
+#define simd_size_d (sizeof(simd_type_d) / sizeof(double))
+#define simd_set1_d(a) _mm_set1_pd(a)
+#define simd_storeu_d(ptr, a) _mm_storeu_pd(ptr, a)
+#define simd_mask_d __m128d
+#define simd_load_d(ptr) _mm_load_pd(ptr)
+#define simd_store_d(ptr, a) _mm_store_pd(ptr, a)
+#define simd_add_d(a, b) _mm_add_pd(a, b)
+#define simd_sub_d(a, b) _mm_sub_pd(a, b)
+#define simd_div_d(a, b) _mm_div_pd(a, b)
+#define simd_cmplt_d(a, b) _mm_cmplt_pd(a, b)
+#define simd_blend_d(a, b, mask) _mm_or_pd(_mm_and_pd(mask, b), _mm_andnot_pd(mask, a)) // No blendv before SSE4.1.
+#define simd_mul_d(a, b) _mm_mul_pd(a, b)
+#define simd_min_d(a, b) _mm_min_pd(a, b)
+#define simd_trunc_d(a) _mm_cvtepi32_pd(_mm_cvttpd_epi32(a))
+#define simd_loadu_cvtepi32_d(ptr) _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)))
+#define simd_storeu_cvttpd_epi32(ptr, a) _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), _mm_cvttpd_epi32(a))
 #else
 // Make sure HAVE_SIMD is not defined so we can still use non-vectorized paths.
 #if defined(HAVE_SIMD)
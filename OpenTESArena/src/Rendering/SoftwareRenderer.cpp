@@ -1,11 +1,17 @@
 #include <algorithm>
 #include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAVE_X86_INTRINSICS
 #include <emmintrin.h>
 #include <immintrin.h>
-#include <limits>
 #include <smmintrin.h>
+#endif
 
+#include "ColumnKernels.h"
 #include "RendererUtils.h"
+#include "Simd.h"
 #include "SoftwareRenderer.h"
 #include "../Entities/EntityAnimationInstance.h"
 #include "../Entities/EntityType.h"
@@ -20,10 +26,10 @@
 #include "../World/ChunkUtils.h"
 #include "../World/VoxelDataType.h"
 #include "../World/VoxelFacing2D.h"
-#include "../World/VoxelGrid.h"
 #include "../World/VoxelUtils.h"
 
 #include "components/debug/Debug.h"
+#include "components/utilities/Profiler.h"
 
 namespace
 {
@@ -31,6 +37,42 @@ namespace
 	constexpr int TextureFilterMode = 0;
 	constexpr bool LightContributionCap = true;
 
+	// Render thread wait budgets before falling back to the next slower waiting strategy. Gaps
+	// between phases are usually a few microseconds, so spinning covers most of them.
+	constexpr int RenderThreadSpinCount = 4096;
+	constexpr int RenderThreadYieldCount = 64;
+
+	// One step of a render thread's spin-wait. x86 has a pause hint so the sibling hyperthread
+	// keeps its execution resources; elsewhere the thread yields instead.
+	void SpinWaitPause()
+	{
+#if defined(HAVE_X86_INTRINSICS)
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	// Column tile widths for work-stealing render threads. Voxel columns are relatively uniform in
+	// cost so they use narrow tiles; flat tiles are wider since each one iterates every visible flat.
+	constexpr int VoxelColumnTileWidth = 8;
+	constexpr int FlatColumnTileWidth = 32;
+
+	// Side length in pixels of the blocks copied when converting a column-major frame to row-major.
+	constexpr int FrameSwizzleBlockSize = 16;
+
+	uint64_t PackColumnTileRange(int begin, int end)
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(begin)) |
+			(static_cast<uint64_t>(static_cast<uint32_t>(end)) << 32);
+	}
+
+	void UnpackColumnTileRange(uint64_t range, int *outBegin, int *outEnd)
+	{
+		*outBegin = static_cast<int>(static_cast<uint32_t>(range & 0xFFFFFFFF));
+		*outEnd = static_cast<int>(static_cast<uint32_t>(range >> 32));
+	}
+
 	// Hardcoded palette indices with special behavior in the original game's renderer.
 	constexpr uint8_t PALETTE_INDEX_LIGHT_LEVEL_LOWEST = 1;
 	constexpr uint8_t PALETTE_INDEX_LIGHT_LEVEL_HIGHEST = 13;
@@ -46,6 +88,34 @@ namespace
 	constexpr uint8_t PALETTE_INDEX_PUDDLE_EVEN_ROW = 30;
 	constexpr uint8_t PALETTE_INDEX_PUDDLE_ODD_ROW = 103;
 
+	// Flat and sky texel alpha uses the same steps as the original game's light level texels.
+	constexpr uint8_t TEXEL_ALPHA_OPAQUE = PALETTE_INDEX_LIGHT_LEVEL_DIVISOR;
+	constexpr double TEXEL_ALPHA_OPAQUE_REAL = static_cast<double>(TEXEL_ALPHA_OPAQUE);
+	static_assert(PALETTE_INDEX_SKY_LEVEL_DIVISOR == TEXEL_ALPHA_OPAQUE);
+
+	// Converts 8-bit texel channels to the [0, 1] range used for shading. Same values as
+	// Double4::fromARGB() in double precision.
+	template <typename T>
+	std::array<T, 256> MakeTexelChannelTable()
+	{
+		std::array<T, 256> table;
+		for (int i = 0; i < static_cast<int>(table.size()); i++)
+		{
+			table[i] = static_cast<T>(static_cast<double>(i) / 255.0);
+		}
+
+		return table;
+	}
+
+	template <typename T>
+	const std::array<T, 256> TexelChannelTable = MakeTexelChannelTable<T>();
+
+	// Gets the alpha for a texel in the given palette color (zero or opaque).
+	uint8_t GetPaletteTexelAlpha(const Color &color)
+	{
+		return (color.a == 0) ? 0 : TEXEL_ALPHA_OPAQUE;
+	}
+
 	bool IsGhostTexel(uint8_t texel)
 	{
 		return (texel >= PALETTE_INDEX_LIGHT_LEVEL_LOWEST) && (texel <= PALETTE_INDEX_LIGHT_LEVEL_HIGHEST);
@@ -60,19 +130,84 @@ namespace
 	{
 		return (texel >= PALETTE_INDEX_SKY_LEVEL_LOWEST) && (texel <= PALETTE_INDEX_SKY_LEVEL_HIGHEST);
 	}
+
+	// Gets the mip level where one screen pixel steps about one texel, given how many level 0
+	// texels a pixel steps over. Also handles infinite and NaN densities from degenerate ranges.
+	int GetMipLevelIndex(double texelsPerPixel, int levelCount)
+	{
+		if (!(texelsPerPixel >= 2.0))
+		{
+			return 0;
+		}
+
+		return std::min(std::ilogb(texelsPerPixel), levelCount - 1);
+	}
+
+	// Texels per pixel down a column that maps [vStart, vEnd] of a texture onto the projected
+	// Y range.
+	double GetColumnTexelsPerPixel(double vStart, double vEnd, int textureHeight, double yProjStart,
+		double yProjEnd)
+	{
+		return (std::abs(vEnd - vStart) * static_cast<double>(textureHeight)) /
+			std::abs(yProjEnd - yProjStart);
+	}
+
+	// The column kernels have float and double versions, so the vectorized shaders use the ones
+	// matching the shading precision. Double builds get the same output as the scalar shaders.
+	using ColumnShadeParams = ColumnKernels::BasicShadeParams<SoftwareRenderer::ShadingReal>;
+
+	bool UseColumnKernels()
+	{
+		const ColumnKernels::Table &kernels = ColumnKernels::getActiveTable();
+#if defined(HAVE_FLOAT_SHADING)
+		return kernels.width > 1;
+#else
+		return kernels.doubleWidth > 1;
+#endif
+	}
+
+	void InterpolateColumnV(const ColumnKernels::Table &kernels, const int *rows, int count,
+		float yProjStart, float yProjEnd, float vStart, float vEnd, float *outV)
+	{
+		kernels.interpolateV(rows, count, yProjStart, yProjEnd, vStart, vEnd, outV);
+	}
+
+	void InterpolateColumnV(const ColumnKernels::Table &kernels, const int *rows, int count,
+		double yProjStart, double yProjEnd, double vStart, double vEnd, double *outV)
+	{
+		kernels.interpolateVDouble(rows, count, yProjStart, yProjEnd, vStart, vEnd, outV);
+	}
+
+	void ShadeColumnPixels(const ColumnKernels::Table &kernels, const float *r, const float *g,
+		const float *b, const float *emission, const float *lightContributions,
+		const float *fogPercents, int count, const ColumnKernels::ShadeParams &params,
+		uint32_t *outColors)
+	{
+		kernels.shadePixels(r, g, b, emission, lightContributions, fogPercents, count, params,
+			outColors);
+	}
+
+	void ShadeColumnPixels(const ColumnKernels::Table &kernels, const double *r, const double *g,
+		const double *b, const double *emission, const double *lightContributions,
+		const double *fogPercents, int count, const ColumnKernels::ShadeParamsDouble &params,
+		uint32_t *outColors)
+	{
+		kernels.shadePixelsDouble(r, g, b, emission, lightContributions, fogPercents, count,
+			params, outColors);
+	}
 }
 
-void SoftwareRenderer::VoxelTexel::init(double r, double g, double b, double emission,
+void SoftwareRenderer::VoxelTexel::init(uint8_t r, uint8_t g, uint8_t b, bool emissive,
 	bool transparent)
 {
 	this->r = r;
 	this->g = g;
 	this->b = b;
-	this->emission = emission;
-	this->transparent = transparent;
+	this->flags = (emissive ? VoxelTexel::FLAG_EMISSIVE : 0) |
+		(transparent ? VoxelTexel::FLAG_TRANSPARENT : 0);
 }
 
-void SoftwareRenderer::FlatTexel::init(double r, double g, double b, double a, uint8_t reflection)
+void SoftwareRenderer::FlatTexel::init(uint8_t r, uint8_t g, uint8_t b, uint8_t a, uint8_t reflection)
 {
 	this->r = r;
 	this->g = g;
@@ -81,7 +216,7 @@ void SoftwareRenderer::FlatTexel::init(double r, double g, double b, double a, u
 	this->reflection = reflection;
 }
 
-void SoftwareRenderer::SkyTexel::init(double r, double g, double b, double a)
+void SoftwareRenderer::SkyTexel::init(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
 	this->r = r;
 	this->g = g;
@@ -89,7 +224,7 @@ void SoftwareRenderer::SkyTexel::init(double r, double g, double b, double a)
 	this->a = a;
 }
 
-void SoftwareRenderer::ChasmTexel::init(double r, double g, double b)
+void SoftwareRenderer::ChasmTexel::init(uint8_t r, uint8_t g, uint8_t b)
 {
 	this->r = r;
 	this->g = g;
@@ -124,16 +259,11 @@ void SoftwareRenderer::VoxelTexture::init(int width, int height, const uint8_t *
 			const int index = x + (y * width);
 			const uint8_t srcTexel = srcTexels[index];
 			const Color &srcColor = palette[srcTexel];
-
-			const Double4 dstColor = Double4::fromARGB(srcColor.toARGB());
-			const double r = dstColor.x;
-			const double g = dstColor.y;
-			const double b = dstColor.z;
-			constexpr double emission = 0.0;
-			const bool transparent = dstColor.w == 0.0;
+			constexpr bool emissive = false;
+			const bool transparent = srcColor.a == 0;
 
 			VoxelTexel &dstTexel = this->texels[index];
-			dstTexel.init(r, g, b, emission, transparent);
+			dstTexel.init(srcColor.r, srcColor.g, srcColor.b, emissive, transparent);
 
 			// Check if the texel is used with night lights (yellow at night).
 			if (srcTexel == PALETTE_INDEX_NIGHT_LIGHT)
@@ -142,6 +272,8 @@ void SoftwareRenderer::VoxelTexture::init(int width, int height, const uint8_t *
 			}
 		}
 	}
+
+	this->generateMipLevels();
 }
 
 void SoftwareRenderer::VoxelTexture::setLightTexelsActive(bool active)
@@ -150,8 +282,9 @@ void SoftwareRenderer::VoxelTexture::setLightTexelsActive(bool active)
 	const Color inactiveColor = Color::Black;
 
 	// Change voxel texels based on whether it's night.
-	const Double4 texelColor = Double4::fromARGB((active ? activeColor : inactiveColor).toARGB());
-	const double texelEmission = active ? 1.0 : 0.0;
+	const Color &texelColor = active ? activeColor : inactiveColor;
+	const bool emissive = active;
+	const bool transparent = texelColor.a == 0;
 
 	for (const Int2 &lightTexel : this->lightTexels)
 	{
@@ -159,13 +292,109 @@ void SoftwareRenderer::VoxelTexture::setLightTexelsActive(bool active)
 
 		DebugAssertIndex(this->texels, index);
 		VoxelTexel &texel = this->texels[index];
-		const double r = texelColor.x;
-		const double g = texelColor.y;
-		const double b = texelColor.z;
-		const double emission = texelEmission;
-		const bool transparent = texelColor.w == 0.0;
-		texel.init(r, g, b, emission, transparent);
+		texel.init(texelColor.r, texelColor.g, texelColor.b, emissive, transparent);
+	}
+
+	if (this->lightTexels.size() > 0)
+	{
+		this->generateMipLevels();
+	}
+}
+
+void SoftwareRenderer::VoxelTexture::generateMipLevels()
+{
+	this->mipLevels.clear();
+
+	int srcLevelIndex = 0;
+	while (true)
+	{
+		const VoxelTexture &srcLevel = (srcLevelIndex == 0) ? *this : this->mipLevels[srcLevelIndex - 1];
+		if ((srcLevel.width <= 1) && (srcLevel.height <= 1))
+		{
+			break;
+		}
+
+		VoxelTexture dstLevel;
+		dstLevel.width = std::max(srcLevel.width / 2, 1);
+		dstLevel.height = std::max(srcLevel.height / 2, 1);
+		dstLevel.texels.resize(dstLevel.width * dstLevel.height);
+
+		for (int y = 0; y < dstLevel.height; y++)
+		{
+			for (int x = 0; x < dstLevel.width; x++)
+			{
+				// Texels in the 2x2 block under this one (fewer at a 1-texel edge).
+				const int srcX0 = x * 2;
+				const int srcY0 = y * 2;
+				const int srcX1 = std::min(srcX0 + 1, srcLevel.width - 1);
+				const int srcY1 = std::min(srcY0 + 1, srcLevel.height - 1);
+				const std::array<int, 4> srcIndices =
+				{
+					srcX0 + (srcY0 * srcLevel.width),
+					srcX1 + (srcY0 * srcLevel.width),
+					srcX0 + (srcY1 * srcLevel.width),
+					srcX1 + (srcY1 * srcLevel.width)
+				};
+
+				int sumR = 0, sumG = 0, sumB = 0;
+				int opaqueCount = 0, transparentCount = 0, emissiveCount = 0;
+				for (const int srcIndex : srcIndices)
+				{
+					const VoxelTexel &srcTexel = srcLevel.texels[srcIndex];
+					if ((srcTexel.flags & VoxelTexel::FLAG_TRANSPARENT) != 0)
+					{
+						transparentCount++;
+						continue;
+					}
+
+					sumR += srcTexel.r;
+					sumG += srcTexel.g;
+					sumB += srcTexel.b;
+					emissiveCount += ((srcTexel.flags & VoxelTexel::FLAG_EMISSIVE) != 0) ? 1 : 0;
+					opaqueCount++;
+				}
+
+				VoxelTexel &dstTexel = dstLevel.texels[x + (y * dstLevel.width)];
+				if (opaqueCount == 0)
+				{
+					dstTexel.init(0, 0, 0, false, true);
+				}
+				else
+				{
+					const int halfCount = opaqueCount / 2;
+					const uint8_t r = static_cast<uint8_t>((sumR + halfCount) / opaqueCount);
+					const uint8_t g = static_cast<uint8_t>((sumG + halfCount) / opaqueCount);
+					const uint8_t b = static_cast<uint8_t>((sumB + halfCount) / opaqueCount);
+					const bool emissive = (emissiveCount * 2) >= opaqueCount;
+					const bool transparent = (transparentCount * 2) >= static_cast<int>(srcIndices.size());
+					dstTexel.init(r, g, b, emissive, transparent);
+				}
+			}
+		}
+
+		this->mipLevels.push_back(std::move(dstLevel));
+		srcLevelIndex++;
+	}
+}
+
+const SoftwareRenderer::VoxelTexture &SoftwareRenderer::VoxelTexture::getMipLevel(
+	double texelsPerPixel) const
+{
+	const int levelCount = static_cast<int>(this->mipLevels.size()) + 1;
+	const int levelIndex = GetMipLevelIndex(texelsPerPixel, levelCount);
+	return (levelIndex == 0) ? *this : this->mipLevels[levelIndex - 1];
+}
+
+size_t SoftwareRenderer::VoxelTexture::getTexelByteCount() const
+{
+	size_t byteCount = (this->texels.size() * sizeof(VoxelTexel)) +
+		(this->lightTexels.size() * sizeof(Int2));
+	for (const VoxelTexture &mipLevel : this->mipLevels)
+	{
+		byteCount += mipLevel.getTexelByteCount();
 	}
+
+	return byteCount;
 }
 
 SoftwareRenderer::FlatTexture::FlatTexture()
@@ -201,22 +430,21 @@ void SoftwareRenderer::FlatTexture::init(int width, int height, const uint8_t *s
 			// and are purely for manipulating the previously rendered color in the frame buffer.
 			if (IsGhostTexel(srcTexel))
 			{
-				// Ghost texel.
-				constexpr double r = 0.0;
-				constexpr double g = 0.0;
-				constexpr double b = 0.0;
-				const double a = static_cast<double>(srcTexel) /
-					static_cast<double>(PALETTE_INDEX_LIGHT_LEVEL_DIVISOR);
+				// Ghost texel. Its alpha is the palette index in 1/14 steps.
+				constexpr uint8_t r = 0;
+				constexpr uint8_t g = 0;
+				constexpr uint8_t b = 0;
+				const uint8_t a = srcTexel;
 				constexpr uint8_t reflection = 0;
 				dstTexel.init(r, g, b, a, reflection);
 			}
 			else if (reflective && IsPuddleTexel(srcTexel))
 			{
 				// Puddle texel. The shader needs to know which reflection type it is.
-				constexpr double r = 0.0;
-				constexpr double g = 0.0;
-				constexpr double b = 0.0;
-				constexpr double a = 1.0;
+				constexpr uint8_t r = 0;
+				constexpr uint8_t g = 0;
+				constexpr uint8_t b = 0;
+				constexpr uint8_t a = TEXEL_ALPHA_OPAQUE;
 				const uint8_t reflection = srcTexel;
 				dstTexel.init(r, g, b, a, reflection);
 			}
@@ -228,16 +456,68 @@ void SoftwareRenderer::FlatTexture::init(int width, int height, const uint8_t *s
 					((srcTexel == PALETTE_INDEX_RED_SRC2) ? PALETTE_INDEX_RED_DST2 : srcTexel);
 
 				const Color &paletteColor = palette[paletteIndex];
-				const Double4 dstColor = Double4::fromARGB(paletteColor.toARGB());
-				const double r = dstColor.x;
-				const double g = dstColor.y;
-				const double b = dstColor.z;
-				const double a = dstColor.w;
+				const uint8_t a = GetPaletteTexelAlpha(paletteColor);
 				constexpr uint8_t reflection = 0;
-				dstTexel.init(r, g, b, a, reflection);
+				dstTexel.init(paletteColor.r, paletteColor.g, paletteColor.b, a, reflection);
+			}
+		}
+	}
+
+	this->generateMipLevels();
+}
+
+void SoftwareRenderer::FlatTexture::generateMipLevels()
+{
+	this->mipLevels.clear();
+
+	int srcLevelIndex = 0;
+	while (true)
+	{
+		const FlatTexture &srcLevel = (srcLevelIndex == 0) ? *this : this->mipLevels[srcLevelIndex - 1];
+		if ((srcLevel.width <= 1) && (srcLevel.height <= 1))
+		{
+			break;
+		}
+
+		FlatTexture dstLevel;
+		dstLevel.width = std::max(srcLevel.width / 2, 1);
+		dstLevel.height = std::max(srcLevel.height / 2, 1);
+		dstLevel.texels.resize(dstLevel.width * dstLevel.height);
+
+		for (int y = 0; y < dstLevel.height; y++)
+		{
+			// The bottom-right texel of each 2x2 block is the one nearest sampling would pick at
+			// the center of the mip texel.
+			const int srcY = std::min((y * 2) + 1, srcLevel.height - 1);
+			for (int x = 0; x < dstLevel.width; x++)
+			{
+				const int srcX = std::min((x * 2) + 1, srcLevel.width - 1);
+				dstLevel.texels[x + (y * dstLevel.width)] = srcLevel.texels[srcX + (srcY * srcLevel.width)];
 			}
 		}
+
+		this->mipLevels.push_back(std::move(dstLevel));
+		srcLevelIndex++;
+	}
+}
+
+const SoftwareRenderer::FlatTexture &SoftwareRenderer::FlatTexture::getMipLevel(
+	double texelsPerPixel) const
+{
+	const int levelCount = static_cast<int>(this->mipLevels.size()) + 1;
+	const int levelIndex = GetMipLevelIndex(texelsPerPixel, levelCount);
+	return (levelIndex == 0) ? *this : this->mipLevels[levelIndex - 1];
+}
+
+size_t SoftwareRenderer::FlatTexture::getTexelByteCount() const
+{
+	size_t byteCount = this->texels.size() * sizeof(FlatTexel);
+	for (const FlatTexture &mipLevel : this->mipLevels)
+	{
+		byteCount += mipLevel.getTexelByteCount();
 	}
+
+	return byteCount;
 }
 
 SoftwareRenderer::SkyTexture::SkyTexture()
@@ -268,24 +548,19 @@ void SoftwareRenderer::SkyTexture::init(int width, int height, const uint8_t *sr
 			// Same as flat texels but for sky objects and without some hardcoded indices.
 			if (IsCloudTexel(srcTexel))
 			{
-				// Transparency for clouds.
-				constexpr double r = 0.0;
-				constexpr double g = 0.0;
-				constexpr double b = 0.0;
-				const double a = static_cast<double>(srcTexel) /
-					static_cast<double>(PALETTE_INDEX_SKY_LEVEL_DIVISOR);
+				// Transparency for clouds. Alpha is the palette index in 1/14 steps.
+				constexpr uint8_t r = 0;
+				constexpr uint8_t g = 0;
+				constexpr uint8_t b = 0;
+				const uint8_t a = srcTexel;
 				dstTexel.init(r, g, b, a);
 			}
 			else
 			{
 				// Color the texel normally.
 				const Color &paletteColor = palette[srcTexel];
-				const Double4 dstColor = Double4::fromARGB(paletteColor.toARGB());
-				const double r = dstColor.x;
-				const double g = dstColor.y;
-				const double b = dstColor.z;
-				const double a = dstColor.w;
-				dstTexel.init(r, g, b, a);
+				const uint8_t a = GetPaletteTexelAlpha(paletteColor);
+				dstTexel.init(paletteColor.r, paletteColor.g, paletteColor.b, a);
 			}
 		}
 	}
@@ -316,13 +591,8 @@ void SoftwareRenderer::ChasmTexture::init(int width, int height, const uint8_t *
 			const uint8_t srcTexel = srcTexels[index];
 			const Color &srcColor = palette[srcTexel];
 
-			const Double4 dstColor = Double4::fromARGB(srcColor.toARGB());
-			const double r = dstColor.x;
-			const double g = dstColor.y;
-			const double b = dstColor.z;
-
 			ChasmTexel &dstTexel = this->texels[index];
-			dstTexel.init(r, g, b);
+			dstTexel.init(srcColor.r, srcColor.g, srcColor.b);
 		}
 	}
 }
@@ -366,6 +636,23 @@ const SoftwareRenderer::FlatTexture &SoftwareRenderer::FlatTextureGroup::getText
 	return texture;
 }
 
+size_t SoftwareRenderer::FlatTextureGroup::getTexelByteCount() const
+{
+	size_t byteCount = 0;
+	for (const State &state : this->states)
+	{
+		for (const TextureList &textureList : state)
+		{
+			for (const FlatTexture &texture : textureList)
+			{
+				byteCount += texture.getTexelByteCount();
+			}
+		}
+	}
+
+	return byteCount;
+}
+
 void SoftwareRenderer::FlatTextureGroup::init(const EntityAnimationInstance &animInst)
 {
 	// Resize each state/keyframe buffer to fit all entity animation keyframes.
@@ -413,6 +700,21 @@ void SoftwareRenderer::FlatTextureGroup::setTexture(int stateID, int angleID, in
 	texture.init(width, height, srcTexels, flipped, reflective, palette);
 }
 
+void SoftwareRenderer::FlatTextureGroup::setTexture(int stateID, int angleID, int textureID,
+	FlatTexture &&texture)
+{
+	if (!this->isValidLookup(stateID, angleID, textureID))
+	{
+		DebugLogWarning("Invalid flat texture group look-up (" + std::to_string(stateID) +
+			", " + std::to_string(angleID) + ", " + std::to_string(textureID) + ").");
+		return;
+	}
+
+	FlatTextureGroup::State &state = this->states[stateID];
+	FlatTextureGroup::TextureList &textureList = state[angleID];
+	textureList[textureID] = std::move(texture);
+}
+
 SoftwareRenderer::Camera::Camera(const Double3 &eye, const Double3 &direction,
 	Degrees fovY, double aspect, double projectionModifier)
 	: eye(eye), direction(direction)
@@ -519,6 +821,147 @@ SoftwareRenderer::Ray::Ray(SNDouble dirX, WEDouble dirZ)
 	this->dirZ = dirZ;
 }
 
+void SoftwareRenderer::RayPacket::init(int startX, int endX, int stride, const Camera &camera,
+	SNInt gridWidth, int gridHeight, WEInt gridDepth, const FrameView &frame)
+{
+	const NewDouble2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
+	const NewDouble2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
+
+	this->laneCount = 0;
+	for (int lane = 0; lane < WIDTH; lane++)
+	{
+		// Lanes past the end repeat the first column so they step like the others.
+		const int x = startX + (lane * stride);
+		const bool hasColumn = x < endX;
+		const int rayX = hasColumn ? x : startX;
+		this->columns[lane] = x;
+		this->laneCount += hasColumn ? 1 : 0;
+
+		// Same ray direction as drawVoxels().
+		const double xPercent = (static_cast<double>(rayX) + 0.50) / frame.widthReal;
+		const NewDouble2 rightComp = rightAspected * ((2.0 * xPercent) - 1.0);
+		const NewDouble2 direction = (forwardZoomed + rightComp).normalized();
+		const SNDouble dirX = direction.x;
+		const WEDouble dirZ = direction.y;
+		this->dirX[lane] = dirX;
+		this->dirZ[lane] = dirZ;
+
+		// Same DDA setup as rayCast2DInternal().
+		const bool nonNegativeDirX = dirX >= 0.0;
+		const bool nonNegativeDirZ = dirZ >= 0.0;
+		this->stepX[lane] = nonNegativeDirX ? 1.0 : -1.0;
+		this->stepZ[lane] = nonNegativeDirZ ? 1.0 : -1.0;
+		this->halfOneMinusStepX[lane] = nonNegativeDirX ? 0.0 : 1.0;
+		this->halfOneMinusStepZ[lane] = nonNegativeDirZ ? 0.0 : 1.0;
+		this->deltaDistX[lane] = (nonNegativeDirX ? 1.0 : -1.0) / dirX;
+		this->deltaDistZ[lane] = (nonNegativeDirZ ? 1.0 : -1.0) / dirZ;
+
+		const SNDouble initialDeltaDistPercentX = nonNegativeDirX ?
+			(1.0 - (camera.eye.x - camera.eyeVoxelReal.x)) : (camera.eye.x - camera.eyeVoxelReal.x);
+		const WEDouble initialDeltaDistPercentZ = nonNegativeDirZ ?
+			(1.0 - (camera.eye.z - camera.eyeVoxelReal.z)) : (camera.eye.z - camera.eyeVoxelReal.z);
+		this->deltaDistSumX[lane] = this->deltaDistX[lane] * initialDeltaDistPercentX;
+		this->deltaDistSumZ[lane] = this->deltaDistZ[lane] * initialDeltaDistPercentZ;
+
+		this->cellX[lane] = static_cast<double>(camera.eyeVoxel.x);
+		this->cellZ[lane] = static_cast<double>(camera.eyeVoxel.z);
+	}
+
+	this->eyeVoxelIsValid =
+		(camera.eyeVoxel.x >= 0) &&
+		(camera.eyeVoxel.y >= 0) &&
+		(camera.eyeVoxel.z >= 0) &&
+		(camera.eyeVoxel.x < gridWidth) &&
+		(camera.eyeVoxel.y < gridHeight) &&
+		(camera.eyeVoxel.z < gridDepth);
+}
+
+void SoftwareRenderer::RayPacket::trace(int firstIndex, int stepCount, const Camera &camera,
+	SNInt gridWidth, WEInt gridDepth)
+{
+	DebugAssert(firstIndex >= 0);
+	DebugAssert((firstIndex + stepCount) <= (BATCH_STEPS + 1));
+
+	alignas(64) double zDistances[WIDTH];
+	for (int i = firstIndex; i < (firstIndex + stepCount); i++)
+	{
+		// Cells before the step, for telling which axis each lane stepped on.
+		alignas(64) double prevCellX[WIDTH];
+		std::copy(std::begin(this->cellX), std::end(this->cellX), std::begin(prevCellX));
+
+#if defined(HAVE_SIMD)
+		// Step on whichever axis has the smaller delta distance sum, then get the distance to the
+		// new voxel's near face the same way as the scalar ray caster.
+		const simd_type_d eyeX = simd_set1_d(camera.eye.x);
+		const simd_type_d eyeZ = simd_set1_d(camera.eye.z);
+		for (int lane = 0; lane < WIDTH; lane += static_cast<int>(simd_size_d))
+		{
+			const simd_type_d sumX = simd_load_d(this->deltaDistSumX + lane);
+			const simd_type_d sumZ = simd_load_d(this->deltaDistSumZ + lane);
+			const simd_mask_d isStepX = simd_cmplt_d(sumX, sumZ);
+
+			const simd_type_d newSumX = simd_blend_d(sumX,
+				simd_add_d(sumX, simd_load_d(this->deltaDistX + lane)), isStepX);
+			const simd_type_d newSumZ = simd_blend_d(
+				simd_add_d(sumZ, simd_load_d(this->deltaDistZ + lane)), sumZ, isStepX);
+
+			const simd_type_d oldCellX = simd_load_d(this->cellX + lane);
+			const simd_type_d oldCellZ = simd_load_d(this->cellZ + lane);
+			const simd_type_d newCellX = simd_blend_d(oldCellX,
+				simd_add_d(oldCellX, simd_load_d(this->stepX + lane)), isStepX);
+			const simd_type_d newCellZ = simd_blend_d(
+				simd_add_d(oldCellZ, simd_load_d(this->stepZ + lane)), oldCellZ, isStepX);
+
+			const simd_type_d zDistanceX = simd_div_d(simd_add_d(simd_sub_d(newCellX, eyeX),
+				simd_load_d(this->halfOneMinusStepX + lane)), simd_load_d(this->dirX + lane));
+			const simd_type_d zDistanceZ = simd_div_d(simd_add_d(simd_sub_d(newCellZ, eyeZ),
+				simd_load_d(this->halfOneMinusStepZ + lane)), simd_load_d(this->dirZ + lane));
+
+			simd_store_d(this->deltaDistSumX + lane, newSumX);
+			simd_store_d(this->deltaDistSumZ + lane, newSumZ);
+			simd_store_d(this->cellX + lane, newCellX);
+			simd_store_d(this->cellZ + lane, newCellZ);
+			simd_store_d(zDistances + lane, simd_blend_d(zDistanceZ, zDistanceX, isStepX));
+		}
+#else
+		for (int lane = 0; lane < WIDTH; lane++)
+		{
+			if (this->deltaDistSumX[lane] < this->deltaDistSumZ[lane])
+			{
+				this->deltaDistSumX[lane] += this->deltaDistX[lane];
+				this->cellX[lane] += this->stepX[lane];
+				zDistances[lane] = ((this->cellX[lane] - camera.eye.x) + this->halfOneMinusStepX[lane]) /
+					this->dirX[lane];
+			}
+			else
+			{
+				this->deltaDistSumZ[lane] += this->deltaDistZ[lane];
+				this->cellZ[lane] += this->stepZ[lane];
+				zDistances[lane] = ((this->cellZ[lane] - camera.eye.z) + this->halfOneMinusStepZ[lane]) /
+					this->dirZ[lane];
+			}
+		}
+#endif
+
+		for (int lane = 0; lane < WIDTH; lane++)
+		{
+			const bool steppedX = this->cellX[lane] != prevCellX[lane];
+			const bool nonNegativeStep = steppedX ? (this->stepX[lane] > 0.0) : (this->stepZ[lane] > 0.0);
+			const bool prevIsValid = (i > 0) ? this->steps[lane][i - 1].isValid : this->eyeVoxelIsValid;
+
+			Step &step = this->steps[lane][i];
+			step.cellX = static_cast<SNInt>(this->cellX[lane]);
+			step.cellZ = static_cast<WEInt>(this->cellZ[lane]);
+			step.facing = steppedX ?
+				(nonNegativeStep ? VoxelFacing2D::NegativeX : VoxelFacing2D::PositiveX) :
+				(nonNegativeStep ? VoxelFacing2D::NegativeZ : VoxelFacing2D::PositiveZ);
+			step.zDistance = zDistances[lane];
+			step.isValid = prevIsValid && (step.cellX >= 0) && (step.cellX < gridWidth) &&
+				(step.cellZ >= 0) && (step.cellZ < gridDepth);
+		}
+	}
+}
+
 SoftwareRenderer::DrawRange::DrawRange(double yProjStart, double yProjEnd, int yStart, int yEnd)
 {
 	this->yProjStart = yProjStart;
@@ -527,16 +970,26 @@ SoftwareRenderer::DrawRange::DrawRange(double yProjStart, double yProjEnd, int y
 	this->yEnd = yEnd;
 }
 
-SoftwareRenderer::OcclusionData::OcclusionData(int yMin, int yMax)
+SoftwareRenderer::OcclusionData::OcclusionData(int yMin, int yMax, bool spansEnabled)
 {
 	this->yMin = yMin;
 	this->yMax = yMax;
+	this->spanStarts.fill(0);
+	this->spanEnds.fill(0);
+	this->spanCount = 0;
+	this->drawnPixels = 0;
+	this->spansEnabled = spansEnabled;
 }
 
 SoftwareRenderer::OcclusionData::OcclusionData()
-	: OcclusionData(0, 0) { }
+	: OcclusionData(0, 0, false) { }
+
+bool SoftwareRenderer::OcclusionData::isFull() const
+{
+	return this->yMin == this->yMax;
+}
 
-void SoftwareRenderer::OcclusionData::clipRange(int *yStart, int *yEnd) const
+void SoftwareRenderer::OcclusionData::clipRange(int *yStart, int *yEnd)
 {
 	const bool occluded = (*yEnd <= this->yMin) || (*yStart >= this->yMax);
 
@@ -544,39 +997,172 @@ void SoftwareRenderer::OcclusionData::clipRange(int *yStart, int *yEnd) const
 	{
 		// The drawing range is completely hidden.
 		*yStart = *yEnd;
+		return;
 	}
-	else
+
+	// Clip the drawing range.
+	*yStart = std::max(*yStart, this->yMin);
+	*yEnd = std::min(*yEnd, this->yMax);
+
+	// Trim the ends that are under covered spans. Spans don't touch each other, so each end
+	// can only move once. A gap in the middle is left to the depth test.
+	for (int i = 0; i < this->spanCount; i++)
+	{
+		if ((this->spanStarts[i] <= *yStart) && (this->spanEnds[i] > *yStart))
+		{
+			*yStart = this->spanEnds[i];
+			break;
+		}
+	}
+
+	for (int i = this->spanCount - 1; i >= 0; i--)
+	{
+		if ((this->spanEnds[i] >= *yEnd) && (this->spanStarts[i] < *yEnd))
+		{
+			*yEnd = this->spanStarts[i];
+			break;
+		}
+	}
+
+	if (*yEnd <= *yStart)
 	{
-		// Clip the drawing range.
-		*yStart = std::max(*yStart, this->yMin);
-		*yEnd = std::min(*yEnd, this->yMax);
+		// Entirely inside a covered span.
+		*yStart = *yEnd;
+		return;
 	}
+
+	this->drawnPixels += *yEnd - *yStart;
 }
 
 void SoftwareRenderer::OcclusionData::update(int yStart, int yEnd)
 {
-	// Slightly different than clipRange() because values just needs to be adjacent
-	// rather than overlap.
-	const bool canIncreaseMin = yStart <= this->yMin;
-	const bool canDecreaseMax = yEnd >= this->yMax;
+	if (yEnd <= yStart)
+	{
+		return;
+	}
+
+	if (!this->spansEnabled)
+	{
+		// Slightly different than clipRange() because values just needs to be adjacent
+		// rather than overlap.
+		const bool canIncreaseMin = yStart <= this->yMin;
+		const bool canDecreaseMax = yEnd >= this->yMax;
+
+		// Determine how to update the occlusion ranges.
+		if (canIncreaseMin && canDecreaseMax)
+		{
+			// The drawing range touches the top and bottom occlusion values, so the 
+			// entire column is occluded.
+			this->yMin = this->yMax;
+		}
+		else if (canIncreaseMin)
+		{
+			// Move the top of the window downward.
+			this->yMin = std::max(yEnd, this->yMin);
+		}
+		else if (canDecreaseMax)
+		{
+			// Move the bottom of the window upward.
+			this->yMax = std::min(yStart, this->yMax);
+		}
+
+		return;
+	}
+
+	// Merge the range with every span it overlaps or touches, keeping the rest in order.
+	std::array<int, MAX_SPANS + 1> newStarts, newEnds;
+	int newCount = 0;
+	bool inserted = false;
+	for (int i = 0; i < this->spanCount; i++)
+	{
+		const int spanStart = this->spanStarts[i];
+		const int spanEnd = this->spanEnds[i];
+		if (spanEnd < yStart)
+		{
+			newStarts[newCount] = spanStart;
+			newEnds[newCount] = spanEnd;
+			newCount++;
+		}
+		else if (spanStart > yEnd)
+		{
+			if (!inserted)
+			{
+				newStarts[newCount] = yStart;
+				newEnds[newCount] = yEnd;
+				newCount++;
+				inserted = true;
+			}
+
+			newStarts[newCount] = spanStart;
+			newEnds[newCount] = spanEnd;
+			newCount++;
+		}
+		else
+		{
+			yStart = std::min(yStart, spanStart);
+			yEnd = std::max(yEnd, spanEnd);
+		}
+	}
+
+	if (!inserted)
+	{
+		newStarts[newCount] = yStart;
+		newEnds[newCount] = yEnd;
+		newCount++;
+	}
+
+	// Spans touching the window edges move the edges instead. Only the first and last spans can
+	// touch them.
+	int first = 0;
+	int last = newCount - 1;
+	if (newStarts[first] <= this->yMin)
+	{
+		this->yMin = std::max(this->yMin, newEnds[first]);
+		first++;
+	}
+
+	if ((last >= first) && (newEnds[last] >= this->yMax))
+	{
+		this->yMax = std::min(this->yMax, newStarts[last]);
+		last--;
+	}
 
-	// Determine how to update the occlusion ranges.
-	if (canIncreaseMin && canDecreaseMax)
+	if (this->yMin >= this->yMax)
 	{
-		// The drawing range touches the top and bottom occlusion values, so the 
-		// entire column is occluded.
 		this->yMin = this->yMax;
+		this->spanCount = 0;
+		return;
 	}
-	else if (canIncreaseMin)
+
+	// Forget the smallest span if there are too many.
+	int keepCount = (last - first) + 1;
+	int droppedIndex = -1;
+	if (keepCount > MAX_SPANS)
 	{
-		// Move the top of the window downward.
-		this->yMin = std::max(yEnd, this->yMin);
+		droppedIndex = first;
+		for (int i = first + 1; i <= last; i++)
+		{
+			if ((newEnds[i] - newStarts[i]) < (newEnds[droppedIndex] - newStarts[droppedIndex]))
+			{
+				droppedIndex = i;
+			}
+		}
+
+		keepCount--;
 	}
-	else if (canDecreaseMax)
+
+	this->spanCount = 0;
+	for (int i = first; i <= last; i++)
 	{
-		// Move the bottom of the window upward.
-		this->yMax = std::min(yStart, this->yMax);
+		if (i != droppedIndex)
+		{
+			this->spanStarts[this->spanCount] = newStarts[i];
+			this->spanEnds[this->spanCount] = newEnds[i];
+			this->spanCount++;
+		}
 	}
+
+	DebugAssert(this->spanCount == keepCount);
 }
 
 SoftwareRenderer::ShadingInfo::ShadingInfo(const std::vector<Double3> &skyPalette,
@@ -594,6 +1180,11 @@ SoftwareRenderer::ShadingInfo::ShadingInfo(const std::vector<Double3> &skyPalett
 	this->isExterior = isExterior;
 	this->ambient = ambient;
 	this->distantAmbient = RendererUtils::getDistantAmbientPercent(ambient);
+
+	for (int i = 0; i < static_cast<int>(this->distantShadedChannels.size()); i++)
+	{
+		this->distantShadedChannels[i] = TexelChannelTable<double>[i] * this->distantAmbient;
+	}
 	this->fogDistance = fogDistance;
 	this->chasmAnimPercent = chasmAnimPercent;
 	this->playerHasLight = playerHasLight;
@@ -606,16 +1197,23 @@ const Double3 &SoftwareRenderer::ShadingInfo::getFogColor() const
 }
 
 SoftwareRenderer::FrameView::FrameView(uint32_t *colorBuffer, double *depthBuffer, 
-	int width, int height)
+	int width, int height, bool columnMajor)
 {
 	this->colorBuffer = colorBuffer;
 	this->depthBuffer = depthBuffer;
 	this->width = width;
 	this->height = height;
+	this->xStride = columnMajor ? height : 1;
+	this->yStride = columnMajor ? 1 : width;
 	this->widthReal = static_cast<double>(width);
 	this->heightReal = static_cast<double>(height);
 }
 
+int SoftwareRenderer::FrameView::getIndex(int x, int y) const
+{
+	return (x * this->xStride) + (y * this->yStride);
+}
+
 template <typename T>
 SoftwareRenderer::DistantObject<T>::DistantObject(const T &obj, int textureIndex)
 	: obj(obj)
@@ -659,12 +1257,9 @@ void SoftwareRenderer::DistantObjects::init(const DistantSky &distantSky,
 
 		// Small stars are never transparent in the original game; this is just using the
 		// same storage representation as clouds which can have some transparencies.
-		const Double4 srcColor = Double4::fromARGB(color);
+		const Color srcColor = Color::fromARGB(color);
 		SkyTexel &dstTexel = texture.texels.front();
-		dstTexel.r = srcColor.x;
-		dstTexel.g = srcColor.y;
-		dstTexel.b = srcColor.z;
-		dstTexel.a = srcColor.w;
+		dstTexel.init(srcColor.r, srcColor.g, srcColor.b, GetPaletteTexelAlpha(srcColor));
 
 		return static_cast<int>(skyTextures.size()) - 1;
 	};
@@ -804,14 +1399,215 @@ void SoftwareRenderer::VisDistantObjects::clear()
 	this->starEnd = 0;
 }
 
-void SoftwareRenderer::VisibleLight::init(const Double3 &position, double radius)
+SoftwareRenderer::SkyCache::SkyCache()
 {
-	this->position = position;
-	this->radius = radius;
+	this->fovY = 0.0;
+	this->daytimePercent = 0.0;
+	this->ambient = 0.0;
+	this->latitude = 0.0;
+	this->isValid = false;
 }
 
-void SoftwareRenderer::LightVisibilityData::init(const Double3 &position, double radius,
-	bool intersectsFrustum)
+void SoftwareRenderer::SkyCache::init(int width, int height)
+{
+	this->colors.init(width * height);
+	this->invalidate();
+}
+
+bool SoftwareRenderer::SkyCache::tryReuse(const Double3 &direction, double fovY,
+	double daytimePercent, double ambient, double latitude, const DistantObjects &distantObjects)
+{
+	// Animated lands and moons are owned by the distant sky and change on their own.
+	auto animLandsMatch = [this, &distantObjects]()
+	{
+		if (this->animLandIndices.size() != distantObjects.animLands.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < distantObjects.animLands.size(); i++)
+		{
+			if (this->animLandIndices[i] != distantObjects.animLands[i].obj.getIndex())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	auto moonsMatch = [this, &distantObjects]()
+	{
+		if (this->moonPhasePercents.size() != distantObjects.moons.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < distantObjects.moons.size(); i++)
+		{
+			if (this->moonPhasePercents[i] != distantObjects.moons[i].obj.getPhasePercent())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	const bool canReuse = this->isValid && (direction == this->direction) && (fovY == this->fovY) &&
+		(latitude == this->latitude) &&
+		(std::abs(daytimePercent - this->daytimePercent) < SkyCache::DAYTIME_PERCENT_STEP) &&
+		(std::abs(ambient - this->ambient) < SkyCache::AMBIENT_STEP) &&
+		animLandsMatch() && moonsMatch();
+
+	if (canReuse)
+	{
+		return true;
+	}
+
+	this->animLandIndices.clear();
+	for (const auto &animLand : distantObjects.animLands)
+	{
+		this->animLandIndices.push_back(animLand.obj.getIndex());
+	}
+
+	this->moonPhasePercents.clear();
+	for (const auto &moon : distantObjects.moons)
+	{
+		this->moonPhasePercents.push_back(moon.obj.getPhasePercent());
+	}
+
+	this->direction = direction;
+	this->fovY = fovY;
+	this->daytimePercent = daytimePercent;
+	this->ambient = ambient;
+	this->latitude = latitude;
+	this->isValid = true;
+	return false;
+}
+
+void SoftwareRenderer::SkyCache::invalidate()
+{
+	this->isValid = false;
+}
+
+SoftwareRenderer::Checkerboard::Checkerboard()
+{
+	this->yShear = 0.0;
+	this->height = 0;
+	this->historyIndex = 0;
+	this->parity = -1;
+	this->frameCount = 0;
+	this->isValid = false;
+}
+
+void SoftwareRenderer::Checkerboard::init(int width, int height)
+{
+	for (Buffer<uint32_t> &historyBuffer : this->historyBuffers)
+	{
+		historyBuffer.init(width * height);
+	}
+
+	this->sourceColumns.init(width);
+	this->height = height;
+	this->invalidate();
+}
+
+int SoftwareRenderer::Checkerboard::beginFrame(const Camera &camera)
+{
+	const NewDouble2 forward(camera.forwardX, camera.forwardZ);
+	const NewDouble2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
+	const NewDouble2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
+
+	// Reprojecting by ray direction is exact for turning, but pitch shifts rows and moving causes
+	// parallax, so those have to stay small.
+	bool canReproject = this->isValid;
+	if (canReproject)
+	{
+		const double turnCos = std::clamp(forward.dot(this->forward), -1.0, 1.0);
+		const double turnDegrees = std::acos(turnCos) * Constants::RadToDeg;
+		const double yShearPixels = std::abs(camera.yShear - this->yShear) *
+			static_cast<double>(this->height);
+		const double eyeDistance = (camera.eye - this->eye).length();
+		canReproject = (turnDegrees <= Checkerboard::MAX_TURN_DEGREES) &&
+			(yShearPixels <= Checkerboard::MAX_Y_SHEAR_PIXELS) &&
+			(eyeDistance <= Checkerboard::MAX_EYE_DISTANCE);
+	}
+
+	if (canReproject)
+	{
+		// Find the previous frame's column for each column's ray. The previous forward and right
+		// vectors are perpendicular, so the ray's screen position is the ratio of its components
+		// along them.
+		const int width = this->sourceColumns.getCount();
+		const double widthReal = static_cast<double>(width);
+		const double prevForwardLenSqr = this->forwardZoomed.dot(this->forwardZoomed);
+		const double prevRightLenSqr = this->rightAspected.dot(this->rightAspected);
+		for (int x = 0; x < width; x++)
+		{
+			const double xPercent = (static_cast<double>(x) + 0.50) / widthReal;
+			const NewDouble2 direction = forwardZoomed + (rightAspected * ((2.0 * xPercent) - 1.0));
+			const double forwardAmount = direction.dot(this->forwardZoomed) / prevForwardLenSqr;
+			const double rightAmount = direction.dot(this->rightAspected) / prevRightLenSqr;
+
+			int sourceX = -1;
+			if (forwardAmount > 0.0)
+			{
+				const double prevXPercent = ((rightAmount / forwardAmount) + 1.0) * 0.50;
+				const double prevX = std::floor(prevXPercent * widthReal);
+				if ((prevX >= 0.0) && (prevX < widthReal))
+				{
+					sourceX = static_cast<int>(prevX);
+				}
+			}
+
+			this->sourceColumns.set(x, sourceX);
+		}
+
+		this->parity = static_cast<int>(this->frameCount & 1);
+	}
+	else
+	{
+		this->parity = -1;
+	}
+
+	this->eye = camera.eye;
+	this->forward = forward;
+	this->forwardZoomed = forwardZoomed;
+	this->rightAspected = rightAspected;
+	this->yShear = camera.yShear;
+	this->historyIndex = (this->historyIndex + 1) % static_cast<int>(this->historyBuffers.size());
+	this->frameCount++;
+
+	// This frame's history is written by the render threads.
+	this->isValid = true;
+	return this->parity;
+}
+
+const uint32_t *SoftwareRenderer::Checkerboard::getPreviousHistory() const
+{
+	const int previousIndex = (this->historyIndex + 1) % static_cast<int>(this->historyBuffers.size());
+	return this->historyBuffers[previousIndex].get();
+}
+
+uint32_t *SoftwareRenderer::Checkerboard::getCurrentHistory()
+{
+	return this->historyBuffers[this->historyIndex].get();
+}
+
+void SoftwareRenderer::Checkerboard::invalidate()
+{
+	this->isValid = false;
+}
+
+void SoftwareRenderer::VisibleLight::init(const Double3 &position, double radius)
+{
+	this->position = position;
+	this->radius = radius;
+}
+
+void SoftwareRenderer::LightVisibilityData::init(const Double3 &position, double radius,
+	bool intersectsFrustum)
 {
 	this->position = position;
 	this->radius = radius;
@@ -840,6 +1636,50 @@ void SoftwareRenderer::VisibleLightList::clear()
 	this->count = 0;
 }
 
+void SoftwareRenderer::VisibleLightList::removeFrom(LightID firstRemovedID)
+{
+	const auto startIter = this->lightIDs.begin();
+	const auto endIter = std::remove_if(startIter, startIter + this->count,
+		[firstRemovedID](LightID lightID) { return lightID >= firstRemovedID; });
+	this->count = static_cast<int>(std::distance(startIter, endIter));
+}
+
+SoftwareRenderer::LightGrid::LightGrid()
+{
+	this->ceilingHeight = 0.0;
+	this->lightsBinned = 0;
+	this->cellsTouched = 0;
+	this->isValid = false;
+}
+
+void SoftwareRenderer::LightGrid::invalidate()
+{
+	this->isValid = false;
+}
+
+SoftwareRenderer::FlatSortOrder::FlatSortOrder()
+{
+	this->shifts = 0;
+}
+
+void SoftwareRenderer::FlatSortOrder::clear()
+{
+	this->entityRanks.clear();
+	this->sortedEntityIDs.clear();
+}
+
+SoftwareRenderer::TextureUploads::TextureUploads()
+{
+	this->batchOpen = false;
+}
+
+void SoftwareRenderer::TextureUploads::clear()
+{
+	this->voxelUploads.clear();
+	this->flatUploads.clear();
+	this->batchOpen = false;
+}
+
 void SoftwareRenderer::VisibleLightList::sortByNearest(const Double3 &point,
 	const BufferView<const VisibleLight> &visLights)
 {
@@ -862,47 +1702,81 @@ void SoftwareRenderer::VisibleLightList::sortByNearest(const Double3 &point,
 	});
 }
 
+SoftwareRenderer::ProfilerData::WaitHistogram::WaitHistogram()
+{
+	this->buckets.fill(0);
+	this->totalSeconds = 0.0;
+	this->sampleCount = 0;
+}
+
+int SoftwareRenderer::ProfilerData::WaitHistogram::getBucketMinMicroseconds(int bucketIndex)
+{
+	DebugAssert(bucketIndex >= 0);
+	DebugAssert(bucketIndex < BUCKET_COUNT);
+	return (bucketIndex == 0) ? 0 : (1 << (bucketIndex - 1));
+}
+
+double SoftwareRenderer::ProfilerData::WaitHistogram::getAverageMicroseconds() const
+{
+	if (this->sampleCount == 0)
+	{
+		return 0.0;
+	}
+
+	return (this->totalSeconds * 1000000.0) / static_cast<double>(this->sampleCount);
+}
+
+SoftwareRenderer::ProfilerData::ThreadTiming::ThreadTiming()
+{
+	this->busySeconds = 0.0;
+	this->idleSeconds = 0.0;
+	this->tilesStolen = 0;
+}
+
 void SoftwareRenderer::RenderThreadData::SkyGradient::init(double projectedYTop,
-	double projectedYBottom, Buffer<Double3> &rowCache)
+	double projectedYBottom, Buffer<Double3> &rowCache, const FrameView &skyFrame, bool reuseSky)
 {
 	this->threadsDone = 0;
 	this->rowCache = &rowCache;
 	this->projectedYTop = projectedYTop;
 	this->projectedYBottom = projectedYBottom;
 	this->shouldDrawStars = false;
+	this->skyFrame = &skyFrame;
+	this->reuseSky = reuseSky;
 }
 
 void SoftwareRenderer::RenderThreadData::DistantSky::init(const VisDistantObjects &visDistantObjs,
 	const std::vector<SkyTexture> &skyTextures)
 {
+	// The ready epoch is not reset here; it only becomes valid once it matches the next frame epoch.
 	this->threadsDone = 0;
 	this->visDistantObjs = &visDistantObjs;
 	this->skyTextures = &skyTextures;
-	this->doneVisTesting = false;
 }
 
 void SoftwareRenderer::RenderThreadData::Voxels::init(int chunkDistance, double ceilingHeight,
+	bool rayPackets,
 	const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates,
 	const std::vector<VisibleLight> &visLights,
-	const Buffer2D<VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const Buffer2D<VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &voxelTextures,
 	const ChasmTextureGroups &chasmTextureGroups, Buffer<OcclusionData> &occlusion)
 {
 	this->threadsDone = 0;
 	this->chunkDistance = chunkDistance;
 	this->ceilingHeight = ceilingHeight;
+	this->rayPackets = rayPackets;
 	this->openDoors = &openDoors;
 	this->fadingVoxels = &fadingVoxels;
 	this->chasmStates = &chasmStates;
 	this->visLights = &visLights;
 	this->visLightLists = &visLightLists;
-	this->voxelGrid = &voxelGrid;
+	this->defGroup = &defGroup;
 	this->voxelTextures = &voxelTextures;
 	this->chasmTextureGroups = &chasmTextureGroups;
 	this->occlusion = &occlusion;
-	this->doneLightVisTesting = false;
 }
 
 void SoftwareRenderer::RenderThreadData::Flats::init(const Double3 &flatNormal,
@@ -915,29 +1789,292 @@ void SoftwareRenderer::RenderThreadData::Flats::init(const Double3 &flatNormal,
 	this->visLights = &visLights;
 	this->visLightLists = &visLightLists;
 	this->flatTextureGroups = &flatTextureGroups;
-	this->doneSorting = false;
+}
+
+void SoftwareRenderer::RenderThreadData::Reconstruction::init(int parity, const int *sourceColumns,
+	const uint32_t *previousHistory, uint32_t *currentHistory)
+{
+	this->sourceColumns = sourceColumns;
+	this->previousHistory = previousHistory;
+	this->currentHistory = currentHistory;
+	this->parity = parity;
+}
+
+void SoftwareRenderer::RenderThreadData::Swizzle::init(uint32_t *outputBuffer)
+{
+	this->threadsDone = 0;
+	this->outputBuffer = outputBuffer;
+}
+
+SoftwareRenderer::RenderThreadData::ColumnScheduler::ColumnScheduler()
+{
+	this->tileWidth = 0;
+	this->tileCount = 0;
+	this->frameWidth = 0;
+}
+
+void SoftwareRenderer::RenderThreadData::ColumnScheduler::init(int threadCount, int tileWidth)
+{
+	DebugAssert(threadCount > 0);
+	DebugAssert(tileWidth > 0);
+	this->queues.init(threadCount);
+	this->tileWidth = tileWidth;
+	this->tileCount = 0;
+	this->frameWidth = 0;
+
+	for (int i = 0; i < this->queues.getCount(); i++)
+	{
+		this->queues.get(i).range = PackColumnTileRange(0, 0);
+	}
+}
+
+void SoftwareRenderer::RenderThreadData::ColumnScheduler::reset(int frameWidth)
+{
+	this->frameWidth = frameWidth;
+	this->tileCount = (frameWidth + this->tileWidth - 1) / this->tileWidth;
+
+	const int threadCount = this->queues.getCount();
+	for (int i = 0; i < threadCount; i++)
+	{
+		const int begin = (i * this->tileCount) / threadCount;
+		const int end = ((i + 1) * this->tileCount) / threadCount;
+		this->queues.get(i).range.store(PackColumnTileRange(begin, end), std::memory_order_relaxed);
+	}
+}
+
+bool SoftwareRenderer::RenderThreadData::ColumnScheduler::tryGetTile(int threadIndex,
+	int *outStartX, int *outEndX, bool *outWasStolen)
+{
+	auto writeTile = [this, outStartX, outEndX](int tileIndex)
+	{
+		*outStartX = tileIndex * this->tileWidth;
+		*outEndX = std::min(*outStartX + this->tileWidth, this->frameWidth);
+	};
+
+	// Take from the front of this thread's own queue first.
+	ColumnTileQueue &ownQueue = this->queues.get(threadIndex);
+	uint64_t ownRange = ownQueue.range.load(std::memory_order_relaxed);
+	int begin, end;
+	UnpackColumnTileRange(ownRange, &begin, &end);
+	while (begin < end)
+	{
+		if (ownQueue.range.compare_exchange_weak(ownRange, PackColumnTileRange(begin + 1, end),
+			std::memory_order_relaxed))
+		{
+			writeTile(begin);
+			*outWasStolen = false;
+			return true;
+		}
+
+		UnpackColumnTileRange(ownRange, &begin, &end);
+	}
+
+	// Steal the back half of another thread's queue, visiting neighbors first. The first stolen
+	// tile is drawn right away and the rest go in this thread's now-empty queue. A thief can't
+	// see a stale range come back (ABA) since the first tile of any range removed from a queue
+	// is always drawn by whoever removed it.
+	const int threadCount = this->queues.getCount();
+	for (int i = 1; i < threadCount; i++)
+	{
+		ColumnTileQueue &victimQueue = this->queues.get((threadIndex + i) % threadCount);
+		uint64_t victimRange = victimQueue.range.load(std::memory_order_relaxed);
+		UnpackColumnTileRange(victimRange, &begin, &end);
+		while (begin < end)
+		{
+			const int stealCount = ((end - begin) + 1) / 2;
+			const int newEnd = end - stealCount;
+			if (victimQueue.range.compare_exchange_weak(victimRange, PackColumnTileRange(begin, newEnd),
+				std::memory_order_relaxed))
+			{
+				if (stealCount > 1)
+				{
+					ownQueue.range.store(PackColumnTileRange(newEnd + 1, end), std::memory_order_relaxed);
+				}
+
+				writeTile(newEnd);
+				*outWasStolen = true;
+				return true;
+			}
+
+			UnpackColumnTileRange(victimRange, &begin, &end);
+		}
+	}
+
+	return false;
+}
+
+SoftwareRenderer::RenderThreadData::WaitStats::WaitStats()
+{
+	this->clear();
+}
+
+void SoftwareRenderer::RenderThreadData::WaitStats::add(int64_t nanoseconds)
+{
+	const int64_t microseconds = nanoseconds / 1000;
+	int bucketIndex = 0;
+	while ((bucketIndex < (ProfilerData::WaitHistogram::BUCKET_COUNT - 1)) &&
+		(microseconds >= ProfilerData::WaitHistogram::getBucketMinMicroseconds(bucketIndex + 1)))
+	{
+		bucketIndex++;
+	}
+
+	this->buckets[bucketIndex].fetch_add(1, std::memory_order_relaxed);
+	this->totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+	this->sampleCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SoftwareRenderer::RenderThreadData::WaitStats::writeTo(
+	ProfilerData::WaitHistogram *outHistogram) const
+{
+	for (int i = 0; i < static_cast<int>(this->buckets.size()); i++)
+	{
+		outHistogram->buckets[i] = this->buckets[i].load(std::memory_order_relaxed);
+	}
+
+	outHistogram->totalSeconds = static_cast<double>(
+		this->totalNanoseconds.load(std::memory_order_relaxed)) / static_cast<double>(std::nano::den);
+	outHistogram->sampleCount = this->sampleCount.load(std::memory_order_relaxed);
+}
+
+void SoftwareRenderer::RenderThreadData::WaitStats::clear()
+{
+	for (std::atomic<int> &bucket : this->buckets)
+	{
+		bucket = 0;
+	}
+
+	this->totalNanoseconds = 0;
+	this->sampleCount = 0;
 }
 
 SoftwareRenderer::RenderThreadData::RenderThreadData()
 {
-	// Make sure 'go' is initialized to false.
+	this->parkedCount = 0;
 	this->totalThreads = 0;
-	this->go = false;
+	this->workStealing = false;
+	this->selfPublishing = false;
+	this->frameEpoch = 0;
 	this->isDestructing = false;
 	this->camera = nullptr;
 	this->shadingInfo = nullptr;
 	this->frame = nullptr;
+	this->distantSky.readyEpoch = 0;
+	this->voxels.readyEpoch = 0;
+	this->flats.readyEpoch = 0;
+	this->reconstruction.init(-1, nullptr, nullptr, nullptr);
+	this->swizzle.outputBuffer = nullptr;
+	this->swizzle.readyEpoch = 0;
+	this->phaseStartNanoseconds.fill(0);
+
+	for (std::atomic<int64_t> &phaseEnd : this->phaseEndNanoseconds)
+	{
+		phaseEnd = 0;
+	}
 }
 
-void SoftwareRenderer::RenderThreadData::init(int totalThreads, const Camera &camera,
-	const ShadingInfo &shadingInfo, const FrameView &frame)
+void SoftwareRenderer::RenderThreadData::init(int totalThreads, bool workStealing,
+	bool selfPublishing, const Camera &camera, const ShadingInfo &shadingInfo, const FrameView &frame)
 {
 	this->totalThreads = totalThreads;
+	this->workStealing = workStealing;
+	this->selfPublishing = selfPublishing;
 	this->camera = &camera;
 	this->shadingInfo = &shadingInfo;
 	this->frame = &frame;
-	this->go = false;
-	this->isDestructing = false;
+}
+
+template <typename Predicate>
+int64_t SoftwareRenderer::RenderThreadData::waitUntil(const Predicate &predicate)
+{
+	if (predicate())
+	{
+		return 0;
+	}
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	auto getElapsedNanoseconds = [&startTime]()
+	{
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		return static_cast<int64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count());
+	};
+
+	// Spin briefly before giving up the core.
+	for (int i = 0; i < RenderThreadSpinCount; i++)
+	{
+		SpinWaitPause();
+
+		if (predicate())
+		{
+			return getElapsedNanoseconds();
+		}
+	}
+
+	// Let other threads on this core make progress.
+	for (int i = 0; i < RenderThreadYieldCount; i++)
+	{
+		std::this_thread::yield();
+
+		if (predicate())
+		{
+			return getElapsedNanoseconds();
+		}
+	}
+
+	// Park until a signaler wakes this thread. The parked count must be published before the
+	// predicate is checked under the lock so a concurrent signaler can't miss this thread.
+	this->parkedCount.fetch_add(1);
+	std::unique_lock<std::mutex> lk(this->parkMutex);
+	this->parkCondVar.wait(lk, predicate);
+	lk.unlock();
+	this->parkedCount.fetch_sub(1);
+
+	return getElapsedNanoseconds();
+}
+
+void SoftwareRenderer::RenderThreadData::notifyParked()
+{
+	if (this->parkedCount.load() > 0)
+	{
+		// Lock and unlock so a thread between its predicate check and wait() can't miss the signal.
+		std::unique_lock<std::mutex> lk(this->parkMutex);
+		lk.unlock();
+		this->parkCondVar.notify_all();
+	}
+}
+
+int64_t SoftwareRenderer::RenderThreadData::getFrameNanoseconds() const
+{
+	const auto now = std::chrono::high_resolution_clock::now();
+	return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		now - this->frameStartTime).count());
+}
+
+void SoftwareRenderer::RenderThreadData::recordPhaseEnd(int phaseIndex)
+{
+	const int64_t nanoseconds = this->getFrameNanoseconds();
+	std::atomic<int64_t> &phaseEnd = this->phaseEndNanoseconds[phaseIndex];
+	int64_t latestEnd = phaseEnd.load(std::memory_order_relaxed);
+	while ((nanoseconds > latestEnd) && !phaseEnd.compare_exchange_weak(latestEnd, nanoseconds,
+		std::memory_order_relaxed)) { }
+}
+
+void SoftwareRenderer::RenderThreadData::publishPhase(std::atomic<Epoch> &readyEpoch,
+	Epoch frameEpoch, int phaseIndex)
+{
+	this->phaseStartNanoseconds[phaseIndex] = this->getFrameNanoseconds();
+	readyEpoch.store(frameEpoch);
+	this->notifyParked();
+}
+
+void SoftwareRenderer::RenderThreadData::waitForThreads(const std::atomic<int> &threadsDone)
+{
+	ProfilerZone("Wait for render threads");
+	const int totalThreads = this->totalThreads;
+	this->waitUntil([&threadsDone, totalThreads]()
+	{
+		return threadsDone.load(std::memory_order_acquire) == totalThreads;
+	});
 }
 
 const double SoftwareRenderer::NEAR_PLANE = 0.0001;
@@ -955,12 +2092,28 @@ SoftwareRenderer::SoftwareRenderer()
 	this->width = 0;
 	this->height = 0;
 	this->renderThreadsMode = 0;
+	this->renderThreadsWorkStealing = false;
+	this->columnMajorFrameBuffer = false;
+	this->checkerboardRendering = false;
+	this->pipelinedRendering = false;
+	this->frameInFlight = false;
+	this->occlusionSpans = true;
+	this->rayPackets = true;
+	this->frameFlatNormal = Double3::Zero;
 	this->fogDistance = 0.0;
+	this->visDistantObjsSeconds = 0.0;
+	this->visFlatsSeconds = 0.0;
+	this->visLightListsSeconds = 0.0;
+	this->potentiallyVisFlatCount = 0;
+	this->culledChunkFlatCount = 0;
 }
 
 SoftwareRenderer::~SoftwareRenderer()
 {
+	this->finishFrame();
 	this->resetRenderThreads();
+	this->endTextureBatch();
+	this->textureJobPool.shutdown();
 }
 
 bool SoftwareRenderer::isInited() const
@@ -969,6 +2122,11 @@ bool SoftwareRenderer::isInited() const
 	return (this->width > 0) && (this->height > 0);
 }
 
+double SoftwareRenderer::getFogDistance() const
+{
+	return this->fogDistance;
+}
+
 SoftwareRenderer::ProfilerData SoftwareRenderer::getProfilerData() const
 {
 	// @todo: make this a member of SoftwareRenderer eventually when it is capturing more
@@ -976,9 +2134,74 @@ SoftwareRenderer::ProfilerData SoftwareRenderer::getProfilerData() const
 	ProfilerData data;
 	data.width = this->width;
 	data.height = this->height;
-	data.potentiallyVisFlatCount = static_cast<int>(this->potentiallyVisibleFlats.size());
+	data.potentiallyVisFlatCount = this->potentiallyVisFlatCount;
 	data.visFlatCount = static_cast<int>(this->visibleFlats.size());
 	data.visLightCount = static_cast<int>(this->visibleLights.size());
+
+	for (int i = 0; i < ProfilerData::PHASE_COUNT; i++)
+	{
+		this->threadData.phaseWaits[i].writeTo(&data.phaseWaits[i]);
+
+		// Phases that didn't run this frame (i.e., swizzling) have no end time.
+		const int64_t phaseEnd = this->threadData.phaseEndNanoseconds[i].load();
+		const int64_t phaseStart = this->threadData.phaseStartNanoseconds[i];
+		data.phaseSeconds[i] = static_cast<double>(std::max<int64_t>(phaseEnd - phaseStart, 0)) /
+			static_cast<double>(std::nano::den);
+	}
+
+	data.visDistantObjsSeconds = this->visDistantObjsSeconds;
+	data.visFlatsSeconds = this->visFlatsSeconds;
+	data.visLightListsSeconds = this->visLightListsSeconds;
+	data.skyReused = this->threadData.skyGradient.reuseSky;
+	data.lightsBinned = this->lightGrid.lightsBinned;
+	data.lightCellsTouched = this->lightGrid.cellsTouched;
+	data.culledChunkFlatCount = this->culledChunkFlatCount;
+	data.flatSortShifts = this->flatSortOrder.shifts;
+	data.checkerboarded = this->threadData.reconstruction.parity >= 0;
+
+	int voxelPixelsDrawn = 0;
+	for (int i = 0; i < this->occlusion.getCount(); i++)
+	{
+		voxelPixelsDrawn += this->occlusion.get(i).drawnPixels;
+	}
+
+	const int pixelCount = this->width * this->height;
+	data.voxelOverdraw = (pixelCount > 0) ?
+		(static_cast<double>(voxelPixelsDrawn) / static_cast<double>(pixelCount)) : 0.0;
+
+	data.textureBytes = 0;
+	for (const VoxelTexture &texture : this->voxelTextures)
+	{
+		data.textureBytes += texture.getTexelByteCount();
+	}
+
+	for (const FlatTextureGroup &textureGroup : this->flatTextureGroups)
+	{
+		data.textureBytes += textureGroup.getTexelByteCount();
+	}
+
+	for (const FlatTexture &texture : this->spriteTextures)
+	{
+		data.textureBytes += texture.getTexelByteCount();
+	}
+
+	for (const SkyTexture &texture : this->skyTextures)
+	{
+		data.textureBytes += texture.texels.size() * sizeof(SkyTexel);
+	}
+
+	for (const auto &pair : this->chasmTextureGroups)
+	{
+		for (const ChasmTexture &texture : pair.second)
+		{
+			data.textureBytes += texture.texels.size() * sizeof(ChasmTexel);
+		}
+	}
+
+	const Buffer<ProfilerData::ThreadTiming> &threadTimings = this->threadData.threadTimings;
+	data.threadTimings = std::vector<ProfilerData::ThreadTiming>(
+		threadTimings.get(), threadTimings.get() + threadTimings.getCount());
+
 	return data;
 }
 
@@ -1015,7 +2238,7 @@ bool SoftwareRenderer::tryGetEntitySelectionData(const Double2 &uv, EntityRender
 
 		// Check if the texel is non-transparent.
 		const FlatTexel &texel = texture.texels[textureIndex];
-		*outIsSelected = texel.a > 0.0;
+		*outIsSelected = texel.a > 0;
 		return true;
 	}
 	else
@@ -1053,27 +2276,46 @@ Double3 SoftwareRenderer::screenPointToRay(double xPercent, double yPercent,
 	return (forwardComponent + rightComponent - upComponent).normalized();
 }
 
-void SoftwareRenderer::init(int width, int height, int renderThreadsMode)
+void SoftwareRenderer::init(int width, int height, int renderThreadsMode,
+	bool renderThreadsWorkStealing, bool columnMajorFrameBuffer, bool checkerboardRendering,
+	bool pipelinedRendering)
 {
+	this->finishFrame();
+	this->endTextureBatch();
+
 	// Initialize frame buffer.
 	this->depthBuffer.init(width, height);
 	this->depthBuffer.fill(std::numeric_limits<double>::infinity());
 
+	// The column-major color buffer is only allocated while in use.
+	this->columnMajorColorBuffer.init(columnMajorFrameBuffer ? (width * height) : 0);
+
 	// Initialize occlusion columns.
 	this->occlusion.init(width);
-	this->occlusion.fill(OcclusionData(0, height));
+	this->occlusion.fill(OcclusionData(0, height, this->occlusionSpans));
 
 	// Initialize sky gradient cache.
 	this->skyGradientRowCache.init(height);
 	this->skyGradientRowCache.fill(Double3::Zero);
+	this->skyCache.init(width, height);
+
+	// Checkerboard history is only allocated while in use.
+	this->checkerboard.init(checkerboardRendering ? width : 0, checkerboardRendering ? height : 0);
 
 	// Initialize texture vectors to default sizes.
 	this->voxelTextures = std::vector<VoxelTexture>(SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
 	this->flatTextureGroups = FlatTextureGroups();
+	this->spriteTextures.clear();
+	this->freeVoxelTextureIDs.clear();
+	this->freeSpriteTextureIDs.clear();
 
 	this->width = width;
 	this->height = height;
 	this->renderThreadsMode = renderThreadsMode;
+	this->renderThreadsWorkStealing = renderThreadsWorkStealing;
+	this->columnMajorFrameBuffer = columnMajorFrameBuffer;
+	this->checkerboardRendering = checkerboardRendering;
+	this->pipelinedRendering = pipelinedRendering;
 
 	// Fog distance is zero by default.
 	this->fogDistance = 0.0;
@@ -1081,10 +2323,18 @@ void SoftwareRenderer::init(int width, int height, int renderThreadsMode)
 	// Initialize render threads.
 	const int threadCount = RendererUtils::getRenderThreadsFromMode(renderThreadsMode);
 	this->initRenderThreads(width, height, threadCount);
+
+	// Texture jobs only run while loading, so they can use every core but the main thread's.
+	if (this->textureJobPool.getThreadCount() == 0)
+	{
+		const int textureThreadCount = std::max(Platform::getThreadCount() - 1, 1);
+		this->textureJobPool.init(textureThreadCount, "Texture job");
+	}
 }
 
 void SoftwareRenderer::setRenderThreadsMode(int mode)
 {
+	this->finishFrame();
 	this->renderThreadsMode = mode;
 
 	// Re-initialize render threads.
@@ -1092,20 +2342,130 @@ void SoftwareRenderer::setRenderThreadsMode(int mode)
 	this->initRenderThreads(this->width, this->height, threadCount);
 }
 
+void SoftwareRenderer::setRenderThreadsWorkStealing(bool enabled)
+{
+	// Render threads are idle once any pipelined frame is done, so the next frame can pick this
+	// up directly.
+	this->finishFrame();
+	this->renderThreadsWorkStealing = enabled;
+}
+
+void SoftwareRenderer::setColumnMajorFrameBuffer(bool enabled)
+{
+	// Render threads are idle once any pipelined frame is done, so the buffer can be swapped out
+	// directly.
+	this->finishFrame();
+	this->columnMajorFrameBuffer = enabled;
+	this->columnMajorColorBuffer.init(enabled ? (this->width * this->height) : 0);
+
+	// The cached sky and checkerboard history have the old frame layout.
+	this->skyCache.invalidate();
+	this->checkerboard.invalidate();
+}
+
+void SoftwareRenderer::setCheckerboardRendering(bool enabled)
+{
+	// Render threads are idle once any pipelined frame is done, so the history can be swapped
+	// out directly.
+	this->finishFrame();
+	this->checkerboardRendering = enabled;
+	this->checkerboard.init(enabled ? this->width : 0, enabled ? this->height : 0);
+}
+
+void SoftwareRenderer::setPipelinedRendering(bool enabled)
+{
+	this->finishFrame();
+	this->pipelinedRendering = enabled;
+}
+
+void SoftwareRenderer::setOcclusionSpans(bool enabled)
+{
+	this->finishFrame();
+	this->occlusionSpans = enabled;
+}
+
+void SoftwareRenderer::setRayPackets(bool enabled)
+{
+	this->finishFrame();
+	this->rayPackets = enabled;
+}
+
+void SoftwareRenderer::beginTextureBatch()
+{
+	this->endTextureBatch();
+	this->textureUploads.batchOpen = true;
+}
+
+void SoftwareRenderer::endTextureBatch()
+{
+	if (!this->textureUploads.batchOpen)
+	{
+		return;
+	}
+
+	ProfilerZone("SoftwareRenderer::endTextureBatch");
+
+	// The converted textures replace the old ones together between frames.
+	this->textureJobPool.wait(this->textureUploads.jobBatch);
+	this->finishFrame();
+
+	for (const std::unique_ptr<TextureUploads::VoxelUpload> &upload : this->textureUploads.voxelUploads)
+	{
+		DebugAssertIndex(this->voxelTextures, upload->id);
+		this->voxelTextures[upload->id] = std::move(upload->texture);
+	}
+
+	for (const std::unique_ptr<TextureUploads::FlatUpload> &upload : this->textureUploads.flatUploads)
+	{
+		// The entity render IDs might have been cleared since the upload was queued.
+		if (this->isValidEntityRenderID(upload->entityRenderID))
+		{
+			FlatTextureGroup &flatTextureGroup = this->flatTextureGroups[upload->entityRenderID];
+			flatTextureGroup.setTexture(upload->stateID, upload->angleID, upload->textureID,
+				std::move(upload->texture));
+		}
+	}
+
+	this->textureUploads.clear();
+}
+
 void SoftwareRenderer::setVoxelTexture(int id, const uint8_t *srcTexels, const Palette &palette)
 {
+	this->finishFrame();
+
 	DebugAssertIndex(this->voxelTextures, id);
-	VoxelTexture &texture = this->voxelTextures[id];
 
 	// Hardcoded dimensions for now.
 	constexpr int width = 64;
 	constexpr int height = width;
 
+	if (this->textureUploads.batchOpen)
+	{
+		// The source texels might not outlive the caller's scope, so the job gets a copy.
+		auto upload = std::make_unique<TextureUploads::VoxelUpload>();
+		upload->id = id;
+		upload->srcTexels.assign(srcTexels, srcTexels + (width * height));
+		upload->palette = std::make_shared<const Palette>(palette);
+
+		TextureUploads::VoxelUpload *uploadPtr = upload.get();
+		this->textureUploads.voxelUploads.emplace_back(std::move(upload));
+		this->textureJobPool.submit([uploadPtr]()
+		{
+			ProfilerZone("VoxelTexture::init");
+			uploadPtr->texture.init(width, height, uploadPtr->srcTexels.data(), *uploadPtr->palette);
+		}, this->textureUploads.jobBatch);
+
+		return;
+	}
+
+	VoxelTexture &texture = this->voxelTextures[id];
 	texture.init(width, height, srcTexels, palette);
 }
 
 EntityRenderID SoftwareRenderer::makeEntityRenderID()
 {
+	// The flat texture groups might reallocate.
+	this->finishFrame();
 	this->flatTextureGroups.push_back(FlatTextureGroup());
 	return static_cast<EntityRenderID>(this->flatTextureGroups.size()) - 1;
 }
@@ -1115,10 +2475,19 @@ void SoftwareRenderer::setFlatTextures(EntityRenderID entityRenderID,
 	bool isPuddle, const Palette &palette, const TextureManager &textureManager,
 	const TextureInstanceManager &textureInstManager)
 {
+	this->finishFrame();
+
 	DebugAssert(this->isValidEntityRenderID(entityRenderID));
 	FlatTextureGroup &flatTextureGroup = this->flatTextureGroups[entityRenderID];
 	flatTextureGroup.init(animInst);
 
+	// Shared by all of the animation's uploads in a texture batch.
+	std::shared_ptr<const Palette> uploadPalette;
+	if (this->textureUploads.batchOpen)
+	{
+		uploadPalette = std::make_shared<const Palette>(palette);
+	}
+
 	for (int stateIndex = 0; stateIndex < animInst.getStateCount(); stateIndex++)
 	{
 		const EntityAnimationDefinition::State &defState = animDef.getState(stateIndex);
@@ -1147,6 +2516,35 @@ void SoftwareRenderer::setFlatTextures(EntityRenderID entityRenderID,
 				// Get texture associated with image ID and write texture data.
 				const Image &image = instKeyframe.getImageHandle(defKeyframe, textureManager);
 				const int textureID = keyframeID;
+
+				if (this->textureUploads.batchOpen)
+				{
+					auto upload = std::make_unique<TextureUploads::FlatUpload>();
+					upload->entityRenderID = entityRenderID;
+					upload->stateID = stateID;
+					upload->angleID = angleID;
+					upload->textureID = textureID;
+					upload->width = image.getWidth();
+					upload->height = image.getHeight();
+					upload->flipped = flipped;
+					upload->reflective = isPuddle;
+					upload->srcTexels.assign(image.getPixels(),
+						image.getPixels() + (image.getWidth() * image.getHeight()));
+					upload->palette = uploadPalette;
+
+					TextureUploads::FlatUpload *uploadPtr = upload.get();
+					this->textureUploads.flatUploads.emplace_back(std::move(upload));
+					this->textureJobPool.submit([uploadPtr]()
+					{
+						ProfilerZone("FlatTexture::init");
+						uploadPtr->texture.init(uploadPtr->width, uploadPtr->height,
+							uploadPtr->srcTexels.data(), uploadPtr->flipped, uploadPtr->reflective,
+							*uploadPtr->palette);
+					}, this->textureUploads.jobBatch);
+
+					continue;
+				}
+
 				flatTextureGroup.setTexture(stateID, angleID, textureID, flipped, image.getPixels(),
 					image.getWidth(), image.getHeight(), isPuddle, palette);
 			}
@@ -1162,29 +2560,36 @@ void SoftwareRenderer::setFogDistance(double fogDistance)
 void SoftwareRenderer::setDistantSky(const DistantSky &distantSky, const Palette &palette,
 	TextureManager &textureManager)
 {
+	this->finishFrame();
+
 	// Clear old distant sky data.
 	this->distantObjects.clear();
 	this->skyTextures.clear();
 
 	// Create distant objects and set the sky textures.
 	this->distantObjects.init(distantSky, this->skyTextures, palette, textureManager);
+	this->skyCache.invalidate();
 }
 
 void SoftwareRenderer::setSkyPalette(const uint32_t *colors, int count)
 {
+	this->finishFrame();
 	this->skyPalette = std::vector<Double3>(count);
 
 	for (size_t i = 0; i < this->skyPalette.size(); i++)
 	{
 		this->skyPalette[i] = Double3::fromRGB(colors[i]);
 	}
+
+	this->skyCache.invalidate();
 }
 
 void SoftwareRenderer::addChasmTexture(VoxelDefinition::ChasmData::Type chasmType,
 	const uint8_t *colors, int width, int height, const Palette &palette)
 {
-	const int chasmID = RendererUtils::getChasmIdFromType(chasmType);
+	this->finishFrame();
 
+	const int chasmID = RendererUtils::getChasmIdFromType(chasmType);
 	auto iter = this->chasmTextureGroups.find(chasmID);
 	if (iter == this->chasmTextureGroups.end())
 	{
@@ -1200,6 +2605,8 @@ void SoftwareRenderer::addChasmTexture(VoxelDefinition::ChasmData::Type chasmTyp
 void SoftwareRenderer::setNightLightsActive(bool active)
 {
 	// @todo: activate lights (don't worry about textures).
+	this->finishFrame();
+	this->endTextureBatch();
 
 	for (VoxelTexture &voxelTexture : this->voxelTextures)
 	{
@@ -1209,36 +2616,57 @@ void SoftwareRenderer::setNightLightsActive(bool active)
 
 void SoftwareRenderer::clearTexturesAndEntityRenderIDs()
 {
+	this->finishFrame();
+	this->endTextureBatch();
+
 	for (auto &texture : this->voxelTextures)
 	{
 		std::fill(texture.texels.begin(), texture.texels.end(), VoxelTexel());
 		texture.lightTexels.clear();
+		texture.mipLevels.clear();
 	}
 
 	this->flatTextureGroups.clear();
+	this->flatSortOrder.clear(); // Entity IDs are reused by the next level.
 
 	// Distant sky textures are cleared because the vector size is managed internally.
 	this->skyTextures.clear();
 	this->distantObjects.sunTextureIndex = SoftwareRenderer::DistantObjects::NO_SUN;
+	this->skyCache.invalidate();
+	this->checkerboard.invalidate();
 
 	this->chasmTextureGroups.clear();
 }
 
 void SoftwareRenderer::clearDistantSky()
 {
+	this->finishFrame();
 	this->distantObjects.clear();
+	this->skyCache.invalidate();
 }
 
 void SoftwareRenderer::resize(int width, int height)
 {
+	this->finishFrame();
+
 	this->depthBuffer.init(width, height);
 	this->depthBuffer.fill(std::numeric_limits<double>::infinity());
 
 	this->occlusion.init(width);
-	this->occlusion.fill(OcclusionData(0, height));
+	this->occlusion.fill(OcclusionData(0, height, this->occlusionSpans));
 
 	this->skyGradientRowCache.init(height);
 	this->skyGradientRowCache.fill(Double3::Zero);
+	this->skyCache.init(width, height);
+
+	this->columnMajorColorBuffer.init(this->columnMajorFrameBuffer ? (width * height) : 0);
+	this->checkerboard.init(this->checkerboardRendering ? width : 0,
+		this->checkerboardRendering ? height : 0);
+
+	if (this->outputBuffer.getCount() > 0)
+	{
+		this->outputBuffer.init(width * height);
+	}
 
 	this->width = width;
 	this->height = height;
@@ -1267,6 +2695,20 @@ void SoftwareRenderer::initRenderThreads(int width, int height, int threadCount)
 	const double blockWidth = static_cast<double>(width) / static_cast<double>(threadCount);
 	const double blockHeight = static_cast<double>(height) / static_cast<double>(threadCount);
 
+	// Wait statistics only describe the current thread configuration.
+	for (RenderThreadData::WaitStats &waitStats : this->threadData.phaseWaits)
+	{
+		waitStats.clear();
+	}
+
+	// Per-thread state is sized for the new thread count while no threads are running.
+	this->threadData.voxels.scheduler.init(threadCount, VoxelColumnTileWidth);
+	this->threadData.flats.scheduler.init(threadCount, FlatColumnTileWidth);
+	this->threadData.threadTimings.init(threadCount);
+
+	// Threads start from the current frame epoch so they only react to future go signals.
+	const RenderThreadData::Epoch initialEpoch = this->threadData.frameEpoch;
+
 	// Start thread loop for each render thread. Rounding is involved so the start and stop
 	// coordinates are correct for all resolutions.
 	for (int i = 0; i < this->renderThreads.getCount(); i++)
@@ -1283,18 +2725,16 @@ void SoftwareRenderer::initRenderThreads(int width, int height, int threadCount)
 		DebugAssert(endY <= height);
 
 		this->renderThreads.set(i, std::thread(SoftwareRenderer::renderThreadLoop,
-			std::ref(this->threadData), i, startX, endX, startY, endY));
+			std::ref(this->threadData), initialEpoch, i, startX, endX, startY, endY));
 	}
 }
 
 void SoftwareRenderer::resetRenderThreads()
 {
 	// Tell each render thread it needs to terminate.
-	std::unique_lock<std::mutex> lk(this->threadData.mutex);
-	this->threadData.go = true;
 	this->threadData.isDestructing = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	this->threadData.frameEpoch++;
+	this->threadData.notifyParked();
 
 	for (int i = 0; i < this->renderThreads.getCount(); i++)
 	{
@@ -1305,8 +2745,8 @@ void SoftwareRenderer::resetRenderThreads()
 		}
 	}
 
-	// Set signal variables back to defaults, in case the render threads are used again.
-	this->threadData.go = false;
+	// Set signal variables back to defaults, in case the render threads are used again. The frame
+	// epoch keeps counting up so stale ready epochs can never match a future frame.
 	this->threadData.isDestructing = false;
 }
 
@@ -1579,101 +3019,12 @@ void SoftwareRenderer::updateVisibleDistantObjects(const ShadingInfo &shadingInf
 	this->visDistantObjs.starEnd = static_cast<int>(this->visDistantObjs.objs.size());
 }
 
-void SoftwareRenderer::updatePotentiallyVisibleFlats(const Camera &camera,
-	SNInt gridWidth, WEInt gridDepth, int chunkDistance, const EntityManager &entityManager,
-	std::vector<const Entity*> *outPotentiallyVisFlats, int *outEntityCount)
-{
-	const ChunkInt2 cameraChunk = VoxelUtils::newVoxelToChunk(
-		NewInt2(camera.eyeVoxel.x, camera.eyeVoxel.z));
-
-	// Get the min and max chunk coordinates to loop over.
-	ChunkInt2 minChunk, maxChunk;
-	ChunkUtils::getSurroundingChunks(cameraChunk, chunkDistance, &minChunk, &maxChunk);
-
-	// Number of potentially visible chunks along each axis (i.e. 3x3).
-	SNInt potentiallyVisChunkCountX;
-	WEInt potentiallyVisChunkCountZ;
-	ChunkUtils::getPotentiallyVisibleChunkCounts(chunkDistance,
-		&potentiallyVisChunkCountX, &potentiallyVisChunkCountZ);
-
-	auto getChunkPotentiallyVisFlatCount = [&entityManager](SNInt chunkX, WEInt chunkZ)
-	{
-		return entityManager.getTotalCountInChunk(ChunkInt2(chunkX, chunkZ));
-	};
-
-	auto getTotalPotentiallyVisFlatCount = [](const BufferView2D<const int> &chunkPotentiallyVisFlatCounts)
-	{
-		int count = 0;
-		for (WEInt z = 0; z < chunkPotentiallyVisFlatCounts.getHeight(); z++)
-		{
-			for (SNInt x = 0; x < chunkPotentiallyVisFlatCounts.getWidth(); x++)
-			{
-				count += chunkPotentiallyVisFlatCounts.get(x, z);
-			}
-		}
-
-		return count;
-	};
-
-	// Get potentially visible flat counts for each chunk.
-	Buffer2D<int> chunkPotentiallyVisFlatCounts(potentiallyVisChunkCountX, potentiallyVisChunkCountZ);
-	for (WEInt z = 0; z < chunkPotentiallyVisFlatCounts.getHeight(); z++)
-	{
-		for (SNInt x = 0; x < chunkPotentiallyVisFlatCounts.getWidth(); x++)
-		{
-			const SNInt chunkX = minChunk.x + x;
-			const WEInt chunkZ = minChunk.y + z;
-			const int count = getChunkPotentiallyVisFlatCount(chunkX, chunkZ);
-			chunkPotentiallyVisFlatCounts.set(x, z, count);
-		}
-	}
-
-	// Total potentially visible flat count (in the chunks surrounding the player).
-	const int potentiallyVisFlatCount = getTotalPotentiallyVisFlatCount(BufferView2D<const int>(
-		chunkPotentiallyVisFlatCounts.get(), chunkPotentiallyVisFlatCounts.getWidth(),
-		chunkPotentiallyVisFlatCounts.getHeight()));
-
-	auto addPotentiallyVisFlatsInChunk = [&entityManager, outPotentiallyVisFlats, &minChunk,
-		&chunkPotentiallyVisFlatCounts](SNInt chunkX, WEInt chunkZ, int insertIndex)
-	{
-		const Entity **entitiesPtr = outPotentiallyVisFlats->data() + insertIndex;
-		const SNInt visChunkX = chunkX - minChunk.x;
-		const WEInt visChunkZ = chunkZ - minChunk.y;
-		const int count = chunkPotentiallyVisFlatCounts.get(visChunkX, visChunkZ);
-		const int writtenCount = entityManager.getTotalEntitiesInChunk(
-			ChunkInt2(chunkX, chunkZ), entitiesPtr, count);
-		DebugAssert(writtenCount <= count);
-	};
-
-	outPotentiallyVisFlats->resize(potentiallyVisFlatCount);
-
-	int potentiallyVisFlatInsertIndex = 0;
-	for (WEInt z = 0; z < potentiallyVisChunkCountZ; z++)
-	{
-		for (SNInt x = 0; x < potentiallyVisChunkCountX; x++)
-		{
-			const int chunkPotentiallyVisFlatCount = chunkPotentiallyVisFlatCounts.get(x, z);
-			const SNInt chunkX = minChunk.x + x;
-			const WEInt chunkZ = minChunk.y + z;
-			addPotentiallyVisFlatsInChunk(chunkX, chunkZ, potentiallyVisFlatInsertIndex);
-			potentiallyVisFlatInsertIndex += chunkPotentiallyVisFlatCount;
-		}
-	}
-
-	*outEntityCount = potentiallyVisFlatInsertIndex;
-}
-
 void SoftwareRenderer::updateVisibleFlats(const Camera &camera, const ShadingInfo &shadingInfo,
-	int chunkDistance, double ceilingHeight, const VoxelGrid &voxelGrid,
-	const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary)
+	const std::vector<EntityRenderInstance> &entityInsts)
 {
 	this->visibleFlats.clear();
 	this->visibleLights.clear();
-
-	// Update potentially visible flats so this method knows what to work with.
-	int potentiallyVisFlatCount;
-	SoftwareRenderer::updatePotentiallyVisibleFlats(camera, voxelGrid.getWidth(), voxelGrid.getDepth(),
-		chunkDistance, entityManager, &this->potentiallyVisibleFlats, &potentiallyVisFlatCount);
+	this->lightGrid.frameStaticLights.clear();
 
 	// Each flat shares the same axes. The forward direction always faces opposite to 
 	// the camera direction.
@@ -1692,80 +3043,53 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera, const ShadingInf
 		this->visibleLights.push_back(std::move(playerVisLight));
 	}
 
-	// Potentially visible flat determination algorithm, given the current camera.
-	// Also calculates visible lights.
-	for (int i = 0; i < potentiallyVisFlatCount; i++)
+	// Visible flat determination algorithm, given the current camera. Also calculates visible
+	// lights. Entity instances that can't be visible are only there for their lights.
+	for (const EntityRenderInstance &entityInst : entityInsts)
 	{
-		const Entity *entity = this->potentiallyVisibleFlats[i];
+		const Double3 &flatPosition = entityInst.getPosition();
+		const NewDouble2 flatEyeDiff = NewDouble2(flatPosition.x, flatPosition.z) - eye2D;
+		const double flatHeight = entityInst.getHeight();
+		const double flatHalfWidth = entityInst.getWidth() * 0.50;
+		const int lightIntensity = entityInst.getLightIntensity();
 
-		// Entities can currently be null because of EntityGroup implementation details.
-		if (entity == nullptr)
-		{
-			continue;
-		}
-
-		const EntityDefinition &entityDef = entityManager.getEntityDef(
-			entity->getDefinitionID(), entityDefLibrary);
-
-		EntityManager::EntityVisibilityData visData;
-		entityManager.getEntityVisibilityData(*entity, eye2D, ceilingHeight, voxelGrid,
-			entityDefLibrary, visData);
-
-		// Get entity animation state to determine render properties.
-		const EntityAnimationDefinition &animDef = entityDef.getAnimDef();
-		const EntityAnimationDefinition::State &animDefState = animDef.getState(visData.stateIndex);
-		const EntityAnimationDefinition::KeyframeList &animDefKeyframeList =
-			animDefState.getKeyframeList(visData.angleIndex);
-		const EntityAnimationDefinition::Keyframe &animDefKeyframe =
-			animDefKeyframeList.getKeyframe(visData.keyframeIndex);
-
-		const double flatWidth = animDefKeyframe.getWidth();
-		const double flatHeight = animDefKeyframe.getHeight();
-		const double flatHalfWidth = flatWidth * 0.50;
-
-		// See if the entity is a light.
-		int lightIntensity;
-		if (!EntityUtils::tryGetLightIntensity(entityDef, &lightIntensity))
-		{
-			constexpr int streetLightIntensity = 4;
-			const bool isActiveStreetLight = ((entityDef.getType() == EntityDefinition::Type::Doodad) &&
-				entityDef.getDoodad().streetlight) && shadingInfo.nightLightsAreActive;
-			lightIntensity = isActiveStreetLight ? streetLightIntensity : 0;
-		}
-
-		const bool isLight = lightIntensity > 0;
-		if (isLight)
+		if (lightIntensity > 0)
 		{
 			// See if the light is visible.
 			SoftwareRenderer::LightVisibilityData lightVisData;
-			SoftwareRenderer::getLightVisibilityData(visData.flatPosition, flatHeight,
+			SoftwareRenderer::getLightVisibilityData(flatPosition, flatHeight,
 				lightIntensity, eye2D, cameraDir, camera.fovX, fogDistance, &lightVisData);
 
-			if (lightVisData.intersectsFrustum)
+			VisibleLight visLight;
+			visLight.init(lightVisData.position, lightVisData.radius);
+
+			if (entityInst.getIsStatic())
 			{
-				// Add a new visible light.
-				VisibleLight visLight;
-				visLight.init(lightVisData.position, lightVisData.radius);
+				// Static lights stay binned in the light lists between frames, so they aren't
+				// culled against the current view.
+				this->lightGrid.frameStaticLights.push_back(std::move(visLight));
+			}
+			else if (lightVisData.intersectsFrustum)
+			{
+				// Add a new visible dynamic light.
 				this->visibleLights.push_back(std::move(visLight));
 			}
 		}
 
-		const NewDouble2 flatPosition2D(visData.flatPosition.x, visData.flatPosition.z);
-
-		// Check if the flat is somewhere in front of the camera.
-		const NewDouble2 flatEyeDiff = flatPosition2D - eye2D;
-		const double flatEyeDiffLen = flatEyeDiff.length();
-		const NewDouble2 flatEyeDir = flatEyeDiff / flatEyeDiffLen;
-		const bool inFrontOfCamera = cameraDir.dot(flatEyeDir) > 0.0;
+		if (!entityInst.getCanBeVisible())
+		{
+			continue;
+		}
 
 		// Check if the flat is within the fog distance. Treat the flat as a cylinder and
 		// see if it's inside the fog distance circle centered on the player. Can't use
 		// distance squared here because a^2 - b^2 does not equal (a - b)^2.
+		const double flatEyeDiffLen = flatEyeDiff.length();
 		const double flatRadius = flatHalfWidth;
 		const double flatEyeCylinderDist = flatEyeDiffLen - flatRadius;
 		const bool inFogDistance = flatEyeCylinderDist < fogDistance;
 
-		if (inFrontOfCamera && inFogDistance)
+		if (inFogDistance)
 		{
 			// Scaled axes based on flat dimensions.
 			const Double3 flatRightScaled = flatRight * flatHalfWidth;
@@ -1773,14 +3097,15 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera, const ShadingInf
 
 			// Determine if the flat is potentially visible to the camera.
 			VisibleFlat visFlat;
-			visFlat.entityRenderID = entity->getRenderID();
-			visFlat.animStateID = visData.stateIndex;
-			visFlat.animAngleID = visData.angleIndex;
-			visFlat.animTextureID = visData.keyframeIndex;
+			visFlat.entityRenderID = entityInst.getEntityRenderID();
+			visFlat.animStateID = entityInst.getAnimStateID();
+			visFlat.animAngleID = entityInst.getAnimAngleID();
+			visFlat.animTextureID = entityInst.getAnimKeyframeID();
+			visFlat.entityID = entityInst.getEntityID();
 
 			// Calculate each corner of the flat in world space.
-			visFlat.bottomLeft = visData.flatPosition + flatRightScaled;
-			visFlat.bottomRight = visData.flatPosition - flatRightScaled;
+			visFlat.bottomLeft = flatPosition + flatRightScaled;
+			visFlat.bottomRight = flatPosition - flatRightScaled;
 			visFlat.topLeft = visFlat.bottomLeft + flatUpScaled;
 			visFlat.topRight = visFlat.bottomRight + flatUpScaled;
 
@@ -1817,12 +3142,134 @@ void SoftwareRenderer::updateVisibleFlats(const Camera &camera, const ShadingInf
 	}
 
 	// Sort the visible flats farthest to nearest (relevant for transparencies).
-	std::sort(this->visibleFlats.begin(), this->visibleFlats.end(),
-		[](const VisibleFlat &a, const VisibleFlat &b) { return a.z > b.z; });
+	SoftwareRenderer::sortVisibleFlats(this->visibleFlats, this->flatSortOrder);
+}
+
+void SoftwareRenderer::sortVisibleFlats(std::vector<VisibleFlat> &visibleFlats, FlatSortOrder &sortOrder)
+{
+	const int flatCount = static_cast<int>(visibleFlats.size());
+	const int oldFlatCount = static_cast<int>(sortOrder.sortedEntityIDs.size());
+	std::vector<int> &entityRanks = sortOrder.entityRanks;
+
+	// Put flats that were visible last frame back in last frame's order, followed by new ones.
+	std::vector<int> &rankSlots = sortOrder.rankSlots;
+	std::vector<int> &flatRanks = sortOrder.flatRanks;
+	rankSlots.assign(oldFlatCount, -1);
+	flatRanks.resize(flatCount);
+
+	int newFlatCount = 0;
+	for (int i = 0; i < flatCount; i++)
+	{
+		const EntityID entityID = visibleFlats[i].entityID;
+		const int rank = ((entityID >= 0) && (entityID < static_cast<int>(entityRanks.size()))) ?
+			entityRanks[entityID] : -1;
+
+		if ((rank >= 0) && (rank < oldFlatCount) && (rankSlots[rank] < 0))
+		{
+			rankSlots[rank] = i;
+			flatRanks[i] = rank;
+		}
+		else
+		{
+			flatRanks[i] = -1;
+			newFlatCount++;
+		}
+	}
+
+	auto isFarther = [](const VisibleFlat &a, const VisibleFlat &b) { return a.z > b.z; };
+
+	const bool useInsertionSort = static_cast<double>(newFlatCount) <=
+		(static_cast<double>(flatCount) * FlatSortOrder::MAX_NEW_FLAT_PERCENT);
+	if (useInsertionSort)
+	{
+		std::vector<VisibleFlat> &seededFlats = sortOrder.seededFlats;
+		seededFlats.clear();
+
+		for (const int flatIndex : rankSlots)
+		{
+			if (flatIndex >= 0)
+			{
+				seededFlats.push_back(visibleFlats[flatIndex]);
+			}
+		}
+
+		for (int i = 0; i < flatCount; i++)
+		{
+			if (flatRanks[i] < 0)
+			{
+				seededFlats.push_back(visibleFlats[i]);
+			}
+		}
+
+		std::swap(visibleFlats, seededFlats);
+
+		// Insertion sort. Each move is one inversion left over from last frame's order. If the
+		// order changed too much (i.e., the camera turned around), it would be quadratic, so give
+		// up past about n log n moves and do a full sort of whatever order it got to.
+		const int maxShifts = std::max(static_cast<int>(static_cast<double>(flatCount) *
+			std::log2(static_cast<double>(std::max(flatCount, 2)))), flatCount);
+		sortOrder.shifts = 0;
+		for (int i = 1; i < flatCount; i++)
+		{
+			if (sortOrder.shifts > maxShifts)
+			{
+				std::sort(visibleFlats.begin(), visibleFlats.end(), isFarther);
+				sortOrder.shifts = -1;
+				break;
+			}
+
+			if (!isFarther(visibleFlats[i], visibleFlats[i - 1]))
+			{
+				continue;
+			}
+
+			VisibleFlat flat = visibleFlats[i];
+			int j = i;
+			while ((j > 0) && isFarther(flat, visibleFlats[j - 1]))
+			{
+				visibleFlats[j] = visibleFlats[j - 1];
+				j--;
+			}
+
+			visibleFlats[j] = flat;
+			sortOrder.shifts += i - j;
+		}
+	}
+	else
+	{
+		std::sort(visibleFlats.begin(), visibleFlats.end(), isFarther);
+		sortOrder.shifts = -1;
+	}
+
+	// Remember this frame's order for the next one.
+	for (const EntityID entityID : sortOrder.sortedEntityIDs)
+	{
+		if ((entityID >= 0) && (entityID < static_cast<int>(entityRanks.size())))
+		{
+			entityRanks[entityID] = -1;
+		}
+	}
+
+	sortOrder.sortedEntityIDs.resize(flatCount);
+	for (int i = 0; i < flatCount; i++)
+	{
+		const EntityID entityID = visibleFlats[i].entityID;
+		sortOrder.sortedEntityIDs[i] = entityID;
+
+		if (entityID >= 0)
+		{
+			if (entityID >= static_cast<int>(entityRanks.size()))
+			{
+				entityRanks.resize(entityID + 1, -1);
+			}
+
+			entityRanks[entityID] = i;
+		}
+	}
 }
 
 void SoftwareRenderer::updateVisibleLightLists(const Camera &camera, int chunkDistance,
-	double ceilingHeight, const VoxelGrid &voxelGrid)
+	double ceilingHeight)
 {
 	// Visible light lists are relative to the potentially visible chunks.
 	const ChunkCoord cameraChunkCoord = VoxelUtils::newVoxelToChunkVoxel(
@@ -1843,29 +3290,57 @@ void SoftwareRenderer::updateVisibleLightLists(const Camera &camera, int chunkDi
 	const SNInt visLightListVoxelCountX = potentiallyVisChunkCountX * ChunkUtils::CHUNK_DIM;
 	const WEInt visLightListVoxelCountZ = potentiallyVisChunkCountZ * ChunkUtils::CHUNK_DIM;
 
+	LightGrid &lightGrid = this->lightGrid;
+	lightGrid.lightsBinned = 0;
+	lightGrid.cellsTouched = 0;
+
 	if (!this->visLightLists.isValid() ||
 		(this->visLightLists.getWidth() != visLightListVoxelCountX) ||
 		(this->visLightLists.getHeight() != visLightListVoxelCountZ))
 	{
 		this->visLightLists.init(visLightListVoxelCountX, visLightListVoxelCountZ);
+		lightGrid.invalidate();
 	}
 
-	// Clear all potentially visible light lists.
-	for (WEInt z = 0; z < this->visLightLists.getHeight(); z++)
+	// Static lights only need re-binning if the lists moved with the camera's chunk or the static
+	// lights themselves changed (i.e., chunks were loaded or night lights were toggled).
+	const bool staticLightsChanged = [&lightGrid]()
 	{
-		for (SNInt x = 0; x < this->visLightLists.getWidth(); x++)
+		const std::vector<VisibleLight> &oldLights = lightGrid.staticLights;
+		const std::vector<VisibleLight> &newLights = lightGrid.frameStaticLights;
+		return !std::equal(oldLights.begin(), oldLights.end(), newLights.begin(), newLights.end(),
+			[](const VisibleLight &a, const VisibleLight &b)
 		{
-			VisibleLightList &visLightList = this->visLightLists.get(x, z);
-			visLightList.clear();
-		}
+			return (a.position == b.position) && (a.radius == b.radius);
+		});
+	}();
+
+	const bool rebinStaticLights = !lightGrid.isValid || staticLightsChanged ||
+		(lightGrid.originVoxel != minAbsoluteChunkVoxel) || (lightGrid.ceilingHeight != ceilingHeight);
+
+	// Static lights always come first in the visible lights so their IDs stay the same between
+	// frames. Dynamic lights gathered this frame follow them.
+	if (rebinStaticLights)
+	{
+		std::swap(lightGrid.staticLights, lightGrid.frameStaticLights);
 	}
 
-	// Populate potentially visible light lists based on visible lights.
-	for (size_t i = 0; i < this->visibleLights.size(); i++)
+	const int staticLightCount = static_cast<int>(lightGrid.staticLights.size());
+	const int dynamicLightCount = static_cast<int>(this->visibleLights.size());
+	this->visibleLights.insert(this->visibleLights.begin(), lightGrid.staticLights.begin(),
+		lightGrid.staticLights.end());
+
+	const BufferView<const VisibleLight> visLightsView(this->visibleLights.data(),
+		static_cast<int>(this->visibleLights.size()));
+
+	// Lambda for adding a light to every voxel column list it reaches, calling the given function
+	// with each list's index.
+	auto binLight = [this, &minAbsoluteChunkVoxel, visLightListVoxelCountX, visLightListVoxelCountZ,
+		&lightGrid](int lightIndex, const auto &onListChanged)
 	{
 		// Iterate over all voxels columns touched by the light.
-		const VisibleLight &visLight = this->visibleLights[i];
-		const VisibleLightList::LightID visLightID = static_cast<VisibleLightList::LightID>(i);
+		const VisibleLight &visLight = this->visibleLights[lightIndex];
+		const VisibleLightList::LightID visLightID = static_cast<VisibleLightList::LightID>(lightIndex);
 
 		// Bounding box around the light's reach in the XZ plane.
 		const NewInt2 visLightMin(
@@ -1901,300 +3376,95 @@ void SoftwareRenderer::updateVisibleLightLists(const Camera &camera, int chunkDi
 					if (!visLightList.isFull())
 					{
 						visLightList.add(visLightID);
+						onListChanged(x + (z * visLightListVoxelCountX));
 					}
 				}
 			}
 		}
-	}
 
-	// Sort all of the touched voxel columns' light references by distance (shading optimization).
-	const BufferView<const VisibleLight> visLightsView(this->visibleLights.data(),
-		static_cast<int>(this->visibleLights.size()));
+		lightGrid.lightsBinned++;
+	};
 
-	for (WEInt z = 0; z < this->visLightLists.getHeight(); z++)
+	// Lambda for sorting a list's light references by distance (shading optimization).
+	auto sortList = [this, &minAbsoluteChunkVoxel, visLightListVoxelCountX, ceilingHeight,
+		&visLightsView](int listIndex)
 	{
-		for (SNInt x = 0; x < this->visLightLists.getWidth(); x++)
+		const SNInt x = listIndex % visLightListVoxelCountX;
+		const WEInt z = listIndex / visLightListVoxelCountX;
+		VisibleLightList &visLightList = this->visLightLists.get(x, z);
+		if (visLightList.count >= 2)
 		{
-			VisibleLightList &visLightList = this->visLightLists.get(x, z);
-			if (visLightList.count >= 2)
-			{
-				const NewInt2 voxel(x + minAbsoluteChunkVoxel.x, z + minAbsoluteChunkVoxel.y);
+			const NewInt2 voxel(x + minAbsoluteChunkVoxel.x, z + minAbsoluteChunkVoxel.y);
 
-				// Default to the middle of the main floor for now (voxel columns aren't really in 3D).
-				const Double3 voxelColumnPoint(
-					static_cast<SNDouble>(voxel.x) + 0.50,
-					ceilingHeight * 1.50,
-					static_cast<WEDouble>(voxel.y) + 0.50);
+			// Default to the middle of the main floor for now (voxel columns aren't really in 3D).
+			const Double3 voxelColumnPoint(
+				static_cast<SNDouble>(voxel.x) + 0.50,
+				ceilingHeight * 1.50,
+				static_cast<WEDouble>(voxel.y) + 0.50);
 
-				visLightList.sortByNearest(voxelColumnPoint, visLightsView);
-			}
+			visLightList.sortByNearest(voxelColumnPoint, visLightsView);
 		}
-	}
-}
-
-VoxelFacing2D SoftwareRenderer::getInitialChasmFarFacing(SNInt voxelX, WEInt voxelZ,
-	const NewDouble2 &eye, const Ray &ray)
-{
-	// Angle of the ray from the camera eye.
-	const Radians angle = MathUtils::fullAtan2(-ray.dirX, -ray.dirZ);
-
-	// Corners in world space.
-	NewDouble2 topLeftCorner, topRightCorner, bottomLeftCorner, bottomRightCorner;
-	RendererUtils::getVoxelCorners2D(voxelX, voxelZ, &topLeftCorner, &topRightCorner,
-		&bottomLeftCorner, &bottomRightCorner);
-
-	const NewDouble2 upLeft = (topLeftCorner - eye).normalized();
-	const NewDouble2 upRight = (topRightCorner - eye).normalized();
-	const NewDouble2 downLeft = (bottomLeftCorner - eye).normalized();
-	const NewDouble2 downRight = (bottomRightCorner - eye).normalized();
-	const Radians upLeftAngle = MathUtils::fullAtan2(upLeft);
-	const Radians upRightAngle = MathUtils::fullAtan2(upRight);
-	const Radians downLeftAngle = MathUtils::fullAtan2(downLeft);
-	const Radians downRightAngle = MathUtils::fullAtan2(downRight);
+	};
 
-	// Find which range the ray's angle lies within.
-	if ((angle < upRightAngle) || (angle > downRightAngle))
-	{
-		return VoxelFacing2D::NegativeZ;
-	}
-	else if (angle < upLeftAngle)
-	{
-		return VoxelFacing2D::NegativeX;
-	}
-	else if (angle < downLeftAngle)
-	{
-		return VoxelFacing2D::PositiveZ;
-	}
-	else
-	{
-		return VoxelFacing2D::PositiveX;
-	}
-}
+	const int listCount = visLightListVoxelCountX * visLightListVoxelCountZ;
+	std::vector<int> &dynamicCellIndices = lightGrid.dynamicCellIndices;
 
-VoxelFacing2D SoftwareRenderer::getChasmFarFacing(SNInt voxelX, WEInt voxelZ, 
-	VoxelFacing2D nearFacing, const Camera &camera, const Ray &ray)
-{
-	const NewDouble2 eye2D(camera.eye.x, camera.eye.z);
-	
-	// Angle of the ray from the camera eye.
-	const Radians angle = MathUtils::fullAtan2(-ray.dirX, -ray.dirZ);
-	
-	// Corners in world space.
-	NewDouble2 topLeftCorner, topRightCorner, bottomLeftCorner, bottomRightCorner;
-	RendererUtils::getVoxelCorners2D(voxelX, voxelZ, &topLeftCorner, &topRightCorner,
-		&bottomLeftCorner, &bottomRightCorner);
-
-	const NewDouble2 upLeft = (topLeftCorner - eye2D).normalized();
-	const NewDouble2 upRight = (topRightCorner - eye2D).normalized();
-	const NewDouble2 downLeft = (bottomLeftCorner - eye2D).normalized();
-	const NewDouble2 downRight = (bottomRightCorner - eye2D).normalized();
-	const Radians upLeftAngle = MathUtils::fullAtan2(upLeft);
-	const Radians upRightAngle = MathUtils::fullAtan2(upRight);
-	const Radians downLeftAngle = MathUtils::fullAtan2(downLeft);
-	const Radians downRightAngle = MathUtils::fullAtan2(downRight);
-
-	// Find which side it starts on then do some checks against line angles. When the
-	// ray origin's voxel is at a diagonal to the voxel, ignore the corner and two
-	// sides closest to that origin.
-	if (nearFacing == VoxelFacing2D::PositiveX)
-	{
-		// Starts somewhere on (1.0, z).
-		if (camera.eyeVoxel.z > voxelZ)
-		{
-			// Ignore bottom-left corner.
-			if (angle < upRightAngle)
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-		}
-		else if (camera.eyeVoxel.z < voxelZ)
-		{
-			// Ignore bottom-right corner.
-			if (angle < upLeftAngle)
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-		}
-		else
-		{
-			if ((angle > upLeftAngle) && (angle < downLeftAngle))
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-			else if ((angle > upRightAngle) && (angle < upLeftAngle))
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
-		}
-	}
-	else if (nearFacing == VoxelFacing2D::NegativeX)
-	{
-		// Starts somewhere on (0.0, z).
-		if (camera.eyeVoxel.z > voxelZ)
-		{
-			// Ignore top-left corner.
-			if ((angle < downRightAngle) && (angle > downLeftAngle))
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
-		}
-		else if (camera.eyeVoxel.z < voxelZ)
-		{
-			// Ignore top-right corner.
-			if (angle < downLeftAngle)
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-			else
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-		}
-		else
-		{
-			if ((angle < downLeftAngle) && (angle > upLeftAngle))
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-			else if ((angle < downRightAngle) && (angle > downLeftAngle))
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
-		}
-	}				
-	else if (nearFacing == VoxelFacing2D::PositiveZ)
+	if (rebinStaticLights)
 	{
-		// Starts somewhere on (x, 1.0).
-		if (camera.eyeVoxel.x > voxelX)
+		// Start over with only the static lights.
+		for (int i = 0; i < listCount; i++)
 		{
-			// Ignore bottom-left corner.
-			if ((angle > upRightAngle) && (angle < upLeftAngle))
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
+			this->visLightLists.get()[i].clear();
 		}
-		else if (camera.eyeVoxel.x < voxelX)
+
+		for (int i = 0; i < staticLightCount; i++)
 		{
-			// Ignore top-left corner.
-			if ((angle < downRightAngle) && (angle > downLeftAngle))
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
+			binLight(i, [](int) { });
 		}
-		else
+
+		for (int i = 0; i < listCount; i++)
 		{
-			if ((angle < downRightAngle) && (angle > downLeftAngle))
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-			else if ((angle < upLeftAngle) && (angle > upRightAngle))
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else
-			{
-				return VoxelFacing2D::NegativeZ;
-			}
+			sortList(i);
 		}
+
+		lightGrid.originVoxel = minAbsoluteChunkVoxel;
+		lightGrid.ceilingHeight = ceilingHeight;
+		lightGrid.isValid = true;
+		lightGrid.cellsTouched += listCount;
 	}
 	else
 	{
-		// Starts somewhere on (x, 0.0).
-		if (camera.eyeVoxel.x > voxelX)
-		{
-			// Ignore bottom-right corner.
-			if (angle < upLeftAngle)
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-		}
-		else if (camera.eyeVoxel.x < voxelX)
-		{
-			// Ignore top-right corner.
-			if (angle > downLeftAngle)
-			{
-				return VoxelFacing2D::PositiveX;
-			}
-			else
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-		}
-		else
+		// Take out the previous frame's dynamic lights. Static lights stay sorted.
+		const VisibleLightList::LightID firstDynamicLightID =
+			static_cast<VisibleLightList::LightID>(staticLightCount);
+		for (const int listIndex : dynamicCellIndices)
 		{
-			if (angle < upLeftAngle)
-			{
-				return VoxelFacing2D::NegativeX;
-			}
-			else if (angle < downLeftAngle)
-			{
-				return VoxelFacing2D::PositiveZ;
-			}
-			else
-			{
-				return VoxelFacing2D::PositiveX;
-			}
+			this->visLightLists.get()[listIndex].removeFrom(firstDynamicLightID);
 		}
+
+		lightGrid.cellsTouched += static_cast<int>(dynamicCellIndices.size());
 	}
-}
 
-void SoftwareRenderer::getChasmTextureGroupTexture(const ChasmTextureGroups &textureGroups,
-	VoxelDefinition::ChasmData::Type chasmType, double chasmAnimPercent,
-	const ChasmTexture **outTexture)
-{
-	const int chasmID = RendererUtils::getChasmIdFromType(chasmType);
-	const auto groupIter = textureGroups.find(chasmID);
-	if (groupIter == textureGroups.end())
+	// Bin this frame's dynamic lights and re-sort the lists they reached.
+	dynamicCellIndices.clear();
+	for (int i = 0; i < dynamicLightCount; i++)
 	{
-		DebugCrash("Missing chasm texture group " + std::to_string(chasmID) + ".");
-		*outTexture = nullptr;
-		return;
+		binLight(staticLightCount + i, [&dynamicCellIndices](int listIndex)
+		{
+			dynamicCellIndices.push_back(listIndex);
+		});
 	}
 
-	const auto &textureGroup = groupIter->second;
-	const int groupSize = static_cast<int>(textureGroup.size());
-	if (groupSize == 0)
+	std::sort(dynamicCellIndices.begin(), dynamicCellIndices.end());
+	dynamicCellIndices.erase(std::unique(dynamicCellIndices.begin(), dynamicCellIndices.end()),
+		dynamicCellIndices.end());
+
+	for (const int listIndex : dynamicCellIndices)
 	{
-		DebugCrash("Empty chasm texture group " + std::to_string(chasmID) + ".");
-		*outTexture = nullptr;
-		return;
+		sortList(listIndex);
 	}
 
-	const double groupRealIndex = MathUtils::getRealIndex(groupSize, chasmAnimPercent);
-	const int animIndex = static_cast<int>(groupRealIndex);
-	*outTexture = &textureGroup[animIndex];
+	lightGrid.cellsTouched += static_cast<int>(dynamicCellIndices.size());
 }
 
 const SoftwareRenderer::VisibleLight &SoftwareRenderer::getVisibleLightByID(
@@ -2741,21 +4011,20 @@ bool SoftwareRenderer::findInitialSwingingDoorIntersection(SNInt voxelX, WEInt v
 bool SoftwareRenderer::findInitialDoorIntersection(SNInt voxelX, WEInt voxelZ,
 	VoxelDefinition::DoorData::Type doorType, double percentOpen, const NewDouble2 &nearPoint,
 	const NewDouble2 &farPoint, const Camera &camera, const Ray &ray,
-	const VoxelGrid &voxelGrid, RayHit &hit)
+	const RenderDefinitionGroup &defGroup, RayHit &hit)
 {
 	// Determine which axis the door should open/close for (either X or Z).
-	const bool xAxis = [voxelX, voxelZ, &voxelGrid]()
+	const bool xAxis = [voxelX, voxelZ, &defGroup]()
 	{
 		// Check adjacent voxels on the X axis for air.
-		auto voxelIsAir = [&voxelGrid](SNInt x, WEInt z)
+		auto voxelIsAir = [&defGroup](SNInt x, WEInt z)
 		{
-			const bool insideGrid = (x >= 0) && (x < voxelGrid.getWidth()) &&
-				(z >= 0) && (z < voxelGrid.getDepth());
+			const bool insideGrid = (x >= 0) && (x < defGroup.getWidth()) &&
+				(z >= 0) && (z < defGroup.getDepth());
 
 			if (insideGrid)
 			{
-				const uint16_t voxelID = voxelGrid.getVoxel(x, 1, z);
-				const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+				const VoxelDefinition &voxelDef = defGroup.getVoxelDef(x, 1, z);
 				return voxelDef.dataType == VoxelDataType::None;
 			}
 			else
@@ -3215,11 +4484,14 @@ double SoftwareRenderer::getLightContributionAtPoint(const NewDouble2 &point,
 
 // @todo: might be better as a macro so there's no chance of a function call in the pixel loop.
 template <int FilterMode, bool Transparency>
-void SoftwareRenderer::sampleVoxelTexture(const VoxelTexture &texture, double u, double v,
-	double *r, double *g, double *b, double *emission, bool *transparent)
+void SoftwareRenderer::sampleVoxelTexture(const VoxelTexture &texture, ShadingReal u, ShadingReal v,
+	ShadingReal *r, ShadingReal *g, ShadingReal *b, ShadingReal *emission, bool *transparent)
 {
-	const double textureWidthReal = static_cast<double>(texture.width);
-	const double textureHeightReal = static_cast<double>(texture.height);
+	const ShadingReal textureWidthReal = static_cast<ShadingReal>(texture.width);
+	const ShadingReal textureHeightReal = static_cast<ShadingReal>(texture.height);
+	const std::array<ShadingReal, 256> &channelTable = TexelChannelTable<ShadingReal>;
+	constexpr ShadingReal zero = static_cast<ShadingReal>(0.0);
+	constexpr ShadingReal one = static_cast<ShadingReal>(1.0);
 
 	if constexpr (FilterMode == 0)
 	{
@@ -3229,37 +4501,38 @@ void SoftwareRenderer::sampleVoxelTexture(const VoxelTexture &texture, double u,
 		const int textureIndex = textureX + (textureY * texture.width);
 
 		const VoxelTexel &texel = texture.texels[textureIndex];
-		*r = texel.r;
-		*g = texel.g;
-		*b = texel.b;
-		*emission = texel.emission;
+		*r = channelTable[texel.r];
+		*g = channelTable[texel.g];
+		*b = channelTable[texel.b];
+		*emission = ((texel.flags & VoxelTexel::FLAG_EMISSIVE) != 0) ? one : zero;
 		
 		if constexpr (Transparency)
 		{
-			*transparent = texel.transparent;
+			*transparent = (texel.flags & VoxelTexel::FLAG_TRANSPARENT) != 0;
 		}
 	}
 	else if constexpr (FilterMode == 1)
 	{
 		// Linear.
-		const double texelWidth = 1.0 / textureWidthReal;
-		const double texelHeight = 1.0 / textureHeightReal;
-		const double halfTexelWidth = texelWidth / 2.0;
-		const double halfTexelHeight = texelHeight / 2.0;
-		const double uL = std::max(u - halfTexelWidth, 0.0); // Change to wrapping for better texture edges
-		const double uR = std::min(u + halfTexelWidth, Constants::JustBelowOne);
-		const double vT = std::max(v - halfTexelHeight, 0.0);
-		const double vB = std::min(v + halfTexelHeight, Constants::JustBelowOne);
-		const double uLWidth = uL * textureWidthReal;
-		const double vTHeight = vT * textureHeightReal;
-		const double uLPercent = 1.0 - (uLWidth - std::floor(uLWidth));
-		const double uRPercent = 1.0 - uLPercent;
-		const double vTPercent = 1.0 - (vTHeight - std::floor(vTHeight));
-		const double vBPercent = 1.0 - vTPercent;
-		const double tlPercent = uLPercent * vTPercent;
-		const double trPercent = uRPercent * vTPercent;
-		const double blPercent = uLPercent * vBPercent;
-		const double brPercent = uRPercent * vBPercent;
+		constexpr ShadingReal justBelowOne = static_cast<ShadingReal>(Constants::JustBelowOne);
+		const ShadingReal texelWidth = one / textureWidthReal;
+		const ShadingReal texelHeight = one / textureHeightReal;
+		const ShadingReal halfTexelWidth = texelWidth / static_cast<ShadingReal>(2.0);
+		const ShadingReal halfTexelHeight = texelHeight / static_cast<ShadingReal>(2.0);
+		const ShadingReal uL = std::max(u - halfTexelWidth, zero); // Change to wrapping for better texture edges
+		const ShadingReal uR = std::min(u + halfTexelWidth, justBelowOne);
+		const ShadingReal vT = std::max(v - halfTexelHeight, zero);
+		const ShadingReal vB = std::min(v + halfTexelHeight, justBelowOne);
+		const ShadingReal uLWidth = uL * textureWidthReal;
+		const ShadingReal vTHeight = vT * textureHeightReal;
+		const ShadingReal uLPercent = one - (uLWidth - std::floor(uLWidth));
+		const ShadingReal uRPercent = one - uLPercent;
+		const ShadingReal vTPercent = one - (vTHeight - std::floor(vTHeight));
+		const ShadingReal vBPercent = one - vTPercent;
+		const ShadingReal tlPercent = uLPercent * vTPercent;
+		const ShadingReal trPercent = uRPercent * vTPercent;
+		const ShadingReal blPercent = uLPercent * vBPercent;
+		const ShadingReal brPercent = uRPercent * vBPercent;
 		const int textureXL = static_cast<int>(uL * textureWidthReal);
 		const int textureXR = static_cast<int>(uR * textureWidthReal);
 		const int textureYT = static_cast<int>(vT * textureHeightReal);
@@ -3273,16 +4546,24 @@ void SoftwareRenderer::sampleVoxelTexture(const VoxelTexture &texture, double u,
 		const VoxelTexel &texelTR = texture.texels[textureIndexTR];
 		const VoxelTexel &texelBL = texture.texels[textureIndexBL];
 		const VoxelTexel &texelBR = texture.texels[textureIndexBR];
-		*r = (texelTL.r * tlPercent) + (texelTR.r * trPercent) + (texelBL.r * blPercent) + (texelBR.r * brPercent);
-		*g = (texelTL.g * tlPercent) + (texelTR.g * trPercent) + (texelBL.g * blPercent) + (texelBR.g * brPercent);
-		*b = (texelTL.b * tlPercent) + (texelTR.b * trPercent) + (texelBL.b * blPercent) + (texelBR.b * brPercent);
-		*emission = (texelTL.emission * tlPercent) + (texelTR.emission * trPercent) +
-			(texelBL.emission * blPercent) + (texelBR.emission * brPercent);
+		auto getEmission = [zero, one](const VoxelTexel &texel)
+		{
+			return ((texel.flags & VoxelTexel::FLAG_EMISSIVE) != 0) ? one : zero;
+		};
+
+		*r = (channelTable[texelTL.r] * tlPercent) + (channelTable[texelTR.r] * trPercent) +
+			(channelTable[texelBL.r] * blPercent) + (channelTable[texelBR.r] * brPercent);
+		*g = (channelTable[texelTL.g] * tlPercent) + (channelTable[texelTR.g] * trPercent) +
+			(channelTable[texelBL.g] * blPercent) + (channelTable[texelBR.g] * brPercent);
+		*b = (channelTable[texelTL.b] * tlPercent) + (channelTable[texelTR.b] * trPercent) +
+			(channelTable[texelBL.b] * blPercent) + (channelTable[texelBR.b] * brPercent);
+		*emission = (getEmission(texelTL) * tlPercent) + (getEmission(texelTR) * trPercent) +
+			(getEmission(texelBL) * blPercent) + (getEmission(texelBR) * brPercent);
 
 		if constexpr (Transparency)
 		{
-			*transparent = texelTL.transparent && texelTR.transparent &&
-				texelBL.transparent && texelBR.transparent;
+			*transparent = (texelTL.flags & texelTR.flags & texelBL.flags & texelBR.flags &
+				VoxelTexel::FLAG_TRANSPARENT) != 0;
 		}
 	}
 	else
@@ -3306,9 +4587,9 @@ void SoftwareRenderer::sampleChasmTexture(const ChasmTexture &texture, double sc
 	const int textureIndex = textureX + (textureY * texture.width);
 
 	const ChasmTexel &texel = texture.texels[textureIndex];
-	*r = texel.r;
-	*g = texel.g;
-	*b = texel.b;
+	*r = TexelChannelTable<double>[texel.r];
+	*g = TexelChannelTable<double>[texel.g];
+	*b = TexelChannelTable<double>[texel.b];
 }
 
 template <bool Fading>
@@ -3318,21 +4599,31 @@ void SoftwareRenderer::drawPixelsShader(int x, const DrawRange &drawRange, doubl
 	OcclusionData &occlusion, const FrameView &frame)
 {
 	// Draw range values.
-	const double yProjStart = drawRange.yProjStart;
-	const double yProjEnd = drawRange.yProjEnd;
+	const ShadingReal yProjStart = static_cast<ShadingReal>(drawRange.yProjStart);
+	const ShadingReal yProjEnd = static_cast<ShadingReal>(drawRange.yProjEnd);
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
+	// Texture coordinates in shading precision.
+	const ShadingReal textureU = static_cast<ShadingReal>(u);
+	const ShadingReal textureVStart = static_cast<ShadingReal>(vStart);
+	const ShadingReal textureVEnd = static_cast<ShadingReal>(vEnd);
+
 	// Horizontal offset in texture.
 	// - Taken care of in texture sampling function (redundant calculation, though).
 	//const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 
 	// Linearly interpolated fog.
 	const Double3 &fogColor = shadingInfo.getFogColor();
-	const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+	const ShadingReal fogR = static_cast<ShadingReal>(fogColor.x);
+	const ShadingReal fogG = static_cast<ShadingReal>(fogColor.y);
+	const ShadingReal fogB = static_cast<ShadingReal>(fogColor.z);
+	const ShadingReal fogPercent = static_cast<ShadingReal>(std::min(depth / shadingInfo.fogDistance, 1.0));
 
 	// Shading on the texture.
-	const Double3 shading(shadingInfo.ambient, shadingInfo.ambient, shadingInfo.ambient);
+	const ShadingReal shading = static_cast<ShadingReal>(shadingInfo.ambient);
+	const ShadingReal lightContribution = static_cast<ShadingReal>(lightContributionPercent);
+	const ShadingReal fade = static_cast<ShadingReal>(fadePercent);
 
 	// Clip the Y start and end coordinates as needed, and refresh the occlusion buffer.
 	occlusion.clipRange(&yStart, &yEnd);
@@ -3341,7 +4632,7 @@ void SoftwareRenderer::drawPixelsShader(int x, const DrawRange &drawRange, doubl
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Check depth of the pixel before rendering.
 		// - @todo: implement occlusion culling and back-to-front transparent rendering so
@@ -3349,54 +4640,146 @@ void SoftwareRenderer::drawPixelsShader(int x, const DrawRange &drawRange, doubl
 		if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
 		{
 			// Percent stepped from beginning to end on the column.
-			const double yPercent =
-				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
+			const ShadingReal yPercent =
+				((static_cast<ShadingReal>(y) + static_cast<ShadingReal>(0.50)) - yProjStart) /
+				(yProjEnd - yProjStart);
 
 			// Vertical texture coordinate.
-			const double v = vStart + ((vEnd - vStart) * yPercent);
+			const ShadingReal v = textureVStart + ((textureVEnd - textureVStart) * yPercent);
 
 			// Texture color. Alpha is ignored in this loop, so transparent texels will appear black.
 			constexpr bool TextureTransparency = false;
-			double colorR, colorG, colorB, colorEmission;
+			ShadingReal colorR, colorG, colorB, colorEmission;
 			SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, TextureTransparency>(
-				texture, u, v, &colorR, &colorG, &colorB, &colorEmission, nullptr);
+				texture, textureU, v, &colorR, &colorG, &colorB, &colorEmission, nullptr);
 
 			// Shading from light.
-			constexpr double shadingMax = 1.0;
-			const double combinedEmission = colorEmission + lightContributionPercent;
-			const double lightR = shading.x + combinedEmission;
-			const double lightG = shading.y + combinedEmission;
-			const double lightB = shading.z + combinedEmission;
-			colorR *= (lightR < shadingMax) ? lightR : shadingMax;
-			colorG *= (lightG < shadingMax) ? lightG : shadingMax;
-			colorB *= (lightB < shadingMax) ? lightB : shadingMax;
+			constexpr ShadingReal shadingMax = static_cast<ShadingReal>(1.0);
+			const ShadingReal combinedEmission = colorEmission + lightContribution;
+			const ShadingReal light = shading + combinedEmission;
+			const ShadingReal lightPercent = (light < shadingMax) ? light : shadingMax;
+			colorR *= lightPercent;
+			colorG *= lightPercent;
+			colorB *= lightPercent;
 
 			if constexpr (Fading)
 			{
 				// Apply voxel fade percent.
-				colorR *= fadePercent;
-				colorG *= fadePercent;
-				colorB *= fadePercent;
+				colorR *= fade;
+				colorG *= fade;
+				colorB *= fade;
 			}
 
 			// Linearly interpolate with fog.
-			colorR += (fogColor.x - colorR) * fogPercent;
-			colorG += (fogColor.y - colorG) * fogPercent;
-			colorB += (fogColor.z - colorB) * fogPercent;
+			colorR += (fogR - colorR) * fogPercent;
+			colorG += (fogG - colorG) * fogPercent;
+			colorB += (fogB - colorB) * fogPercent;
 
 			// Clamp maximum (don't worry about negative values).
-			constexpr double high = 1.0;
+			constexpr ShadingReal high = static_cast<ShadingReal>(1.0);
 			colorR = (colorR > high) ? high : colorR;
 			colorG = (colorG > high) ? high : colorG;
 			colorB = (colorB > high) ? high : colorB;
 
-			// Convert floats to integers.
-			const uint32_t colorRGB = static_cast<uint32_t>(
-				((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-				((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-				((static_cast<uint8_t>(colorB * 255.0))));
+			// Convert floats to integers.
+			constexpr ShadingReal channelMax = static_cast<ShadingReal>(255.0);
+			const uint32_t colorRGB = static_cast<uint32_t>(
+				((static_cast<uint8_t>(colorR * channelMax)) << 16) |
+				((static_cast<uint8_t>(colorG * channelMax)) << 8) |
+				((static_cast<uint8_t>(colorB * channelMax))));
+
+			frame.colorBuffer[index] = colorRGB;
+			frame.depthBuffer[index] = depth;
+		}
+	}
+}
+
+template <bool Transparency>
+void SoftwareRenderer::drawPixelsVectorized(int x, int yStart, int yEnd, const DrawRange &drawRange,
+	double depth, double u, double vStart, double vEnd, const VoxelTexture &texture,
+	double fadePercent, double lightContributionPercent, const ShadingInfo &shadingInfo,
+	const FrameView &frame)
+{
+	const ColumnKernels::Table &kernels = ColumnKernels::getActiveTable();
+
+	const Double3 &fogColor = shadingInfo.getFogColor();
+	ColumnShadeParams shadeParams;
+	shadeParams.ambient = static_cast<ShadingReal>(shadingInfo.ambient);
+	shadeParams.fade = static_cast<ShadingReal>(fadePercent);
+	shadeParams.fogR = static_cast<ShadingReal>(fogColor.x);
+	shadeParams.fogG = static_cast<ShadingReal>(fogColor.y);
+	shadeParams.fogB = static_cast<ShadingReal>(fogColor.z);
+	shadeParams.lightContribution = static_cast<ShadingReal>(lightContributionPercent);
+	shadeParams.fogPercent = static_cast<ShadingReal>(std::min(depth / shadingInfo.fogDistance, 1.0));
+
+	const ShadingReal yProjStart = static_cast<ShadingReal>(drawRange.yProjStart);
+	const ShadingReal yProjEnd = static_cast<ShadingReal>(drawRange.yProjEnd);
+	const ShadingReal textureVStart = static_cast<ShadingReal>(vStart);
+	const ShadingReal textureVEnd = static_cast<ShadingReal>(vEnd);
+	const ShadingReal textureU = static_cast<ShadingReal>(u);
+
+	// Rows that passed the depth test, and their sampled colors.
+	alignas(ColumnKernels::ChunkAlignment) int rows[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal textureVs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorRs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorGs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorBs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal emissions[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) uint32_t colors[ColumnKernels::ChunkSize];
+
+	int y = yStart;
+	while (y < yEnd)
+	{
+		const int chunkEnd = std::min(y + ColumnKernels::ChunkSize, yEnd);
+
+		// Check depth of each pixel before rendering.
+		int rowCount = 0;
+		for (; y < chunkEnd; y++)
+		{
+			const int index = frame.getIndex(x, y);
+			if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
+			{
+				rows[rowCount] = y;
+				rowCount++;
+			}
+		}
+
+		if (rowCount == 0)
+		{
+			continue;
+		}
+
+		InterpolateColumnV(kernels, rows, rowCount, yProjStart, yProjEnd, textureVStart, textureVEnd,
+			textureVs);
+
+		// Sample texels one at a time, dropping transparent ones if needed.
+		int pixelCount = 0;
+		for (int i = 0; i < rowCount; i++)
+		{
+			ShadingReal colorR, colorG, colorB, colorEmission;
+			bool colorTransparent = false;
+			SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, Transparency>(
+				texture, textureU, textureVs[i], &colorR, &colorG, &colorB, &colorEmission,
+				&colorTransparent);
+
+			if (!colorTransparent)
+			{
+				rows[pixelCount] = rows[i];
+				colorRs[pixelCount] = colorR;
+				colorGs[pixelCount] = colorG;
+				colorBs[pixelCount] = colorB;
+				emissions[pixelCount] = colorEmission;
+				pixelCount++;
+			}
+		}
+
+		ShadeColumnPixels(kernels, colorRs, colorGs, colorBs, emissions, nullptr, nullptr,
+			pixelCount, shadeParams, colors);
 
-			frame.colorBuffer[index] = colorRGB;
+		for (int i = 0; i < pixelCount; i++)
+		{
+			const int index = frame.getIndex(x, rows[i]);
+			frame.colorBuffer[index] = colors[i];
 			frame.depthBuffer[index] = depth;
 		}
 	}
@@ -3407,16 +4790,30 @@ void SoftwareRenderer::drawPixels(int x, const DrawRange &drawRange, double dept
 	double fadePercent, double lightContributionPercent, const ShadingInfo &shadingInfo,
 	OcclusionData &occlusion, const FrameView &frame)
 {
-	if (fadePercent == 1.0)
+	const VoxelTexture &mipTexture = texture.getMipLevel(GetColumnTexelsPerPixel(
+		vStart, vEnd, texture.height, drawRange.yProjStart, drawRange.yProjEnd));
+
+	if (UseColumnKernels())
+	{
+		int yStart = drawRange.yStart;
+		int yEnd = drawRange.yEnd;
+		occlusion.clipRange(&yStart, &yEnd);
+		occlusion.update(yStart, yEnd);
+
+		constexpr bool transparency = false;
+		SoftwareRenderer::drawPixelsVectorized<transparency>(x, yStart, yEnd, drawRange, depth, u,
+			vStart, vEnd, mipTexture, fadePercent, lightContributionPercent, shadingInfo, frame);
+	}
+	else if (fadePercent == 1.0)
 	{
 		constexpr bool fading = false;
-		SoftwareRenderer::drawPixelsShader<fading>(x, drawRange, depth, u, vStart, vEnd, normal, texture,
+		SoftwareRenderer::drawPixelsShader<fading>(x, drawRange, depth, u, vStart, vEnd, normal, mipTexture,
 			fadePercent, lightContributionPercent, shadingInfo, occlusion, frame);
 	}
 	else
 	{
 		constexpr bool fading = true;
-		SoftwareRenderer::drawPixelsShader<fading>(x, drawRange, depth, u, vStart, vEnd, normal, texture,
+		SoftwareRenderer::drawPixelsShader<fading>(x, drawRange, depth, u, vStart, vEnd, normal, mipTexture,
 			fadePercent, lightContributionPercent, shadingInfo, occlusion, frame);
 	}
 }
@@ -3436,9 +4833,13 @@ void SoftwareRenderer::drawPerspectivePixelsShader(int x, const DrawRange &drawR
 
 	// Fog color to interpolate with.
 	const Double3 &fogColor = shadingInfo.getFogColor();
+	const ShadingReal fogR = static_cast<ShadingReal>(fogColor.x);
+	const ShadingReal fogG = static_cast<ShadingReal>(fogColor.y);
+	const ShadingReal fogB = static_cast<ShadingReal>(fogColor.z);
 
 	// Base shading on the texture.
-	const Double3 shading(shadingInfo.ambient, shadingInfo.ambient, shadingInfo.ambient);
+	const ShadingReal shading = static_cast<ShadingReal>(shadingInfo.ambient);
+	const ShadingReal fade = static_cast<ShadingReal>(fadePercent);
 
 	// Values for perspective-correct interpolation.
 	const double depthStartRecip = 1.0 / depthStart;
@@ -3454,7 +4855,7 @@ void SoftwareRenderer::drawPerspectivePixelsShader(int x, const DrawRange &drawR
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -3470,61 +4871,66 @@ void SoftwareRenderer::drawPerspectivePixelsShader(int x, const DrawRange &drawR
 		if (depth <= frame.depthBuffer[index])
 		{
 			// Linearly interpolated fog.
-			const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+			const ShadingReal fogPercent = static_cast<ShadingReal>(
+				std::min(depth / shadingInfo.fogDistance, 1.0));
 
 			// Interpolate between start and end points.
 			const SNDouble currentPointX = (startPointDiv.x + (pointDivDiff.x * yPercent)) * depth;
 			const WEDouble currentPointY = (startPointDiv.y + (pointDivDiff.y * yPercent)) * depth;
 
-			// Texture coordinates.
-			const double u = std::clamp(currentPointX - std::floor(currentPointX), 0.0, Constants::JustBelowOne);
-			const double v = std::clamp(currentPointY - std::floor(currentPointY), 0.0, Constants::JustBelowOne);
+			// Texture coordinates. The fractional part is taken in double precision since the
+			// points are in world space.
+			const ShadingReal u = static_cast<ShadingReal>(
+				std::clamp(currentPointX - std::floor(currentPointX), 0.0, Constants::JustBelowOne));
+			const ShadingReal v = static_cast<ShadingReal>(
+				std::clamp(currentPointY - std::floor(currentPointY), 0.0, Constants::JustBelowOne));
 
 			// Texture color. Alpha is ignored in this loop, so transparent texels will appear black.
 			constexpr bool TextureTransparency = false;
-			double colorR, colorG, colorB, colorEmission;
+			ShadingReal colorR, colorG, colorB, colorEmission;
 			SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, TextureTransparency>(
 				texture, u, v, &colorR, &colorG, &colorB, &colorEmission, nullptr);
 
 			// Light contribution.
 			const NewDouble2 currentPoint(currentPointX, currentPointY);
-			const double lightContributionPercent = SoftwareRenderer::getLightContributionAtPoint<
-				LightContributionCap>(currentPoint, visLights, visLightList);
+			const ShadingReal lightContribution = static_cast<ShadingReal>(
+				SoftwareRenderer::getLightContributionAtPoint<LightContributionCap>(
+					currentPoint, visLights, visLightList));
 
 			// Shading from light.
-			constexpr double shadingMax = 1.0;
-			const double combinedEmission = colorEmission + lightContributionPercent;
-			const double lightR = shading.x + combinedEmission;
-			const double lightG = shading.y + combinedEmission;
-			const double lightB = shading.z + combinedEmission;
-			colorR *= (lightR < shadingMax) ? lightR : shadingMax;
-			colorG *= (lightG < shadingMax) ? lightG : shadingMax;
-			colorB *= (lightB < shadingMax) ? lightB : shadingMax;
+			constexpr ShadingReal shadingMax = static_cast<ShadingReal>(1.0);
+			const ShadingReal combinedEmission = colorEmission + lightContribution;
+			const ShadingReal light = shading + combinedEmission;
+			const ShadingReal lightPercent = (light < shadingMax) ? light : shadingMax;
+			colorR *= lightPercent;
+			colorG *= lightPercent;
+			colorB *= lightPercent;
 
 			if constexpr (Fading)
 			{
 				// Apply voxel fade percent.
-				colorR *= fadePercent;
-				colorG *= fadePercent;
-				colorB *= fadePercent;
+				colorR *= fade;
+				colorG *= fade;
+				colorB *= fade;
 			}
 
 			// Linearly interpolate with fog.
-			colorR += (fogColor.x - colorR) * fogPercent;
-			colorG += (fogColor.y - colorG) * fogPercent;
-			colorB += (fogColor.z - colorB) * fogPercent;
+			colorR += (fogR - colorR) * fogPercent;
+			colorG += (fogG - colorG) * fogPercent;
+			colorB += (fogB - colorB) * fogPercent;
 
 			// Clamp maximum (don't worry about negative values).
-			constexpr double high = 1.0;
+			constexpr ShadingReal high = static_cast<ShadingReal>(1.0);
 			colorR = (colorR > high) ? high : colorR;
 			colorG = (colorG > high) ? high : colorG;
 			colorB = (colorB > high) ? high : colorB;
 
 			// Convert floats to integers.
+			constexpr ShadingReal channelMax = static_cast<ShadingReal>(255.0);
 			const uint32_t colorRGB = static_cast<uint32_t>(
-				((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-				((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-				((static_cast<uint8_t>(colorB * 255.0))));
+				((static_cast<uint8_t>(colorR * channelMax)) << 16) |
+				((static_cast<uint8_t>(colorG * channelMax)) << 8) |
+				((static_cast<uint8_t>(colorB * channelMax))));
 
 			frame.colorBuffer[index] = colorRGB;
 			frame.depthBuffer[index] = depth;
@@ -3532,24 +4938,138 @@ void SoftwareRenderer::drawPerspectivePixelsShader(int x, const DrawRange &drawR
 	}
 }
 
+void SoftwareRenderer::drawPerspectivePixelsVectorized(int x, int yStart, int yEnd,
+	const DrawRange &drawRange, const NewDouble2 &startPoint, const NewDouble2 &endPoint,
+	double depthStart, double depthEnd, const VoxelTexture &texture, double fadePercent,
+	const BufferView<const VisibleLight> &visLights, const VisibleLightList &visLightList,
+	const ShadingInfo &shadingInfo, const FrameView &frame)
+{
+	const ColumnKernels::Table &kernels = ColumnKernels::getActiveTable();
+
+	const Double3 &fogColor = shadingInfo.getFogColor();
+	ColumnShadeParams shadeParams;
+	shadeParams.ambient = static_cast<ShadingReal>(shadingInfo.ambient);
+	shadeParams.fade = static_cast<ShadingReal>(fadePercent);
+	shadeParams.fogR = static_cast<ShadingReal>(fogColor.x);
+	shadeParams.fogG = static_cast<ShadingReal>(fogColor.y);
+	shadeParams.fogB = static_cast<ShadingReal>(fogColor.z);
+	shadeParams.lightContribution = static_cast<ShadingReal>(0.0);
+	shadeParams.fogPercent = static_cast<ShadingReal>(0.0);
+
+	// Values for perspective-correct interpolation.
+	const double yProjStart = drawRange.yProjStart;
+	const double yProjEnd = drawRange.yProjEnd;
+	const double depthStartRecip = 1.0 / depthStart;
+	const double depthEndRecip = 1.0 / depthEnd;
+	const NewDouble2 startPointDiv = startPoint * depthStartRecip;
+	const NewDouble2 endPointDiv = endPoint * depthEndRecip;
+	const NewDouble2 pointDivDiff = endPointDiv - startPointDiv;
+
+	// Pixels that passed the depth test, and their sampled colors and lighting.
+	alignas(ColumnKernels::ChunkAlignment) int rows[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) double depths[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorRs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorGs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal colorBs[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal emissions[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal lightContributions[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) ShadingReal fogPercents[ColumnKernels::ChunkSize];
+	alignas(ColumnKernels::ChunkAlignment) uint32_t colors[ColumnKernels::ChunkSize];
+
+	int y = yStart;
+	while (y < yEnd)
+	{
+		const int chunkEnd = std::min(y + ColumnKernels::ChunkSize, yEnd);
+
+		// Depth, texture coordinates, and lighting depend on world position, so they stay in
+		// double precision and are calculated per pixel.
+		int pixelCount = 0;
+		for (; y < chunkEnd; y++)
+		{
+			const int index = frame.getIndex(x, y);
+			const double yPercent =
+				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
+			const double depth = 1.0 /
+				(depthStartRecip + ((depthEndRecip - depthStartRecip) * yPercent));
+
+			if (depth <= frame.depthBuffer[index])
+			{
+				const SNDouble currentPointX = (startPointDiv.x + (pointDivDiff.x * yPercent)) * depth;
+				const WEDouble currentPointY = (startPointDiv.y + (pointDivDiff.y * yPercent)) * depth;
+				const ShadingReal u = static_cast<ShadingReal>(
+					std::clamp(currentPointX - std::floor(currentPointX), 0.0, Constants::JustBelowOne));
+				const ShadingReal v = static_cast<ShadingReal>(
+					std::clamp(currentPointY - std::floor(currentPointY), 0.0, Constants::JustBelowOne));
+
+				constexpr bool TextureTransparency = false;
+				ShadingReal colorR, colorG, colorB, colorEmission;
+				SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, TextureTransparency>(
+					texture, u, v, &colorR, &colorG, &colorB, &colorEmission, nullptr);
+
+				const NewDouble2 currentPoint(currentPointX, currentPointY);
+				const double lightContribution =
+					SoftwareRenderer::getLightContributionAtPoint<LightContributionCap>(
+						currentPoint, visLights, visLightList);
+
+				rows[pixelCount] = y;
+				depths[pixelCount] = depth;
+				colorRs[pixelCount] = colorR;
+				colorGs[pixelCount] = colorG;
+				colorBs[pixelCount] = colorB;
+				emissions[pixelCount] = colorEmission;
+				lightContributions[pixelCount] = static_cast<ShadingReal>(lightContribution);
+				fogPercents[pixelCount] = static_cast<ShadingReal>(
+					std::min(depth / shadingInfo.fogDistance, 1.0));
+				pixelCount++;
+			}
+		}
+
+		ShadeColumnPixels(kernels, colorRs, colorGs, colorBs, emissions, lightContributions,
+			fogPercents, pixelCount, shadeParams, colors);
+
+		for (int i = 0; i < pixelCount; i++)
+		{
+			const int index = frame.getIndex(x, rows[i]);
+			frame.colorBuffer[index] = colors[i];
+			frame.depthBuffer[index] = depths[i];
+		}
+	}
+}
+
 void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
 	const NewDouble2 &startPoint, const NewDouble2 &endPoint, double depthStart, double depthEnd,
 	const Double3 &normal, const VoxelTexture &texture, double fadePercent,
 	const BufferView<const VisibleLight> &visLights, const VisibleLightList &visLightList,
 	const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame)
 {
-	if (fadePercent == 1.0)
+	// Texels per pixel averaged over the floor or ceiling distance the column covers.
+	const double texelsPerPixel = ((endPoint - startPoint).length() * static_cast<double>(texture.width)) /
+		std::abs(drawRange.yProjEnd - drawRange.yProjStart);
+	const VoxelTexture &mipTexture = texture.getMipLevel(texelsPerPixel);
+
+	if (UseColumnKernels())
+	{
+		int yStart = drawRange.yStart;
+		int yEnd = drawRange.yEnd;
+		occlusion.clipRange(&yStart, &yEnd);
+		occlusion.update(yStart, yEnd);
+
+		SoftwareRenderer::drawPerspectivePixelsVectorized(x, yStart, yEnd, drawRange, startPoint,
+			endPoint, depthStart, depthEnd, mipTexture, fadePercent, visLights, visLightList,
+			shadingInfo, frame);
+	}
+	else if (fadePercent == 1.0)
 	{
 		constexpr bool fading = false;
 		SoftwareRenderer::drawPerspectivePixelsShader<fading>(x, drawRange, startPoint, endPoint,
-			depthStart, depthEnd, normal, texture, fadePercent, visLights, visLightList,
+			depthStart, depthEnd, normal, mipTexture, fadePercent, visLights, visLightList,
 			shadingInfo, occlusion, frame);
 	}
 	else
 	{
 		constexpr bool fading = true;
 		SoftwareRenderer::drawPerspectivePixelsShader<fading>(x, drawRange, startPoint, endPoint,
-			depthStart, depthEnd, normal, texture, fadePercent, visLights, visLightList,
+			depthStart, depthEnd, normal, mipTexture, fadePercent, visLights, visLightList,
 			shadingInfo, occlusion, frame);
 	}
 }
@@ -3557,79 +5077,101 @@ void SoftwareRenderer::drawPerspectivePixels(int x, const DrawRange &drawRange,
 void SoftwareRenderer::drawTransparentPixels(int x, const DrawRange &drawRange, double depth,
 	double u, double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
 	double lightContributionPercent, const ShadingInfo &shadingInfo,
-	const OcclusionData &occlusion, const FrameView &frame)
+	OcclusionData &occlusion, const FrameView &frame)
 {
+	const VoxelTexture &mipTexture = texture.getMipLevel(GetColumnTexelsPerPixel(
+		vStart, vEnd, texture.height, drawRange.yProjStart, drawRange.yProjEnd));
+
 	// Draw range values.
-	const double yProjStart = drawRange.yProjStart;
-	const double yProjEnd = drawRange.yProjEnd;
+	const ShadingReal yProjStart = static_cast<ShadingReal>(drawRange.yProjStart);
+	const ShadingReal yProjEnd = static_cast<ShadingReal>(drawRange.yProjEnd);
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
+	// Texture coordinates in shading precision.
+	const ShadingReal textureU = static_cast<ShadingReal>(u);
+	const ShadingReal textureVStart = static_cast<ShadingReal>(vStart);
+	const ShadingReal textureVEnd = static_cast<ShadingReal>(vEnd);
+
 	// Horizontal offset in texture.
 	// - Taken care of in texture sampling function (redundant calculation, though).
 	//const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 
 	// Linearly interpolated fog.
 	const Double3 &fogColor = shadingInfo.getFogColor();
-	const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+	const ShadingReal fogR = static_cast<ShadingReal>(fogColor.x);
+	const ShadingReal fogG = static_cast<ShadingReal>(fogColor.y);
+	const ShadingReal fogB = static_cast<ShadingReal>(fogColor.z);
+	const ShadingReal fogPercent = static_cast<ShadingReal>(std::min(depth / shadingInfo.fogDistance, 1.0));
 
 	// Shading on the texture.
-	const Double3 shading(shadingInfo.ambient, shadingInfo.ambient, shadingInfo.ambient);
+	const ShadingReal shading = static_cast<ShadingReal>(shadingInfo.ambient);
+	const ShadingReal lightContribution = static_cast<ShadingReal>(lightContributionPercent);
 
 	// Clip the Y start and end coordinates as needed, but do not refresh the occlusion buffer,
 	// because transparent ranges do not occlude as simply as opaque ranges.
 	occlusion.clipRange(&yStart, &yEnd);
 
+	if (UseColumnKernels())
+	{
+		constexpr bool transparency = true;
+		constexpr double fadePercent = 1.0;
+		SoftwareRenderer::drawPixelsVectorized<transparency>(x, yStart, yEnd, drawRange, depth, u,
+			vStart, vEnd, mipTexture, fadePercent, lightContributionPercent, shadingInfo, frame);
+		return;
+	}
+
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Check depth of the pixel before rendering.
 		if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
 		{
 			// Percent stepped from beginning to end on the column.
-			const double yPercent =
-				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
+			const ShadingReal yPercent =
+				((static_cast<ShadingReal>(y) + static_cast<ShadingReal>(0.50)) - yProjStart) /
+				(yProjEnd - yProjStart);
 
 			// Vertical texture coordinate.
-			const double v = vStart + ((vEnd - vStart) * yPercent);
+			const ShadingReal v = textureVStart + ((textureVEnd - textureVStart) * yPercent);
 
 			// Texture color. Alpha is checked in this loop, and transparent texels are not drawn.
 			constexpr bool TextureTransparency = true;
-			double colorR, colorG, colorB, colorEmission;
+			ShadingReal colorR, colorG, colorB, colorEmission;
 			bool colorTransparent;
 			SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, TextureTransparency>(
-				texture, u, v, &colorR, &colorG, &colorB, &colorEmission, &colorTransparent);
+				mipTexture, textureU, v, &colorR, &colorG, &colorB, &colorEmission, &colorTransparent);
 			
 			if (!colorTransparent)
 			{
 				// Shading from light.
-				constexpr double shadingMax = 1.0;
-				const double combinedEmission = colorEmission + lightContributionPercent;
-				const double lightR = shading.x + combinedEmission;
-				const double lightG = shading.y + combinedEmission;
-				const double lightB = shading.z + combinedEmission;
-				colorR *= (lightR < shadingMax) ? lightR : shadingMax;
-				colorG *= (lightG < shadingMax) ? lightG : shadingMax;
-				colorB *= (lightB < shadingMax) ? lightB : shadingMax;
+				constexpr ShadingReal shadingMax = static_cast<ShadingReal>(1.0);
+				const ShadingReal combinedEmission = colorEmission + lightContribution;
+				const ShadingReal light = shading + combinedEmission;
+				const ShadingReal lightPercent = (light < shadingMax) ? light : shadingMax;
+				colorR *= lightPercent;
+				colorG *= lightPercent;
+				colorB *= lightPercent;
 
 				// Linearly interpolate with fog.
-				colorR += (fogColor.x - colorR) * fogPercent;
-				colorG += (fogColor.y - colorG) * fogPercent;
-				colorB += (fogColor.z - colorB) * fogPercent;
+				colorR += (fogR - colorR) * fogPercent;
+				colorG += (fogG - colorG) * fogPercent;
+				colorB += (fogB - colorB) * fogPercent;
 				
 				// Clamp maximum (don't worry about negative values).
-				constexpr double high = 1.0;
+				constexpr ShadingReal high = static_cast<ShadingReal>(1.0);
 				colorR = (colorR > high) ? high : colorR;
 				colorG = (colorG > high) ? high : colorG;
 				colorB = (colorB > high) ? high : colorB;
 
 				// Convert floats to integers.
+				constexpr ShadingReal channelMax = static_cast<ShadingReal>(255.0);
 				const uint32_t colorRGB = static_cast<uint32_t>(
-					((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-					((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-					((static_cast<uint8_t>(colorB * 255.0))));
+					((static_cast<uint8_t>(colorR * channelMax)) << 16) |
+					((static_cast<uint8_t>(colorG * channelMax)) << 8) |
+					((static_cast<uint8_t>(colorB * channelMax))));
 
 				frame.colorBuffer[index] = colorRGB;
 				frame.depthBuffer[index] = depth;
@@ -3645,21 +5187,30 @@ void SoftwareRenderer::drawChasmPixelsShader(int x, const DrawRange &drawRange,
 	OcclusionData &occlusion, const FrameView &frame)
 {
 	// Draw range values.
-	const double yProjStart = drawRange.yProjStart;
-	const double yProjEnd = drawRange.yProjEnd;
+	const ShadingReal yProjStart = static_cast<ShadingReal>(drawRange.yProjStart);
+	const ShadingReal yProjEnd = static_cast<ShadingReal>(drawRange.yProjEnd);
 	int yStart = drawRange.yStart;
 	int yEnd = drawRange.yEnd;
 
+	// Texture coordinates in shading precision.
+	const ShadingReal textureU = static_cast<ShadingReal>(u);
+	const ShadingReal textureVStart = static_cast<ShadingReal>(vStart);
+	const ShadingReal textureVEnd = static_cast<ShadingReal>(vEnd);
+
 	// Horizontal offset in texture.
 	// - Taken care of in texture sampling function (redundant calculation, though).
 	//const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 
 	// Linearly interpolated fog.
 	const Double3 &fogColor = shadingInfo.getFogColor();
-	const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+	const ShadingReal fogR = static_cast<ShadingReal>(fogColor.x);
+	const ShadingReal fogG = static_cast<ShadingReal>(fogColor.y);
+	const ShadingReal fogB = static_cast<ShadingReal>(fogColor.z);
+	const ShadingReal fogPercent = static_cast<ShadingReal>(std::min(depth / shadingInfo.fogDistance, 1.0));
 
 	// Shading on the texture.
-	const Double3 shading(shadingInfo.ambient, shadingInfo.ambient, shadingInfo.ambient);
+	const ShadingReal shading = static_cast<ShadingReal>(shadingInfo.ambient);
+	const ShadingReal lightContribution = static_cast<ShadingReal>(lightContributionPercent);
 
 	// Clip the Y start and end coordinates as needed, and refresh the occlusion buffer.
 	occlusion.clipRange(&yStart, &yEnd);
@@ -3668,56 +5219,57 @@ void SoftwareRenderer::drawChasmPixelsShader(int x, const DrawRange &drawRange,
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Check depth of the pixel before rendering.
 		if (depth <= (frame.depthBuffer[index] - Constants::Epsilon))
 		{
 			// Percent stepped from beginning to end on the column.
-			const double yPercent =
-				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
+			const ShadingReal yPercent =
+				((static_cast<ShadingReal>(y) + static_cast<ShadingReal>(0.50)) - yProjStart) /
+				(yProjEnd - yProjStart);
 
 			// Vertical texture coordinate.
-			const double v = vStart + ((vEnd - vStart) * yPercent);
+			const ShadingReal v = textureVStart + ((textureVEnd - textureVStart) * yPercent);
 
 			// Texture color. If the texel is transparent, use the chasm texture instead.
 			// @todo: maybe this could be optimized to a 'transparent-texel-only' look-up, that
 			// then branches to determine whether to sample the voxel or chasm texture?
 			constexpr bool TextureTransparency = true;
-			double colorR, colorG, colorB, colorEmission;
+			ShadingReal colorR, colorG, colorB, colorEmission;
 			bool colorTransparent;
 			SoftwareRenderer::sampleVoxelTexture<TextureFilterMode, TextureTransparency>(
-				texture, u, v, &colorR, &colorG, &colorB, &colorEmission, &colorTransparent);
+				texture, textureU, v, &colorR, &colorG, &colorB, &colorEmission, &colorTransparent);
 
 			if (!colorTransparent)
 			{
 				// Voxel texture.
 				// Shading from light.
-				constexpr double shadingMax = 1.0;
-				const double combinedEmission = colorEmission + lightContributionPercent;
-				const double lightR = shading.x + combinedEmission;
-				const double lightG = shading.y + combinedEmission;
-				const double lightB = shading.z + combinedEmission;
-				colorR *= (lightR < shadingMax) ? lightR : shadingMax;
-				colorG *= (lightG < shadingMax) ? lightG : shadingMax;
-				colorB *= (lightB < shadingMax) ? lightB : shadingMax;
+				constexpr ShadingReal shadingMax = static_cast<ShadingReal>(1.0);
+				const ShadingReal combinedEmission = colorEmission + lightContribution;
+				const ShadingReal light = shading + combinedEmission;
+				const ShadingReal lightPercent = (light < shadingMax) ? light : shadingMax;
+				colorR *= lightPercent;
+				colorG *= lightPercent;
+				colorB *= lightPercent;
 
 				// Linearly interpolate with fog.
-				colorR += (fogColor.x - colorR) * fogPercent;
-				colorG += (fogColor.y - colorG) * fogPercent;
-				colorB += (fogColor.z - colorB) * fogPercent;
+				colorR += (fogR - colorR) * fogPercent;
+				colorG += (fogG - colorG) * fogPercent;
+				colorB += (fogB - colorB) * fogPercent;
 
 				// Clamp maximum (don't worry about negative values).
-				constexpr double high = 1.0;
+				constexpr ShadingReal high = static_cast<ShadingReal>(1.0);
 				colorR = (colorR > high) ? high : colorR;
 				colorG = (colorG > high) ? high : colorG;
 				colorB = (colorB > high) ? high : colorB;
 
 				// Convert floats to integers.
+				constexpr ShadingReal channelMax = static_cast<ShadingReal>(255.0);
 				const uint32_t colorRGB = static_cast<uint32_t>(
-					((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-					((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-					((static_cast<uint8_t>(colorB * 255.0))));
+					((static_cast<uint8_t>(colorR * channelMax)) << 16) |
+					((static_cast<uint8_t>(colorG * channelMax)) << 8) |
+					((static_cast<uint8_t>(colorB * channelMax))));
 
 				frame.colorBuffer[index] = colorRGB;
 				frame.depthBuffer[index] = depth;
@@ -3763,6 +5315,9 @@ void SoftwareRenderer::drawChasmPixels(int x, const DrawRange &drawRange, double
 	const ChasmTexture &chasmTexture, double lightContributionPercent, const ShadingInfo &shadingInfo,
 	OcclusionData &occlusion, const FrameView &frame)
 {
+	const VoxelTexture &mipTexture = texture.getMipLevel(GetColumnTexelsPerPixel(
+		vStart, vEnd, texture.height, drawRange.yProjStart, drawRange.yProjEnd));
+
 	const bool useAmbientChasmShading = shadingInfo.isExterior && !emissive;
 	const bool useTrueChasmDepth = true;
 
@@ -3773,14 +5328,14 @@ void SoftwareRenderer::drawChasmPixels(int x, const DrawRange &drawRange, double
 		{
 			constexpr bool trueDepth = true;
 			SoftwareRenderer::drawChasmPixelsShader<ambientShading, trueDepth>(x, drawRange, depth,
-				u, vStart, vEnd, normal, texture, chasmTexture, lightContributionPercent, shadingInfo,
+				u, vStart, vEnd, normal, mipTexture, chasmTexture, lightContributionPercent, shadingInfo,
 				occlusion, frame);
 		}
 		else
 		{
 			constexpr bool trueDepth = false;
 			SoftwareRenderer::drawChasmPixelsShader<ambientShading, trueDepth>(x, drawRange, depth,
-				u, vStart, vEnd, normal, texture, chasmTexture, lightContributionPercent, shadingInfo,
+				u, vStart, vEnd, normal, mipTexture, chasmTexture, lightContributionPercent, shadingInfo,
 				occlusion, frame);
 		}
 	}
@@ -3791,14 +5346,14 @@ void SoftwareRenderer::drawChasmPixels(int x, const DrawRange &drawRange, double
 		{
 			constexpr bool trueDepth = true;
 			SoftwareRenderer::drawChasmPixelsShader<ambientShading, trueDepth>(x, drawRange, depth,
-				u, vStart, vEnd, normal, texture, chasmTexture, lightContributionPercent, shadingInfo,
+				u, vStart, vEnd, normal, mipTexture, chasmTexture, lightContributionPercent, shadingInfo,
 				occlusion, frame);
 		}
 		else
 		{
 			constexpr bool trueDepth = false;
 			SoftwareRenderer::drawChasmPixelsShader<ambientShading, trueDepth>(x, drawRange, depth,
-				u, vStart, vEnd, normal, texture, chasmTexture, lightContributionPercent, shadingInfo,
+				u, vStart, vEnd, normal, mipTexture, chasmTexture, lightContributionPercent, shadingInfo,
 				occlusion, frame);
 		}
 	}
@@ -3836,7 +5391,7 @@ void SoftwareRenderer::drawPerspectiveChasmPixelsShader(int x, const DrawRange &
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -3954,20 +5509,14 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 	// Horizontal offset in texture.
 	const int textureX = static_cast<int>(u * static_cast<double>(texture.width));
 	
-	// Shading on the texture. Some distant objects are completely bright.
-	const double shading = emissive ? 1.0 : shadingInfo.distantAmbient;
+	// Shading on the texture, already applied to each channel value. Some distant objects are
+	// completely bright.
+	const std::array<double, 256> &shadedChannels = emissive ?
+		TexelChannelTable<double> : shadingInfo.distantShadedChannels;
 
-	// Draw the column to the output buffer.
-	for (int y = yStart; y < yEnd; y++)
+	auto drawPixel = [x, textureX, &texture, &shadedChannels, &frame](int y, double v)
 	{
-		const int index = x + (y * frame.width);
-
-		// Percent stepped from beginning to end on the column.
-		const double yPercent =
-			((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
-
-		// Vertical texture coordinate.
-		const double v = vStart + ((vEnd - vStart) * yPercent);
+		const int index = frame.getIndex(x, y);
 
 		// Y position in texture.
 		const int textureY = static_cast<int>(v * static_cast<double>(texture.height));
@@ -3976,17 +5525,18 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 		const int textureIndex = textureX + (textureY * texture.width);
 		const SkyTexel &texel = texture.texels[textureIndex];
 
-		if (texel.a != 0.0)
+		if (texel.a != 0)
 		{
 			// Special case (for true color): if texel alpha is between 0 and 1,
 			// the previously rendered pixel is diminished by some amount. This is mostly
 			// only pertinent to the edges of some clouds (with respect to distant sky).
 			double colorR, colorG, colorB;
-			if (texel.a < 1.0)
+			if (texel.a < TEXEL_ALPHA_OPAQUE)
 			{
 				// Diminish the previous color in the frame buffer.
 				const Double3 prevColor = Double3::fromRGB(frame.colorBuffer[index]);
-				const double visPercent = std::clamp(1.0 - texel.a, 0.0, 1.0);
+				const double alpha = static_cast<double>(texel.a) / TEXEL_ALPHA_OPAQUE_REAL;
+				const double visPercent = std::clamp(1.0 - alpha, 0.0, 1.0);
 				colorR = prevColor.x * visPercent;
 				colorG = prevColor.y * visPercent;
 				colorB = prevColor.z * visPercent;
@@ -3994,9 +5544,9 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 			else
 			{
 				// Texture color with shading.
-				colorR = texel.r * shading;
-				colorG = texel.g * shading;
-				colorB = texel.b * shading;
+				colorR = shadedChannels[texel.r];
+				colorG = shadedChannels[texel.g];
+				colorB = shadedChannels[texel.b];
 			}
 
 			// Clamp maximum (don't worry about negative values).
@@ -4013,315 +5563,48 @@ void SoftwareRenderer::drawDistantPixels(int x, const DrawRange &drawRange, doub
 
 			frame.colorBuffer[index] = colorRGB;
 		}
-	}
-}
-
-/*void SoftwareRenderer::drawDistantPixelsSSE(int x, const DrawRange &drawRange, double u,
-	double vStart, double vEnd, const SkyTexture &texture, bool emissive,
-	const ShadingInfo &shadingInfo, const FrameView &frame)
-{
-	// @todo: fix. this is now out of sync with the non-SSE version.
-
-	// Draw range values.
-	const int yStart = drawRange.yStart;
-	const int yEnd = drawRange.yEnd;
-	const __m128d yProjStarts = _mm_set1_pd(drawRange.yProjStart);
-	const __m128d yProjEnds = _mm_set1_pd(drawRange.yProjEnd);
-	const __m128d yStarts = _mm_set1_pd(drawRange.yStart);
-	const __m128d yEnds = _mm_set1_pd(drawRange.yEnd);
+	};
 
-	// Horizontal offset in texture.
-	const __m128i textureXs = [u, &texture]()
+	// Vertical texture coordinates come from the column kernels several rows at a time when a
+	// vector table is active. Texels are still fetched one at a time, like the other column
+	// shaders.
+	const ColumnKernels::Table &kernels = ColumnKernels::getActiveTable();
+	if (kernels.doubleWidth > 1)
 	{
-		const __m128d us = _mm_set1_pd(std::min(u, Constants::JustBelowOne));
-		const __m128d textureWidths = _mm_cvtepi32_pd(_mm_set1_epi32(texture.width));
-		const __m128d mults = _mm_mul_pd(us, textureWidths);
-		return _mm_cvttpd_epi32(mults);
-	}();
-
-	// Shading on the texture. Some distant objects are completely bright.
-	const __m128d shadings = _mm_set1_pd(emissive ? 1.0 : shadingInfo.distantAmbient);
-
-	// Some pre-calculated values.
-	const __m128i zeroes = _mm_set1_epi32(0);
-	const __m128d halfReals = _mm_set1_pd(0.50);
-	const __m128d oneReals = _mm_set1_pd(1.0);
-	const __m128d twoFiftyFiveReals = _mm_set1_pd(255.0);
-	const __m128i xs = _mm_set1_epi32(x);
-	const __m128i frameWidths = _mm_set1_epi32(frame.width);
-	const __m128i frameHeights = _mm_set1_epi32(frame.height);
-	const __m128d yProjDiffs = _mm_sub_pd(yProjStarts, yProjEnds);
-	const __m128d vStarts = _mm_set1_pd(std::max(vStart, 0.0));
-	const __m128d vEnds = _mm_set1_pd(std::min(vEnd, Constants::JustBelowOne));
-	const __m128d vDiffs = _mm_sub_pd(vStarts, vEnds);
-	const __m128i textureWidths = _mm_set1_epi32(texture.width);
-	const __m128i textureHeights = _mm_set1_epi32(texture.height);
-	const __m128d textureWidthReals = _mm_cvtepi32_pd(textureWidths);
-	const __m128d textureHeightReals = _mm_cvtepi32_pd(textureHeights);
-
-	// SIMD stride size.
-	constexpr int stride = sizeof(__m128d) / sizeof(double);
-	static_assert(stride == 2);
-
-	// @todo: need special case loop afterwards to catch missed rows.
-	for (int y = yStart; y < (yEnd - (stride - 1)); y += stride)
-	{
-		// Row and frame buffer index.
-		const __m128i ys = _mm_setr_epi32(y, y + 1, 0, 0);
-		const __m128i yRowOffsets = _mm_mullo_epi32(ys, frameWidths);
-
-		// Percents stepped from beginning to end on the column.
-		const __m128d yReals = _mm_cvtepi32_pd(ys);
-		const __m128d yMidpoints = _mm_add_pd(yReals, halfReals);
-		const __m128d yMidpointDiffs = _mm_sub_pd(yMidpoints, yProjStarts);
-		const __m128d yPercents = _mm_div_pd(yMidpointDiffs, yProjDiffs);
-
-		// Vertical texture coordinate.
-		const __m128d vDiffYPercents = _mm_mul_pd(vDiffs, yPercents);
-		const __m128d vs = _mm_add_pd(vStarts, vDiffYPercents);
-
-		// Y position in texture.
-		const __m128d vTextureHeights = _mm_mul_pd(vs, textureHeightReals);
-		const __m128i textureYs = _mm_cvttpd_epi32(vTextureHeights);
-
-		// Alpha is checked in this loop, and transparent texels are not drawn.
-		const __m128i textureYWidths = _mm_mullo_epi32(textureYs, textureWidths);
-		const __m128i textureIndices = _mm_add_epi32(textureXs, textureYWidths);
-
-		// Load alpha component of texel to see if it's even visible.
-		// @todo: proper SIMD texel format.
-		// - For now, assume we can load texels really fast?! No gather instruction for SSE.
-		// - This seems like a big bandwidth win once each color channel is in its own array.
-		const SkyTexel &texel0 = texture.texels[_mm_extract_epi32(textureIndices, 0)];
-		const SkyTexel &texel1 = texture.texels[_mm_extract_epi32(textureIndices, 1)];
-		const __m128i texelAs = _mm_setr_epi32(
-			static_cast<int>(texel0.a == 0.0),
-			static_cast<int>(texel1.a == 0.0),
-			static_cast<int>(false),
-			static_cast<int>(false));
-
-		// Check if the texel is opaque.
-		const __m128i opaques = _mm_cmpeq_epi32(texelAs, zeroes);
-		const bool opaque0 = _mm_extract_epi32(opaques, 0) != 0;
-		const bool opaque1 = _mm_extract_epi32(opaques, 0) != 0;
-		const bool anyOpaque = opaque0 || opaque1;
-		if (anyOpaque)
-		{
-			// @todo: missing transparency branch of non-SSE version.
-			// Texel colors.
-			const __m128d texelRs = _mm_setr_pd(texel0.r, texel1.r);
-			const __m128d texelGs = _mm_setr_pd(texel0.g, texel1.g);
-			const __m128d texelBs = _mm_setr_pd(texel0.b, texel1.b);
-
-			// Texture color with shading.
-			__m128d colorRs = _mm_mul_pd(texelRs, shadings);
-			__m128d colorGs = _mm_mul_pd(texelGs, shadings);
-			__m128d colorBs = _mm_mul_pd(texelBs, shadings);
-
-			// Clamp maximum (don't worry about negative values).
-			const __m128d highs = oneReals;
-			__m128d colorRCmps = _mm_cmpgt_pd(colorRs, highs);
-			__m128d colorGCmps = _mm_cmpgt_pd(colorGs, highs);
-			__m128d colorBCmps = _mm_cmpgt_pd(colorBs, highs);
-			colorRs = _mm_blendv_pd(colorRs, highs, colorRCmps);
-			colorGs = _mm_blendv_pd(colorGs, highs, colorGCmps);
-			colorBs = _mm_blendv_pd(colorBs, highs, colorBCmps);
-
-			// Convert floats to integers.
-			const __m128d mul255s = twoFiftyFiveReals;
-			const __m128d colorRs255 = _mm_mul_pd(colorRs, mul255s);
-			const __m128d colorGs255 = _mm_mul_pd(colorGs, mul255s);
-			const __m128d colorBs255 = _mm_mul_pd(colorBs, mul255s);
-			const __m128i colorRsU32 = _mm_cvttpd_epi32(colorRs255);
-			const __m128i colorGsU32 = _mm_cvttpd_epi32(colorGs255);
-			const __m128i colorBsU32 = _mm_cvttpd_epi32(colorBs255);
-			const __m128i colorRsShifted = _mm_slli_epi32(colorRsU32, 16);
-			const __m128i colorGsShifted = _mm_slli_epi32(colorGsU32, 8);
-			const __m128i colorBsShifted = colorBsU32;
-			const __m128i colors = _mm_or_si128(
-				_mm_or_si128(colorRsShifted, colorGsShifted), colorBsShifted);
-
-			// Frame buffer index.
-			const __m128i indices = _mm_add_epi32(xs, yRowOffsets);
-
-			// (SIMD only) Conditionally write pixels based on texel opacity.
-			if (opaque0)
-			{
-				const int index0 = _mm_extract_epi32(indices, 0);
-				const uint32_t color0 = _mm_extract_epi32(colors, 0);
-				frame.colorBuffer[index0] = color0;
+		alignas(ColumnKernels::ChunkAlignment) int rows[ColumnKernels::ChunkSize];
+		alignas(ColumnKernels::ChunkAlignment) double textureVs[ColumnKernels::ChunkSize];
+		for (int y = yStart; y < yEnd; y += ColumnKernels::ChunkSize)
+		{
+			const int rowCount = std::min(ColumnKernels::ChunkSize, yEnd - y);
+			for (int i = 0; i < rowCount; i++)
+			{
+				rows[i] = y + i;
 			}
 
-			if (opaque1)
+			kernels.interpolateVDouble(rows, rowCount, yProjStart, yProjEnd, vStart, vEnd, textureVs);
+
+			for (int i = 0; i < rowCount; i++)
 			{
-				const int index1 = _mm_extract_epi32(indices, 1);
-				const uint32_t color1 = _mm_extract_epi32(colors, 1);
-				frame.colorBuffer[index1] = color1;
+				drawPixel(rows[i], textureVs[i]);
 			}
 		}
 	}
-}*/
-
-/*void SoftwareRenderer::drawDistantPixelsAVX(int x, const DrawRange &drawRange, double u,
-	double vStart, double vEnd, const SkyTexture &texture, bool emissive,
-	const ShadingInfo &shadingInfo, const FrameView &frame)
-{
-	// Draw range values.
-	const int yStart = drawRange.yStart;
-	const int yEnd = drawRange.yEnd;
-	const __m256d yProjStarts = _mm256_set1_pd(drawRange.yProjStart);
-	const __m256d yProjEnds = _mm256_set1_pd(drawRange.yProjEnd);
-	const __m256d yStarts = _mm256_set1_pd(drawRange.yStart);
-	const __m256d yEnds = _mm256_set1_pd(drawRange.yEnd);
-
-	// Horizontal offset in texture.
-	const __m128i textureXs = [u, &texture]()
+	else
 	{
-		const __m256d us = _mm256_set1_pd(std::min(u, Constants::JustBelowOne));
-		const __m256d textureWidths = _mm256_cvtepi32_pd(_mm_set1_epi32(texture.width));
-		const __m256d mults = _mm256_mul_pd(us, textureWidths);
-		return _mm256_cvttpd_epi32(mults);
-	}();
-
-	// Shading on the texture. Some distant objects are completely bright.
-	const __m256d shadings = _mm256_set1_pd(emissive ? 1.0 : shadingInfo.distantAmbient);
-
-	// Some pre-calculated values.
-	const __m128i zeroes = _mm_set1_epi32(0);
-	const __m256d halfReals = _mm256_set1_pd(0.50);
-	const __m256d oneReals = _mm256_set1_pd(1.0);
-	const __m256d twoFiftyFiveReals = _mm256_set1_pd(255.0);
-	const __m128i xs = _mm_set1_epi32(x);
-	const __m128i frameWidths = _mm_set1_epi32(frame.width);
-	const __m128i frameHeights = _mm_set1_epi32(frame.height);
-	const __m256d yProjDiffs = _mm256_sub_pd(yProjStarts, yProjEnds);
-	const __m256d vStarts = _mm256_set1_pd(std::max(vStart, 0.0));
-	const __m256d vEnds = _mm256_set1_pd(std::min(vEnd, Constants::JustBelowOne));
-	const __m256d vDiffs = _mm256_sub_pd(vStarts, vEnds);
-	const __m128i textureWidths = _mm_set1_epi32(texture.width);
-	const __m128i textureHeights = _mm_set1_epi32(texture.height);
-	const __m256d textureWidthReals = _mm256_cvtepi32_pd(textureWidths);
-	const __m256d textureHeightReals = _mm256_cvtepi32_pd(textureHeights);
-
-	// SIMD stride size.
-	constexpr int stride = sizeof(__m256d) / sizeof(double);
-	static_assert(stride == 4);
-
-	// @todo: need special case loop afterwards to catch missed rows.
-	for (int y = yStart; y < (yEnd - (stride - 1)); y += stride)
-	{
-		// Row and frame buffer index.
-		const __m128i ys = _mm_setr_epi32(y, y + 1, y + 2, y + 3);
-		const __m128i yRowOffsets = _mm_mullo_epi32(ys, frameWidths);
-
-		// Percents stepped from beginning to end on the column.
-		const __m256d yReals = _mm256_cvtepi32_pd(ys);
-		const __m256d yMidpoints = _mm256_add_pd(yReals, halfReals);
-		const __m256d yMidpointDiffs = _mm256_sub_pd(yMidpoints, yProjStarts);
-		const __m256d yPercents = _mm256_div_pd(yMidpointDiffs, yProjDiffs);
-
-		// Vertical texture coordinate.
-		const __m256d vDiffYPercents = _mm256_mul_pd(vDiffs, yPercents);
-		const __m256d vs = _mm256_add_pd(vStarts, vDiffYPercents);
-
-		// Y position in texture.
-		const __m256d vTextureHeights = _mm256_mul_pd(vs, textureHeightReals);
-		const __m128i textureYs = _mm256_cvttpd_epi32(vTextureHeights);
-
-		// Alpha is checked in this loop, and transparent texels are not drawn.
-		const __m128i textureYWidths = _mm_mullo_epi32(textureYs, textureWidths);
-		const __m128i textureIndices = _mm_add_epi32(textureXs, textureYWidths);
-
-		// Load alpha component of texel to see if it's even visible.
-		// @todo: proper SIMD texel format.
-		// - For now, assume we can load texels really fast?! No gather instruction for SSE.
-		// - This seems like a big bandwidth win once each color channel is in its own array.
-		const SkyTexel &texel0 = texture.texels[_mm_extract_epi32(textureIndices, 0)];
-		const SkyTexel &texel1 = texture.texels[_mm_extract_epi32(textureIndices, 1)];
-		const SkyTexel &texel2 = texture.texels[_mm_extract_epi32(textureIndices, 2)];
-		const SkyTexel &texel3 = texture.texels[_mm_extract_epi32(textureIndices, 3)];
-		const __m128i texelAs = _mm_setr_epi32(
-			static_cast<int>(texel0.transparent),
-			static_cast<int>(texel1.transparent),
-			static_cast<int>(texel2.transparent),
-			static_cast<int>(texel3.transparent));
-
-		// Check if the texel is opaque.
-		const __m128i opaques = _mm_cmpeq_epi32(texelAs, zeroes);
-		const bool opaque0 = _mm_extract_epi32(opaques, 0) != 0;
-		const bool opaque1 = _mm_extract_epi32(opaques, 1) != 0;
-		const bool opaque2 = _mm_extract_epi32(opaques, 2) != 0;
-		const bool opaque3 = _mm_extract_epi32(opaques, 3) != 0;
-		const bool anyOpaque = opaque0 || opaque1 || opaque2 || opaque3;
-		if (anyOpaque)
-		{
-			// Texel colors.
-			const __m256d texelRs = _mm256_setr_pd(texel0.r, texel1.r, texel2.r, texel3.r);
-			const __m256d texelGs = _mm256_setr_pd(texel0.g, texel1.g, texel2.g, texel3.g);
-			const __m256d texelBs = _mm256_setr_pd(texel0.b, texel1.b, texel2.b, texel3.b);
-
-			// Texture color with shading.
-			__m256d colorRs = _mm256_mul_pd(texelRs, shadings);
-			__m256d colorGs = _mm256_mul_pd(texelGs, shadings);
-			__m256d colorBs = _mm256_mul_pd(texelBs, shadings);
-
-			// Clamp maximum (don't worry about negative values).
-			const __m256d highs = oneReals;
-			__m256d colorRCmps = _mm256_cmp_pd(colorRs, highs, _CMP_GT_OS);
-			__m256d colorGCmps = _mm256_cmp_pd(colorGs, highs, _CMP_GT_OS);
-			__m256d colorBCmps = _mm256_cmp_pd(colorBs, highs, _CMP_GT_OS);
-			colorRs = _mm256_blendv_pd(colorRs, highs, colorRCmps);
-			colorGs = _mm256_blendv_pd(colorGs, highs, colorGCmps);
-			colorBs = _mm256_blendv_pd(colorBs, highs, colorBCmps);
-
-			// Convert floats to integers.
-			const __m256d mul255s = twoFiftyFiveReals;
-			const __m256d colorRs255 = _mm256_mul_pd(colorRs, mul255s);
-			const __m256d colorGs255 = _mm256_mul_pd(colorGs, mul255s);
-			const __m256d colorBs255 = _mm256_mul_pd(colorBs, mul255s);
-			const __m128i colorRsU32 = _mm256_cvttpd_epi32(colorRs255);
-			const __m128i colorGsU32 = _mm256_cvttpd_epi32(colorGs255);
-			const __m128i colorBsU32 = _mm256_cvttpd_epi32(colorBs255);
-			const __m128i colorRsShifted = _mm_slli_epi32(colorRsU32, 16);
-			const __m128i colorGsShifted = _mm_slli_epi32(colorGsU32, 8);
-			const __m128i colorBsShifted = colorBsU32;
-			const __m128i colors = _mm_or_si128(
-				_mm_or_si128(colorRsShifted, colorGsShifted), colorBsShifted);
-
-			// Frame buffer index.
-			const __m128i indices = _mm_add_epi32(xs, yRowOffsets);
-
-			// (SIMD only) Conditionally write pixels based on texel opacity.
-			if (opaque0)
-			{
-				const int index0 = _mm_extract_epi32(indices, 0);
-				const uint32_t color0 = _mm_extract_epi32(colors, 0);
-				frame.colorBuffer[index0] = color0;
-			}
-
-			if (opaque1)
-			{
-				const int index1 = _mm_extract_epi32(indices, 1);
-				const uint32_t color1 = _mm_extract_epi32(colors, 1);
-				frame.colorBuffer[index1] = color1;
-			}
+		// Draw the column to the output buffer.
+		for (int y = yStart; y < yEnd; y++)
+		{
+			// Percent stepped from beginning to end on the column.
+			const double yPercent =
+				((static_cast<double>(y) + 0.50) - yProjStart) / (yProjEnd - yProjStart);
 
-			if (opaque2)
-			{
-				const int index2 = _mm_extract_epi32(indices, 2);
-				const uint32_t color2 = _mm_extract_epi32(colors, 2);
-				frame.colorBuffer[index2] = color2;
-			}
+			// Vertical texture coordinate.
+			const double v = vStart + ((vEnd - vStart) * yPercent);
 
-			if (opaque3)
-			{
-				const int index3 = _mm_extract_epi32(indices, 3);
-				const uint32_t color3 = _mm_extract_epi32(colors, 3);
-				frame.colorBuffer[index3] = color3;
-			}
+			drawPixel(y, v);
 		}
 	}
-}*/
+}
 
 void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double u, double vStart,
 	double vEnd, const SkyTexture &texture, const ShadingInfo &shadingInfo, const FrameView &frame)
@@ -4347,7 +5630,7 @@ void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -4363,12 +5646,15 @@ void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double
 		const int textureIndex = textureX + (textureY * texture.width);
 		const SkyTexel &texel = texture.texels[textureIndex];
 
-		if (texel.a != 0.0)
+		if (texel.a != 0)
 		{
 			// Determine how the pixel should be shaded based on the moon texel. Should be
 			// safe to do floating-point comparisons here with no error.
-			const bool texelIsLit = (texel.r != unlitColor.x) && (texel.g != unlitColor.y) &&
-				(texel.b != unlitColor.z);
+			const double texelR = TexelChannelTable<double>[texel.r];
+			const double texelG = TexelChannelTable<double>[texel.g];
+			const double texelB = TexelChannelTable<double>[texel.b];
+			const bool texelIsLit = (texelR != unlitColor.x) && (texelG != unlitColor.y) &&
+				(texelB != unlitColor.z);
 
 			double colorR;
 			double colorG;
@@ -4377,9 +5663,9 @@ void SoftwareRenderer::drawMoonPixels(int x, const DrawRange &drawRange, double
 			if (texelIsLit)
 			{
 				// Use the moon texel.
-				colorR = texel.r;
-				colorG = texel.g;
-				colorB = texel.b;
+				colorR = texelR;
+				colorG = texelG;
+				colorB = texelB;
 			}
 			else
 			{
@@ -4422,7 +5708,7 @@ void SoftwareRenderer::drawStarPixels(int x, const DrawRange &drawRange, double
 	// Draw the column to the output buffer.
 	for (int y = yStart; y < yEnd; y++)
 	{
-		const int index = x + (y * frame.width);
+		const int index = frame.getIndex(x, y);
 
 		// Percent stepped from beginning to end on the column.
 		const double yPercent =
@@ -4438,7 +5724,7 @@ void SoftwareRenderer::drawStarPixels(int x, const DrawRange &drawRange, double
 		const int textureIndex = textureX + (textureY * texture.width);
 		const SkyTexel &texel = texture.texels[textureIndex];
 
-		if (texel.a != 0.0)
+		if (texel.a != 0)
 		{
 			// Get gradient color from sky gradient row cache.
 			const Double3 &gradientColor = skyGradientRowCache.get(y);
@@ -4461,9 +5747,9 @@ void SoftwareRenderer::drawStarPixels(int x, const DrawRange &drawRange, double
 					0.0, 1.0);
 
 				// Texture color with shading.
-				double colorR = texel.r;
-				double colorG = texel.g;
-				double colorB = texel.b;
+				double colorR = TexelChannelTable<double>[texel.r];
+				double colorG = TexelChannelTable<double>[texel.g];
+				double colorB = TexelChannelTable<double>[texel.b];
 
 				// Lerp with sky gradient for smoother transition between day and night.
 				colorR += (gradientColor.x - colorR) * gradientVisPercent;
@@ -4494,18 +5780,17 @@ void SoftwareRenderer::drawInitialVoxelSameFloor(int x, SNInt voxelX, int voxelY
 	const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
 	const std::vector<LevelData::DoorState> &openDoors, const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates, const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 	OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -4825,7 +6110,7 @@ void SoftwareRenderer::drawInitialVoxelSameFloor(int x, SNInt voxelX, int voxelY
 
 		RayHit hit;
 		const bool success = SoftwareRenderer::findInitialDoorIntersection(voxelX, voxelZ,
-			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, voxelGrid, hit);
+			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, defGroup, hit);
 
 		if (success)
 		{
@@ -4927,18 +6212,17 @@ void SoftwareRenderer::drawInitialVoxelAbove(int x, SNInt voxelX, int voxelY, WE
 	const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
 	const std::vector<LevelData::DoorState> &openDoors, const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates, const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 	OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -5155,7 +6439,7 @@ void SoftwareRenderer::drawInitialVoxelAbove(int x, SNInt voxelX, int voxelY, WE
 
 		RayHit hit;
 		const bool success = SoftwareRenderer::findInitialDoorIntersection(voxelX, voxelZ,
-			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, voxelGrid, hit);
+			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, defGroup, hit);
 
 		if (success)
 		{
@@ -5257,18 +6541,17 @@ void SoftwareRenderer::drawInitialVoxelBelow(int x, SNInt voxelX, int voxelY, WE
 	const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
 	const std::vector<LevelData::DoorState> &openDoors, const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates, const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 	OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -5565,7 +6848,7 @@ void SoftwareRenderer::drawInitialVoxelBelow(int x, SNInt voxelX, int voxelY, WE
 
 		RayHit hit;
 		const bool success = SoftwareRenderer::findInitialDoorIntersection(voxelX, voxelZ,
-			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, voxelGrid, hit);
+			doorData.type, percentOpen, nearPoint, farPoint, camera, ray, defGroup, hit);
 
 		if (success)
 		{
@@ -5666,7 +6949,7 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, SNInt voxelX, WEInt voxelZ,
 	double nearZ, double farZ, const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
 	const std::vector<LevelData::DoorState> &openDoors, const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates, const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 	OcclusionData &occlusion, const FrameView &frame)
 {
@@ -5713,7 +6996,7 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, SNInt voxelX, WEInt voxelZ,
 	// Draw the player's current voxel first.
 	SoftwareRenderer::drawInitialVoxelSameFloor(x, voxelX, adjustedVoxelY, voxelZ, camera, ray,
 		facing, nearPoint, farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo, chunkDistance,
-		ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid,
+		ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup,
 		textures, chasmTextureGroups, occlusion, frame);
 
 	// Draw voxels below the player's voxel.
@@ -5722,16 +7005,16 @@ void SoftwareRenderer::drawInitialVoxelColumn(int x, SNInt voxelX, WEInt voxelZ,
 		SoftwareRenderer::drawInitialVoxelBelow(x, voxelX, voxelY, voxelZ, camera, ray,
 			facing, nearPoint, farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo,
 			chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-			visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+			visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 	}
 
 	// Draw voxels above the player's voxel.
-	for (int voxelY = (adjustedVoxelY + 1); voxelY < voxelGrid.getHeight(); voxelY++)
+	for (int voxelY = (adjustedVoxelY + 1); voxelY < defGroup.getHeight(); voxelY++)
 	{
 		SoftwareRenderer::drawInitialVoxelAbove(x, voxelX, voxelY, voxelZ, camera, ray,
 			facing, nearPoint, farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo,
 			chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-			visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+			visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 	}
 }
 
@@ -5741,17 +7024,16 @@ void SoftwareRenderer::drawVoxelSameFloor(int x, SNInt voxelX, int voxelY, WEInt
 	int chunkDistance, double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels, const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights, const BufferView2D<const VisibleLightList> &visLightLists,
-	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
+	const RenderDefinitionGroup &defGroup, const std::vector<VoxelTexture> &textures,
 	const ChasmTextureGroups &chasmTextureGroups, OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -6185,17 +7467,16 @@ void SoftwareRenderer::drawVoxelAbove(int x, SNInt voxelX, int voxelY, WEInt vox
 	int chunkDistance, double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels, const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights, const BufferView2D<const VisibleLightList> &visLightLists,
-	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
+	const RenderDefinitionGroup &defGroup, const std::vector<VoxelTexture> &textures,
 	const ChasmTextureGroups &chasmTextureGroups, OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -6535,17 +7816,16 @@ void SoftwareRenderer::drawVoxelBelow(int x, SNInt voxelX, int voxelY, WEInt vox
 	int chunkDistance, double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels, const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights, const BufferView2D<const VisibleLightList> &visLightLists,
-	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
+	const RenderDefinitionGroup &defGroup, const std::vector<VoxelTexture> &textures,
 	const ChasmTextureGroups &chasmTextureGroups, OcclusionData &occlusion, const FrameView &frame)
 {
-	const uint16_t voxelID = voxelGrid.getVoxel(voxelX, voxelY, voxelZ);
-	const VoxelDefinition &voxelDef = voxelGrid.getVoxelDef(voxelID);
+	const VoxelDefinition &voxelDef = defGroup.getVoxelDef(voxelX, voxelY, voxelZ);
 	const double voxelHeight = ceilingHeight;
 	const double voxelYReal = static_cast<double>(voxelY) * voxelHeight;
 
 	const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 		visLightLists, voxelX, voxelZ, camera.eyeVoxel.x, camera.eyeVoxel.z,
-		voxelGrid.getWidth(), voxelGrid.getDepth(), chunkDistance);
+		defGroup.getWidth(), defGroup.getDepth(), chunkDistance);
 
 	if (voxelDef.dataType == VoxelDataType::Wall)
 	{
@@ -6985,7 +8265,7 @@ void SoftwareRenderer::drawVoxelColumn(int x, SNInt voxelX, WEInt voxelZ, const
 	double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels, const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights, const BufferView2D<const VisibleLightList> &visLightLists,
-	const VoxelGrid &voxelGrid, const std::vector<VoxelTexture> &textures,
+	const RenderDefinitionGroup &defGroup, const std::vector<VoxelTexture> &textures,
 	const ChasmTextureGroups &chasmTextureGroups, OcclusionData &occlusion, const FrameView &frame)
 {
 	// Much of the code here is duplicated from the initial voxel column drawing method, but
@@ -7038,7 +8318,7 @@ void SoftwareRenderer::drawVoxelColumn(int x, SNInt voxelX, WEInt voxelZ, const
 	// Draw voxel straight ahead first.
 	SoftwareRenderer::drawVoxelSameFloor(x, voxelX, adjustedVoxelY, voxelZ, camera, ray, facing,
 		nearPoint, farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo, chunkDistance,
-		ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid,
+		ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup,
 		textures, chasmTextureGroups, occlusion, frame);
 
 	// Draw voxels below the voxel.
@@ -7046,21 +8326,21 @@ void SoftwareRenderer::drawVoxelColumn(int x, SNInt voxelX, WEInt voxelZ, const
 	{
 		SoftwareRenderer::drawVoxelBelow(x, voxelX, voxelY, voxelZ, camera, ray, facing, nearPoint,
 			farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo, chunkDistance, ceilingHeight,
-			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid, textures,
+			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup, textures,
 			chasmTextureGroups, occlusion, frame);
 	}
 
 	// Draw voxels above the voxel.
-	for (int voxelY = (adjustedVoxelY + 1); voxelY < voxelGrid.getHeight(); voxelY++)
+	for (int voxelY = (adjustedVoxelY + 1); voxelY < defGroup.getHeight(); voxelY++)
 	{
 		SoftwareRenderer::drawVoxelAbove(x, voxelX, voxelY, voxelZ, camera, ray, facing, nearPoint,
 			farPoint, nearZ, farZ, wallU, wallNormal, shadingInfo, chunkDistance, ceilingHeight,
-			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid, textures,
+			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup, textures,
 			chasmTextureGroups, occlusion, frame);
 	}
 }
 
-void SoftwareRenderer::drawFlat(int startX, int endX, const VisibleFlat &flat, const Double3 &normal,
+void SoftwareRenderer::drawFlat(int startX, int endX, int stride, const VisibleFlat &flat, const Double3 &normal,
 	const NewDouble2 &eye, const NewInt2 &eyeVoxelXZ, double horizonProjY, const ShadingInfo &shadingInfo,
 	int chunkDistance, const FlatTexture &texture, const BufferView<const VisibleLight> &visLights,
 	const BufferView2D<const VisibleLightList> &visLightLists, int gridWidth, int gridDepth,
@@ -7119,10 +8399,23 @@ void SoftwareRenderer::drawFlat(int startX, int endX, const VisibleFlat &flat, c
 	const int yEnd = RendererUtils::getUpperBoundedPixel(projectedYEnd, frame.height);
 
 	// Shading on the texture.
-	const Double3 shading(shadingInfo.ambient, shadingInfo.ambient, shadingInfo.ambient);
+	const ShadingReal shading = static_cast<ShadingReal>(shadingInfo.ambient);
+
+	// Vertical projection in shading precision for the texture coordinate.
+	const ShadingReal projectedYStartReal = static_cast<ShadingReal>(projectedYStart);
+	const ShadingReal projectedYEndReal = static_cast<ShadingReal>(projectedYEnd);
+
+	// Fog color to interpolate with.
+	const Double3 &fogColor = shadingInfo.getFogColor();
+	const ShadingReal fogR = static_cast<ShadingReal>(fogColor.x);
+	const ShadingReal fogG = static_cast<ShadingReal>(fogColor.y);
+	const ShadingReal fogB = static_cast<ShadingReal>(fogColor.z);
+
+	// First column at or after the flat's start that is one of the caller's columns.
+	const int xFirst = xStart + ((((startX - xStart) % stride) + stride) % stride);
 
 	// Draw by-column, similar to wall rendering.
-	for (int x = xStart; x < xEnd; x++)
+	for (int x = xFirst; x < xEnd; x += stride)
 	{
 		const double xPercent = ((static_cast<double>(x) + 0.50) - projectedXStart) /
 			(projectedXEnd - projectedXStart);
@@ -7148,47 +8441,50 @@ void SoftwareRenderer::drawFlat(int startX, int endX, const VisibleFlat &flat, c
 		const VisibleLightList &visLightList = SoftwareRenderer::getVisibleLightList(
 			visLightLists, voxelX, voxelZ, eyeVoxelXZ.x, eyeVoxelXZ.y, gridWidth, gridDepth,
 			chunkDistance);
-		const double lightContributionPercent = SoftwareRenderer::getLightContributionAtPoint<
-			LightContributionCap>(topPointXZ, visLights, visLightList);
+		const ShadingReal lightContribution = static_cast<ShadingReal>(
+			SoftwareRenderer::getLightContributionAtPoint<LightContributionCap>(
+				topPointXZ, visLights, visLightList));
 
 		// Linearly interpolated fog.
-		const Double3 &fogColor = shadingInfo.getFogColor();
-		const double fogPercent = std::min(depth / shadingInfo.fogDistance, 1.0);
+		const ShadingReal fogPercent = static_cast<ShadingReal>(
+			std::min(depth / shadingInfo.fogDistance, 1.0));
 
 		for (int y = yStart; y < yEnd; y++)
 		{
-			const int index = x + (y * frame.width);
+			const int index = frame.getIndex(x, y);
 
 			if (depth <= frame.depthBuffer[index])
 			{
-				const double yPercent = ((static_cast<double>(y) + 0.50) - projectedYStart) /
-					(projectedYEnd - projectedYStart);
+				const ShadingReal yPercent =
+					((static_cast<ShadingReal>(y) + static_cast<ShadingReal>(0.50)) - projectedYStartReal) /
+					(projectedYEndReal - projectedYStartReal);
 
 				// Vertical texture coordinate.
-				const double startV = 0.0;
-				const double endV = Constants::JustBelowOne;
-				const double v = startV + ((endV - startV) * yPercent);
+				constexpr ShadingReal startV = static_cast<ShadingReal>(0.0);
+				constexpr ShadingReal endV = static_cast<ShadingReal>(Constants::JustBelowOne);
+				const ShadingReal v = startV + ((endV - startV) * yPercent);
 
 				// Vertical texel position.
-				const int textureY = static_cast<int>(v * static_cast<double>(texture.height));
+				const int textureY = static_cast<int>(v * static_cast<ShadingReal>(texture.height));
 
 				// Alpha is checked in this loop, and transparent texels are not drawn.
 				// Flats do not have emission, so ignore it.
 				const int textureIndex = textureX + (textureY * texture.width);
 				const FlatTexel &texel = texture.texels[textureIndex];
 
-				if (texel.a > 0.0)
+				if (texel.a > 0)
 				{
-					double colorR, colorG, colorB;
-					if (texel.a < 1.0)
+					ShadingReal colorR, colorG, colorB;
+					if (texel.a < TEXEL_ALPHA_OPAQUE)
 					{
 						// Special case (for true color): if texel alpha is between 0 and 1,
 						// the previously rendered pixel is diminished by some amount.
 						const Double3 prevColor = Double3::fromRGB(frame.colorBuffer[index]);
-						const double visPercent = std::clamp(1.0 - texel.a, 0.0, 1.0);
-						colorR = prevColor.x * visPercent;
-						colorG = prevColor.y * visPercent;
-						colorB = prevColor.z * visPercent;
+						const double alpha = static_cast<double>(texel.a) / TEXEL_ALPHA_OPAQUE_REAL;
+						const double visPercent = std::clamp(1.0 - alpha, 0.0, 1.0);
+						colorR = static_cast<ShadingReal>(prevColor.x * visPercent);
+						colorG = static_cast<ShadingReal>(prevColor.y * visPercent);
+						colorB = static_cast<ShadingReal>(prevColor.z * visPercent);
 					}
 					else if (texel.reflection != 0)
 					{
@@ -7201,46 +8497,49 @@ void SoftwareRenderer::drawFlat(int startX, int endX, const VisibleFlat &flat, c
 						if (insideScreen)
 						{
 							// Read from mirrored position in frame buffer.
-							const int reflectedIndex = x + (reflectedY * frame.width);
+							const int reflectedIndex = frame.getIndex(x, reflectedY);
 							const Double3 prevColor = Double3::fromRGB(frame.colorBuffer[reflectedIndex]);
-							colorR = prevColor.x;
-							colorG = prevColor.y;
-							colorB = prevColor.z;
+							colorR = static_cast<ShadingReal>(prevColor.x);
+							colorG = static_cast<ShadingReal>(prevColor.y);
+							colorB = static_cast<ShadingReal>(prevColor.z);
 						}
 						else
 						{
 							// Use sky color instead.
 							const Double3 &skyColor = shadingInfo.skyColors.back();
-							colorR = skyColor.x;
-							colorG = skyColor.y;
-							colorB = skyColor.z;
+							colorR = static_cast<ShadingReal>(skyColor.x);
+							colorG = static_cast<ShadingReal>(skyColor.y);
+							colorB = static_cast<ShadingReal>(skyColor.z);
 						}
 					}
 					else
 					{
 						// Texture color with shading.
-						const double shadingMax = 1.0;
-						colorR = texel.r * std::min(shading.x + lightContributionPercent, shadingMax);
-						colorG = texel.g * std::min(shading.y + lightContributionPercent, shadingMax);
-						colorB = texel.b * std::min(shading.z + lightContributionPercent, shadingMax);
+						constexpr ShadingReal shadingMax = static_cast<ShadingReal>(1.0);
+						const ShadingReal lightPercent = std::min(shading + lightContribution, shadingMax);
+						const std::array<ShadingReal, 256> &channelTable = TexelChannelTable<ShadingReal>;
+						colorR = channelTable[texel.r] * lightPercent;
+						colorG = channelTable[texel.g] * lightPercent;
+						colorB = channelTable[texel.b] * lightPercent;
 					}
 
 					// Linearly interpolate with fog.
-					colorR += (fogColor.x - colorR) * fogPercent;
-					colorG += (fogColor.y - colorG) * fogPercent;
-					colorB += (fogColor.z - colorB) * fogPercent;
+					colorR += (fogR - colorR) * fogPercent;
+					colorG += (fogG - colorG) * fogPercent;
+					colorB += (fogB - colorB) * fogPercent;
 
 					// Clamp maximum (don't worry about negative values).
-					const double high = 1.0;
+					constexpr ShadingReal high = static_cast<ShadingReal>(1.0);
 					colorR = (colorR > high) ? high : colorR;
 					colorG = (colorG > high) ? high : colorG;
 					colorB = (colorB > high) ? high : colorB;
 
 					// Convert floats to integers.
+					constexpr ShadingReal channelMax = static_cast<ShadingReal>(255.0);
 					const uint32_t colorRGB = static_cast<uint32_t>(
-						((static_cast<uint8_t>(colorR * 255.0)) << 16) |
-						((static_cast<uint8_t>(colorG * 255.0)) << 8) |
-						((static_cast<uint8_t>(colorB * 255.0))));
+						((static_cast<uint8_t>(colorR * channelMax)) << 16) |
+						((static_cast<uint8_t>(colorG * channelMax)) << 8) |
+						((static_cast<uint8_t>(colorB * channelMax))));
 
 					frame.colorBuffer[index] = colorRGB;
 					frame.depthBuffer[index] = depth;
@@ -7257,7 +8556,7 @@ void SoftwareRenderer::rayCast2DInternal(int x, const Camera &camera, const Ray
 	const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 	OcclusionData &occlusion, const FrameView &frame)
 {
@@ -7295,9 +8594,9 @@ void SoftwareRenderer::rayCast2DInternal(int x, const Camera &camera, const Ray
 	const SNDouble initialDeltaDistX = deltaDistX * initialDeltaDistPercentX;
 	const WEDouble initialDeltaDistZ = deltaDistZ * initialDeltaDistPercentZ;
 
-	const SNInt gridWidth = voxelGrid.getWidth();
-	const int gridHeight = voxelGrid.getHeight();
-	const WEInt gridDepth = voxelGrid.getDepth();
+	const SNInt gridWidth = defGroup.getWidth();
+	const int gridHeight = defGroup.getHeight();
+	const WEInt gridDepth = defGroup.getDepth();
 
 	// The Z distance from the camera to the wall, and the X or Z normal of the intersected
 	// voxel face. The first Z distance is a special case, so it's brought outside the 
@@ -7344,7 +8643,7 @@ void SoftwareRenderer::rayCast2DInternal(int x, const Camera &camera, const Ray
 		SoftwareRenderer::drawInitialVoxelColumn(x, camera.eyeVoxel.x, camera.eyeVoxel.z,
 			camera, ray, facing, initialNearPoint, initialFarPoint, SoftwareRenderer::NEAR_PLANE,
 			zDistance, shadingInfo, chunkDistance, ceilingHeight, openDoors, fadingVoxels,
-			chasmStates, visLights, visLightLists, voxelGrid, textures, chasmTextureGroups,
+			chasmStates, visLights, visLightLists, defGroup, textures, chasmTextureGroups,
 			occlusion, frame);
 	}
 
@@ -7394,7 +8693,7 @@ void SoftwareRenderer::rayCast2DInternal(int x, const Camera &camera, const Ray
 	// distance stepped is less than the distance at which fog is maximum, and
 	// the column is not completely occluded.
 	while (voxelIsValid && (zDistance < shadingInfo.fogDistance) &&
-		(occlusion.yMin != occlusion.yMax))
+		!occlusion.isFull())
 	{
 		// Store the cell coordinates, axis, and Z distance for wall rendering. The
 		// loop needs to do another DDA step to calculate the far point.
@@ -7418,7 +8717,7 @@ void SoftwareRenderer::rayCast2DInternal(int x, const Camera &camera, const Ray
 		// Draw all voxels in a column at the given XZ coordinate.
 		SoftwareRenderer::drawVoxelColumn(x, savedCellX, savedCellZ, camera, ray, savedFacing,
 			nearPoint, farPoint, wallDistance, zDistance, shadingInfo, chunkDistance, ceilingHeight,
-			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid, textures,
+			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup, textures,
 			chasmTextureGroups, occlusion, frame);
 	}
 }
@@ -7429,7 +8728,7 @@ void SoftwareRenderer::rayCast2D(int x, const Camera &camera, const Ray &ray,
 	const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups, 
 	OcclusionData &occlusion, const FrameView &frame)
 {
@@ -7444,13 +8743,13 @@ void SoftwareRenderer::rayCast2D(int x, const Camera &camera, const Ray &ray,
 		{
 			SoftwareRenderer::rayCast2DInternal<true, true>(x, camera, ray, shadingInfo,
 				chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-				visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+				visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 		}
 		else
 		{
 			SoftwareRenderer::rayCast2DInternal<true, false>(x, camera, ray, shadingInfo,
 				chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-				visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+				visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 		}
 	}
 	else
@@ -7459,13 +8758,13 @@ void SoftwareRenderer::rayCast2D(int x, const Camera &camera, const Ray &ray,
 		{
 			SoftwareRenderer::rayCast2DInternal<false, true>(x, camera, ray, shadingInfo,
 				chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-				visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+				visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 		}
 		else
 		{
 			SoftwareRenderer::rayCast2DInternal<false, false>(x, camera, ray, shadingInfo,
 				chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates, visLights,
-				visLightLists, voxelGrid, textures, chasmTextureGroups, occlusion, frame);
+				visLightLists, defGroup, textures, chasmTextureGroups, occlusion, frame);
 		}
 	}
 }
@@ -7475,21 +8774,17 @@ void SoftwareRenderer::drawSkyGradient(int startY, int endY, double gradientProj
 	std::atomic<bool> &shouldDrawStars, const ShadingInfo &shadingInfo, const FrameView &frame)
 {
 	// Lambda for drawing one row of colors and depth in the frame buffer.
-	auto drawSkyRow = [&frame](int y, const Double3 &color)
+	const ColumnKernels::Table &kernels = ColumnKernels::getActiveTable();
+	constexpr double depthValue = std::numeric_limits<double>::infinity();
+	const bool isRowMajor = frame.xStride == 1;
+	auto drawSkyRow = [&frame, &kernels](int y, const Double3 &color)
 	{
-		uint32_t *colorPtr = frame.colorBuffer;
-		double *depthPtr = frame.depthBuffer;
-		const int startIndex = y * frame.width;
-		const int endIndex = (y + 1) * frame.width;
+		const int startIndex = frame.getIndex(0, y);
 		const uint32_t colorValue = color.toRGB();
-		constexpr double depthValue = std::numeric_limits<double>::infinity();
 
 		// Clear the color and depth of one row.
-		for (int i = startIndex; i < endIndex; i++)
-		{
-			colorPtr[i] = colorValue;
-			depthPtr[i] = depthValue;
-		}
+		kernels.fillSpan(frame.colorBuffer + startIndex, frame.depthBuffer + startIndex,
+			frame.width, colorValue, depthValue);
 	};
 
 	// While drawing the sky gradient, determine if it is dark enough for stars to be visible.
@@ -7515,7 +8810,29 @@ void SoftwareRenderer::drawSkyGradient(int startY, int endY, double gradientProj
 		const double maxComp = std::max(std::max(color.x, color.y), color.z);
 		isDarkEnough |= maxComp <= ShadingInfo::STAR_VIS_THRESHOLD;
 
-		drawSkyRow(y, color);
+		if (isRowMajor)
+		{
+			drawSkyRow(y, color);
+		}
+	}
+
+	if (!isRowMajor && (startY < endY))
+	{
+		// Rows aren't contiguous in a column-major frame, so write each column's slice of the
+		// gradient instead.
+		std::vector<uint32_t> rowColors(endY - startY);
+		for (int y = startY; y < endY; y++)
+		{
+			rowColors[y - startY] = skyGradientRowCache.get(y).toRGB();
+		}
+
+		for (int x = 0; x < frame.width; x++)
+		{
+			const int startIndex = frame.getIndex(x, startY);
+			std::copy(rowColors.begin(), rowColors.end(), frame.colorBuffer + startIndex);
+			std::fill(frame.depthBuffer + startIndex, frame.depthBuffer + startIndex + (endY - startY),
+				depthValue);
+		}
 	}
 
 	if (isDarkEnough)
@@ -7524,6 +8841,29 @@ void SoftwareRenderer::drawSkyGradient(int startY, int endY, double gradientProj
 	}
 }
 
+void SoftwareRenderer::swizzleFrameRows(int startY, int endY, const FrameView &frame,
+	uint32_t *outputBuffer)
+{
+	// Copy in square blocks so the column-major reads and row-major writes each only touch a
+	// few cache lines at a time.
+	for (int blockY = startY; blockY < endY; blockY += FrameSwizzleBlockSize)
+	{
+		const int blockEndY = std::min(blockY + FrameSwizzleBlockSize, endY);
+		for (int blockX = 0; blockX < frame.width; blockX += FrameSwizzleBlockSize)
+		{
+			const int blockEndX = std::min(blockX + FrameSwizzleBlockSize, frame.width);
+			for (int y = blockY; y < blockEndY; y++)
+			{
+				uint32_t *outputRow = outputBuffer + (y * frame.width);
+				for (int x = blockX; x < blockEndX; x++)
+				{
+					outputRow[x] = frame.colorBuffer[frame.getIndex(x, y)];
+				}
+			}
+		}
+	}
+}
+
 void SoftwareRenderer::drawDistantSky(int startX, int endX, const VisDistantObjects &visDistantObjs,
 	const std::vector<SkyTexture> &skyTextures, const Buffer<Double3> &skyGradientRowCache,
 	bool shouldDrawStars, const ShadingInfo &shadingInfo, const FrameView &frame)
@@ -7569,55 +8909,236 @@ void SoftwareRenderer::drawDistantSky(int startX, int endX, const VisDistantObje
 			}
 			else if (renderType == DistantRenderType::Star)
 			{
-				SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
-					texture, skyGradientRowCache, shadingInfo, frame);
+				SoftwareRenderer::drawStarPixels(x, drawRange, u, 0.0, Constants::JustBelowOne,
+					texture, skyGradientRowCache, shadingInfo, frame);
+			}
+		}
+	};
+
+	// Lambda for drawing a group of distant objects with some render type.
+	auto drawDistantObjRange = [&visDistantObjs, &drawDistantObj](int start, int end,
+		DistantRenderType renderType)
+	{
+		DebugAssert(start >= 0);
+		DebugAssert(end <= visDistantObjs.objs.size());
+
+		// Reverse iterate so objects are drawn far to near.
+		const VisDistantObject *objs = visDistantObjs.objs.data();
+		for (int i = end - 1; i >= start; i--)
+		{
+			drawDistantObj(objs[i], renderType);
+		}
+	};
+
+	// Stars are only drawn when the sky gradient is dark enough. This saves on performance during
+	// the daytime.
+	if (shouldDrawStars)
+	{
+		drawDistantObjRange(visDistantObjs.starStart, visDistantObjs.starEnd, DistantRenderType::Star);
+	}
+
+	drawDistantObjRange(visDistantObjs.sunStart, visDistantObjs.sunEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.moonStart, visDistantObjs.moonEnd, DistantRenderType::Moon);
+	drawDistantObjRange(visDistantObjs.airStart, visDistantObjs.airEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.animLandStart, visDistantObjs.animLandEnd, DistantRenderType::General);
+	drawDistantObjRange(visDistantObjs.landStart, visDistantObjs.landEnd, DistantRenderType::General);
+}
+
+void SoftwareRenderer::copySkyRows(int startY, int endY, const FrameView &skyFrame,
+	const FrameView &frame)
+{
+	constexpr double depthValue = std::numeric_limits<double>::infinity();
+
+	if (frame.xStride == 1)
+	{
+		// The rows are one contiguous block in a row-major frame.
+		const int startIndex = frame.getIndex(0, startY);
+		const int endIndex = frame.getIndex(0, endY);
+		std::copy(skyFrame.colorBuffer + startIndex, skyFrame.colorBuffer + endIndex,
+			frame.colorBuffer + startIndex);
+		std::fill(frame.depthBuffer + startIndex, frame.depthBuffer + endIndex, depthValue);
+	}
+	else if (startY < endY)
+	{
+		for (int x = 0; x < frame.width; x++)
+		{
+			const int startIndex = frame.getIndex(x, startY);
+			const int endIndex = startIndex + (endY - startY);
+			std::copy(skyFrame.colorBuffer + startIndex, skyFrame.colorBuffer + endIndex,
+				frame.colorBuffer + startIndex);
+			std::fill(frame.depthBuffer + startIndex, frame.depthBuffer + endIndex, depthValue);
+		}
+	}
+}
+
+void SoftwareRenderer::copySkyColumns(int startX, int endX, const FrameView &skyFrame,
+	const FrameView &frame)
+{
+	if (frame.yStride == 1)
+	{
+		// The columns are one contiguous block in a column-major frame.
+		const int startIndex = frame.getIndex(startX, 0);
+		const int endIndex = frame.getIndex(endX, 0);
+		std::copy(skyFrame.colorBuffer + startIndex, skyFrame.colorBuffer + endIndex,
+			frame.colorBuffer + startIndex);
+	}
+	else if (startX < endX)
+	{
+		for (int y = 0; y < frame.height; y++)
+		{
+			const int startIndex = frame.getIndex(startX, y);
+			const int endIndex = startIndex + (endX - startX);
+			std::copy(skyFrame.colorBuffer + startIndex, skyFrame.colorBuffer + endIndex,
+				frame.colorBuffer + startIndex);
+		}
+	}
+}
+
+void SoftwareRenderer::rayCastPacket(RayPacket &packet, const Camera &camera,
+	const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
+	const std::vector<LevelData::DoorState> &openDoors,
+	const std::vector<LevelData::FadeState> &fadingVoxels,
+	const LevelData::ChasmStates &chasmStates,
+	const BufferView<const VisibleLight> &visLights,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
+	const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
+	Buffer<OcclusionData> &occlusion, const FrameView &frame)
+{
+	const SNInt gridWidth = defGroup.getWidth();
+	const WEInt gridDepth = defGroup.getDepth();
+
+	// Draw all voxels in each lane's column at the player's XZ coordinate.
+	if (packet.eyeVoxelIsValid)
+	{
+		for (int lane = 0; lane < packet.laneCount; lane++)
+		{
+			const Ray ray(packet.dirX[lane], packet.dirZ[lane]);
+			const bool nonNegativeDirX = ray.dirX >= 0.0;
+			const bool nonNegativeDirZ = ray.dirZ >= 0.0;
+			const SNDouble initialDeltaDistX = packet.deltaDistSumX[lane];
+			const WEDouble initialDeltaDistZ = packet.deltaDistSumZ[lane];
+
+			double zDistance;
+			VoxelFacing2D facing;
+			if (initialDeltaDistX < initialDeltaDistZ)
+			{
+				zDistance = initialDeltaDistX;
+				facing = nonNegativeDirX ? VoxelFacing2D::NegativeX : VoxelFacing2D::PositiveX;
+			}
+			else
+			{
+				zDistance = initialDeltaDistZ;
+				facing = nonNegativeDirZ ? VoxelFacing2D::NegativeZ : VoxelFacing2D::PositiveZ;
 			}
+
+			const NewDouble2 initialNearPoint(
+				camera.eye.x + (ray.dirX * SoftwareRenderer::NEAR_PLANE),
+				camera.eye.z + (ray.dirZ * SoftwareRenderer::NEAR_PLANE));
+			const NewDouble2 initialFarPoint(
+				camera.eye.x + (ray.dirX * zDistance),
+				camera.eye.z + (ray.dirZ * zDistance));
+
+			const int x = packet.columns[lane];
+			SoftwareRenderer::drawInitialVoxelColumn(x, camera.eyeVoxel.x, camera.eyeVoxel.z,
+				camera, ray, facing, initialNearPoint, initialFarPoint, SoftwareRenderer::NEAR_PLANE,
+				zDistance, shadingInfo, chunkDistance, ceilingHeight, openDoors, fadingVoxels,
+				chasmStates, visLights, visLightLists, defGroup, textures, chasmTextureGroups,
+				occlusion.get(x), frame);
 		}
-	};
+	}
 
-	// Lambda for drawing a group of distant objects with some render type.
-	auto drawDistantObjRange = [&visDistantObjs, &drawDistantObj](int start, int end,
-		DistantRenderType renderType)
+	// Step forward in the grid once to leave the initial voxel.
+	packet.trace(0, 1, camera, gridWidth, gridDepth);
+
+	// Trace a batch of steps for every lane, then draw each lane's column up to where its ray
+	// ends. Lanes whose rays ended keep stepping with the others but aren't drawn.
+	std::array<bool, RayPacket::WIDTH> lanesActive;
+	std::fill(lanesActive.begin(), lanesActive.end(), false);
+	std::fill(lanesActive.begin(), lanesActive.begin() + packet.laneCount, true);
+	int activeCount = packet.laneCount;
+	while (activeCount > 0)
 	{
-		DebugAssert(start >= 0);
-		DebugAssert(end <= visDistantObjs.objs.size());
+		packet.trace(1, RayPacket::BATCH_STEPS, camera, gridWidth, gridDepth);
 
-		// Reverse iterate so objects are drawn far to near.
-		const VisDistantObject *objs = visDistantObjs.objs.data();
-		for (int i = end - 1; i >= start; i--)
+		for (int lane = 0; lane < packet.laneCount; lane++)
 		{
-			drawDistantObj(objs[i], renderType);
+			if (!lanesActive[lane])
+			{
+				continue;
+			}
+
+			const int x = packet.columns[lane];
+			const Ray ray(packet.dirX[lane], packet.dirZ[lane]);
+			OcclusionData &columnOcclusion = occlusion.get(x);
+			const std::array<RayPacket::Step, RayPacket::BATCH_STEPS + 1> &laneSteps = packet.steps[lane];
+			for (int i = 0; i < RayPacket::BATCH_STEPS; i++)
+			{
+				// Same end conditions as the scalar ray caster.
+				const RayPacket::Step &step = laneSteps[i];
+				if (!step.isValid || (step.zDistance >= shadingInfo.fogDistance) || columnOcclusion.isFull())
+				{
+					lanesActive[lane] = false;
+					activeCount--;
+					break;
+				}
+
+				const double wallDistance = step.zDistance;
+				const double zDistance = laneSteps[i + 1].zDistance;
+				const NewDouble2 nearPoint(
+					camera.eye.x + (ray.dirX * wallDistance),
+					camera.eye.z + (ray.dirZ * wallDistance));
+				const NewDouble2 farPoint(
+					camera.eye.x + (ray.dirX * zDistance),
+					camera.eye.z + (ray.dirZ * zDistance));
+
+				SoftwareRenderer::drawVoxelColumn(x, step.cellX, step.cellZ, camera, ray, step.facing,
+					nearPoint, farPoint, wallDistance, zDistance, shadingInfo, chunkDistance, ceilingHeight,
+					openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup, textures,
+					chasmTextureGroups, columnOcclusion, frame);
+			}
 		}
-	};
 
-	// Stars are only drawn when the sky gradient is dark enough. This saves on performance during
-	// the daytime.
-	if (shouldDrawStars)
-	{
-		drawDistantObjRange(visDistantObjs.starStart, visDistantObjs.starEnd, DistantRenderType::Star);
+		// The last step of the batch hasn't been drawn yet.
+		for (int lane = 0; lane < RayPacket::WIDTH; lane++)
+		{
+			packet.steps[lane][0] = packet.steps[lane][RayPacket::BATCH_STEPS];
+		}
 	}
-
-	drawDistantObjRange(visDistantObjs.sunStart, visDistantObjs.sunEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.moonStart, visDistantObjs.moonEnd, DistantRenderType::Moon);
-	drawDistantObjRange(visDistantObjs.airStart, visDistantObjs.airEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.animLandStart, visDistantObjs.animLandEnd, DistantRenderType::General);
-	drawDistantObjRange(visDistantObjs.landStart, visDistantObjs.landEnd, DistantRenderType::General);
 }
 
-void SoftwareRenderer::drawVoxels(int startX, int stride, const Camera &camera,
-	int chunkDistance, double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
+void SoftwareRenderer::drawVoxels(int startX, int endX, int stride, const Camera &camera,
+	int chunkDistance, double ceilingHeight, bool rayPackets,
+	const std::vector<LevelData::DoorState> &openDoors,
 	const std::vector<LevelData::FadeState> &fadingVoxels,
 	const LevelData::ChasmStates &chasmStates,
 	const BufferView<const VisibleLight> &visLights,
-	const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+	const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 	const std::vector<VoxelTexture> &voxelTextures, const ChasmTextureGroups &chasmTextureGroups,
 	Buffer<OcclusionData> &occlusion, const ShadingInfo &shadingInfo, const FrameView &frame)
 {
+	if (rayPackets)
+	{
+		// Columns a packet apart share DDA steps in SIMD lanes.
+		RayPacket packet;
+		const int packetSpan = stride * RayPacket::WIDTH;
+		for (int packetStartX = startX; packetStartX < endX; packetStartX += packetSpan)
+		{
+			packet.init(packetStartX, endX, stride, camera, defGroup.getWidth(), defGroup.getHeight(),
+				defGroup.getDepth(), frame);
+			SoftwareRenderer::rayCastPacket(packet, camera, shadingInfo, chunkDistance, ceilingHeight,
+				openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup, voxelTextures,
+				chasmTextureGroups, occlusion, frame);
+		}
+
+		return;
+	}
+
 	const NewDouble2 forwardZoomed(camera.forwardZoomedX, camera.forwardZoomedZ);
 	const NewDouble2 rightAspected(camera.rightAspectedX, camera.rightAspectedZ);
 
-	// Draw pixel columns with spacing determined by the number of render threads.
-	for (int x = startX; x < frame.width; x += stride)
+	// Draw pixel columns with spacing determined by the caller (interleaved between render threads
+	// or contiguous within a column tile).
+	for (int x = startX; x < endX; x += stride)
 	{
 		// X percent across the screen.
 		const double xPercent = (static_cast<double>(x) + 0.50) / frame.widthReal;
@@ -7633,12 +9154,12 @@ void SoftwareRenderer::drawVoxels(int startX, int stride, const Camera &camera,
 
 		// Cast the 2D ray and fill in the column's pixels with color.
 		SoftwareRenderer::rayCast2D(x, camera, ray, shadingInfo, chunkDistance, ceilingHeight,
-			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, voxelGrid,
+			openDoors, fadingVoxels, chasmStates, visLights, visLightLists, defGroup,
 			voxelTextures, chasmTextureGroups, occlusion.get(x), frame);
 	}
 }
 
-void SoftwareRenderer::drawFlats(int startX, int endX, const Camera &camera,
+void SoftwareRenderer::drawFlats(int startX, int endX, int stride, const Camera &camera,
 	const Double3 &flatNormal, const std::vector<VisibleFlat> &visibleFlats,
 	const FlatTextureGroups &flatTextureGroups, const ShadingInfo &shadingInfo, int chunkDistance,
 	const BufferView<const VisibleLight> &visLights,
@@ -7656,25 +9177,109 @@ void SoftwareRenderer::drawFlats(int startX, int endX, const Camera &camera,
 		// the "flat.flipped" value.
 		const EntityRenderID entityRenderID = flat.entityRenderID;
 		const FlatTextureGroup &textureGroup = flatTextureGroups[entityRenderID];
-		const FlatTexture &texture = textureGroup.getTexture(
+		const FlatTexture &baseTexture = textureGroup.getTexture(
 			flat.animStateID, flat.animAngleID, flat.animTextureID);
 
-		SoftwareRenderer::drawFlat(startX, endX, flat, flatNormal, eye2D, eyeVoxel2D,
+		// Flats are upright so every column has the same texel density.
+		const double projectedHeight = (flat.endY - flat.startY) * frame.heightReal;
+		const FlatTexture &texture = baseTexture.getMipLevel(
+			static_cast<double>(baseTexture.height) / std::abs(projectedHeight));
+
+		SoftwareRenderer::drawFlat(startX, endX, stride, flat, flatNormal, eye2D, eyeVoxel2D,
 			camera.horizonProjY, shadingInfo, chunkDistance, texture, visLights, visLightLists,
 			gridWidth, gridDepth, frame);
 	}
 }
 
-void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData, int threadIndex, int startX,
-	int endX, int startY, int endY)
+void SoftwareRenderer::reconstructColumns(int startX, int endX, int parity, const int *sourceColumns,
+	const uint32_t *previousHistory, uint32_t *currentHistory, const FrameView &frame)
+{
+	// Lambda for getting where a skipped column comes from. Columns that were off screen last
+	// frame use a neighbor drawn this frame, but only within this range since other threads might
+	// still be drawing outside of it.
+	auto getSource = [startX, endX, sourceColumns, previousHistory, &frame](int x,
+		const uint32_t **outBuffer, int *outX)
+	{
+		const int sourceX = sourceColumns[x];
+		if (sourceX >= 0)
+		{
+			*outBuffer = previousHistory;
+			*outX = sourceX;
+		}
+		else if ((x - 1) >= startX)
+		{
+			*outBuffer = frame.colorBuffer;
+			*outX = x - 1;
+		}
+		else if ((x + 1) < endX)
+		{
+			*outBuffer = frame.colorBuffer;
+			*outX = x + 1;
+		}
+		else
+		{
+			*outBuffer = previousHistory;
+			*outX = x;
+		}
+	};
+
+	if (frame.yStride == 1)
+	{
+		// Each column is one contiguous block in a column-major frame.
+		for (int x = startX; x < endX; x++)
+		{
+			uint32_t *column = frame.colorBuffer + frame.getIndex(x, 0);
+			if ((parity >= 0) && ((x & 1) != parity))
+			{
+				const uint32_t *sourceBuffer;
+				int sourceX;
+				getSource(x, &sourceBuffer, &sourceX);
+
+				const uint32_t *sourceColumn = sourceBuffer + frame.getIndex(sourceX, 0);
+				std::copy(sourceColumn, sourceColumn + frame.height, column);
+			}
+
+			std::copy(column, column + frame.height, currentHistory + frame.getIndex(x, 0));
+		}
+	}
+	else if (startX < endX)
+	{
+		// Walk row by row in a row-major frame.
+		for (int y = 0; y < frame.height; y++)
+		{
+			uint32_t *row = frame.colorBuffer + frame.getIndex(0, y);
+			if (parity >= 0)
+			{
+				const int firstSkippedX = startX + ((parity + 1 - startX) & 1);
+				for (int x = firstSkippedX; x < endX; x += 2)
+				{
+					const uint32_t *sourceBuffer;
+					int sourceX;
+					getSource(x, &sourceBuffer, &sourceX);
+					row[x] = sourceBuffer[frame.getIndex(sourceX, y)];
+				}
+			}
+
+			std::copy(row + startX, row + endX, currentHistory + frame.getIndex(startX, y));
+		}
+	}
+}
+
+void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData,
+	RenderThreadData::Epoch initialEpoch, int threadIndex, int startX, int endX, int startY, int endY)
 {
+	RenderThreadData::Epoch frameEpoch = initialEpoch;
+	Profiler::get().setThreadName("Render thread " + std::to_string(threadIndex));
+
 	while (true)
 	{
-		// Initial wait condition. The lock must be unlocked after wait() so other threads can
-		// lock it.
-		std::unique_lock<std::mutex> lk(threadData.mutex);
-		threadData.condVar.wait(lk, [&threadData]() { return threadData.go; });
-		lk.unlock();
+		// Initial wait condition. Between frames this usually ends up parked.
+		threadData.waitUntil([&threadData, frameEpoch]()
+		{
+			return threadData.frameEpoch.load(std::memory_order_acquire) != frameEpoch;
+		});
+
+		frameEpoch = threadData.frameEpoch.load(std::memory_order_acquire);
 
 		// Received a go signal. Check if the renderer is being destroyed before doing anything.
 		if (threadData.isDestructing)
@@ -7682,106 +9287,248 @@ void SoftwareRenderer::renderThreadLoop(RenderThreadData &threadData, int thread
 			break;
 		}
 
-		// Lambda for making a thread wait until others are finished rendering something. The last
-		// thread to call this calls notify on all others.
-		auto threadBarrier = [&threadData, &lk](auto &data)
-		{
-			lk.lock();
-			data.threadsDone++;
-
-			// If this was the last thread, notify all to continue.
-			if (data.threadsDone == threadData.totalThreads)
-			{
-				lk.unlock();
-				threadData.condVar.notify_all();
+		// Wake-up latency counts as the sky gradient's wait time.
+		const auto wakeTime = std::chrono::high_resolution_clock::now();
+		const int64_t wakeNanoseconds = static_cast<int64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				wakeTime - threadData.frameStartTime).count());
+		threadData.phaseWaits[ProfilerData::PHASE_SKY_GRADIENT].add(wakeNanoseconds);
+
+		// This thread's timing for the frame, written to the shared profiler data at the end.
+		ProfilerData::ThreadTiming timing;
+		timing.idleSeconds = static_cast<double>(wakeNanoseconds) / static_cast<double>(std::nano::den);
+		auto busyStartTime = wakeTime;
+
+		// Lambda for reporting this thread's part of a phase as finished. The main thread is the
+		// only one waiting on the done count; render threads instead wait on the next phase's
+		// ready epoch, which is only published after every thread is done. For a pipelined frame
+		// the main thread has already moved on, so the last thread to finish publishes it.
+		auto finishPhase = [&threadData, frameEpoch](std::atomic<int> &threadsDone, int phaseIndex,
+			std::atomic<RenderThreadData::Epoch> *nextReadyEpoch, int nextPhaseIndex)
+		{
+			threadData.recordPhaseEnd(phaseIndex);
+			const int doneCount = threadsDone.fetch_add(1) + 1;
+			if (threadData.selfPublishing && (nextReadyEpoch != nullptr) &&
+				(doneCount == threadData.totalThreads))
+			{
+				threadData.publishPhase(*nextReadyEpoch, frameEpoch, nextPhaseIndex);
 			}
 			else
 			{
-				// Wait for other threads to finish.
-				threadData.condVar.wait(lk, [&threadData, &data]()
-				{
-					return data.threadsDone == threadData.totalThreads;
-				});
-
-				lk.unlock();
+				threadData.notifyParked();
 			}
 		};
 
-		// Draw this thread's portion of the sky gradient.
-		RenderThreadData::SkyGradient &skyGradient = threadData.skyGradient;
-		SoftwareRenderer::drawSkyGradient(startY, endY, skyGradient.projectedYTop,
-			skyGradient.projectedYBottom, *skyGradient.rowCache, skyGradient.shouldDrawStars,
-			*threadData.shadingInfo, *threadData.frame);
+		// Lambda for waiting until the main thread says a phase's inputs are ready this frame.
+		// Time since the last wait ended counts as busy time.
+		auto waitForPhase = [&threadData, frameEpoch, &timing, &busyStartTime](
+			const std::atomic<RenderThreadData::Epoch> &readyEpoch, int phaseIndex)
+		{
+			ProfilerZone("Wait for phase");
+			const auto waitStartTime = std::chrono::high_resolution_clock::now();
+			timing.busySeconds += std::chrono::duration<double>(waitStartTime - busyStartTime).count();
+
+			const int64_t waitNanoseconds = threadData.waitUntil([&readyEpoch, frameEpoch]()
+			{
+				return readyEpoch.load(std::memory_order_acquire) == frameEpoch;
+			});
 
-		// Wait for other threads to finish the sky gradient.
-		threadBarrier(skyGradient);
+			threadData.phaseWaits[phaseIndex].add(waitNanoseconds);
+			timing.idleSeconds += static_cast<double>(waitNanoseconds) / static_cast<double>(std::nano::den);
+			busyStartTime = std::chrono::high_resolution_clock::now();
+		};
+
+		// Draw this thread's portion of the sky gradient into the sky cache, or copy the cached
+		// sky if it's still valid.
+		RenderThreadData::SkyGradient &skyGradient = threadData.skyGradient;
+		const bool reuseSky = skyGradient.reuseSky;
+		{
+			ProfilerZone("Sky gradient");
+			if (reuseSky)
+			{
+				SoftwareRenderer::copySkyRows(startY, endY, *skyGradient.skyFrame, *threadData.frame);
+			}
+			else
+			{
+				SoftwareRenderer::drawSkyGradient(startY, endY, skyGradient.projectedYTop,
+					skyGradient.projectedYBottom, *skyGradient.rowCache, skyGradient.shouldDrawStars,
+					*threadData.shadingInfo, *skyGradient.skyFrame);
+			}
+		}
 
-		// Wait for the visible distant object testing to finish.
 		RenderThreadData::DistantSky &distantSky = threadData.distantSky;
-		lk.lock();
-		threadData.condVar.wait(lk, [&distantSky]() { return distantSky.doneVisTesting; });
-		lk.unlock();
+		finishPhase(skyGradient.threadsDone, ProfilerData::PHASE_SKY_GRADIENT, &distantSky.readyEpoch,
+			ProfilerData::PHASE_DISTANT_SKY);
 
-		// Draw this thread's portion of distant sky objects.
-		SoftwareRenderer::drawDistantSky(startX, endX, *distantSky.visDistantObjs,
-			*distantSky.skyTextures, *skyGradient.rowCache, skyGradient.shouldDrawStars,
-			*threadData.shadingInfo, *threadData.frame);
+		// Wait for the visible distant object testing to finish.
+		waitForPhase(distantSky.readyEpoch, ProfilerData::PHASE_DISTANT_SKY);
 
-		// Wait for other threads to finish distant sky objects.
-		threadBarrier(distantSky);
+		// Draw this thread's portion of distant sky objects into the sky cache, then copy its
+		// columns of the finished sky to the frame. A reused sky already has them.
+		if (!reuseSky)
+		{
+			ProfilerZone("Distant sky");
+			SoftwareRenderer::drawDistantSky(startX, endX, *distantSky.visDistantObjs,
+				*distantSky.skyTextures, *skyGradient.rowCache, skyGradient.shouldDrawStars,
+				*threadData.shadingInfo, *skyGradient.skyFrame);
+			SoftwareRenderer::copySkyColumns(startX, endX, *skyGradient.skyFrame, *threadData.frame);
+		}
 
-		// Wait for visible light testing to finish.
 		RenderThreadData::Voxels &voxels = threadData.voxels;
-		lk.lock();
-		threadData.condVar.wait(lk, [&voxels]() { return voxels.doneLightVisTesting; });
-		lk.unlock();
+		finishPhase(distantSky.threadsDone, ProfilerData::PHASE_DISTANT_SKY, &voxels.readyEpoch,
+			ProfilerData::PHASE_VOXELS);
 
-		// Number of columns to skip per ray cast (for interleaved ray casting as a means of
-		// load-balancing).
-		const int strideX = threadData.totalThreads;
+		// Wait for visible light testing to finish.
+		waitForPhase(voxels.readyEpoch, ProfilerData::PHASE_VOXELS);
 
 		// Draw this thread's portion of voxels.
 		const BufferView<const VisibleLight> voxelsVisLightsView(voxels.visLights->data(),
 			static_cast<int>(voxels.visLights->size()));
 		const BufferView2D<const VisibleLightList> voxelsVisLightListsView(voxels.visLightLists->get(),
 			voxels.visLightLists->getWidth(), voxels.visLightLists->getHeight());
-		SoftwareRenderer::drawVoxels(threadIndex, strideX, *threadData.camera, voxels.chunkDistance,
-			voxels.ceilingHeight, *voxels.openDoors, *voxels.fadingVoxels, *voxels.chasmStates,
-			voxelsVisLightsView, voxelsVisLightListsView, *voxels.voxelGrid, *voxels.voxelTextures,
-			*voxels.chasmTextureGroups, *voxels.occlusion, *threadData.shadingInfo, *threadData.frame);
+		auto drawVoxelColumns = [&threadData, &voxels, &voxelsVisLightsView,
+			&voxelsVisLightListsView](int voxelStartX, int voxelEndX, int voxelStrideX)
+		{
+			SoftwareRenderer::drawVoxels(voxelStartX, voxelEndX, voxelStrideX, *threadData.camera,
+				voxels.chunkDistance, voxels.ceilingHeight, voxels.rayPackets, *voxels.openDoors,
+				*voxels.fadingVoxels,
+				*voxels.chasmStates, voxelsVisLightsView, voxelsVisLightListsView, *voxels.defGroup,
+				*voxels.voxelTextures, *voxels.chasmTextureGroups, *voxels.occlusion,
+				*threadData.shadingInfo, *threadData.frame);
+		};
 
-		// Wait for other threads to finish voxels.
-		threadBarrier(voxels);
+		// With checkerboard rendering, only every other column is drawn.
+		const RenderThreadData::Reconstruction &reconstruction = threadData.reconstruction;
+		const int columnParity = reconstruction.parity;
+		const int columnStride = (columnParity >= 0) ? 2 : 1;
+		auto getFirstColumn = [columnParity](int rangeStartX)
+		{
+			return (columnParity >= 0) ? (rangeStartX + ((columnParity - rangeStartX) & 1)) : rangeStartX;
+		};
+
+		const bool workStealing = threadData.workStealing;
+		{
+			ProfilerZone("Voxels");
+			if (workStealing)
+			{
+				// Draw column tiles until every thread's queue is empty.
+				int tileStartX, tileEndX;
+				bool wasStolen;
+				while (voxels.scheduler.tryGetTile(threadIndex, &tileStartX, &tileEndX, &wasStolen))
+				{
+					drawVoxelColumns(getFirstColumn(tileStartX), tileEndX, columnStride);
+					timing.tilesStolen += wasStolen ? 1 : 0;
+				}
+			}
+			else
+			{
+				// Interleaved ray casting as a means of load-balancing, skipping one column per thread.
+				drawVoxelColumns(getFirstColumn(0) + (threadIndex * columnStride), threadData.frame->width,
+					threadData.totalThreads * columnStride);
+			}
+		}
 
-		// Wait for the visible flat sorting to finish.
 		RenderThreadData::Flats &flats = threadData.flats;
-		lk.lock();
-		threadData.condVar.wait(lk, [&flats]() { return flats.doneSorting; });
-		lk.unlock();
+		finishPhase(voxels.threadsDone, ProfilerData::PHASE_VOXELS, &flats.readyEpoch,
+			ProfilerData::PHASE_FLATS);
+
+		// Wait for the visible flat sorting to finish.
+		waitForPhase(flats.readyEpoch, ProfilerData::PHASE_FLATS);
 
 		// Draw this thread's portion of flats.
 		const BufferView<const VisibleLight> flatsVisLightsView(flats.visLights->data(),
 			static_cast<int>(flats.visLights->size()));
 		const BufferView2D<const VisibleLightList> flatsVisLightListsView(flats.visLightLists->get(),
 			flats.visLightLists->getWidth(), flats.visLightLists->getHeight());
-		SoftwareRenderer::drawFlats(startX, endX, *threadData.camera, *flats.flatNormal,
-			*flats.visibleFlats, *flats.flatTextureGroups, *threadData.shadingInfo,
-			voxels.chunkDistance, flatsVisLightsView, flatsVisLightListsView,
-			voxels.voxelGrid->getWidth(), voxels.voxelGrid->getDepth(), *threadData.frame);
+		auto drawFlatColumns = [&threadData, &voxels, &flats, &flatsVisLightsView,
+			&flatsVisLightListsView, &reconstruction, columnStride, &getFirstColumn](int flatStartX,
+			int flatEndX)
+		{
+			SoftwareRenderer::drawFlats(getFirstColumn(flatStartX), flatEndX, columnStride,
+				*threadData.camera, *flats.flatNormal, *flats.visibleFlats, *flats.flatTextureGroups,
+				*threadData.shadingInfo, voxels.chunkDistance, flatsVisLightsView,
+				flatsVisLightListsView, voxels.defGroup->getWidth(), voxels.defGroup->getDepth(),
+				*threadData.frame);
+
+			// The columns are finished, so fill in the skipped ones and keep them for next frame.
+			if (reconstruction.currentHistory != nullptr)
+			{
+				SoftwareRenderer::reconstructColumns(flatStartX, flatEndX, reconstruction.parity,
+					reconstruction.sourceColumns, reconstruction.previousHistory,
+					reconstruction.currentHistory, *threadData.frame);
+			}
+		};
+
+		{
+			ProfilerZone("Flats");
+			if (workStealing)
+			{
+				int tileStartX, tileEndX;
+				bool wasStolen;
+				while (flats.scheduler.tryGetTile(threadIndex, &tileStartX, &tileEndX, &wasStolen))
+				{
+					drawFlatColumns(tileStartX, tileEndX);
+					timing.tilesStolen += wasStolen ? 1 : 0;
+				}
+			}
+			else
+			{
+				drawFlatColumns(startX, endX);
+			}
+		}
+
+		// If drawing to a column-major frame, convert this thread's rows once every thread is done
+		// drawing.
+		RenderThreadData::Swizzle &swizzle = threadData.swizzle;
+		const bool swizzling = swizzle.outputBuffer != nullptr;
+		if (swizzling)
+		{
+			finishPhase(flats.threadsDone, ProfilerData::PHASE_FLATS, &swizzle.readyEpoch,
+				ProfilerData::PHASE_SWIZZLE);
+			waitForPhase(swizzle.readyEpoch, ProfilerData::PHASE_SWIZZLE);
+
+			ProfilerZone("Swizzle");
+			SoftwareRenderer::swizzleFrameRows(startY, endY, *threadData.frame, swizzle.outputBuffer);
+		}
 
-		// Wait for other threads to finish flats.
-		threadBarrier(flats);
+		// Timing must be written before the main thread can see this thread as done.
+		const auto frameEndTime = std::chrono::high_resolution_clock::now();
+		timing.busySeconds += std::chrono::duration<double>(frameEndTime - busyStartTime).count();
+		threadData.threadTimings.get(threadIndex) = timing;
+
+		if (swizzling)
+		{
+			finishPhase(swizzle.threadsDone, ProfilerData::PHASE_SWIZZLE, nullptr, 0);
+		}
+		else
+		{
+			finishPhase(flats.threadsDone, ProfilerData::PHASE_FLATS, nullptr, 0);
+		}
 	}
 }
 
-void SoftwareRenderer::render(const Double3 &eye, const Double3 &direction, double fovY,
+void SoftwareRenderer::render(const RenderDefinitionGroup &defGroup,
+	const RenderInstanceGroup &instGroup, const RenderCamera &camera,
+	const RenderFrameSettings &settings, uint32_t *colorBuffer)
+{
+	ProfilerZone("SoftwareRenderer::render");
+
+	// The previous frame's buffers and visibility lists are about to be reused.
+	this->finishFrame();
+	this->endTextureBatch();
+
+	this->drawFrame(camera.getAbsolutePosition(), camera.getDirection(), camera.getFovY(),
+		settings.getAmbient(), settings.getDaytimePercent(), settings.getChasmAnimPercent(),
+		settings.getLatitude(), settings.getNightLightsAreActive(), settings.getIsExterior(),
+		settings.getPlayerHasLight(), settings.getChunkDistance(), settings.getCeilingHeight(),
+		defGroup, instGroup, colorBuffer);
+}
+
+void SoftwareRenderer::drawFrame(const Double3 &eye, const Double3 &direction, Degrees fovY,
 	double ambient, double daytimePercent, double chasmAnimPercent, double latitude,
 	bool nightLightsAreActive, bool isExterior, bool playerHasLight, int chunkDistance,
-	double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-	const std::vector<LevelData::FadeState> &fadingVoxels,
-	const LevelData::ChasmStates &chasmStates, const VoxelGrid &voxelGrid,
-	const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary,
-	uint32_t *colorBuffer)
+	double ceilingHeight, const RenderDefinitionGroup &defGroup,
+	const RenderInstanceGroup &instGroup, uint32_t *colorBuffer)
 {
 	// Constants for screen dimensions.
 	const double widthReal = static_cast<double>(this->width);
@@ -7791,96 +9538,312 @@ void SoftwareRenderer::render(const Double3 &eye, const Double3 &direction, doub
 	// To account for tall pixels.
 	const double projectionModifier = SoftwareRenderer::TALL_PIXEL_RATIO;
 
-	// 2.5D camera definition.
-	const Camera camera(eye, direction, fovY, aspect, projectionModifier);
+	// 2.5D camera definition. Values the render threads read are kept in members so a pipelined
+	// frame can still be drawing after this returns.
+	const Camera &camera = this->frameCamera.emplace(eye, direction, fovY, aspect, projectionModifier);
 
 	// Normal of all flats (always facing the camera).
-	const Double3 flatNormal = Double3(-camera.forwardX, 0.0, -camera.forwardZ).normalized();
+	this->frameFlatNormal = Double3(-camera.forwardX, 0.0, -camera.forwardZ).normalized();
 
 	// Calculate shading information for this frame. Create some helper structs to keep similar
 	// values together.
-	const ShadingInfo shadingInfo(this->skyPalette, daytimePercent, latitude, ambient,
-		this->fogDistance, chasmAnimPercent, nightLightsAreActive, isExterior, playerHasLight);
-	const FrameView frame(colorBuffer, this->depthBuffer.get(), this->width, this->height);
+	const ShadingInfo &shadingInfo = this->frameShadingInfo.emplace(this->skyPalette, daytimePercent,
+		latitude, ambient, this->fogDistance, chasmAnimPercent, nightLightsAreActive, isExterior,
+		playerHasLight);
+	const bool columnMajor = this->columnMajorFrameBuffer;
+	uint32_t *frameColorBuffer = columnMajor ? this->columnMajorColorBuffer.get() : colorBuffer;
+	const FrameView &frame = this->frameView.emplace(frameColorBuffer, this->depthBuffer.get(),
+		this->width, this->height, columnMajor);
+
+	// The sky is drawn into the sky cache so later frames can copy it while the view and time of
+	// day hold. It shares the frame's layout and depth buffer.
+	const bool reuseSky = this->skyCache.tryReuse(direction, fovY, daytimePercent, ambient, latitude,
+		this->distantObjects);
+	const FrameView &skyFrame = this->skyFrameView.emplace(this->skyCache.colors.get(),
+		this->depthBuffer.get(), this->width, this->height, columnMajor);
+
+	const bool pipelined = this->pipelinedRendering;
+
+	// Decide whether this frame only draws every other column.
+	if (this->checkerboardRendering)
+	{
+		const int parity = this->checkerboard.beginFrame(camera);
+		this->threadData.reconstruction.init(parity, this->checkerboard.sourceColumns.get(),
+			this->checkerboard.getPreviousHistory(), this->checkerboard.getCurrentHistory());
+	}
+	else
+	{
+		this->threadData.reconstruction.init(-1, nullptr, nullptr, nullptr);
+	}
 
 	// Projected Y range of the sky gradient.
 	double gradientProjYTop, gradientProjYBottom;
 	SoftwareRenderer::getSkyGradientProjectedYRange(camera, gradientProjYTop, gradientProjYBottom);
 
 	// Set all the render-thread-specific shared data for this frame.
-	this->threadData.init(this->renderThreads.getCount(), camera, shadingInfo, frame);
-	this->threadData.skyGradient.init(gradientProjYTop, gradientProjYBottom, this->skyGradientRowCache);
+	this->threadData.init(this->renderThreads.getCount(), this->renderThreadsWorkStealing, pipelined,
+		camera, shadingInfo, frame);
+	this->threadData.skyGradient.init(gradientProjYTop, gradientProjYBottom, this->skyGradientRowCache,
+		skyFrame, reuseSky);
 	this->threadData.distantSky.init(this->visDistantObjs, this->skyTextures);
-	this->threadData.voxels.init(chunkDistance, ceilingHeight, openDoors, fadingVoxels, chasmStates,
-		this->visibleLights, this->visLightLists, voxelGrid, this->voxelTextures,
-		this->chasmTextureGroups, this->occlusion);
-	this->threadData.flats.init(flatNormal, this->visibleFlats, this->visibleLights, this->visLightLists,
-		this->flatTextureGroups);
+	this->threadData.voxels.init(chunkDistance, ceilingHeight, this->rayPackets,
+		instGroup.getOpenDoors(), instGroup.getFadingVoxels(), instGroup.getChasmStates(),
+		this->visibleLights, this->visLightLists, defGroup,
+		this->voxelTextures, this->chasmTextureGroups, this->occlusion);
+	this->threadData.flats.init(this->frameFlatNormal, this->visibleFlats, this->visibleLights,
+		this->visLightLists, this->flatTextureGroups);
+	this->threadData.swizzle.init(columnMajor ? colorBuffer : nullptr);
+
+	if (this->renderThreadsWorkStealing)
+	{
+		this->threadData.voxels.scheduler.reset(this->width);
+		this->threadData.flats.scheduler.reset(this->width);
+	}
+
+	// Lambda for timing main thread work done alongside the render threads. The work also shows up
+	// as a profiler zone.
+	auto timeSeconds = [](const char *zoneName, auto &&function)
+	{
+		const Profiler::Zone zone(zoneName);
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		function();
+		const auto endTime = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double>(endTime - startTime).count();
+	};
+
+	// Lambdas for the main thread's visibility work, which the render threads wait on between
+	// phases.
+	auto updateDistantObjects = [&]()
+	{
+		// Not needed when the cached sky is reused.
+		this->visDistantObjsSeconds = timeSeconds("SoftwareRenderer::updateVisibleDistantObjects", [&]()
+		{
+			if (!reuseSky)
+			{
+				this->updateVisibleDistantObjects(shadingInfo, camera, frame);
+			}
+		});
+	};
+
+	auto updateFlatsAndLights = [&]()
+	{
+		// Refresh the visible flats. This should erase the old list, calculate a new list, and sort
+		// it by depth.
+		this->visFlatsSeconds = timeSeconds("SoftwareRenderer::updateVisibleFlats", [&]()
+		{
+			this->updateVisibleFlats(camera, shadingInfo, instGroup.getEntities());
+		});
+
+		this->potentiallyVisFlatCount = instGroup.getPotentiallyVisibleEntityCount();
+		this->culledChunkFlatCount = instGroup.getCulledChunkEntityCount();
+
+		// Refresh visible light lists used for shading voxels and entities efficiently.
+		this->visLightListsSeconds = timeSeconds("SoftwareRenderer::updateVisibleLightLists", [&]()
+		{
+			this->updateVisibleLightLists(camera, chunkDistance, ceilingHeight);
+		});
+	};
+
+	// Lambda for giving the render threads the go signal. All shared frame data above must be
+	// written before the epoch is incremented.
+	auto startRenderThreads = [this]()
+	{
+		for (std::atomic<int64_t> &phaseEnd : this->threadData.phaseEndNanoseconds)
+		{
+			phaseEnd.store(0, std::memory_order_relaxed);
+		}
+
+		this->threadData.frameStartTime = std::chrono::high_resolution_clock::now();
+		const RenderThreadData::Epoch frameEpoch = this->threadData.frameEpoch.fetch_add(1) + 1;
+		this->threadData.notifyParked();
+		return frameEpoch;
+	};
+
+	if (pipelined)
+	{
+		// Do all the visibility work up front so the render threads can go through every phase on
+		// their own, then return so the next game tick can run while they draw. The caller keeps
+		// the render groups unchanged until the frame is finished.
+		updateDistantObjects();
+		updateFlatsAndLights();
+		this->occlusion.fill(OcclusionData(0, this->height, this->occlusionSpans));
+		startRenderThreads();
+		this->frameInFlight = true;
+		return;
+	}
 
 	// Give the render threads the go signal. They can work on the sky and voxels while this thread
 	// does things like resetting occlusion and doing visible flat determination.
-	// - Note about locks: they must always be locked before wait(), and stay locked after wait().
-	std::unique_lock<std::mutex> lk(this->threadData.mutex);
-	this->threadData.go = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	const RenderThreadData::Epoch frameEpoch = startRenderThreads();
 
 	// Reset occlusion. Don't need to reset sky gradient row cache because it is written to before
 	// it is read.
-	this->occlusion.fill(OcclusionData(0, this->height));
+	this->occlusion.fill(OcclusionData(0, this->height, this->occlusionSpans));
 
 	// Refresh the visible distant objects.
-	this->updateVisibleDistantObjects(shadingInfo, camera, frame);
+	updateDistantObjects();
 
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
-	{
-		return this->threadData.skyGradient.threadsDone == this->threadData.totalThreads;
-	});
+	// Let the render threads know that they can start drawing distant objects once the sky
+	// gradient is done.
+	this->threadData.waitForThreads(this->threadData.skyGradient.threadsDone);
+	this->threadData.publishPhase(this->threadData.distantSky.readyEpoch, frameEpoch,
+		ProfilerData::PHASE_DISTANT_SKY);
 
-	// Keep the render threads from getting the go signal again before the next frame.
-	this->threadData.go = false;
+	updateFlatsAndLights();
 
-	// Let the render threads know that they can start drawing distant objects.
-	this->threadData.distantSky.doneVisTesting = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+	// Let the render threads know that they can start drawing voxels.
+	this->threadData.waitForThreads(this->threadData.distantSky.threadsDone);
+	this->threadData.publishPhase(this->threadData.voxels.readyEpoch, frameEpoch,
+		ProfilerData::PHASE_VOXELS);
 
-	// Refresh the visible flats. This should erase the old list, calculate a new list, and sort
-	// it by depth.
-	this->updateVisibleFlats(camera, shadingInfo, chunkDistance, ceilingHeight,
-		voxelGrid, entityManager, entityDefLibrary);
+	// Let the render threads know that they can start drawing flats.
+	this->threadData.waitForThreads(this->threadData.voxels.threadsDone);
+	this->threadData.publishPhase(this->threadData.flats.readyEpoch, frameEpoch,
+		ProfilerData::PHASE_FLATS);
 
-	// Refresh visible light lists used for shading voxels and entities efficiently.
-	this->updateVisibleLightLists(camera, chunkDistance, ceilingHeight, voxelGrid);
+	// Wait until render threads are done drawing flats.
+	this->threadData.waitForThreads(this->threadData.flats.threadsDone);
 
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	if (columnMajor)
 	{
-		return this->threadData.distantSky.threadsDone == this->threadData.totalThreads;
-	});
+		// Let the render threads convert the finished frame to the row-major output.
+		this->threadData.publishPhase(this->threadData.swizzle.readyEpoch, frameEpoch,
+			ProfilerData::PHASE_SWIZZLE);
+		this->threadData.waitForThreads(this->threadData.swizzle.threadsDone);
+	}
+}
 
-	// Let the render threads know that they can start drawing voxels.
-	this->threadData.voxels.doneLightVisTesting = true;
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+void SoftwareRenderer::finishFrame()
+{
+	if (!this->frameInFlight)
+	{
+		return;
+	}
+
+	ProfilerZone("SoftwareRenderer::finishFrame");
+
+	// The swizzle is the last phase when it runs.
+	const bool swizzling = this->threadData.swizzle.outputBuffer != nullptr;
+	this->threadData.waitForThreads(swizzling ? this->threadData.swizzle.threadsDone :
+		this->threadData.flats.threadsDone);
+	this->frameInFlight = false;
+}
+
+void SoftwareRenderer::init(const RenderInitSettings &settings)
+{
+	this->init(settings.getWidth(), settings.getHeight(), settings.getRenderThreadsMode(),
+		settings.getRenderThreadsWorkStealing(), settings.getColumnMajorFrameBuffer(),
+		settings.getCheckerboardRendering(), settings.getPipelinedRendering());
+
+	this->outputBuffer.init(settings.getWidth() * settings.getHeight());
+	this->outputBuffer.fill(0);
+}
+
+void SoftwareRenderer::shutdown()
+{
+	this->finishFrame();
+	this->resetRenderThreads();
+	this->endTextureBatch();
+	this->textureJobPool.shutdown();
+}
+
+VoxelTextureID SoftwareRenderer::createVoxelTexture(int width, int height)
+{
+	DebugAssert(MathUtils::isPowerOf2(width)); // Must be power-of-two dimensions for mipmaps.
+	DebugAssert(MathUtils::isPowerOf2(height));
+	this->finishFrame();
 
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	VoxelTextureID id;
+	if (this->freeVoxelTextureIDs.size() > 0)
 	{
-		return this->threadData.voxels.threadsDone == this->threadData.totalThreads;
-	});
+		id = this->freeVoxelTextureIDs.back();
+		this->freeVoxelTextureIDs.pop_back();
+	}
+	else
+	{
+		id = static_cast<VoxelTextureID>(this->voxelTextures.size());
+		this->voxelTextures.emplace_back(VoxelTexture());
+	}
 
-	// Let the render threads know that they can start drawing flats.
-	this->threadData.flats.doneSorting = true;
+	VoxelTexture &texture = this->voxelTextures[id];
+	texture.texels = std::vector<VoxelTexel>(width * height, VoxelTexel());
+	texture.lightTexels.clear();
+	texture.mipLevels.clear();
+	texture.width = width;
+	texture.height = height;
+	return id;
+}
 
-	lk.unlock();
-	this->threadData.condVar.notify_all();
+SpriteTextureID SoftwareRenderer::createSpriteTexture(int width, int height)
+{
+	this->finishFrame();
 
-	// Wait until render threads are done drawing flats.
-	lk.lock();
-	this->threadData.condVar.wait(lk, [this]()
+	SpriteTextureID id;
+	if (this->freeSpriteTextureIDs.size() > 0)
 	{
-		return this->threadData.flats.threadsDone == this->threadData.totalThreads;
-	});
+		id = this->freeSpriteTextureIDs.back();
+		this->freeSpriteTextureIDs.pop_back();
+	}
+	else
+	{
+		id = static_cast<SpriteTextureID>(this->spriteTextures.size());
+		this->spriteTextures.emplace_back(FlatTexture());
+	}
+
+	FlatTexture &texture = this->spriteTextures[id];
+	texture.texels = std::vector<FlatTexel>(width * height, FlatTexel());
+	texture.mipLevels.clear();
+	texture.width = width;
+	texture.height = height;
+	return id;
+}
+
+void SoftwareRenderer::freeVoxelTexture(VoxelTextureID textureID)
+{
+	// Textures set with setVoxelTexture() aren't owned by the renderer interface.
+	DebugAssert(textureID >= SoftwareRenderer::DEFAULT_VOXEL_TEXTURE_COUNT);
+	DebugAssert(textureID < static_cast<int>(this->voxelTextures.size()));
+	this->finishFrame();
+
+	VoxelTexture &texture = this->voxelTextures[textureID];
+	texture.texels.clear();
+	texture.lightTexels.clear();
+	texture.mipLevels.clear();
+	texture.width = 0;
+	texture.height = 0;
+	this->freeVoxelTextureIDs.push_back(textureID);
+}
+
+void SoftwareRenderer::freeSpriteTexture(SpriteTextureID textureID)
+{
+	DebugAssert(textureID >= 0);
+	DebugAssert(textureID < static_cast<int>(this->spriteTextures.size()));
+	this->finishFrame();
+
+	FlatTexture &texture = this->spriteTextures[textureID];
+	texture.texels.clear();
+	texture.mipLevels.clear();
+	texture.width = 0;
+	texture.height = 0;
+	this->freeSpriteTextureIDs.push_back(textureID);
+}
+
+void SoftwareRenderer::submitFrame(const RenderDefinitionGroup &defGroup,
+	const RenderInstanceGroup &instGroup, const RenderCamera &camera,
+	const RenderFrameSettings &settings)
+{
+	ProfilerZone("SoftwareRenderer::submitFrame");
+	DebugAssert(this->outputBuffer.getCount() > 0);
+
+	this->render(defGroup, instGroup, camera, settings, this->outputBuffer.get());
+}
+
+void SoftwareRenderer::present()
+{
+	this->finishFrame();
+}
+
+const uint32_t *SoftwareRenderer::getOutputBuffer() const
+{
+	return this->outputBuffer.get();
 }
@@ -3,13 +3,19 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "RenderDefinitionGroup.h"
+#include "RenderInstanceGroup.h"
+#include "RendererInterface.h"
 #include "../Entities/EntityManager.h"
 #include "../Game/Options.h"
 #include "../Math/MathUtils.h"
@@ -26,38 +32,115 @@
 #include "components/utilities/Buffer2D.h"
 #include "components/utilities/BufferView.h"
 #include "components/utilities/BufferView2D.h"
+#include "components/utilities/JobPool.h"
 
 // This class runs the CPU-based 3D rendering for the application.
 
-class Entity;
-class VoxelGrid;
-
 enum class VoxelFacing2D;
 
-class SoftwareRenderer
+class SoftwareRenderer : public RendererInterface
 {
 public:
+	// Precision of per-pixel shading math (fog, light accumulation, texel colors and texture
+	// coordinates). Ray casting, projection and the depth buffer always use doubles. Building
+	// with HAVE_FLOAT_SHADING selects single precision, which doubles the SIMD lane count.
+#if defined(HAVE_FLOAT_SHADING)
+	using ShadingReal = float;
+#else
+	using ShadingReal = double;
+#endif
+
 	// Profiling info gathered from internal renderer state.
 	struct ProfilerData
 	{
+		// Distribution of render thread wait times for one phase. Bucket 0 counts waits under
+		// one microsecond, and each bucket after that doubles the upper bound.
+		struct WaitHistogram
+		{
+			static constexpr int BUCKET_COUNT = 16;
+
+			std::array<int, BUCKET_COUNT> buckets;
+			double totalSeconds;
+			int sampleCount;
+
+			WaitHistogram();
+
+			// Gets the inclusive lower bound of a bucket in microseconds.
+			static int getBucketMinMicroseconds(int bucketIndex);
+
+			double getAverageMicroseconds() const;
+		};
+
+		// Render thread phases in the order they run each frame.
+		static constexpr int PHASE_SKY_GRADIENT = 0;
+		static constexpr int PHASE_DISTANT_SKY = 1;
+		static constexpr int PHASE_VOXELS = 2;
+		static constexpr int PHASE_FLATS = 3;
+		static constexpr int PHASE_SWIZZLE = 4; // Only with a column-major frame buffer.
+		static constexpr int PHASE_COUNT = 5;
+
+		// Time one render thread spent drawing and waiting during the most recent frame.
+		struct ThreadTiming
+		{
+			double busySeconds, idleSeconds;
+			int tilesStolen; // Only non-zero with work stealing.
+
+			ThreadTiming();
+		};
+
 		int width, height;
 		int potentiallyVisFlatCount, visFlatCount, visLightCount;
+		int culledChunkFlatCount; // Entities skipped by chunk culling except for light checks.
+		bool checkerboarded; // Whether only every other column was drawn.
+		int flatSortShifts; // Insertion sort moves for visible flats, or -1 after a full sort.
+
+		// Time render threads spent waiting to start each phase since the threads were started.
+		std::array<WaitHistogram, PHASE_COUNT> phaseWaits;
+
+		// Wall-clock time of each phase in the most recent frame, from when render threads were
+		// allowed to start it until the last one finished it.
+		std::array<double, PHASE_COUNT> phaseSeconds;
+
+		// Main thread visibility work in the most recent frame (overlaps with render threads).
+		double visDistantObjsSeconds, visFlatsSeconds, visLightListsSeconds;
+
+		// Whether the most recent frame copied the cached sky instead of drawing it.
+		bool skyReused;
+
+		// Lights inserted into visible light lists and light lists changed in the most recent frame.
+		int lightsBinned, lightCellsTouched;
+
+		// Voxel pixels shaded in the most recent frame per pixel in the frame.
+		double voxelOverdraw;
+
+		// Bytes of texels in every loaded texture, including mip levels.
+		size_t textureBytes;
+
+		// One entry per render thread.
+		std::vector<ThreadTiming> threadTimings;
 	};
 private:
+	// Texels keep 8-bit color channels instead of doubles so a whole texture fits in a few
+	// kilobytes of cache while drawing columns. Channels are converted to the [0, 1] range through
+	// a 256-entry lookup table when sampled.
 	struct VoxelTexel
 	{
-		double r, g, b, emission;
-		bool transparent; // Only supports alpha testing, not alpha blending.
+		static constexpr uint8_t FLAG_TRANSPARENT = 1 << 0; // Only supports alpha testing, not alpha blending.
+		static constexpr uint8_t FLAG_EMISSIVE = 1 << 1;
+
+		uint8_t r, g, b;
+		uint8_t flags;
 
-		void init(double r, double g, double b, double emission, bool transparent);
+		void init(uint8_t r, uint8_t g, uint8_t b, bool emissive, bool transparent);
 	};
 
 	struct FlatTexel
 	{
-		double r, g, b, a;
+		uint8_t r, g, b;
+		uint8_t a; // In the original game's 1/14 light level steps so ghost texels stay exact.
 		uint8_t reflection; // Puddle texels have two reflection states.
 
-		void init(double r, double g, double b, double a, uint8_t reflection);
+		void init(uint8_t r, uint8_t g, uint8_t b, uint8_t a, uint8_t reflection);
 	};
 
 	// For distant sky objects (mountains, clouds, etc.). Although most distant objects
@@ -65,16 +148,17 @@ private:
 	// of transparency.
 	struct SkyTexel
 	{
-		double r, g, b, a;
+		uint8_t r, g, b;
+		uint8_t a; // In 1/14 steps like flat texels.
 
-		void init(double r, double g, double b, double a);
+		void init(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 	};
 
 	struct ChasmTexel
 	{
-		double r, g, b;
+		uint8_t r, g, b;
 
-		void init(double r, double g, double b);
+		void init(uint8_t r, uint8_t g, uint8_t b);
 	};
 
 	struct VoxelTexture
@@ -84,10 +168,24 @@ private:
 		// @todo: replace lightTexels with two VoxelTextures: one for day, one for night.
 		int width, height;
 
+		// Half-size copies of the texture down to 1x1, so distant columns sample a few kilobytes
+		// instead of striding across the whole texel array. Level 0 is the texture itself.
+		std::vector<VoxelTexture> mipLevels;
+
 		VoxelTexture();
 
 		void init(int width, int height, const uint8_t *srcTexels, const Palette &palette);
 		void setLightTexelsActive(bool active);
+
+		// Rebuilds the mip levels from the texels. Each mip texel is the average of the opaque
+		// texels under it, and is transparent if at least half of them are transparent.
+		void generateMipLevels();
+
+		// Gets the mip level for sampling with the given number of texels per screen pixel.
+		const VoxelTexture &getMipLevel(double texelsPerPixel) const;
+
+		// Gets the bytes used by the texels, light texels and mip levels.
+		size_t getTexelByteCount() const;
 	};
 
 	struct FlatTexture
@@ -95,10 +193,18 @@ private:
 		std::vector<FlatTexel> texels;
 		int width, height;
 
+		// Half-size copies of the texture like voxel textures, except each mip texel is a copy of
+		// one texel under it since ghost and puddle texels can't be averaged.
+		std::vector<FlatTexture> mipLevels;
+
 		FlatTexture();
 
 		void init(int width, int height, const uint8_t *srcTexels, bool flipped, bool reflective,
 			const Palette &palette);
+
+		void generateMipLevels();
+		const FlatTexture &getMipLevel(double texelsPerPixel) const;
+		size_t getTexelByteCount() const;
 	};
 
 	struct SkyTexture
@@ -196,17 +302,33 @@ private:
 	// casting loop can return early.
 	struct OcclusionData
 	{
-		// Min is inclusive, max is exclusive.
+		// Max number of covered spans kept inside the open window. When full, the smallest
+		// span is forgotten, which only means less gets rejected.
+		static constexpr int MAX_SPANS = 4;
+
+		// Open window of the column. Min is inclusive, max is exclusive.
 		int yMin, yMax;
 
-		OcclusionData(int yMin, int yMax);
+		// Opaque ranges drawn inside the window that don't touch it or each other, sorted from
+		// top to bottom. A span that grows to touch the window edge shrinks the window instead.
+		std::array<int, MAX_SPANS> spanStarts, spanEnds;
+		int spanCount;
+
+		int drawnPixels; // Pixels let through by clipRange() this frame.
+		bool spansEnabled; // Whether covered spans inside the window are tracked.
+
+		OcclusionData(int yMin, int yMax, bool spansEnabled);
 		OcclusionData();
 
+		// Returns whether every pixel in the column is covered.
+		bool isFull() const;
+
 		// Modifies the given start and end pixel coordinates based on the current occlusion.
-		// This will either keep (yEnd - yStart) the same or less than it was before.
-		void clipRange(int *yStart, int *yEnd) const;
+		// This will either keep (yEnd - yStart) the same or less than it was before. Ranges
+		// entirely inside a covered span become empty.
+		void clipRange(int *yStart, int *yEnd);
 
-		// Updates the occlusion range given some range of opaque pixels.
+		// Updates the occlusion given some range of opaque pixels.
 		void update(int yStart, int yEnd);
 	};
 
@@ -245,6 +367,10 @@ private:
 		// Ambient light percent used with distant sky objects.
 		double distantAmbient;
 
+		// Texel channel values with distant ambient shading already applied, indexed by 8-bit
+		// channel value.
+		std::array<double, 256> distantShadedChannels;
+
 		// Distance at which fog is maximum.
 		double fogDistance;
 
@@ -275,8 +401,65 @@ private:
 		double *depthBuffer;
 		int width, height;
 		double widthReal, heightReal;
+		int xStride, yStride; // Buffer index distance between neighboring pixels.
 
-		FrameView(uint32_t *colorBuffer, double *depthBuffer, int width, int height);
+		FrameView(uint32_t *colorBuffer, double *depthBuffer, int width, int height,
+			bool columnMajor);
+
+		// Gets the color and depth buffer index of a pixel. Column-major frames keep each screen
+		// column contiguous so drawing a column walks memory linearly.
+		int getIndex(int x, int y) const;
+	};
+
+	// Rays of neighboring columns stepped through the voxel grid in lockstep, a batch of steps
+	// at a time. The delta distance sums, cells and Z distances of the lanes are advanced with
+	// SIMD, then each lane's column is drawn from the voxels it entered before the next batch.
+	struct RayPacket
+	{
+		static constexpr int WIDTH = 8; // Columns per packet.
+		static constexpr int BATCH_STEPS = 8; // Steps per lane between drawing.
+
+		// A voxel entered by a ray, and the distance to its near face.
+		struct Step
+		{
+			SNInt cellX;
+			WEInt cellZ;
+			VoxelFacing2D facing;
+			double zDistance;
+			bool isValid; // Whether this and every voxel before it are inside the grid.
+		};
+
+		// Per-lane DDA state. Cells are kept as doubles so they step in the same registers.
+		alignas(64) double dirX[WIDTH];
+		alignas(64) double dirZ[WIDTH];
+		alignas(64) double deltaDistX[WIDTH];
+		alignas(64) double deltaDistZ[WIDTH];
+		alignas(64) double deltaDistSumX[WIDTH];
+		alignas(64) double deltaDistSumZ[WIDTH];
+		alignas(64) double stepX[WIDTH];
+		alignas(64) double stepZ[WIDTH];
+		alignas(64) double halfOneMinusStepX[WIDTH];
+		alignas(64) double halfOneMinusStepZ[WIDTH];
+		alignas(64) double cellX[WIDTH];
+		alignas(64) double cellZ[WIDTH];
+
+		// Steps of the current batch for each lane. The first is the last step of the previous
+		// batch, which hasn't been drawn yet.
+		std::array<std::array<Step, BATCH_STEPS + 1>, WIDTH> steps;
+
+		std::array<int, WIDTH> columns; // Screen X of each lane.
+		int laneCount; // Lanes with a column, the rest only follow along.
+		bool eyeVoxelIsValid; // Whether the camera's voxel is inside the grid.
+
+		// Sets up rays for up to WIDTH columns starting at the given X, with columns spaced by
+		// the stride.
+		void init(int startX, int endX, int stride, const Camera &camera, SNInt gridWidth,
+			int gridHeight, WEInt gridDepth, const FrameView &frame);
+
+		// Advances every lane by the given number of steps, writing them to the steps starting
+		// at the given index.
+		void trace(int firstIndex, int stepCount, const Camera &camera, SNInt gridWidth,
+			WEInt gridDepth);
 	};
 
 	// Each renderable entity ID has a set of animation state mappings to groups of texture
@@ -298,6 +481,9 @@ private:
 		// points into texture list.
 		const FlatTexture &getTexture(int stateID, int angleID, int textureID) const;
 
+		// Gets the bytes used by every texture in the group.
+		size_t getTexelByteCount() const;
+
 		// Initializes internal buffers to fit each discrete frame of the given entity animation.
 		// Basically "I want to allocate space for this animation, and textures will come next".
 		// Each keyframe's texture should be populated immediately afterwards by the caller.
@@ -309,6 +495,9 @@ private:
 		// determined by a trueColor bool.
 		void setTexture(int stateID, int angleID, int textureID, bool flipped,
 			const uint8_t *srcTexels, int width, int height, bool reflective, const Palette &palette);
+
+		// Replaces the given texture with one that was already converted.
+		void setTexture(int stateID, int angleID, int textureID, FlatTexture &&texture);
 	};
 
 	// Each flat texture group is indexed by the entity render ID.
@@ -339,6 +528,8 @@ private:
 		int animStateID;
 		int animAngleID;
 		int animTextureID;
+
+		EntityID entityID; // For seeding next frame's sort.
 	};
 
 	// Pairs together a distant sky object with its render texture index. If it's an animation,
@@ -400,6 +591,76 @@ private:
 		void clear();
 	};
 
+	// Sky gradient and distant objects drawn by an earlier frame. The sky only depends on the
+	// view direction, time of day, and distant sky, so while those stay the same, the sky phases
+	// copy this into the frame instead of redrawing it.
+	struct SkyCache
+	{
+		// Largest change in daytime percent before the sky is redrawn. About 15 game seconds,
+		// which keeps the sun's movement between redraws under a pixel at usual resolutions.
+		static constexpr double DAYTIME_PERCENT_STEP = 1.0 / (24.0 * 60.0 * 4.0);
+
+		// Largest change in ambient light before the sky is redrawn (one 8-bit color step).
+		static constexpr double AMBIENT_STEP = 1.0 / 255.0;
+
+		Buffer<uint32_t> colors; // Same layout as the frame.
+		std::vector<int> animLandIndices; // Animation frame of each animated land when drawn.
+		std::vector<double> moonPhasePercents;
+		Double3 direction;
+		double fovY, daytimePercent, ambient, latitude;
+		bool isValid;
+
+		SkyCache();
+
+		void init(int width, int height);
+
+		// Returns whether the cached sky can be reused for a frame with the given values. If not,
+		// records them for the sky about to be drawn into the cache.
+		bool tryReuse(const Double3 &direction, double fovY, double daytimePercent, double ambient,
+			double latitude, const DistantObjects &distantObjects);
+
+		// Forces the sky to be redrawn next frame.
+		void invalidate();
+	};
+
+	// Checkerboard rendering draws every other screen column each frame, alternating between
+	// even and odd columns. Skipped columns are reprojected from the previous finished frame by
+	// matching ray directions, so turning the camera doesn't smear them. Frames where the camera
+	// changed too much for that to hold up draw every column instead.
+	struct Checkerboard
+	{
+		// Largest camera changes between frames that still reproject skipped columns.
+		static constexpr double MAX_TURN_DEGREES = 4.0;
+		static constexpr double MAX_Y_SHEAR_PIXELS = 0.50;
+		static constexpr double MAX_EYE_DISTANCE = 0.25;
+
+		std::array<Buffer<uint32_t>, 2> historyBuffers; // Finished frames with the frame's layout.
+		Buffer<int> sourceColumns; // Previous frame's column with each column's ray direction, or -1.
+		Double3 eye; // Previous frame's camera.
+		NewDouble2 forward, forwardZoomed, rightAspected;
+		double yShear;
+		int height;
+		int historyIndex; // History buffer written this frame. The other holds the previous frame.
+		int parity; // Columns drawn this frame have (x % 2) == parity, or -1 for every column.
+		uint32_t frameCount;
+		bool isValid; // Whether the previous frame's history can be read.
+
+		Checkerboard();
+
+		// Allocates history for the given frame size, or frees it when zero.
+		void init(int width, int height);
+
+		// Picks the columns to draw this frame and where skipped columns come from in the
+		// previous frame. Returns the parity of drawn columns, or -1 to draw every column.
+		int beginFrame(const Camera &camera);
+
+		const uint32_t *getPreviousHistory() const;
+		uint32_t *getCurrentHistory();
+
+		// Forces the next frame to draw every column.
+		void invalidate();
+	};
+
 	// Instance of an entity light in the world.
 	struct VisibleLight
 	{
@@ -434,29 +695,144 @@ private:
 		void add(LightID lightID);
 		void clear();
 
+		// Removes light IDs at or above the given one, keeping the rest in order.
+		void removeFrom(LightID firstRemovedID);
+
 		// Shading optimization, only useful when the light intensity cap is on for early-out.
 		void sortByNearest(const Double3 &point, const BufferView<const VisibleLight> &visLights);
 	};
 
-	// Data owned by the main thread that is referenced by render threads.
+	// Bookkeeping for keeping the visible light lists between frames. Static lights (street lamps,
+	// braziers, etc.) are binned into the lists only when the potentially visible chunks move or
+	// the static lights in them change. Dynamic lights (the player, moving entities) are taken out
+	// of the lists they touched and re-binned every frame.
+	struct LightGrid
+	{
+		std::vector<VisibleLight> staticLights; // Binned static lights. Light IDs are their indices.
+		std::vector<VisibleLight> frameStaticLights; // Static lights gathered for the current frame.
+		std::vector<int> dynamicCellIndices; // Lists holding the previous frame's dynamic lights.
+		NewInt2 originVoxel; // Closest-to-origin voxel of the potentially visible chunks.
+		double ceilingHeight; // Used for sorting lights by distance.
+		int lightsBinned, cellsTouched; // Work done in the most recent frame.
+		bool isValid;
+
+		LightGrid();
+
+		// Forces static lights to be re-binned next frame.
+		void invalidate();
+	};
+
+	// Depth order of visible flats from the previous frame. Flats barely move relative to each
+	// other between frames, so starting from the old order leaves an almost-sorted list that an
+	// insertion sort finishes in close to linear time.
+	struct FlatSortOrder
+	{
+		// Falls back to a full sort when more than this fraction of flats weren't in last
+		// frame's order (i.e., after a teleport or level change).
+		static constexpr double MAX_NEW_FLAT_PERCENT = 0.25;
+
+		std::vector<int> entityRanks; // Last frame's sorted index of each entity ID, or -1.
+		std::vector<EntityID> sortedEntityIDs; // Last frame's visible flats in sorted order.
+		std::vector<int> rankSlots; // Scratch, visible flat index for each old rank.
+		std::vector<int> flatRanks; // Scratch, old rank of each visible flat, or -1.
+		std::vector<VisibleFlat> seededFlats; // Scratch, visible flats in last frame's order.
+		int shifts; // Insertion sort moves in the most recent frame, or -1 if it fell back to a full sort.
+
+		FlatSortOrder();
+
+		// Forgets the previous order.
+		void clear();
+	};
+
+	// Texture conversions queued on the texture job pool while a texture batch is open. Each
+	// upload converts into its own texture, so nothing a frame reads from changes until all of
+	// them are moved into place when the batch ends.
+	struct TextureUploads
+	{
+		struct VoxelUpload
+		{
+			int id;
+			std::vector<uint8_t> srcTexels;
+			std::shared_ptr<const Palette> palette;
+			VoxelTexture texture;
+		};
+
+		struct FlatUpload
+		{
+			EntityRenderID entityRenderID;
+			int stateID, angleID, textureID;
+			int width, height;
+			bool flipped, reflective;
+			std::vector<uint8_t> srcTexels;
+			std::shared_ptr<const Palette> palette;
+			FlatTexture texture;
+		};
+
+		// Heap-allocated so jobs can keep pointers while more uploads are queued.
+		std::vector<std::unique_ptr<VoxelUpload>> voxelUploads;
+		std::vector<std::unique_ptr<FlatUpload>> flatUploads;
+		JobPool::Batch jobBatch; // Conversion jobs of the open batch.
+		bool batchOpen;
+
+		TextureUploads();
+
+		void clear();
+	};
+
+	// Data owned by the main thread that is referenced by render threads. Phases are sequenced with
+	// epoch counters: the main thread bumps the frame epoch to start a frame and copies it into each
+	// phase's ready epoch once that phase's inputs are prepared. Render threads spin briefly on
+	// these atomics before parking, so short gaps between phases never touch a lock.
 	struct RenderThreadData
 	{
+		using Epoch = uint32_t;
+
+		// Column tile range owned by one render thread. The owner pops tiles from the front and
+		// idle threads steal from the back. Both ends share one word so every update is a single
+		// compare-and-swap.
+		struct alignas(64) ColumnTileQueue
+		{
+			std::atomic<uint64_t> range; // Begin tile index in the low 32 bits, end in the high 32.
+		};
+
+		// Work-stealing distribution of screen column tiles between render threads for one phase.
+		struct ColumnScheduler
+		{
+			Buffer<ColumnTileQueue> queues; // One per render thread.
+			int tileWidth, tileCount, frameWidth;
+
+			ColumnScheduler();
+
+			void init(int threadCount, int tileWidth);
+
+			// Splits the frame into tiles and deals them out as contiguous blocks so each thread
+			// starts with neighboring columns. Only called while no render thread is in this phase.
+			void reset(int frameWidth);
+
+			// Gets the column range of the next tile for the given thread, stealing from other threads
+			// once its own queue is empty. Returns false when no tiles are left to take.
+			bool tryGetTile(int threadIndex, int *outStartX, int *outEndX, bool *outWasStolen);
+		};
+
 		struct SkyGradient
 		{
-			int threadsDone;
+			std::atomic<int> threadsDone;
 			Buffer<Double3> *rowCache;
 			double projectedYTop, projectedYBottom; // Projected Y range of sky gradient.
 			std::atomic<bool> shouldDrawStars; // True if the sky is dark enough.
+			const FrameView *skyFrame; // Sky cache with the frame's layout and depth buffer.
+			bool reuseSky; // Whether the sky cache is copied instead of redrawn.
 
-			void init(double projectedYTop, double projectedYBottom, Buffer<Double3> &rowCache);
+			void init(double projectedYTop, double projectedYBottom, Buffer<Double3> &rowCache,
+				const FrameView &skyFrame, bool reuseSky);
 		};
 
 		struct DistantSky
 		{
-			int threadsDone;
+			std::atomic<int> threadsDone;
 			const VisDistantObjects *visDistantObjs;
 			const std::vector<SkyTexture> *skyTextures;
-			bool doneVisTesting; // True when render threads can start rendering distant sky.
+			std::atomic<Epoch> readyEpoch; // Matches the frame epoch when vis testing is done.
 
 			void init(const VisDistantObjects &visDistantObjs,
 				const std::vector<SkyTexture> &skyTextures);
@@ -464,39 +840,42 @@ private:
 
 		struct Voxels
 		{
-			int threadsDone;
+			std::atomic<int> threadsDone;
 			const std::vector<LevelData::DoorState> *openDoors;
 			const std::vector<LevelData::FadeState> *fadingVoxels;
 			const LevelData::ChasmStates *chasmStates;
 			const std::vector<VisibleLight> *visLights;
 			const Buffer2D<VisibleLightList> *visLightLists;
-			const VoxelGrid *voxelGrid;
+			const RenderDefinitionGroup *defGroup;
 			const std::vector<VoxelTexture> *voxelTextures;
 			const ChasmTextureGroups *chasmTextureGroups;
 			Buffer<OcclusionData> *occlusion;
+			ColumnScheduler scheduler; // Only used with work stealing.
 			double ceilingHeight;
 			int chunkDistance;
-			bool doneLightVisTesting; // True when render threads can start rendering voxels.
+			bool rayPackets;
+			std::atomic<Epoch> readyEpoch; // Matches the frame epoch when light vis testing is done.
 
-			void init(int chunkDistance, double ceilingHeight,
+			void init(int chunkDistance, double ceilingHeight, bool rayPackets,
 				const std::vector<LevelData::DoorState> &openDoors,
 				const std::vector<LevelData::FadeState> &fadingVoxels,
 				const LevelData::ChasmStates &chasmStates,
 				const std::vector<VisibleLight> &visLights,
-				const Buffer2D<VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+				const Buffer2D<VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 				const std::vector<VoxelTexture> &voxelTextures,
 				const ChasmTextureGroups &chasmTextureGroups, Buffer<OcclusionData> &occlusion);
 		};
 
 		struct Flats
 		{
-			int threadsDone;
+			std::atomic<int> threadsDone;
 			const Double3 *flatNormal;
 			const std::vector<VisibleFlat> *visibleFlats;
 			const std::vector<VisibleLight> *visLights;
 			const Buffer2D<VisibleLightList> *visLightLists;
 			const FlatTextureGroups *flatTextureGroups;
-			bool doneSorting; // True when render threads can start rendering flats.
+			ColumnScheduler scheduler; // Only used with work stealing.
+			std::atomic<Epoch> readyEpoch; // Matches the frame epoch when flat sorting is done.
 
 			void init(const Double3 &flatNormal, const std::vector<VisibleFlat> &visibleFlats,
 				const std::vector<VisibleLight> &visLights,
@@ -504,24 +883,98 @@ private:
 				const FlatTextureGroups &flatTextureGroups);
 		};
 
+		// Fills skipped checkerboard columns once their flats are done, and saves each finished
+		// column for the next frame.
+		struct Reconstruction
+		{
+			const int *sourceColumns;
+			const uint32_t *previousHistory;
+			uint32_t *currentHistory; // Null when checkerboard rendering is off.
+			int parity; // Columns drawn this frame, or -1 for every column.
+
+			void init(int parity, const int *sourceColumns, const uint32_t *previousHistory,
+				uint32_t *currentHistory);
+		};
+
+		// Copies a column-major frame to the row-major output buffer after all drawing is done.
+		struct Swizzle
+		{
+			std::atomic<int> threadsDone;
+			uint32_t *outputBuffer; // Null when the frame is already row-major.
+			std::atomic<Epoch> readyEpoch; // Matches the frame epoch when flats are done.
+
+			void init(uint32_t *outputBuffer);
+		};
+
+		// Lock-free accumulator for one phase's wait histogram, written by all render threads.
+		struct WaitStats
+		{
+			std::array<std::atomic<int>, ProfilerData::WaitHistogram::BUCKET_COUNT> buckets;
+			std::atomic<int64_t> totalNanoseconds;
+			std::atomic<int> sampleCount;
+
+			WaitStats();
+
+			void add(int64_t nanoseconds);
+			void writeTo(ProfilerData::WaitHistogram *outHistogram) const;
+			void clear();
+		};
+
 		SkyGradient skyGradient;
 		DistantSky distantSky;
 		Voxels voxels;
 		Flats flats;
+		Reconstruction reconstruction;
+		Swizzle swizzle;
 		const Camera *camera;
 		const ShadingInfo *shadingInfo;
 		const FrameView *frame;
 
-		std::condition_variable condVar;
-		std::mutex mutex;
+		// Slow path for waiters that exhausted their spin budget. Signalers only lock the mutex
+		// when at least one thread is parked.
+		std::condition_variable parkCondVar;
+		std::mutex parkMutex;
+		std::atomic<int> parkedCount;
+
+		std::array<WaitStats, ProfilerData::PHASE_COUNT> phaseWaits;
+		Buffer<ProfilerData::ThreadTiming> threadTimings; // Each render thread writes its own entry.
+		std::chrono::high_resolution_clock::time_point frameStartTime; // Written before each go signal.
+
+		// Nanoseconds since the frame started. Start times are written by the main thread when it
+		// publishes a phase, and end times by each render thread as it finishes the phase.
+		std::array<int64_t, ProfilerData::PHASE_COUNT> phaseStartNanoseconds;
+		std::array<std::atomic<int64_t>, ProfilerData::PHASE_COUNT> phaseEndNanoseconds;
 		int totalThreads;
-		bool go; // Initial go signal to start work each frame.
-		bool isDestructing; // Helps shut down threads in the renderer destructor.
+		bool workStealing; // Whether voxel and flat columns are handed out by the column schedulers.
+		bool selfPublishing; // Whether the last thread to finish a phase publishes the next one.
+		std::atomic<Epoch> frameEpoch; // Incremented once per frame as the go signal.
+		std::atomic<bool> isDestructing; // Helps shut down threads in the renderer destructor.
 
 		RenderThreadData();
 
-		void init(int totalThreads, const Camera &camera, const ShadingInfo &shadingInfo,
-			const FrameView &frame);
+		void init(int totalThreads, bool workStealing, bool selfPublishing, const Camera &camera,
+			const ShadingInfo &shadingInfo, const FrameView &frame);
+
+		// Spins, then yields, then parks until the predicate returns true. Returns the time spent
+		// waiting in nanoseconds.
+		template <typename Predicate>
+		int64_t waitUntil(const Predicate &predicate);
+
+		// Wakes any parked threads so they re-check their predicates. Must be called after storing
+		// a new value in any atomic that waiters depend on.
+		void notifyParked();
+
+		// Gets the time since the current frame's go signal.
+		int64_t getFrameNanoseconds() const;
+
+		// Extends a phase's end time to now if this thread is the latest to finish it so far.
+		void recordPhaseEnd(int phaseIndex);
+
+		// Tells render threads that a phase's inputs are ready this frame.
+		void publishPhase(std::atomic<Epoch> &readyEpoch, Epoch frameEpoch, int phaseIndex);
+
+		// Waits until all render threads have finished a phase.
+		void waitForThreads(const std::atomic<int> &threadsDone);
 	};
 
 	// Clipping planes for Z coordinates.
@@ -546,23 +999,46 @@ private:
 
 	Buffer2D<double> depthBuffer;
 	Buffer<OcclusionData> occlusion; // 1D buffer, min and max Y for each pixel column.
-	std::vector<const Entity*> potentiallyVisibleFlats; // Updated every frame.
 	std::vector<VisibleFlat> visibleFlats; // Flats to be drawn.
+	FlatSortOrder flatSortOrder; // Seeds the depth sort of visible flats.
 	DistantObjects distantObjects; // Distant sky objects (mountains, clouds, etc.).
 	VisDistantObjects visDistantObjs; // Visible distant sky objects.
 	Buffer2D<VisibleLightList> visLightLists; // Potentially-visible voxel column references to visible lights.
-	std::vector<VisibleLight> visibleLights; // Lights that contribute to the current frame.
+	LightGrid lightGrid; // Keeps static lights binned in the visible light lists between frames.
+	std::vector<VisibleLight> visibleLights; // Static lights, then dynamic lights for the current frame.
 	std::vector<VoxelTexture> voxelTextures; // Max 64 voxel textures in original engine.
 	FlatTextureGroups flatTextureGroups; // Entity anim textures accessed by entity render ID.
 	ChasmTextureGroups chasmTextureGroups; // Mappings from chasm ID to textures.
 	std::vector<SkyTexture> skyTextures; // Distant object textures. Size is managed internally.
 	std::vector<Double3> skyPalette; // Colors for each time of day.
 	Buffer<Double3> skyGradientRowCache; // Contains row colors of most recent sky gradient.
+	SkyCache skyCache; // Most recently drawn sky, reused while the view and time of day hold.
+	Checkerboard checkerboard; // Previous frames for checkerboard rendering, only allocated while in use.
+	Buffer<uint32_t> columnMajorColorBuffer; // Drawn to instead of the output when column-major.
+	std::vector<FlatTexture> spriteTextures; // Allocated through the renderer interface.
+	std::vector<VoxelTextureID> freeVoxelTextureIDs; // Freed interface textures available for reuse.
+	std::vector<SpriteTextureID> freeSpriteTextureIDs;
+	Buffer<uint32_t> outputBuffer; // Drawn to by submitFrame(), only allocated through the renderer interface.
+	std::optional<Camera> frameCamera; // Per-frame values read by render threads.
+	std::optional<ShadingInfo> frameShadingInfo;
+	std::optional<FrameView> frameView, skyFrameView;
+	Double3 frameFlatNormal;
 	Buffer<std::thread> renderThreads; // Threads used for rendering the world.
+	JobPool textureJobPool; // Converts batched textures in the background.
+	TextureUploads textureUploads; // Conversions in the current texture batch.
 	RenderThreadData threadData; // Managed by main thread, used by render threads.
 	double fogDistance; // Distance at which fog is maximum.
 	int width, height; // Dimensions of frame buffer.
 	int renderThreadsMode; // Determines number of threads to use for rendering.
+	bool renderThreadsWorkStealing; // Whether render threads balance columns with work stealing.
+	bool columnMajorFrameBuffer; // Whether columns are drawn to a column-major buffer first.
+	bool checkerboardRendering; // Whether every other column is reprojected from the previous frame.
+	bool pipelinedRendering; // Whether render() returns while the render threads are still drawing.
+	bool frameInFlight; // Whether a pipelined frame hasn't been waited on yet.
+	bool occlusionSpans; // Whether opaque spans inside each column's open window are tracked.
+	bool rayPackets; // Whether neighboring columns' rays are stepped together.
+	double visDistantObjsSeconds, visFlatsSeconds, visLightListsSeconds; // Most recent frame's vis timings.
+	int potentiallyVisFlatCount, culledChunkFlatCount; // Most recent frame's entity instance counts.
 
 	// Initializes render threads that run in the background for the duration of the renderer's
 	// lifetime. This can also be used to reset threads after a screen resize.
@@ -576,20 +1052,17 @@ private:
 	void updateVisibleDistantObjects(const ShadingInfo &shadingInfo, const Camera &camera,
 		const FrameView &frame);
 
-	// Refreshes the list of potentially visible flats (to be passed to actually-visible flat
-	// calculation).
-	static void updatePotentiallyVisibleFlats(const Camera &camera, SNInt gridWidth, WEInt gridDepth,
-		int chunkDistance, const EntityManager &entityManager,
-		std::vector<const Entity*> *outPotentiallyVisFlats, int *outEntityCount);
+	// Sorts visible flats farthest to nearest, starting from the previous frame's order.
+	static void sortVisibleFlats(std::vector<VisibleFlat> &visibleFlats, FlatSortOrder &sortOrder);
 
-	// Refreshes the list of flats to be drawn.
-	void updateVisibleFlats(const Camera &camera, const ShadingInfo &shadingInfo, int chunkDistance,
-		double ceilingHeight, const VoxelGrid &voxelGrid, const EntityManager &entityManager,
-		const EntityDefinitionLibrary &entityDefLibrary);
+	// Refreshes the list of flats to be drawn, and gathers the static and dynamic lights among
+	// the entity instances.
+	void updateVisibleFlats(const Camera &camera, const ShadingInfo &shadingInfo,
+		const std::vector<EntityRenderInstance> &entityInsts);
 
-	// Refreshes the visible light lists in each voxel column in the view frustum.
-	void updateVisibleLightLists(const Camera &camera, int chunkDistance, double ceilingHeight,
-		const VoxelGrid &voxelGrid);
+	// Refreshes the visible light lists in each voxel column of the potentially visible chunks.
+	// Static lights are only re-binned when needed (see LightGrid).
+	void updateVisibleLightLists(const Camera &camera, int chunkDistance, double ceilingHeight);
 	
 	// Gets the facing value for the far side of a chasm.
 	static VoxelFacing2D getInitialChasmFarFacing(SNInt voxelX, WEInt voxelZ,
@@ -676,7 +1149,7 @@ private:
 	// type determines what kind of door formula to calculate for the intersection.
 	static bool findInitialDoorIntersection(SNInt voxelX, WEInt voxelZ,
 		VoxelDefinition::DoorData::Type doorType, double percentOpen, const NewDouble2 &nearPoint,
-		const NewDouble2 &farPoint, const Camera &camera, const Ray &ray, const VoxelGrid &voxelGrid,
+		const NewDouble2 &farPoint, const Camera &camera, const Ray &ray, const RenderDefinitionGroup &defGroup,
 		RayHit &hit);
 
 	// Helper method for findDoorIntersection() for swinging doors.
@@ -706,8 +1179,8 @@ private:
 
 	// Low-level texture sampling function.
 	template <int FilterMode, bool Transparency>
-	static void sampleVoxelTexture(const VoxelTexture &texture, double u, double v,
-		double *r, double *g, double *b, double *emission, bool *transparent);
+	static void sampleVoxelTexture(const VoxelTexture &texture, ShadingReal u, ShadingReal v,
+		ShadingReal *r, ShadingReal *g, ShadingReal *b, ShadingReal *emission, bool *transparent);
 
 	// Low-level screen-space chasm texture sampling function.
 	static void sampleChasmTexture(const ChasmTexture &texture, double screenXPercent,
@@ -721,6 +1194,15 @@ private:
 		double fadePercent, double lightContributionPercent, const ShadingInfo &shadingInfo,
 		OcclusionData &occlusion, const FrameView &frame);
 
+	// Vectorized version of the non-perspective wall shaders. The caller clips the Y range and
+	// updates occlusion. Pixels passing the depth test are sampled in chunks, then shaded by the
+	// active column kernels.
+	template <bool Transparency>
+	static void drawPixelsVectorized(int x, int yStart, int yEnd, const DrawRange &drawRange,
+		double depth, double u, double vStart, double vEnd, const VoxelTexture &texture,
+		double fadePercent, double lightContributionPercent, const ShadingInfo &shadingInfo,
+		const FrameView &frame);
+
 	// Draws a column of pixels with no perspective or transparency.
 	static void drawPixels(int x, const DrawRange &drawRange, double depth, double u,
 		double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
@@ -735,6 +1217,14 @@ private:
 		const BufferView<const VisibleLight> &visLights, const VisibleLightList &visLightList,
 		const ShadingInfo &shadingInfo, OcclusionData &occlusion, const FrameView &frame);
 
+	// Vectorized version of the perspective wall shader. The caller clips the Y range and updates
+	// occlusion.
+	static void drawPerspectivePixelsVectorized(int x, int yStart, int yEnd,
+		const DrawRange &drawRange, const NewDouble2 &startPoint, const NewDouble2 &endPoint,
+		double depthStart, double depthEnd, const VoxelTexture &texture, double fadePercent,
+		const BufferView<const VisibleLight> &visLights, const VisibleLightList &visLightList,
+		const ShadingInfo &shadingInfo, const FrameView &frame);
+
 	// Draws a column of pixels with perspective but no transparency. The pixel drawing order is 
 	// top to bottom, so the start and end values should be passed with that in mind.
 	static void drawPerspectivePixels(int x, const DrawRange &drawRange, const NewDouble2 &startPoint,
@@ -747,7 +1237,7 @@ private:
 	static void drawTransparentPixels(int x, const DrawRange &drawRange, double depth, double u,
 		double vStart, double vEnd, const Double3 &normal, const VoxelTexture &texture,
 		double lightContributionPercent, const ShadingInfo &shadingInfo,
-		const OcclusionData &occlusion, const FrameView &frame);
+		OcclusionData &occlusion, const FrameView &frame);
 
 	// Low-level shader for chasm pixel rendering.
 	// @todo: consider template bool for treating screen-space texels as regular texels.
@@ -784,12 +1274,6 @@ private:
 	static void drawDistantPixels(int x, const DrawRange &drawRange, double u, double vStart,
 		double vEnd, const SkyTexture &texture, bool emissive, const ShadingInfo &shadingInfo,
 		const FrameView &frame);
-	/*static void drawDistantPixelsSSE(int x, const DrawRange &drawRange, double u, double vStart,
-		double vEnd, const SkyTexture &texture, bool emissive, const ShadingInfo &shadingInfo,
-		const FrameView &frame);*/
-	/*static void drawDistantPixelsAVX(int x, const DrawRange &drawRange, double u, double vStart,
-		double vEnd, const SkyTexture &texture, bool emissive, const ShadingInfo &shadingInfo,
-		const FrameView &frame);*/
 
 	// Draws a column of pixels for a moon. This is its own pixel-rendering method because of
 	// the unique method of shading required for moons.
@@ -812,7 +1296,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 	static void drawInitialVoxelAbove(int x, SNInt voxelX, int voxelY, WEInt voxelZ,
@@ -823,7 +1307,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 	static void drawInitialVoxelBelow(int x, SNInt voxelX, int voxelY, WEInt voxelZ,
@@ -834,7 +1318,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
@@ -846,7 +1330,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
@@ -858,7 +1342,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 	static void drawVoxelAbove(int x, SNInt voxelX, int voxelY, WEInt voxelZ, const Camera &camera,
@@ -868,7 +1352,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 	static void drawVoxelBelow(int x, SNInt voxelX, int voxelY, WEInt voxelZ, const Camera &camera,
@@ -878,7 +1362,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
@@ -890,13 +1374,13 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
-	// Draws the portion of a flat contained within the given X range of the screen. The end
-	// X value is exclusive.
-	static void drawFlat(int startX, int endX, const VisibleFlat &flat, const Double3 &normal,
+	// Draws the portion of a flat contained within the given X range of the screen, in every
+	// stride'th column counting from the start X. The end X value is exclusive.
+	static void drawFlat(int startX, int endX, int stride, const VisibleFlat &flat, const Double3 &normal,
 		const NewDouble2 &eye, const NewInt2 &eyeVoxelXZ, double horizonProjY, const ShadingInfo &shadingInfo,
 		int chunkDistance, const FlatTexture &texture, const BufferView<const VisibleLight> &visLights,
 		const BufferView2D<const VisibleLightList> &visLightLists, SNInt gridWidth, WEInt gridDepth,
@@ -911,7 +1395,7 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
@@ -923,10 +1407,22 @@ private:
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
 		OcclusionData &occlusion, const FrameView &frame);
 
+	// Casts the rays of a packet of columns and draws them. Same results as rayCast2D() for each
+	// column, but the DDA steps of neighboring columns are shared between SIMD lanes.
+	static void rayCastPacket(RayPacket &packet, const Camera &camera,
+		const ShadingInfo &shadingInfo, int chunkDistance, double ceilingHeight,
+		const std::vector<LevelData::DoorState> &openDoors,
+		const std::vector<LevelData::FadeState> &fadingVoxels,
+		const LevelData::ChasmStates &chasmStates,
+		const BufferView<const VisibleLight> &visLights,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
+		const std::vector<VoxelTexture> &textures, const ChasmTextureGroups &chasmTextureGroups,
+		Buffer<OcclusionData> &occlusion, const FrameView &frame);
+
 	// Draws a portion of the sky gradient. The start and end Y are determined from current
 	// threading settings.
 	static void drawSkyGradient(int startY, int endY, double gradientProjYTop,
@@ -934,41 +1430,73 @@ private:
 		std::atomic<bool> &shouldDrawStars, const ShadingInfo &shadingInfo,
 		const FrameView &frame);
 
+	// Copies rows of a column-major frame's colors into the row-major output buffer.
+	static void swizzleFrameRows(int startY, int endY, const FrameView &frame,
+		uint32_t *outputBuffer);
+
 	// Draws some columns of distant sky objects (mountains, clouds, etc.). The start and end X
 	// are determined from current threading settings.
 	static void drawDistantSky(int startX, int endX, const VisDistantObjects &visDistantObjs,
 		const std::vector<SkyTexture> &skyTextures, const Buffer<Double3> &skyGradientRowCache,
 		bool shouldDrawStars, const ShadingInfo &shadingInfo, const FrameView &frame);
 
-	// Handles drawing all voxels for the current frame.
-	static void drawVoxels(int startX, int stride, const Camera &camera, int chunkDistance,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
+	// Copies rows of the cached sky into the frame and clears their depth. Used instead of drawing
+	// the sky gradient when the cached sky is reused.
+	static void copySkyRows(int startY, int endY, const FrameView &skyFrame, const FrameView &frame);
+
+	// Copies columns of the freshly drawn sky cache into the frame. Depth was already cleared while
+	// drawing the sky gradient.
+	static void copySkyColumns(int startX, int endX, const FrameView &skyFrame, const FrameView &frame);
+
+	// Handles drawing voxels in every stride'th column between the start and end X for the
+	// current frame. The end X is exclusive.
+	static void drawVoxels(int startX, int endX, int stride, const Camera &camera, int chunkDistance,
+		double ceilingHeight, bool rayPackets, const std::vector<LevelData::DoorState> &openDoors,
 		const std::vector<LevelData::FadeState> &fadingVoxels,
 		const LevelData::ChasmStates &chasmStates,
 		const BufferView<const VisibleLight> &visLights,
-		const BufferView2D<const VisibleLightList> &visLightLists, const VoxelGrid &voxelGrid,
+		const BufferView2D<const VisibleLightList> &visLightLists, const RenderDefinitionGroup &defGroup,
 		const std::vector<VoxelTexture> &voxelTextures, const ChasmTextureGroups &chasmTextureGroups,
 		Buffer<OcclusionData> &occlusion, const ShadingInfo &shadingInfo, const FrameView &frame);
 
-	// Handles drawing all flats for the current frame.
-	static void drawFlats(int startX, int endX, const Camera &camera, const Double3 &flatNormal,
+	// Handles drawing all flats in every stride'th column between the start and end X for the
+	// current frame.
+	static void drawFlats(int startX, int endX, int stride, const Camera &camera, const Double3 &flatNormal,
 		const std::vector<VisibleFlat> &visibleFlats, const FlatTextureGroups &flatTextureGroups,
 		const ShadingInfo &shadingInfo, int chunkDistance, const BufferView<const VisibleLight> &visLights,
 		const BufferView2D<const VisibleLightList> &visLightLists, SNInt gridWidth, WEInt gridDepth,
 		const FrameView &frame);
 
+	// Fills the columns between the start and end X that weren't drawn this frame from the
+	// previous frame (or a drawn neighbor if they weren't on screen), then saves the finished
+	// columns for the next frame. The end X is exclusive.
+	static void reconstructColumns(int startX, int endX, int parity, const int *sourceColumns,
+		const uint32_t *previousHistory, uint32_t *currentHistory, const FrameView &frame);
+
 	// Thread loop for each render thread. All threads are initialized in the constructor and
 	// wait for a go signal at the beginning of each render(). If the renderer is destructing,
 	// then each render thread still gets a go signal, but they immediately leave their loop
-	// and terminate. Non-thread-data parameters are for start/end column/row for each thread.
-	static void renderThreadLoop(RenderThreadData &threadData, int threadIndex, int startX,
-		int endX, int startY, int endY);
+	// and terminate. The initial epoch is the frame epoch at the time the thread was created.
+	// Other non-thread-data parameters are for start/end column/row for each thread.
+	static void renderThreadLoop(RenderThreadData &threadData, RenderThreadData::Epoch initialEpoch,
+		int threadIndex, int startX, int endX, int startY, int endY);
+
+	// Draws a frame from the given voxel definitions and instances. With pipelined rendering,
+	// everything passed by reference is still read after this returns.
+	void drawFrame(const Double3 &eye, const Double3 &direction, Degrees fovY, double ambient,
+		double daytimePercent, double chasmAnimPercent, double latitude, bool nightLightsAreActive,
+		bool isExterior, bool playerHasLight, int chunkDistance, double ceilingHeight,
+		const RenderDefinitionGroup &defGroup, const RenderInstanceGroup &instGroup,
+		uint32_t *colorBuffer);
 public:
 	SoftwareRenderer();
 	~SoftwareRenderer();
 
 	bool isInited() const;
 
+	// Gets the distance at which the fog is maximum.
+	double getFogDistance() const;
+
 	// Gets profiling information about renderer internals.
 	ProfilerData getProfilerData() const;
 
@@ -988,6 +1516,31 @@ public:
 	// Sets the render threads mode to use (low, medium, high, etc.).
 	void setRenderThreadsMode(int mode);
 
+	// Sets whether render threads dynamically share voxel and flat columns instead of using
+	// fixed column assignments.
+	void setRenderThreadsWorkStealing(bool enabled);
+
+	// Sets whether columns are drawn to an internal column-major frame buffer that is copied to
+	// the row-major output at the end of the frame.
+	void setColumnMajorFrameBuffer(bool enabled);
+
+	// Sets whether only every other column is drawn each frame, with the rest reprojected from
+	// the previous frame.
+	void setCheckerboardRendering(bool enabled);
+
+	// Sets whether render() returns as soon as the frame is handed to the render threads, so
+	// the next game tick can run while it's drawn. The output buffer and render groups are only
+	// safe to use again after finishFrame().
+	void setPipelinedRendering(bool enabled);
+
+	// Sets whether opaque ranges in the middle of a column reject later voxel pixels behind them,
+	// rather than only ranges touching the top or bottom of the open window. For comparison.
+	void setOcclusionSpans(bool enabled);
+
+	// Sets whether voxel rays of neighboring columns are stepped together in SIMD lanes. The
+	// image is the same either way. For comparison.
+	void setRayPackets(bool enabled);
+
 	// Sets the distance at which the fog is maximum.
 	void setFogDistance(double fogDistance);
 
@@ -1003,6 +1556,15 @@ public:
 	void addChasmTexture(VoxelDefinition::ChasmData::Type chasmType, const uint8_t *colors,
 		int width, int height, const Palette &palette);
 
+	// Starts queueing texture conversions from setVoxelTexture() and setFlatTextures() on the
+	// texture job pool instead of converting them on the calling thread. The previous textures
+	// are drawn until the batch ends.
+	void beginTextureBatch();
+
+	// Waits for the batch's conversions and swaps all of the converted textures in at once. Done
+	// automatically before anything else reads or replaces textures.
+	void endTextureBatch();
+
 	// Overwrites the selected voxel texture's data with the given 64x64 set of texels.
 	void setVoxelTexture(int id, const uint8_t *srcTexels, const Palette &palette);
 
@@ -1028,20 +1590,46 @@ public:
 
 	// Initializes software renderer with the given frame buffer dimensions. This can be called
 	// on first start or to reset the software renderer.
-	void init(int width, int height, int renderThreadsMode);
+	void init(int width, int height, int renderThreadsMode, bool renderThreadsWorkStealing,
+		bool columnMajorFrameBuffer, bool checkerboardRendering, bool pipelinedRendering);
 
-	// Resizes the frame buffer and related values.
-	void resize(int width, int height);
+	// Initializes the renderer through the renderer interface, which also allocates the output
+	// buffer that submitFrame() draws to.
+	void init(const RenderInitSettings &settings) override;
 
-	// Draws the scene to the output color buffer in ARGB8888 format.
-	void render(const Double3 &eye, const Double3 &direction, Degrees fovY,
-		double ambient, double daytimePercent, double chasmAnimPercent, double latitude,
-		bool nightLightsAreActive, bool isExterior, bool playerHasLight, int chunkDistance,
-		double ceilingHeight, const std::vector<LevelData::DoorState> &openDoors,
-		const std::vector<LevelData::FadeState> &fadingVoxels,
-		const LevelData::ChasmStates &chasmStates, const VoxelGrid &voxelGrid,
-		const EntityManager &entityManager, const EntityDefinitionLibrary &entityDefLibrary,
-		uint32_t *colorBuffer);
+	// Waits for any frame in flight and stops the render threads.
+	void shutdown() override;
+
+	// Resizes the frame buffer and related values.
+	void resize(int width, int height) override;
+
+	// Allocates textures for the renderer interface. Voxel texture IDs continue after the
+	// textures set with setVoxelTexture().
+	VoxelTextureID createVoxelTexture(int width, int height) override;
+	SpriteTextureID createSpriteTexture(int width, int height) override;
+	void freeVoxelTexture(VoxelTextureID textureID) override;
+	void freeSpriteTexture(SpriteTextureID textureID) override;
+
+	// Draws the scene to the output buffer. The definition and instance groups must stay
+	// unchanged until present() when pipelined.
+	void submitFrame(const RenderDefinitionGroup &defGroup, const RenderInstanceGroup &instGroup,
+		const RenderCamera &camera, const RenderFrameSettings &settings) override;
+
+	// Waits for the submitted frame to be in the output buffer.
+	void present() override;
+
+	// Gets the ARGB8888 output of the most recently presented frame.
+	const uint32_t *getOutputBuffer() const;
+
+	// Draws the scene to the given color buffer in ARGB8888 format, like submitFrame() but for
+	// callers with their own buffer. The groups are filled in by RenderDataBuilder. With
+	// pipelined rendering, the frame is still being drawn when this returns, and the groups
+	// and color buffer must stay unchanged until finishFrame().
+	void render(const RenderDefinitionGroup &defGroup, const RenderInstanceGroup &instGroup,
+		const RenderCamera &camera, const RenderFrameSettings &settings, uint32_t *colorBuffer);
+
+	// Waits for a pipelined frame to finish drawing. Does nothing if no frame is in flight.
+	void finishFrame();
 };
 
 #endif
@@ -1 +1,11 @@
-#include "VoxelRenderDefinition.h"
\ No newline at end of file
+#include "VoxelRenderDefinition.h"
+
+void VoxelRenderDefinition::init(const VoxelDefinition &voxelDef)
+{
+	this->voxelDef = voxelDef;
+}
+
+const VoxelDefinition &VoxelRenderDefinition::getVoxelDef() const
+{
+	return this->voxelDef;
+}
@@ -4,6 +4,7 @@
 #include <array>
 
 #include "RectangleRenderDefinition.h"
+#include "../World/VoxelDefinition.h"
 
 // Common voxel render data usable by all renderers. Can be pointed to by multiple voxel
 // render instances. Each voxel render definition's coordinate is implicitly defined by its
@@ -26,8 +27,14 @@ private:
 	// - Make a render utils function for converting +/- {x,y,z} face/enum to index (like sky octants).
 	std::array<VoxelRectangleRenderDefinition, MAX_RECTS> rects;
 	std::array<FaceIndicesDef, FACES> faceIndices; // X: 0, 1; Y: 2, 3; Z: 4, 5.
+
+	// Voxel definition this was made from. The software renderer ray casts against it until
+	// the rectangles above are filled in.
+	VoxelDefinition voxelDef;
 public:
+	void init(const VoxelDefinition &voxelDef);
 
+	const VoxelDefinition &getVoxelDef() const;
 };
 
 #endif
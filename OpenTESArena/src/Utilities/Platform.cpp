@@ -129,6 +129,24 @@ std::string Platform::getScreenshotPath()
 	return String::replace(screenshotPathString, '\\', '/');
 }
 
+std::string Platform::getProfilerTracePath()
+{
+	// SDL_GetPrefPath() creates the desired folder if it doesn't exist.
+	char *tracePathPtr = SDL_GetPrefPath("OpenTESArena", "traces");
+
+	if (tracePathPtr == nullptr)
+	{
+		DebugLogWarning("SDL_GetPrefPath() not available on this platform.");
+		tracePathPtr = SDL_strdup("traces/");
+	}
+
+	const std::string tracePathString(tracePathPtr);
+	SDL_free(tracePathPtr);
+
+	// Convert Windows backslashes to forward slashes.
+	return String::replace(tracePathString, '\\', '/');
+}
+
 std::string Platform::getLogPath()
 {
 	// Unfortunately there's no SDL_GetLogPath(), so we need to make our own.
@@ -1,27 +1,53 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <optional>
+#include <unordered_map>
 
 #include "ChunkManager.h"
 #include "ChunkUtils.h"
+#include "LevelDefinition.h"
+#include "LevelInfoDefinition.h"
+#include "MapDefinition.h"
+#include "VoxelDataType.h"
 #include "WorldType.h"
 #include "../Entities/EntityManager.h"
 #include "../Game/Game.h"
 
 #include "components/debug/Debug.h"
 #include "components/utilities/Buffer.h"
+#include "components/utilities/JobPool.h"
+
+ChunkManager::BuildSlot::BuildSlot()
+	: done(false)
+{
+	this->inUse = false;
+}
 
 ChunkManager::ChunkManager()
 {
+	this->buildSlotCount = 0;
 	this->worldType = static_cast<WorldType>(-1);
 	this->chunkDistance = -1;
+	this->resetStreamingStats();
+}
+
+ChunkManager::~ChunkManager()
+{
+	// Workers write into the build slots, so they can't be freed before the workers finish.
+	this->waitForBuilds();
 }
 
 void ChunkManager::init(WorldType worldType, int chunkDistance)
 {
 	DebugAssertMsg(this->activeChunks.empty(), "Expected no active chunks.");
+	this->waitForBuilds();
 
+	// Chunks around where the player is headed are kept as well, which is at most one chunk
+	// further than the active range in any direction.
 	SNInt chunkCountX;
 	WEInt chunkCountZ;
-	ChunkUtils::getPotentiallyVisibleChunkCounts(chunkDistance, &chunkCountX, &chunkCountZ);
+	ChunkUtils::getPotentiallyVisibleChunkCounts(chunkDistance + 1, &chunkCountX, &chunkCountZ);
 
 	const int totalChunkCount = chunkCountX * chunkCountZ;
 	this->chunkPool = std::vector<ChunkPtr>(totalChunkCount);
@@ -32,8 +58,11 @@ void ChunkManager::init(WorldType worldType, int chunkDistance)
 		chunkPtr = std::make_unique<Chunk>();
 	}
 
+	this->buildSlots = std::make_unique<BuildSlot[]>(totalChunkCount);
+	this->buildSlotCount = totalChunkCount;
 	this->worldType = worldType;
 	this->chunkDistance = chunkDistance;
+	this->resetStreamingStats();
 }
 
 bool ChunkManager::isValidChunkID(ChunkID id) const
@@ -68,8 +97,9 @@ bool ChunkManager::tryGetChunkID(const ChunkInt2 &coord, ChunkID *outID) const
 {
 	for (int i = 0; i < static_cast<int>(this->activeChunks.size()); i++)
 	{
+		// Recycled chunks leave their slot empty.
 		const ChunkPtr &chunkPtr = this->activeChunks[i];
-		if (chunkPtr->getCoord() == coord)
+		if ((chunkPtr != nullptr) && (chunkPtr->getCoord() == coord))
 		{
 			*outID = this->getChunkID(i);
 			return true;
@@ -89,11 +119,31 @@ const Chunk &ChunkManager::getChunk(ChunkID id) const
 	return *this->getChunkPtr(id);
 }
 
-ChunkID ChunkManager::spawnChunk()
+double ChunkManager::getLastUpdateSeconds() const
 {
-	DebugAssertMsg(this->chunkPool.size() > 0, "No more chunks allocated.");
-	ChunkPtr chunkPtr = std::move(this->chunkPool.back());
-	this->chunkPool.pop_back();
+	return this->lastUpdateSeconds;
+}
+
+double ChunkManager::getMaxUpdateSeconds() const
+{
+	return this->maxUpdateSeconds;
+}
+
+int ChunkManager::getSyncBuildCount() const
+{
+	return this->syncBuildCount;
+}
+
+void ChunkManager::resetStreamingStats()
+{
+	this->lastUpdateSeconds = 0.0;
+	this->maxUpdateSeconds = 0.0;
+	this->syncBuildCount = 0;
+}
+
+ChunkID ChunkManager::activateChunk(ChunkPtr &&chunkPtr)
+{
+	DebugAssert(chunkPtr != nullptr);
 
 	// Find open spot in active chunks list, or append new slot.
 	std::optional<int> existingIndex;
@@ -138,39 +188,209 @@ void ChunkManager::recycleChunk(ChunkID id, EntityManager &entityManager)
 	entityManager.clearChunk(chunkCoord);
 }
 
-bool ChunkManager::populateChunk(ChunkID id, WorldType worldType, EntityManager &entityManager)
+bool ChunkManager::tryGetChunkLevel(const ChunkInt2 &coord, const MapDefinition &mapDefinition,
+	int levelIndex, const LevelDefinition **outLevelDef, const LevelInfoDefinition **outLevelInfoDef,
+	LevelInt2 *outLevelOffset) const
 {
-	DebugAssert(this->isValidChunkID(id));
-	Chunk &chunk = this->getChunk(id);
+	if ((this->worldType == WorldType::Interior) || (this->worldType == WorldType::City))
+	{
+		// The level spans many chunks, so the chunk is a window into it.
+		// @todo: city chunks outside the level should be wrapped with only floor voxels.
+		const LevelDefinition &levelDef = mapDefinition.getLevel(levelIndex);
+		const LevelInt2 levelOffset = VoxelUtils::chunkVoxelToNewVoxel(coord, VoxelInt2(0, 0));
+		const bool intersectsLevel = (levelOffset.x < levelDef.getWidth()) &&
+			((levelOffset.x + Chunk::WIDTH) > 0) && (levelOffset.y < levelDef.getDepth()) &&
+			((levelOffset.y + Chunk::DEPTH) > 0);
+
+		if (!intersectsLevel)
+		{
+			return false;
+		}
+
+		*outLevelDef = &levelDef;
+		*outLevelInfoDef = &mapDefinition.getLevelInfoForLevel(levelIndex);
+		*outLevelOffset = levelOffset;
+		return true;
+	}
+	else if (this->worldType == WorldType::Wilderness)
+	{
+		// Each wild chunk is its own level.
+		const MapDefinition::Wild &wild = mapDefinition.getWild();
+		const int wildLevelIndex = wild.getLevelDefIndex(coord);
+		*outLevelDef = &mapDefinition.getLevel(wildLevelIndex);
+		*outLevelInfoDef = &mapDefinition.getLevelInfoForLevel(wildLevelIndex);
+		*outLevelOffset = LevelInt2(0, 0);
+		return true;
+	}
+	else
+	{
+		DebugNotImplementedMsg(std::to_string(static_cast<int>(this->worldType)));
+		return false;
+	}
+}
+
+void ChunkManager::populateChunkVoxels(Chunk &chunk, const ChunkInt2 &coord, int height,
+	const LevelDefinition *levelDef, const LevelInfoDefinition *levelInfoDef,
+	const LevelInt2 &levelOffset)
+{
+	chunk.init(coord, height);
 
-	if (worldType == WorldType::Interior)
+	if (levelDef == nullptr)
 	{
-		// @todo
-		// Needs to know if the chunk coordinate intersects the level dimensions, so it knows
-		// to grab voxel data from the level definition. Otherwise, default empty chunk.
+		// Nothing to fill the chunk with.
+		return;
 	}
-	else if (worldType == WorldType::City)
+
+	DebugAssert(levelInfoDef != nullptr);
+
+	// Level voxel definitions are added to the chunk the first time they're used in it.
+	std::unordered_map<LevelDefinition::VoxelDefID, Chunk::VoxelID> chunkVoxelIDs;
+	auto getChunkVoxelID = [&chunk, levelInfoDef, &chunkVoxelIDs](LevelDefinition::VoxelDefID levelVoxelID)
 	{
-		// @todo
-		// Same as interior, except chunks outside the level are wrapped with only floor voxels.
+		const auto iter = chunkVoxelIDs.find(levelVoxelID);
+		if (iter != chunkVoxelIDs.end())
+		{
+			return iter->second;
+		}
+
+		VoxelDefinition voxelDef = levelInfoDef->getVoxelDef(levelVoxelID);
+		Chunk::VoxelID chunkVoxelID = 0;
+		if (voxelDef.dataType != VoxelDataType::None)
+		{
+			if (!chunk.tryAddVoxelDef(std::move(voxelDef), &chunkVoxelID))
+			{
+				DebugLogWarning("Too many voxel definitions in chunk (" + chunk.getCoord().toString() + ").");
+				chunkVoxelID = 0;
+			}
+		}
+
+		chunkVoxelIDs.emplace(levelVoxelID, chunkVoxelID);
+		return chunkVoxelID;
+	};
+
+	// Only copy the part of the level that overlaps the chunk.
+	const SNInt startX = std::max(levelOffset.x, 0);
+	const SNInt endX = std::min(levelOffset.x + Chunk::WIDTH, levelDef->getWidth());
+	const int endY = std::min(height, levelDef->getHeight());
+	const WEInt startZ = std::max(levelOffset.y, 0);
+	const WEInt endZ = std::min(levelOffset.y + Chunk::DEPTH, levelDef->getDepth());
+
+	for (WEInt z = startZ; z < endZ; z++)
+	{
+		for (int y = 0; y < endY; y++)
+		{
+			for (SNInt x = startX; x < endX; x++)
+			{
+				const LevelDefinition::VoxelDefID levelVoxelID = levelDef->getVoxel(x, y, z);
+				const Chunk::VoxelID chunkVoxelID = getChunkVoxelID(levelVoxelID);
+				chunk.set(x - levelOffset.x, y, z - levelOffset.y, chunkVoxelID);
+			}
+		}
+	}
+}
+
+int ChunkManager::getChunkHeight() const
+{
+	if (this->worldType == WorldType::Interior)
+	{
+		return Chunk::INTERIOR_HEIGHT;
 	}
-	else if (worldType == WorldType::Wilderness)
+	else if (this->worldType == WorldType::City)
 	{
-		// @todo
-		// Get the .RMD file (or equivalent) that goes in that chunk's spot.
+		return Chunk::EXTERIOR_HEIGHT;
+	}
+	else if (this->worldType == WorldType::Wilderness)
+	{
+		return Chunk::WILDERNESS_HEIGHT;
 	}
 	else
 	{
-		DebugNotImplementedMsg(std::to_string(static_cast<int>(worldType)));
-		return false;
+		DebugUnhandledReturnMsg(int, std::to_string(static_cast<int>(this->worldType)));
+	}
+}
+
+bool ChunkManager::isChunkBuilding(const ChunkInt2 &coord) const
+{
+	for (int i = 0; i < this->buildSlotCount; i++)
+	{
+		const BuildSlot &slot = this->buildSlots[i];
+		if (slot.inUse && (slot.coord == coord))
+		{
+			return true;
+		}
 	}
 
-	return true;
+	return false;
 }
 
-void ChunkManager::update(const ChunkInt2 &playerChunk, WorldType worldType,
+void ChunkManager::waitForBuild(const BuildSlot &slot)
+{
+	std::unique_lock<std::mutex> lock(this->buildMutex);
+	this->buildCondition.wait(lock, [&slot]()
+	{
+		return !slot.inUse || slot.done.load(std::memory_order_acquire);
+	});
+}
+
+void ChunkManager::publishBuiltChunks(const ChunkInt2 &playerChunk, const ChunkInt2 &predictedChunk,
 	EntityManager &entityManager)
 {
+	for (int i = 0; i < this->buildSlotCount; i++)
+	{
+		BuildSlot &slot = this->buildSlots[i];
+		if (!slot.inUse || !slot.done.load(std::memory_order_acquire))
+		{
+			continue;
+		}
+
+		slot.done.store(false, std::memory_order_relaxed);
+		slot.inUse = false;
+
+		const bool isWanted = ChunkUtils::isWithinActiveRange(playerChunk, slot.coord, this->chunkDistance) ||
+			ChunkUtils::isWithinActiveRange(predictedChunk, slot.coord, this->chunkDistance);
+
+		if (isWanted)
+		{
+			// @todo: populate the chunk's entities from the level's entity placements here on the
+			// main thread once LevelInstance owns entities (they need the renderer for textures).
+			this->activateChunk(std::move(slot.chunk));
+		}
+		else
+		{
+			// The player changed direction before it was needed.
+			slot.chunk->clear();
+			this->chunkPool.push_back(std::move(slot.chunk));
+		}
+	}
+}
+
+void ChunkManager::update(const NewDouble2 &playerPosition, const NewDouble2 &playerVelocity,
+	const MapDefinition &mapDefinition, int levelIndex, JobPool &jobPool, EntityManager &entityManager)
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	auto getChunkAtPosition = [](const NewDouble2 &position)
+	{
+		const NewInt2 voxel(
+			static_cast<SNInt>(std::floor(position.x)),
+			static_cast<WEInt>(std::floor(position.y)));
+		return VoxelUtils::newVoxelToChunk(voxel);
+	};
+
+	// Where the player will be soon, kept within a chunk of where they are so the chunk pool can
+	// hold both areas.
+	const ChunkInt2 playerChunk = getChunkAtPosition(playerPosition);
+	const ChunkInt2 predictedChunk = [&playerPosition, &playerVelocity, &getChunkAtPosition, &playerChunk]()
+	{
+		const NewDouble2 predictedPosition = playerPosition + (playerVelocity * PREDICTION_SECONDS);
+		const ChunkInt2 chunk = getChunkAtPosition(predictedPosition);
+		return ChunkInt2(
+			std::clamp(chunk.x, playerChunk.x - 1, playerChunk.x + 1),
+			std::clamp(chunk.y, playerChunk.y - 1, playerChunk.y + 1));
+	}();
+
+	this->publishBuiltChunks(playerChunk, predictedChunk, entityManager);
+
 	// Free out-of-range chunks.
 	for (int i = 0; i < static_cast<int>(this->activeChunks.size()); i++)
 	{
@@ -178,8 +398,9 @@ void ChunkManager::update(const ChunkInt2 &playerChunk, WorldType worldType,
 		if (chunkPtr != nullptr)
 		{
 			const ChunkInt2 &coord = chunkPtr->getCoord();
-			const bool shouldRemainActive = ChunkUtils::isWithinActiveRange(
-				playerChunk, coord, this->chunkDistance);
+			const bool shouldRemainActive =
+				ChunkUtils::isWithinActiveRange(playerChunk, coord, this->chunkDistance) ||
+				ChunkUtils::isWithinActiveRange(predictedChunk, coord, this->chunkDistance);
 
 			if (!shouldRemainActive)
 			{
@@ -189,22 +410,146 @@ void ChunkManager::update(const ChunkInt2 &playerChunk, WorldType worldType,
 		}
 	}
 
-	// Add new chunks to take the place of the removed ones. Get all the surrounding chunk coords
-	// for the player chunk and see which ones aren't in active list.
-	ChunkInt2 minCoord, maxCoord;
-	ChunkUtils::getSurroundingChunks(playerChunk, this->chunkDistance, &minCoord, &maxCoord);
+	const int chunkHeight = this->getChunkHeight();
 
-	for (WEInt y = minCoord.y; y < maxCoord.y; y++)
+	// The player's own chunk can't wait for a later update. If a worker has it, wait for that,
+	// otherwise build it here.
+	ChunkID playerChunkID;
+	if (!this->tryGetChunkID(playerChunk, &playerChunkID))
 	{
-		for (SNInt x = minCoord.x; x < maxCoord.x; x++)
+		if (this->isChunkBuilding(playerChunk))
 		{
-			const ChunkInt2 coord(x, y);			
-			ChunkID chunkID;
-			if (!this->tryGetChunkID(coord, &chunkID))
+			for (int i = 0; i < this->buildSlotCount; i++)
 			{
-				chunkID = this->spawnChunk();
-				this->populateChunk(chunkID, this->worldType, entityManager);
+				const BuildSlot &slot = this->buildSlots[i];
+				if (slot.inUse && (slot.coord == playerChunk))
+				{
+					this->waitForBuild(slot);
+				}
 			}
+
+			this->publishBuiltChunks(playerChunk, predictedChunk, entityManager);
+			this->syncBuildCount++;
+		}
+		else
+		{
+			// Chunks still building for an area the player turned away from aren't back in the
+			// pool yet, so it can run dry. The player's chunk can't wait for them.
+			if (this->chunkPool.size() == 0)
+			{
+				DebugLogWarning("Chunk pool is empty, allocating another chunk.");
+				this->chunkPool.emplace_back(std::make_unique<Chunk>());
+			}
+
+			ChunkPtr chunkPtr = std::move(this->chunkPool.back());
+			this->chunkPool.pop_back();
+
+			const LevelDefinition *levelDef = nullptr;
+			const LevelInfoDefinition *levelInfoDef = nullptr;
+			LevelInt2 levelOffset;
+			this->tryGetChunkLevel(playerChunk, mapDefinition, levelIndex, &levelDef, &levelInfoDef,
+				&levelOffset);
+			ChunkManager::populateChunkVoxels(*chunkPtr, playerChunk, chunkHeight, levelDef,
+				levelInfoDef, levelOffset);
+			this->activateChunk(std::move(chunkPtr));
+			this->syncBuildCount++;
 		}
 	}
+
+	// Hand the rest of the missing chunks to the workers, around the player first, then around
+	// where they're headed.
+	auto requestChunks = [this, &mapDefinition, levelIndex, &jobPool, chunkHeight](const ChunkInt2 &centerChunk)
+	{
+		ChunkInt2 minCoord, maxCoord;
+		ChunkUtils::getSurroundingChunks(centerChunk, this->chunkDistance, &minCoord, &maxCoord);
+
+		int slotIndex = 0;
+		for (WEInt y = minCoord.y; y <= maxCoord.y; y++)
+		{
+			for (SNInt x = minCoord.x; x <= maxCoord.x; x++)
+			{
+				const ChunkInt2 coord(x, y);
+				ChunkID chunkID;
+				if (this->tryGetChunkID(coord, &chunkID) || this->isChunkBuilding(coord))
+				{
+					continue;
+				}
+
+				// Out of chunks or build slots. The rest are requested once running builds are
+				// published and unwanted chunks are recycled.
+				if (this->chunkPool.size() == 0)
+				{
+					return;
+				}
+
+				while ((slotIndex < this->buildSlotCount) && this->buildSlots[slotIndex].inUse)
+				{
+					slotIndex++;
+				}
+
+				if (slotIndex == this->buildSlotCount)
+				{
+					return;
+				}
+
+				BuildSlot &slot = this->buildSlots[slotIndex];
+				slot.chunk = std::move(this->chunkPool.back());
+				this->chunkPool.pop_back();
+				slot.coord = coord;
+				slot.inUse = true;
+
+				const LevelDefinition *levelDef = nullptr;
+				const LevelInfoDefinition *levelInfoDef = nullptr;
+				LevelInt2 levelOffset;
+				this->tryGetChunkLevel(coord, mapDefinition, levelIndex, &levelDef, &levelInfoDef,
+					&levelOffset);
+
+				Chunk *chunk = slot.chunk.get();
+				std::atomic<bool> *done = &slot.done;
+				std::mutex *buildMutex = &this->buildMutex;
+				std::condition_variable *buildCondition = &this->buildCondition;
+				jobPool.submit([chunk, coord, chunkHeight, levelDef, levelInfoDef, levelOffset, done,
+					buildMutex, buildCondition]()
+				{
+					ChunkManager::populateChunkVoxels(*chunk, coord, chunkHeight, levelDef, levelInfoDef,
+						levelOffset);
+
+					// Set and signaled under the lock so a waiting main thread can't miss it.
+					std::lock_guard<std::mutex> lock(*buildMutex);
+					done->store(true, std::memory_order_release);
+					buildCondition->notify_all();
+				});
+			}
+		}
+	};
+
+	requestChunks(playerChunk);
+	if (predictedChunk != playerChunk)
+	{
+		requestChunks(predictedChunk);
+	}
+
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	this->lastUpdateSeconds = std::chrono::duration<double>(endTime - startTime).count();
+	this->maxUpdateSeconds = std::max(this->maxUpdateSeconds, this->lastUpdateSeconds);
+}
+
+void ChunkManager::waitForBuilds()
+{
+	// Always takes the lock, even if every build was already published, so a worker that's still
+	// signaling its finished chunk is done with the chunk manager when this returns.
+	std::unique_lock<std::mutex> lock(this->buildMutex);
+	this->buildCondition.wait(lock, [this]()
+	{
+		for (int i = 0; i < this->buildSlotCount; i++)
+		{
+			const BuildSlot &slot = this->buildSlots[i];
+			if (slot.inUse && !slot.done.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	});
 }
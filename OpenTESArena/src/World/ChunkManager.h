@@ -1,7 +1,10 @@
 #ifndef CHUNK_MANAGER_H
 #define CHUNK_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Chunk.h"
@@ -11,9 +14,22 @@
 // Handles active chunks and the voxels in them. Does not store any entities. When freeing a chunk,
 // it needs to tell the entity manager about it so the entities in it are handled correctly
 // (i.e. marked for deletion one way or another).
+//
+// Chunks are streamed in the background. Chunks the player is about to need (judging by their
+// velocity) are populated on job pool workers from the map definition's level data, and the
+// main thread picks them up on a later update. Only the chunk the player is standing in is ever
+// populated on the main thread, if it isn't ready in time.
+//
+// Only voxels are streamed so far. Streamed chunks don't get their level's entities, and the game
+// loop doesn't drive the chunk manager yet since LevelInstance isn't finished (the game still uses
+// LevelData and its voxel grid), so only bench_chunks calls update() for now.
 
 class EntityManager;
 class Game;
+class JobPool;
+class LevelDefinition;
+class LevelInfoDefinition;
+class MapDefinition;
 
 enum class WorldType;
 
@@ -22,11 +38,37 @@ class ChunkManager
 private:
 	using ChunkPtr = std::unique_ptr<Chunk>;
 
+	// A pooled chunk being populated by a worker. The done flag is the only state the worker
+	// and main thread share: the worker sets it once the chunk is filled, and the main thread
+	// takes the chunk after seeing it, so publishing a finished chunk never waits on a lock.
+	// The worker also signals the build condition for when the main thread has to block on it.
+	struct BuildSlot
+	{
+		ChunkPtr chunk;
+		ChunkInt2 coord; // Main thread only.
+		std::atomic<bool> done;
+		bool inUse; // Main thread only.
+
+		BuildSlot();
+	};
+
+	// How far ahead of the player's movement to predict which chunks are needed next.
+	static constexpr double PREDICTION_SECONDS = 1.0;
+
 	std::vector<ChunkPtr> chunkPool;
 	std::vector<ChunkPtr> activeChunks;
+	std::unique_ptr<BuildSlot[]> buildSlots; // One per chunk in the pool.
+	int buildSlotCount;
+	std::mutex buildMutex;
+	std::condition_variable buildCondition; // Signaled when a worker finishes a chunk.
 	WorldType worldType;
 	int chunkDistance;
 
+	// Streaming timings for finding hitches while the player moves through the world.
+	double lastUpdateSeconds;
+	double maxUpdateSeconds;
+	int syncBuildCount; // Chunks the player needed before a worker could finish them.
+
 	// Returns whether the given chunk ID points to an active chunk. The chunk ID of a chunk can
 	// never change until it has returned to the chunk pool.
 	bool isValidChunkID(ChunkID id) const;
@@ -35,16 +77,39 @@ private:
 	ChunkPtr &getChunkPtr(ChunkID id);
 	const ChunkPtr &getChunkPtr(ChunkID id) const;
 
-	// Takes a chunk from the chunk pool and moves it to the active chunks.
-	ChunkID spawnChunk();
+	// Moves a populated chunk to the active chunks.
+	ChunkID activateChunk(ChunkPtr &&chunkPtr);
 
 	// Clears the chunk, including entities, and removes it from the active chunks.
 	void recycleChunk(ChunkID id, EntityManager &entityManager);
 
-	// Fills the chunk with the data required based on its position and the world type.
-	bool populateChunk(ChunkID id, WorldType worldType, EntityManager &entityManager);
+	// Gets the level a chunk is populated from and where the chunk starts in it. Returns false
+	// if the chunk is outside the level.
+	bool tryGetChunkLevel(const ChunkInt2 &coord, const MapDefinition &mapDefinition, int levelIndex,
+		const LevelDefinition **outLevelDef, const LevelInfoDefinition **outLevelInfoDef,
+		LevelInt2 *outLevelOffset) const;
+
+	// Fills the chunk with voxels from the level, or leaves it empty if there's no level. Only
+	// reads immutable level data, so it's safe to call on a worker thread.
+	static void populateChunkVoxels(Chunk &chunk, const ChunkInt2 &coord, int height,
+		const LevelDefinition *levelDef, const LevelInfoDefinition *levelInfoDef,
+		const LevelInt2 &levelOffset);
+
+	int getChunkHeight() const;
+
+	// Returns whether the chunk is being populated by a worker.
+	bool isChunkBuilding(const ChunkInt2 &coord) const;
+
+	// Blocks until the worker populating the slot's chunk is finished, if any.
+	void waitForBuild(const BuildSlot &slot);
+
+	// Activates chunks the workers have finished, or returns them to the chunk pool if they're
+	// no longer wanted.
+	void publishBuiltChunks(const ChunkInt2 &playerChunk, const ChunkInt2 &predictedChunk,
+		EntityManager &entityManager);
 public:
 	ChunkManager();
+	~ChunkManager();
 
 	void init(WorldType worldType, int chunkDistance);
 
@@ -54,9 +119,28 @@ public:
 	Chunk &getChunk(ChunkID id);
 	const Chunk &getChunk(ChunkID id) const;
 
-	// Updates the chunk manager with the given chunk as the current center of the game world.
-	// This invalidates all existing chunk IDs.
-	void update(const ChunkInt2 &playerChunk, WorldType worldType, EntityManager &entityManager);
+	// Seconds taken by the last update, and the most taken by any update since the stats were
+	// reset. The max is the hitch metric to watch while traversing the world.
+	double getLastUpdateSeconds() const;
+	double getMaxUpdateSeconds() const;
+
+	// Number of chunks populated on the main thread since the stats were reset.
+	int getSyncBuildCount() const;
+
+	void resetStreamingStats();
+
+	// Updates the chunk manager with the player's position as the current center of the game
+	// world. Chunks around the player and where they're headed are populated on the job pool from
+	// the given level of the map definition (ignored in the wilderness, where each chunk has its
+	// own level), which must outlive any chunks still building. This invalidates all existing
+	// chunk IDs.
+	void update(const NewDouble2 &playerPosition, const NewDouble2 &playerVelocity,
+		const MapDefinition &mapDefinition, int levelIndex, JobPool &jobPool,
+		EntityManager &entityManager);
+
+	// Blocks until every chunk being populated by a worker is finished. Finished chunks are
+	// picked up by the next update.
+	void waitForBuilds();
 };
 
 #endif
@@ -42,6 +42,7 @@
 
 #include "components/debug/Debug.h"
 #include "components/utilities/Bytes.h"
+#include "components/utilities/Profiler.h"
 #include "components/utilities/String.h"
 #include "components/utilities/StringView.h"
 
@@ -1394,11 +1395,17 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 	const BinaryAssetLibrary &binaryAssetLibrary, Random &random, CitizenManager &citizenManager,
 	TextureManager &textureManager, TextureInstanceManager &textureInstManager, Renderer &renderer)
 {
+	ProfilerZone("LevelData::setActive");
+
 	// Clear renderer textures, distant sky, and entities.
 	renderer.clearTexturesAndEntityRenderIDs();
 	renderer.clearDistantSky();
 	this->entityManager.clear();
 
+	// Voxel and entity textures are converted on the renderer's job pool while the rest of the
+	// level loads, and swapped in together at the end.
+	renderer.beginTextureBatch();
+
 	// Palette for voxels and flats, required in the renderer so it can conditionally transform
 	// certain palette indices for transparency.
 	COLFile col;
@@ -1562,7 +1569,7 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 
 				// The entity can only be instantiated if there is at least an idle animation.
 				int idleStateIndex;
-				if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &idleStateIndex))
+				if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &idleStateIndex))
 				{
 					DebugLogWarning("Missing static entity idle anim state for flat \"" +
 						std::to_string(flatIndex) + "\".");
@@ -1585,7 +1592,7 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 
 				// Must have at least an idle animation.
 				int idleStateIndex;
-				if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &idleStateIndex))
+				if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &idleStateIndex))
 				{
 					DebugLogWarning("Missing dynamic entity idle anim state for flat \"" +
 						std::to_string(flatIndex) + "\".");
@@ -1691,7 +1698,7 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 				if (!isStreetlight)
 				{
 					// Entities will use idle animation by default.
-					if (!entityAnimDefRef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &defaultStateIndex))
+					if (!entityAnimDefRef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &defaultStateIndex))
 					{
 						DebugLogWarning("Couldn't get idle state index for flat \"" +
 							std::to_string(flatIndex) + "\".");
@@ -1703,8 +1710,10 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 					// Need to turn streetlights on or off at initialization.
 					const std::string &streetlightStateName = nightLightsAreActive ?
 						EntityAnimationUtils::STATE_ACTIVATED : EntityAnimationUtils::STATE_IDLE;
+					const EntityAnimationStateID streetlightStateID = nightLightsAreActive ?
+						EntityAnimationUtils::STATE_ID_ACTIVATED : EntityAnimationUtils::STATE_ID_IDLE;
 
-					if (!entityAnimDefRef.tryGetStateIndex(streetlightStateName.c_str(), &defaultStateIndex))
+					if (!entityAnimDefRef.tryGetStateIndex(streetlightStateID, &defaultStateIndex))
 					{
 						DebugLogWarning("Couldn't get \"" + streetlightStateName +
 							"\" streetlight state index for flat \"" + std::to_string(flatIndex) + "\".");
@@ -1756,6 +1765,8 @@ void LevelData::setActive(bool nightLightsAreActive, const WorldData &worldData,
 	loadVoxelTextures();
 	loadChasmTextures();
 	loadEntities();
+
+	renderer.endTextureBatch();
 }
 
 void LevelData::tick(Game &game, double dt)
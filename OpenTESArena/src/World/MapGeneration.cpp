@@ -229,7 +229,7 @@ namespace MapGeneration
 
 			// The entity can only be instantiated if there is at least an idle animation.
 			int idleStateIndex;
-			if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &idleStateIndex))
+			if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &idleStateIndex))
 			{
 				DebugLogWarning("Missing static entity idle anim state for flat \"" +
 					std::to_string(flatIndex) + "\".");
@@ -251,7 +251,7 @@ namespace MapGeneration
 
 			// Must have at least an idle animation.
 			int idleStateIndex;
-			if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_IDLE.c_str(), &idleStateIndex))
+			if (!entityAnimDef.tryGetStateIndex(EntityAnimationUtils::STATE_ID_IDLE, &idleStateIndex))
 			{
 				DebugLogWarning("Missing dynamic entity idle anim state for flat \"" +
 					std::to_string(flatIndex) + "\".");
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <atomic>
 
+#include "ChunkUtils.h"
 #include "VoxelGrid.h"
 
 #include "components/debug/Debug.h"
@@ -13,10 +15,23 @@ VoxelGrid::VoxelGrid(SNInt width, int height, WEInt depth)
 	this->height = height;
 	this->depth = depth;
 
+	ChunkUtils::getChunkCounts(width, depth, &this->chunkCountX, &this->chunkCountZ);
+	this->chunkRevisions = std::vector<uint64_t>(this->chunkCountX * this->chunkCountZ);
+	for (uint64_t &revision : this->chunkRevisions)
+	{
+		revision = VoxelGrid::makeRevision();
+	}
+
 	// Add empty (air) voxel definition by default.
 	this->addVoxelDef(VoxelDefinition());
 }
 
+uint64_t VoxelGrid::makeRevision()
+{
+	static std::atomic<uint64_t> nextRevision(1);
+	return nextRevision.fetch_add(1, std::memory_order_relaxed);
+}
+
 int VoxelGrid::getIndex(SNInt x, int y, WEInt z) const
 {
 	DebugAssert(this->coordIsValid(x, y, z));
@@ -38,6 +53,23 @@ WEInt VoxelGrid::getDepth() const
 	return this->depth;
 }
 
+SNInt VoxelGrid::getChunkCountX() const
+{
+	return this->chunkCountX;
+}
+
+WEInt VoxelGrid::getChunkCountZ() const
+{
+	return this->chunkCountZ;
+}
+
+uint64_t VoxelGrid::getChunkRevision(SNInt chunkX, WEInt chunkZ) const
+{
+	DebugAssert((chunkX >= 0) && (chunkX < this->chunkCountX));
+	DebugAssert((chunkZ >= 0) && (chunkZ < this->chunkCountZ));
+	return this->chunkRevisions[chunkX + (chunkZ * this->chunkCountX)];
+}
+
 bool VoxelGrid::coordIsValid(SNInt x, int y, WEInt z) const
 {
 	return (x >= 0) && (x < this->width) && (y >= 0) && (y < this->height) &&
@@ -50,12 +82,6 @@ uint16_t VoxelGrid::getVoxel(SNInt x, int y, WEInt z) const
 	return this->voxels.data()[index];
 }
 
-VoxelDefinition &VoxelGrid::getVoxelDef(uint16_t id)
-{
-	DebugAssertIndex(this->voxelDefs, id);
-	return this->voxelDefs[id];
-}
-
 const VoxelDefinition &VoxelGrid::getVoxelDef(uint16_t id) const
 {
 	DebugAssertIndex(this->voxelDefs, id);
@@ -85,5 +111,13 @@ uint16_t VoxelGrid::addVoxelDef(const VoxelDefinition &voxelDef)
 void VoxelGrid::setVoxel(SNInt x, int y, WEInt z, uint16_t id)
 {
 	const int index = this->getIndex(x, y, z);
-	this->voxels.data()[index] = id;
+	uint16_t &voxel = this->voxels.data()[index];
+	if (voxel != id)
+	{
+		voxel = id;
+
+		const SNInt chunkX = x / ChunkUtils::CHUNK_DIM;
+		const WEInt chunkZ = z / ChunkUtils::CHUNK_DIM;
+		this->chunkRevisions[chunkX + (chunkZ * this->chunkCountX)] = VoxelGrid::makeRevision();
+	}
 }
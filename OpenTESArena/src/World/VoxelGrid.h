@@ -23,9 +23,16 @@ public:
 private:
 	std::vector<uint16_t> voxels;
 	std::vector<VoxelDefinition> voxelDefs;
+	std::vector<uint64_t> chunkRevisions; // Changes whenever a voxel in the chunk changes.
 	SNInt width;
 	int height;
 	WEInt depth;
+	SNInt chunkCountX;
+	WEInt chunkCountZ;
+
+	// Gets a revision no voxel grid has used before, so caches built from one grid are never
+	// mistaken as current for another.
+	static uint64_t makeRevision();
 
 	// Converts XYZ coordinate to index.
 	int getIndex(SNInt x, int y, WEInt z) const;
@@ -37,14 +44,22 @@ public:
 	int getHeight() const;
 	WEInt getDepth() const;
 
+	// Gets the number of chunks needed to cover the voxel grid.
+	SNInt getChunkCountX() const;
+	WEInt getChunkCountZ() const;
+
+	// Gets a revision for telling whether data derived from a chunk is out of date. It changes
+	// when one of the chunk's voxels is set to a different ID.
+	uint64_t getChunkRevision(SNInt chunkX, WEInt chunkZ) const;
+
 	// Returns whether the given coordinate lies within the voxel grid.
 	bool coordIsValid(SNInt x, int y, WEInt z) const;
 
 	// Convenience method for getting a voxel's ID.
 	uint16_t getVoxel(SNInt x, int y, WEInt z) const;
 
-	// Gets the voxel definitions associated with an ID.
-	VoxelDefinition &getVoxelDef(uint16_t id);
+	// Gets the voxel definitions associated with an ID. Definitions can't be changed once added,
+	// so chunk revisions cover everything derived from the grid.
 	const VoxelDefinition &getVoxelDef(uint16_t id) const;
 	
 	// Finds a voxel definition ID that matches the predicate, or none if not found.
@@ -0,0 +1,163 @@
+#include "JobPool.h"
+#include "Profiler.h"
+#include "../debug/Debug.h"
+
+JobPool::Batch::Batch()
+{
+	this->pendingCount = 0;
+}
+
+JobPool::JobPool()
+{
+	this->pendingCount = 0;
+	this->stopping = false;
+}
+
+JobPool::~JobPool()
+{
+	this->shutdown();
+}
+
+void JobPool::workerLoop()
+{
+	while (true)
+	{
+		QueuedJob queuedJob;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->jobCondition.wait(lock, [this]()
+			{
+				return this->stopping || (this->jobs.size() > 0);
+			});
+
+			// Queued jobs are still run when stopping so waiters aren't left hanging.
+			if (this->jobs.size() == 0)
+			{
+				return;
+			}
+
+			queuedJob = std::move(this->jobs.front());
+			this->jobs.pop_front();
+		}
+
+		queuedJob.job();
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->pendingCount--;
+
+		bool batchDone = false;
+		if (queuedJob.batch != nullptr)
+		{
+			queuedJob.batch->pendingCount--;
+			batchDone = queuedJob.batch->pendingCount == 0;
+		}
+
+		if ((this->pendingCount == 0) || batchDone)
+		{
+			this->idleCondition.notify_all();
+		}
+	}
+}
+
+void JobPool::init(int threadCount, const std::string &threadName)
+{
+	DebugAssert(threadCount >= 0);
+	this->shutdown();
+
+	this->stopping = false;
+	this->threads.reserve(threadCount);
+	for (int i = 0; i < threadCount; i++)
+	{
+		const std::string name = threadName + " " + std::to_string(i);
+		this->threads.emplace_back([this, name]()
+		{
+			Profiler::get().setThreadName(name);
+			this->workerLoop();
+		});
+	}
+}
+
+int JobPool::getThreadCount() const
+{
+	return static_cast<int>(this->threads.size());
+}
+
+void JobPool::submit(Job &&job)
+{
+	if (this->threads.size() == 0)
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		QueuedJob &queuedJob = this->jobs.emplace_back();
+		queuedJob.job = std::move(job);
+		queuedJob.batch = nullptr;
+		this->pendingCount++;
+	}
+
+	this->jobCondition.notify_one();
+}
+
+void JobPool::submit(Job &&job, Batch &batch)
+{
+	if (this->threads.size() == 0)
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		QueuedJob &queuedJob = this->jobs.emplace_back();
+		queuedJob.job = std::move(job);
+		queuedJob.batch = &batch;
+		this->pendingCount++;
+		batch.pendingCount++;
+	}
+
+	this->jobCondition.notify_one();
+}
+
+void JobPool::wait()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->idleCondition.wait(lock, [this]()
+	{
+		return this->pendingCount == 0;
+	});
+}
+
+void JobPool::wait(Batch &batch)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->idleCondition.wait(lock, [&batch]()
+	{
+		return batch.pendingCount == 0;
+	});
+}
+
+void JobPool::shutdown()
+{
+	if (this->threads.size() == 0)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+
+	this->jobCondition.notify_all();
+
+	for (std::thread &thread : this->threads)
+	{
+		thread.join();
+	}
+
+	this->threads.clear();
+}
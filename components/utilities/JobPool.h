@@ -0,0 +1,76 @@
+#ifndef JOB_POOL_H
+#define JOB_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Worker threads that run queued jobs in the background. Meant for batches of independent CPU
+// work (i.e., converting textures while a level loads) where the submitting thread keeps going
+// and later waits for everything it submitted to finish. Jobs can be submitted as part of a
+// batch so the submitter only waits for its own jobs and not for other users of the pool.
+//
+// Jobs start in submission order but may finish in any order. A pool without threads runs each
+// job immediately on the submitting thread.
+
+class JobPool
+{
+public:
+	using Job = std::function<void()>;
+
+	// Unfinished jobs of one group of submissions. Must outlive its jobs, so wait on it before
+	// it goes away.
+	struct Batch
+	{
+		int pendingCount; // Queued and running jobs. Guarded by the pool's mutex.
+
+		Batch();
+	};
+private:
+	struct QueuedJob
+	{
+		Job job;
+		Batch *batch; // Null if not part of a batch.
+	};
+
+	std::vector<std::thread> threads;
+	std::deque<QueuedJob> jobs;
+	std::mutex mutex;
+	std::condition_variable jobCondition; // Signaled when a job is queued or the pool is stopping.
+	std::condition_variable idleCondition; // Signaled when the last pending job (or batch job) finishes.
+	int pendingCount; // Queued and running jobs.
+	bool stopping;
+
+	void workerLoop();
+public:
+	JobPool();
+	~JobPool();
+
+	// Starts the given number of worker threads, replacing any existing ones. The thread name
+	// is for profiler traces.
+	void init(int threadCount, const std::string &threadName);
+
+	int getThreadCount() const;
+
+	// Queues a job for the next idle worker.
+	void submit(Job &&job);
+
+	// Queues a job for the next idle worker as part of the given batch.
+	void submit(Job &&job, Batch &batch);
+
+	// Blocks until every job submitted so far has finished.
+	void wait();
+
+	// Blocks until every job submitted so far in the given batch has finished. Jobs from other
+	// batches might still be running.
+	void wait(Batch &batch);
+
+	// Finishes pending jobs and stops the worker threads.
+	void shutdown();
+};
+
+#endif
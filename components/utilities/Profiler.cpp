@@ -1,67 +1,233 @@
 #include <algorithm>
+#include <fstream>
 
 #include "Profiler.h"
 #include "../debug/Debug.h"
 
-double Profiler::Sampler::getSeconds() const
+namespace
 {
-	return static_cast<double>((this->endTime - this->startTime).count()) /
-		static_cast<double>(std::nano::den);
+	// Cached per thread so recording a zone doesn't need the timelines mutex.
+	thread_local void *CurrentThreadTimeline = nullptr;
+
+	// Zone names are usually identifiers, but make sure they can't break the JSON.
+	std::string EscapeJsonString(const std::string &str)
+	{
+		std::string escaped;
+		escaped.reserve(str.size());
+
+		for (const char c : str)
+		{
+			if ((c == '"') || (c == '\\'))
+			{
+				escaped.push_back('\\');
+				escaped.push_back(c);
+			}
+			else if (static_cast<unsigned char>(c) >= 0x20)
+			{
+				escaped.push_back(c);
+			}
+		}
+
+		return escaped;
+	}
+
+	// Chrome trace timestamps are in microseconds.
+	std::string NanosecondsToMicroseconds(int64_t nanoseconds)
+	{
+		const int64_t wholeMicroseconds = nanoseconds / 1000;
+		const int64_t remainder = nanoseconds % 1000;
+		std::string str = std::to_string(wholeMicroseconds) + '.';
+		str += static_cast<char>('0' + (remainder / 100));
+		str += static_cast<char>('0' + ((remainder / 10) % 10));
+		str += static_cast<char>('0' + (remainder % 10));
+		return str;
+	}
+}
+
+Profiler::Zone::Zone(const char *name)
+{
+	this->name = name;
+
+	Profiler &profiler = Profiler::get();
+	if (profiler.isEnabled())
+	{
+		ThreadTimeline &timeline = profiler.getThreadTimeline();
+		timeline.depth++;
+		this->startNanoseconds = profiler.getNanoseconds();
+	}
+	else
+	{
+		this->startNanoseconds = -1;
+	}
 }
 
-double Profiler::Sampler::getMilliseconds() const
+Profiler::Zone::~Zone()
 {
-	return this->getSeconds() * 1000.0;
+	if (this->startNanoseconds < 0)
+	{
+		return;
+	}
+
+	Profiler &profiler = Profiler::get();
+	const int64_t endNanoseconds = profiler.getNanoseconds();
+	ThreadTimeline &timeline = profiler.getThreadTimeline();
+	timeline.depth--;
+
+	// Only this thread writes the count, so a relaxed load is enough. The release store makes the
+	// event visible to an exporting thread once the count includes it.
+	const uint64_t eventCount = timeline.eventCount.load(std::memory_order_relaxed);
+	Event &event = timeline.events[eventCount % Profiler::EVENTS_PER_THREAD];
+	event.name = this->name;
+	event.startNanoseconds = this->startNanoseconds;
+	event.endNanoseconds = endNanoseconds;
+	event.depth = timeline.depth;
+	timeline.eventCount.store(eventCount + 1, std::memory_order_release);
 }
 
-void Profiler::Sampler::setStart()
+Profiler::ThreadTimeline::ThreadTimeline(int id)
+	: events(std::make_unique<Event[]>(Profiler::EVENTS_PER_THREAD))
 {
+	this->eventCount = 0;
+	this->name = "Thread " + std::to_string(id);
+	this->id = id;
+	this->depth = 0;
+}
+
+Profiler::Profiler()
+{
+	this->frameMarkers.fill(0);
+	this->frameCount = 0;
 	this->startTime = std::chrono::high_resolution_clock::now();
+	this->enabled = false;
 }
 
-void Profiler::Sampler::setStop()
+Profiler &Profiler::get()
 {
-	this->endTime = std::chrono::high_resolution_clock::now();
+	static Profiler profiler;
+	return profiler;
 }
 
-Profiler::Sampler *Profiler::findSampler(const std::string &name)
+Profiler::ThreadTimeline &Profiler::getThreadTimeline()
 {
-	const auto iter = std::find_if(this->samplers.begin(), this->samplers.end(),
-		[&name](const auto &pair)
+	if (CurrentThreadTimeline == nullptr)
 	{
-		return pair.first == name;
-	});
+		// Timelines are never freed while the profiler exists, so the pointer stays valid even
+		// after the thread exits.
+		std::lock_guard<std::mutex> lock(this->timelinesMutex);
+		const int id = static_cast<int>(this->timelines.size());
+		this->timelines.push_back(std::make_unique<ThreadTimeline>(id));
+		CurrentThreadTimeline = this->timelines.back().get();
+	}
+
+	return *static_cast<ThreadTimeline*>(CurrentThreadTimeline);
+}
 
-	return (iter != this->samplers.end()) ? iter->second.get() : nullptr;
+int64_t Profiler::getNanoseconds() const
+{
+	const auto now = std::chrono::high_resolution_clock::now();
+	return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		now - this->startTime).count());
+}
+
+bool Profiler::isEnabled() const
+{
+	return this->enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::getFrameCount() const
+{
+	return this->frameCount.load(std::memory_order_relaxed);
 }
 
-Profiler::Sampler *Profiler::addSampler(const std::string &name)
+void Profiler::setEnabled(bool enabled)
 {
-	DebugAssertMsg(this->findSampler(name) == nullptr, "Sampler \"" + name + "\" already exists.");
-	this->samplers.push_back(std::make_pair(name, std::make_unique<Sampler>()));
-	return this->samplers.back().second.get();
+	this->enabled.store(enabled, std::memory_order_relaxed);
 }
 
-Profiler::Sampler *Profiler::getSampler(const std::string &name)
+void Profiler::setThreadName(const std::string &name)
 {
-	return this->findSampler(name);
+	ThreadTimeline &timeline = this->getThreadTimeline();
+	std::lock_guard<std::mutex> lock(this->timelinesMutex);
+	timeline.name = name;
+}
+
+void Profiler::markFrame()
+{
+	if (!this->isEnabled())
+	{
+		return;
+	}
+
+	const uint64_t frameIndex = this->frameCount.load(std::memory_order_relaxed);
+	this->frameMarkers[frameIndex % Profiler::MAX_FRAME_MARKERS] = this->getNanoseconds();
+	this->frameCount.store(frameIndex + 1, std::memory_order_release);
 }
 
-void Profiler::removeSampler(const std::string &name)
+bool Profiler::exportChromeTrace(const std::string &filename)
 {
-	const auto iter = std::find_if(this->samplers.begin(), this->samplers.end(),
-		[&name](const auto &pair)
+	std::ofstream stream(filename);
+	if (!stream.is_open())
 	{
-		return pair.first == name;
-	});
+		DebugLogError("Couldn't open \"" + filename + "\" for writing.");
+		return false;
+	}
+
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
 
-	if (iter != this->samplers.end())
+	bool isFirstEvent = true;
+	auto beginEvent = [&stream, &isFirstEvent]() -> std::ofstream&
 	{
-		this->samplers.erase(iter);
+		if (!isFirstEvent)
+		{
+			stream << ",\n";
+		}
+
+		isFirstEvent = false;
+		return stream;
+	};
+
+	std::lock_guard<std::mutex> lock(this->timelinesMutex);
+	for (const auto &timeline : this->timelines)
+	{
+		beginEvent() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << timeline->id <<
+			",\"args\":{\"name\":\"" << EscapeJsonString(timeline->name) << "\"}}";
+
+		// Oldest to newest surviving events.
+		const uint64_t eventCount = timeline->eventCount.load(std::memory_order_acquire);
+		const uint64_t firstEvent = (eventCount > static_cast<uint64_t>(Profiler::EVENTS_PER_THREAD)) ?
+			(eventCount - Profiler::EVENTS_PER_THREAD) : 0;
+		for (uint64_t i = firstEvent; i < eventCount; i++)
+		{
+			const Event &event = timeline->events[i % Profiler::EVENTS_PER_THREAD];
+			beginEvent() << "{\"name\":\"" << EscapeJsonString(event.name) <<
+				"\",\"ph\":\"X\",\"pid\":0,\"tid\":" << timeline->id <<
+				",\"ts\":" << NanosecondsToMicroseconds(event.startNanoseconds) <<
+				",\"dur\":" << NanosecondsToMicroseconds(event.endNanoseconds - event.startNanoseconds) <<
+				",\"args\":{\"depth\":" << event.depth << "}}";
+		}
 	}
+
+	// Frame markers as global instant events.
+	const uint64_t frameCount = this->frameCount.load(std::memory_order_acquire);
+	const uint64_t firstFrame = (frameCount > static_cast<uint64_t>(Profiler::MAX_FRAME_MARKERS)) ?
+		(frameCount - Profiler::MAX_FRAME_MARKERS) : 0;
+	for (uint64_t i = firstFrame; i < frameCount; i++)
+	{
+		beginEvent() << "{\"name\":\"Frame " << i << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0" <<
+			",\"ts\":" << NanosecondsToMicroseconds(this->frameMarkers[i % Profiler::MAX_FRAME_MARKERS]) << "}";
+	}
+
+	stream << "\n]}\n";
+	return stream.good();
 }
 
 void Profiler::clear()
 {
-	this->samplers.clear();
+	std::lock_guard<std::mutex> lock(this->timelinesMutex);
+	for (const auto &timeline : this->timelines)
+	{
+		timeline->eventCount.store(0, std::memory_order_relaxed);
+	}
+
+	this->frameCount.store(0, std::memory_order_relaxed);
 }
@@ -1,44 +1,115 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+// Hierarchical profiler for timing nested zones of code on any thread. Each thread records its
+// finished zones into its own fixed-size ring buffer without locking, so only the most recent
+// zones are kept. Recorded timelines can be exported as Chrome trace-event JSON and opened in
+// chrome://tracing or Perfetto.
+//
+// Zones are declared with the macros at the bottom of this file. When the profiler is disabled,
+// a zone costs one atomic load.
+
 class Profiler
 {
 public:
-	class Sampler
+	// Max finished zones kept per thread before the oldest are overwritten.
+	static constexpr int EVENTS_PER_THREAD = 1 << 14;
+
+	// Max frame markers kept before the oldest are overwritten.
+	static constexpr int MAX_FRAME_MARKERS = 1024;
+
+	// A finished zone on one thread.
+	struct Event
+	{
+		const char *name; // Must outlive the profiler (i.e., a string literal).
+		int64_t startNanoseconds, endNanoseconds; // Relative to the profiler's creation.
+		int depth; // Nesting level on the zone's thread, 0 for outermost zones.
+	};
+
+	// Times the calling thread from construction to destruction.
+	class Zone
 	{
 	private:
-		std::chrono::time_point<std::chrono::high_resolution_clock> startTime, endTime;
+		const char *name;
+		int64_t startNanoseconds; // Negative if the profiler was disabled at construction.
 	public:
-		double getSeconds() const;
-		double getMilliseconds() const;
+		Zone(const char *name);
+		~Zone();
 
-		void setStart();
-		void setStop();
+		Zone(const Zone&) = delete;
+		Zone &operator=(const Zone&) = delete;
 	};
 private:
-	// Need to allocate sampler on the heap so returned pointers are not invalidated
-	// on vector resize.
-	std::vector<std::pair<std::string, std::unique_ptr<Sampler>>> samplers;
+	// Zones recorded by one thread. Only that thread writes events; other threads only read
+	// them while exporting.
+	struct ThreadTimeline
+	{
+		std::unique_ptr<Event[]> events; // Ring buffer.
+		std::atomic<uint64_t> eventCount; // Events written since the last clear.
+		std::string name;
+		int id;
+		int depth; // Current zone nesting level.
+
+		ThreadTimeline(int id);
+	};
+
+	std::vector<std::unique_ptr<ThreadTimeline>> timelines; // One per thread that recorded a zone.
+	std::mutex timelinesMutex;
+	std::array<int64_t, MAX_FRAME_MARKERS> frameMarkers; // Ring buffer of frame start times.
+	std::atomic<uint64_t> frameCount;
+	std::chrono::high_resolution_clock::time_point startTime;
+	std::atomic<bool> enabled;
 
-	// Searches samplers for the one with the given name.
-	Sampler *findSampler(const std::string &name);
+	Profiler();
+
+	// Gets the calling thread's timeline, registering it on first use.
+	ThreadTimeline &getThreadTimeline();
+
+	// Time since the profiler was created.
+	int64_t getNanoseconds() const;
 public:
-	// Overwrites existing (if any).
-	Sampler *addSampler(const std::string &name);
+	// The process-wide profiler, so any thread can record zones without being handed one.
+	static Profiler &get();
+
+	bool isEnabled() const;
+
+	// Frames before the first marker count as frame 0.
+	uint64_t getFrameCount() const;
+
+	// Starts or stops recording. Zones already in progress still finish normally.
+	void setEnabled(bool enabled);
 
-	// Gets sampler from the given name, or null if it doesn't exist.
-	Sampler *getSampler(const std::string &name);
+	// Names the calling thread in exported traces.
+	void setThreadName(const std::string &name);
 
-	// Removes sampler if it exists.
-	void removeSampler(const std::string &name);
+	// Marks the start of a new frame. Intended to be called once per iteration of the main loop.
+	void markFrame();
 
-	// Clears all samplers from the profiler.
+	// Writes every thread's recorded zones and the frame markers to a Chrome trace-event JSON
+	// file. Zones finishing during the export may or may not be included.
+	bool exportChromeTrace(const std::string &filename);
+
+	// Forgets recorded zones and frame markers. Only call when no zones are being recorded on
+	// other threads.
 	void clear();
 };
 
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+// Times the rest of the enclosing scope as a zone with the given string literal name.
+#define ProfilerZone(name) const Profiler::Zone PROFILER_CONCAT(profilerZone, __LINE__)(name)
+
+// Marks the start of a new frame.
+#define ProfilerFrame() Profiler::get().markFrame()
+
 #endif